@@ -56,6 +56,7 @@
 
 #include "make_const_nonconst.h"
 #include "behavior_data.h"
+#include "engine/behavior_script.h"
 
 #define BC_B(a) _SHIFTL(a, 24, 8)
 #define BC_BB(a, b) (_SHIFTL(a, 24, 8) | _SHIFTL(b, 16, 8))
@@ -67,65 +68,6 @@
 #define BC_W(a) ((uintptr_t)(u32)(a))
 #define BC_PTR(a) ((uintptr_t)(a))
 
-enum BehaviorCommands {
-    /*0x00*/ BHV_CMD_BEGIN,
-    /*0x01*/ BHV_CMD_DELAY,
-    /*0x02*/ BHV_CMD_CALL,
-    /*0x03*/ BHV_CMD_RETURN,
-    /*0x04*/ BHV_CMD_GOTO,
-    /*0x05*/ BHV_CMD_BEGIN_REPEAT,
-    /*0x06*/ BHV_CMD_END_REPEAT,
-    /*0x07*/ BHV_CMD_END_REPEAT_CONTINUE,
-    /*0x08*/ BHV_CMD_BEGIN_LOOP,
-    /*0x09*/ BHV_CMD_END_LOOP,
-    /*0x0A*/ BHV_CMD_BREAK,
-    /*0x0B*/ BHV_CMD_BREAK_UNUSED,
-    /*0x0C*/ BHV_CMD_CALL_NATIVE,
-    /*0x0D*/ BHV_CMD_ADD_FLOAT,
-    /*0x0E*/ BHV_CMD_SET_FLOAT,
-    /*0x0F*/ BHV_CMD_ADD_INT,
-    /*0x10*/ BHV_CMD_SET_INT,
-    /*0x11*/ BHV_CMD_OR_INT,
-    /*0x12*/ BHV_CMD_BIT_CLEAR,
-    /*0x13*/ BHV_CMD_SET_INT_RAND_RSHIFT,
-    /*0x14*/ BHV_CMD_SET_RANDOM_FLOAT,
-    /*0x15*/ BHV_CMD_SET_RANDOM_INT,
-    /*0x16*/ BHV_CMD_ADD_RANDOM_FLOAT,
-    /*0x17*/ BHV_CMD_ADD_INT_RAND_RSHIFT,
-    /*0x18*/ BHV_CMD_NOP_1,
-    /*0x19*/ BHV_CMD_NOP_2,
-    /*0x1A*/ BHV_CMD_NOP_3,
-    /*0x1B*/ BHV_CMD_SET_MODEL,
-    /*0x1C*/ BHV_CMD_SPAWN_CHILD,
-    /*0x1D*/ BHV_CMD_DEACTIVATE,
-    /*0x1E*/ BHV_CMD_DROP_TO_FLOOR,
-    /*0x1F*/ BHV_CMD_SUM_FLOAT,
-    /*0x20*/ BHV_CMD_SUM_INT,
-    /*0x21*/ BHV_CMD_BILLBOARD,
-    /*0x22*/ BHV_CMD_HIDE,
-    /*0x23*/ BHV_CMD_SET_HITBOX,
-    /*0x24*/ BHV_CMD_NOP_4,
-    /*0x25*/ BHV_CMD_DELAY_VAR,
-    /*0x26*/ BHV_CMD_BEGIN_REPEAT_UNUSED,
-    /*0x27*/ BHV_CMD_LOAD_ANIMATIONS,
-    /*0x28*/ BHV_CMD_ANIMATE,
-    /*0x29*/ BHV_CMD_SPAWN_CHILD_WITH_PARam,
-    /*0x2A*/ BHV_CMD_LOAD_COLLISION_DATA,
-    /*0x2B*/ BHV_CMD_SET_HITBOX_WITH_OFFSet,
-    /*0x2C*/ BHV_CMD_SPAWN_OBJ,
-    /*0x2D*/ BHV_CMD_SET_HOME,
-    /*0x2E*/ BHV_CMD_SET_HURTBOX,
-    /*0x2F*/ BHV_CMD_SET_INTERACT_TYPE,
-    /*0x30*/ BHV_CMD_SET_OBJ_PHYSICS,
-    /*0x31*/ BHV_CMD_SET_INTERACT_SUBTYPE,
-    /*0x32*/ BHV_CMD_SCALE,
-    /*0x33*/ BHV_CMD_PARENT_BIT_CLEAR,
-    /*0x34*/ BHV_CMD_ANIMATE_TEXTURE,
-    /*0x35*/ BHV_CMD_DISABLE_RENDERING,
-    /*0x36*/ BHV_CMD_SET_INT_UNUSED,
-    /*0x37*/ BHV_CMD_SPAWN_WATER_DROPLET,
-};
-
 // Defines the start of the behavior script as well as the object list the object belongs to.
 // Has some special behavior for certain objects.
 #define BEGIN(objList) \
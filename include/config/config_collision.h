@@ -23,3 +23,39 @@
 // Currently, they *must* say as s8, because the room tables generated by literally anything are explicitly u8 and don't use a macro, making this currently infeasable.
 #define COLLISION_DATA_TYPE s16
 #define ROOM_DATA_TYPE s8
+
+// Splits static collision cells that hold more than STATIC_SURFACE_TREE_LEAF_SIZE floors or ceilings into a quadtree when the area is loaded,
+// so floor and ceiling checks in dense parts of big levels only walk the surfaces near them. Results are identical to the plain cell lists.
+// Costs one surface node per surface per leaf it overlaps, plus STATIC_SURFACE_TREE_NODE_POOL_SIZE tree nodes (8 bytes each) of RAM.
+// Building the trees about doubles the time load_area_terrain takes (BBH goes from 0.5 to 1.1 ms in tools/collision_bench on a PC),
+// unless the collision is baked with BAKE_COLLISION=1, which builds them at compile time instead.
+#define STATIC_SURFACE_TREE
+#define STATIC_SURFACE_TREE_LEAF_SIZE      16
+#define STATIC_SURFACE_TREE_MAX_DEPTH      3 // Each level of depth halves the leaf size, 3 turns 1024 unit cells into 128 unit leaves.
+#define STATIC_SURFACE_TREE_NODE_POOL_SIZE 2048
+
+// Packs the static floors, ceilings and walls into flat structure-of-arrays storage once an area is loaded, so collision checks read
+// contiguous index ranges instead of following SurfaceNode pointers across the surface pool. Results are identical to the plain lists.
+// Costs 37 bytes per PACKED_SURFACE_POOL_SIZE surface and 6 bytes per PACKED_SURFACE_ENTRY_POOL_SIZE list entry of RAM.
+// Areas that don't fit keep using the lists. Both sizes can be at most 65535.
+// #define PACKED_STATIC_SURFACES
+#define PACKED_SURFACE_POOL_SIZE       4096
+#define PACKED_SURFACE_ENTRY_POOL_SIZE 24576
+
+// Keeps the surfaces of surface objects in the dynamic partition between frames instead of clearing and reloading all of them every frame.
+// Objects whose transform didn't change since they were last loaded are skipped, and moved objects only update the cells they leave and enter.
+// Surfaces at the same height can end up in a different order in their cell lists, so which of two such floors is found may differ.
+// Each surface object's surfaces are allocated from a pool of DYNAMIC_SURFACE_POOL_SIZE surfaces (48 bytes each) of RAM.
+// #define INCREMENTAL_DYNAMIC_SURFACES
+#define DYNAMIC_SURFACE_POOL_SIZE 1024
+
+// Remembers the results of the last floor checks, so checking the same point again before any surface is loaded, moved or unloaded
+// (e.g. an object's shadow right after its floor snapping) doesn't walk the cell lists again. Results are identical to uncached checks.
+// Must be a power of 2. Comment out to disable.
+#define FIND_FLOOR_CACHE_SIZE 16
+
+// Sorts the tangible objects into a grid once per frame before checking object collisions, so each object is only checked
+// against the objects near it instead of every object of the lists it's checked against. Results are identical to checking the lists.
+// Building the grid costs about as much as clearing the collisions already did, so it mostly pays off in levels with lots of
+// tangible objects, like a few hundred coins. Costs about 7 KB of RAM.
+#define OBJECT_COLLISION_GRID
@@ -14,6 +14,12 @@
 // If not using PUPPYPRINT_DEBUG, press L to toggle the profiler.
 // #define USE_PROFILER
 
+// Records begin/end events for the frame, object updates, collision, graph processing, audio and RSP tasks.
+// The most recent frame that took longer than two vblanks is kept in RAM (gProfilerTraceSlowFrame), and is also
+// sent over USB when UNF is enabled. Convert it with tools/profiler_trace_to_json.py and open it in a Chrome
+// trace viewer such as chrome://tracing or Perfetto. Costs about 48 KB of RAM. Enables USE_PROFILER.
+// #define PROFILER_TRACE
+
 // TEST LEVEL
 // Uncomment this define and set a test level in order to boot straight into said level.
 // This allows you to quickly test the level you're working on.
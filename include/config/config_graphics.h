@@ -82,6 +82,33 @@
 // This improves performance a bit, and does not seem to break anything.
 #define DISABLE_GRAPH_NODE_TYPE_FUNCTIONAL
 
+// Skips display list nodes whose vertices are entirely outside the camera frustum, including above and below the screen.
+// Bounds are computed from the vertices when the geo layout is loaded. Only helps levels whose geometry is split into
+// several display lists by location, since a display list is either drawn whole or not at all.
+// Display lists that load their own matrices with gSPMatrix are never culled. Not yet tested on console.
+// #define DISPLAY_LIST_CULLING
+
+// Draws all instances of a single-material display list node on a layer together, e.g. every coin on screen.
+// The display list's material setup runs once per layer instead of once per instance.
+// Only applies to z-buffered layers, since the instances are drawn after the rest of the layer, and not to display
+// lists after one of the object's generated lists, which can depend on the state it sets.
+// Checked against drawing each instance on its own by tools/graph_check/instancing_check. Not yet tested on console.
+// #define DISPLAY_LIST_INSTANCING
+
+// Decodes each animation frame once per frame, no matter how many objects show it, instead of once per object.
+// Helps most with groups of objects that animate in step, like goombas or coins. Uses about 6KB of RAM.
+#define ANIMATION_POSE_CACHE
+
+// Converts the matrices of a frame to fixed point in one pass after the scene graph is processed, instead of at every
+// transform node. Matrices no display list is drawn with, e.g. those of culled nodes, are never converted or allocated.
+// tools/graph_check/mtx_check checks that the batch converts matrices the same way as mtxf_to_mtx.
+#define BATCHED_MATRIX_CONVERSION
+
+// Lays out each geo layout as flat depth-first lists when it is loaded, which are processed in a loop instead of
+// recursively. Switch cases, generated lists and other nodes that process their own children still do so.
+// Checked against recursive processing by tools/graph_check/flat_geo_check. Not yet tested on console.
+// #define FLAT_GEO_LAYOUTS
+
 // Disables all object shadows. You'll probably only want this either as a last resort for performance or if you're making a super stylized hack.
 // #define DISABLE_SHADOWS
 
@@ -1,5 +1,14 @@
 #pragma once
 
+/***************************
+ * GENERAL OBJECT SETTINGS *
+ ***************************/
+
+// Decodes the BEGIN_LOOP bodies of behavior scripts the first time an object runs them, so the loops made of CALL_NATIVE and
+// simple field commands (most of them) run straight from a list of function pointers and arguments instead of going through
+// the command table every frame. Costs about 6 KB of RAM.
+#define BEHAVIOR_SCRIPT_PREDECODE
+
 /****************************
  * SPECIFIC OBJECT SETTINGS *
  ****************************/
@@ -8,6 +8,12 @@
 // The end quote should be here:               "
 #define INTERNAL_ROM_NAME "MeatyJesus&Jsels    "
 
+// Decompresses segments while they are DMAed from ROM, instead of DMAing all of a segment before decompressing it.
+// The compressed data goes through a 16KB buffer rather than a copy of the whole segment. RNC1, RNC2 and gzip only.
+// COMPRESS_IN_PLACE=1 in the Makefile turns this off, as that needs no extra buffer at all.
+// Checked against the data segments were compressed from by tools/stream_check. Not yet tested on console.
+// #define STREAMED_DECOMPRESSION
+
 // Enables Rumble Pak Support.
 // Currently not recommended, as it may cause random crashes.
 // #define ENABLE_RUMBLE (1 || VERSION_SH)
@@ -47,6 +47,7 @@
     #undef COMPLETE_SAVE_FILE
     #undef DEBUG_FORCE_CRASH_ON_BOOT
     #undef USE_PROFILER
+    #undef PROFILER_TRACE
 #endif // DISABLE_ALL
 
 #ifdef DEBUG_ALL
@@ -79,6 +80,11 @@
     #define USE_PROFILER
 #endif // PUPPYPRINT_DEBUG
 
+#ifdef PROFILER_TRACE
+    #undef USE_PROFILER
+    #define USE_PROFILER
+#endif // PROFILER_TRACE
+
 #ifdef COMPLETE_SAVE_FILE
     #undef UNLOCK_ALL
     #define UNLOCK_ALL
@@ -159,6 +165,14 @@
  * config_rom.h
  */
 
+#if !defined(RNC1) && !defined(RNC2) && !defined(GZIP)
+    #undef STREAMED_DECOMPRESSION // YAY0 and MIO0 read from three places in the data at once.
+#endif // !RNC1 && !RNC2 && !GZIP
+
+#ifdef IN_PLACE_DECOMPRESSION
+    #undef STREAMED_DECOMPRESSION // The compressed data goes in the buffer being decompressed into instead.
+#endif // IN_PLACE_DECOMPRESSION
+
 #ifndef TARGET_N64
     #undef BORDER_HEIGHT_CONSOLE
     #define BORDER_HEIGHT_CONSOLE  0
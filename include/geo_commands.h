@@ -59,6 +59,7 @@ enum GeoLayoutCommands {
     /*0x1F*/ GEO_CMD_NOP_1F,
     /*0x20*/ GEO_CMD_NODE_CULLING_RADIUS,
     /*0x21*/ GEO_CMD_BONE,
+    /*0x22*/ GEO_CMD_NODE_ROOMS,
 };
 
 // geo layout macros
@@ -484,4 +485,17 @@ enum GeoLayoutCommands {
     CMD_HHHHHH(tx, ty, tz, rx, ry, rz), \
     CMD_PTR(displayList)
 
+/**
+ * 0x22: Create a rooms scene graph node, which only renders the children that can be seen
+ *       from the rooms Mario and the camera are in. The first child is room 1, like the cases
+ *       of geo_switch_area. Outside of any room all children are rendered.
+ *   0x01: unused
+ *   0x02: s16 numRooms
+ *   0x04: const RoomVisibility *visibility: per room, a bit for every room visible from it,
+ *         baked by tools/collision_bench/bake_room_pvs
+ */
+#define GEO_ROOMS(numRooms, visibility) \
+    CMD_BBH(GEO_CMD_NODE_ROOMS, 0x00, numRooms), \
+    CMD_PTR(visibility)
+
 #endif // GEO_COMMANDS_H
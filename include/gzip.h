@@ -54,6 +54,12 @@ extern int	flush_window(void);
 //
 //
 u32   expand_gzip(u8 *src_addr, u8 *dst_addr, u32 size, u32 outbytes_limit);
+u32   expand_gzip_stream(u8 *dst_addr, u32 outbytes_limit, unsigned char *(*read)(void *arg, unsigned int *size),
+                         void *arg, u8 *window);
+
+// Decodes the raw deflate data at src_addr into the size bytes at dst_addr, in fewer instructions than expand_gzip.
+// Needs the whole stream in memory. In src/boot/inflate.s, built with FAST_INFLATE=1
+s32   inflate_segment(u8 *src_addr, u8 *dst_addr, u32 size);
 
 
 #endif
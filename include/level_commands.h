@@ -403,6 +403,17 @@ enum GoddardScene {
     CMD_BBH(LEVEL_CMD_SET_TERRAIN_DATA, 0x08, 0x0000), \
     CMD_PTR(terrainData)
 
+// Same as TERRAIN, but with BAKE_COLLISION=1 the area loads the surfaces baked from terrainData at build time.
+// Requires terrainData to be an areas/<area>/collision.inc.c, whose leveldata.c also includes collision_baked.inc.c.
+#ifdef BAKED_COLLISION
+#define TERRAIN_BAKED(terrainData) \
+    CMD_BBH(LEVEL_CMD_SET_TERRAIN_DATA, 0x0C, 0x0000), \
+    CMD_PTR(terrainData), \
+    CMD_PTR(&terrainData##_baked)
+#else
+#define TERRAIN_BAKED(terrainData) TERRAIN(terrainData)
+#endif
+
 #define ROOMS(surfaceRooms) \
     CMD_BBH(LEVEL_CMD_SET_ROOMS, 0x08, 0x0000), \
     CMD_PTR(surfaceRooms)
@@ -106,6 +106,7 @@ typedef Angle Vec3a[3];
 
 // -- Collision --
 typedef ROOM_DATA_TYPE RoomData;
+typedef u32 RoomVisibility; // One bit per room, see GEO_ROOMS
 typedef COLLISION_DATA_TYPE Collision; // Collision is by default an s16, but it's best to have it match the type of COLLISION_DATA_TYPE
 typedef Collision TerrainData;
 typedef Collision Vec3t[3];
@@ -211,6 +212,7 @@ enum AnimFlags {
     ANIM_FLAG_DISABLED   = BIT(5), // 0x20
     ANIM_FLAG_NO_TRANS   = BIT(6), // 0x40
     ANIM_FLAG_UNUSED     = BIT(7), // 0x80
+    ANIM_FLAG_COMPRESSED = BIT(8), // 0x100, see retrieve_compressed_animation_value
 };
 
 struct Animation {
@@ -227,6 +229,14 @@ struct Animation {
 
 #define ANIMINDEX_NUMPARTS(animindex) (sizeof(animindex) / sizeof(u16) / 6 - 1)
 
+// Attribute headers of animations with ANIM_FLAG_COMPRESSED.
+#define ANIM_ATTRIBUTE_CONSTANT       0x0000
+#define ANIM_ATTRIBUTE_DELTA          0x8000
+#define ANIM_ATTRIBUTE_SHIFT(header)  (((header) >> 12) & 0x7)
+#define ANIM_ATTRIBUTE_FRAMES(header) ((header) & 0xFFF)
+#define ANIM_DELTA_BLOCK_FRAMES       15
+#define ANIM_DELTA_BLOCK_SIZE         8 // s16s, the key value and ANIM_DELTA_BLOCK_FRAMES - 1 deltas
+
 struct GraphNode {
     /*0x00*/ s16 type; // structure type
     /*0x02*/ s16 flags; // hi = drawing layer, lo = rendering modes
@@ -58,6 +58,9 @@
 #include "levels/bbh/merry_go_round/model.inc.c"
 #include "levels/bbh/coffin/model.inc.c"
 #include "levels/bbh/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bbh/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bbh/areas/1/room.inc.c"
 #include "levels/bbh/areas/1/macro.inc.c"
 #include "levels/bbh/staircase_step/collision.inc.c"
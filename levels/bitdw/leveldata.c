@@ -37,6 +37,9 @@
 #include "levels/bitdw/collapsing_stairs_4/model.inc.c"
 #include "levels/bitdw/collapsing_stairs_5/model.inc.c"
 #include "levels/bitdw/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bitdw/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bitdw/areas/1/macro.inc.c"
 #include "levels/bitdw/sliding_platform/collision.inc.c"
 #include "levels/bitdw/seesaw_platform/collision.inc.c"
@@ -43,6 +43,9 @@
 #include "levels/bitfs/sinking_platforms/model.inc.c"
 #include "levels/bitfs/seesaw_platform/model.inc.c"
 #include "levels/bitfs/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bitfs/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bitfs/areas/1/macro.inc.c"
 #include "levels/bitfs/elevator/collision.inc.c"
 #include "levels/bitfs/sinking_cage_platform/collision.inc.c"
@@ -42,6 +42,9 @@
 #include "levels/bits/areas/1/31/model.inc.c"
 #include "levels/bits/areas/1/32/model.inc.c"
 #include "levels/bits/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bits/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bits/areas/1/macro.inc.c"
 #include "levels/bits/areas/1/20/collision.inc.c"
 #include "levels/bits/areas/1/21/collision.inc.c"
@@ -99,7 +99,7 @@ const LevelScript level_bits_entry[] = {
         WARP_NODE(/*id*/ 0xF1, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x6B, /*flags*/ WARP_NO_CHECKPOINT),
         JUMP_LINK(script_func_local_1),
         JUMP_LINK(script_func_local_2),
-        TERRAIN(/*terrainData*/ bits_seg7_collision_level),
+        TERRAIN_BAKED(/*terrainData*/ bits_seg7_collision_level),
         MACRO_OBJECTS(/*objList*/ bits_seg7_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0000, /*seq*/ SEQ_LEVEL_KOOPA_ROAD),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_STONE),
@@ -20,6 +20,9 @@
 #include "levels/bob/seesaw_platform/model.inc.c"
 #include "levels/bob/grate_door/model.inc.c"
 #include "levels/bob/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bob/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bob/areas/1/macro.inc.c"
 #include "levels/bob/chain_chomp_gate/collision.inc.c"
 #include "levels/bob/seesaw_platform/collision.inc.c"
@@ -9,6 +9,7 @@ extern const GeoLayout bowser_1_geo_0000D0[];
 // leveldata
 extern const Gfx bowser_1_seg7_dl_07002768[];
 extern const Collision bowser_1_seg7_collision_level[];
+extern const struct BakedCollision bowser_1_seg7_collision_level_baked;
 
 // script
 extern const LevelScript level_bowser_1_entry[];
@@ -11,3 +11,6 @@
 #include "levels/bowser_1/texture.inc.c"
 #include "levels/bowser_1/areas/1/1/model.inc.c"
 #include "levels/bowser_1/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bowser_1/areas/1/collision_baked.inc.c"
+#endif
@@ -12,4 +12,7 @@
 #include "levels/bowser_2/tilting_platform/model.inc.c"
 #include "levels/bowser_2/areas/1/1/model.inc.c"
 #include "levels/bowser_2/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bowser_2/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bowser_2/tilting_platform/collision.inc.c"
@@ -22,6 +22,9 @@
 #include "levels/bowser_3/areas/1/1/model.inc.c"
 #include "levels/bowser_3/areas/1/bomb_stand/model.inc.c"
 #include "levels/bowser_3/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/bowser_3/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/bowser_3/falling_platform_1/collision.inc.c"
 #include "levels/bowser_3/falling_platform_2/collision.inc.c"
 #include "levels/bowser_3/falling_platform_3/collision.inc.c"
@@ -60,7 +60,7 @@ const LevelScript level_bowser_3_entry[] = {
         WARP_NODE(/*id*/ 0x0A, /*destLevel*/ LEVEL_BOWSER_3, /*destArea*/ 0x01, /*destNode*/ 0x0A, /*flags*/ WARP_NO_CHECKPOINT),
         JUMP_LINK(script_func_local_1),
         WARP_NODE(/*id*/ 0xF1, /*destLevel*/ LEVEL_BITS, /*destArea*/ 0x01, /*destNode*/ 0x0C, /*flags*/ WARP_NO_CHECKPOINT),
-        TERRAIN(/*terrainData*/ bowser_3_seg7_collision_level),
+        TERRAIN_BAKED(/*terrainData*/ bowser_3_seg7_collision_level),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0002, /*seq*/ SEQ_LEVEL_BOSS_KOOPA_FINAL),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_STONE),
     END_AREA(),
@@ -15,5 +15,8 @@
 #include "levels/castle_courtyard/areas/1/2/model.inc.c"
 #include "levels/castle_courtyard/areas/1/3/model.inc.c"
 #include "levels/castle_courtyard/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/castle_courtyard/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/castle_courtyard/areas/1/macro.inc.c"
 #include "levels/castle_courtyard/areas/1/movtext.inc.c"
@@ -57,7 +57,7 @@ const LevelScript level_castle_courtyard_entry[] = {
         WARP_NODE(/*id*/ 0xF1, /*destLevel*/ LEVEL_CASTLE_GROUNDS, /*destArea*/ 0x01, /*destNode*/ 0x03, /*flags*/ WARP_NO_CHECKPOINT),
         JUMP_LINK(script_func_local_1),
         JUMP_LINK(script_func_local_2),
-        TERRAIN(/*terrainData*/ castle_courtyard_seg7_collision),
+        TERRAIN_BAKED(/*terrainData*/ castle_courtyard_seg7_collision),
         MACRO_OBJECTS(/*objList*/ castle_courtyard_seg7_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0000, /*seq*/ SEQ_SOUND_PLAYER),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_STONE),
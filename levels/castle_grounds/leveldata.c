@@ -27,6 +27,9 @@
 #include "levels/castle_grounds/areas/1/13/model.inc.c" // Peach signature
 #endif
 #include "levels/castle_grounds/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/castle_grounds/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/castle_grounds/areas/1/macro.inc.c"
 #include "levels/castle_grounds/areas/1/7/collision.inc.c"
 #include "levels/castle_grounds/areas/1/8/collision.inc.c"
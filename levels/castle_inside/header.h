@@ -134,8 +134,11 @@ extern const Gfx inside_castle_seg7_dl_07066FA0[];
 extern const Gfx inside_castle_seg7_dl_07068850[];
 extern const Gfx inside_castle_seg7_dl_07068B10[];
 extern const Collision inside_castle_seg7_area_1_collision[];
+extern const struct BakedCollision inside_castle_seg7_area_1_collision_baked;
 extern const Collision inside_castle_seg7_area_2_collision[];
+extern const struct BakedCollision inside_castle_seg7_area_2_collision_baked;
 extern const Collision inside_castle_seg7_area_3_collision[];
+extern const struct BakedCollision inside_castle_seg7_area_3_collision_baked;
 extern const Collision inside_castle_seg7_collision_ddd_warp[];
 extern const Collision inside_castle_seg7_collision_ddd_warp_2[];
 extern const MacroObject inside_castle_seg7_area_1_macro_objs[];
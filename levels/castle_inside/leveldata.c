@@ -70,8 +70,17 @@
 #include "levels/castle_inside/areas/3/11/model.inc.c"
 #include "levels/castle_inside/water_level_pillar/model.inc.c"
 #include "levels/castle_inside/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/castle_inside/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/castle_inside/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/castle_inside/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/castle_inside/areas/3/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/castle_inside/areas/3/collision_baked.inc.c"
+#endif
 #include "levels/castle_inside/areas/1/macro.inc.c"
 #include "levels/castle_inside/areas/2/macro.inc.c"
 #include "levels/castle_inside/areas/3/macro.inc.c"
@@ -31,6 +31,9 @@
 #include "levels/ccm/snowman_head/1.inc.c"
 #include "levels/ccm/snowman_head/2.inc.c"
 #include "levels/ccm/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ccm/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/ccm/areas/1/macro.inc.c"
 #include "levels/ccm/ropeway_lift/collision.inc.c"
 #include "levels/ccm/areas/1/trajectory.inc.c"
@@ -43,5 +46,8 @@
 #include "levels/ccm/areas/2/6/model.inc.c"
 #include "levels/ccm/areas/2/7/model.inc.c"
 #include "levels/ccm/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ccm/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/ccm/areas/2/macro.inc.c"
 #include "levels/ccm/areas/2/trajectory.inc.c"
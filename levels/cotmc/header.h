@@ -11,6 +11,7 @@ extern const Gfx cotmc_seg7_dl_07007D48[];
 extern const Gfx cotmc_seg7_dl_0700A160[];
 extern const Gfx cotmc_seg7_dl_0700A4B8[];
 extern const Collision cotmc_seg7_collision_level[];
+extern const struct BakedCollision cotmc_seg7_collision_level_baked;
 extern const MacroObject cotmc_seg7_macro_objs[];
 extern const Gfx cotmc_dl_water_begin[];
 extern const Gfx cotmc_dl_water_end[];
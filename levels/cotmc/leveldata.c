@@ -14,5 +14,8 @@
 #include "levels/cotmc/areas/1/2/model.inc.c"
 #include "levels/cotmc/areas/1/3/model.inc.c"
 #include "levels/cotmc/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/cotmc/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/cotmc/areas/1/macro.inc.c"
 #include "levels/cotmc/movtext.inc.c"
@@ -29,7 +29,9 @@ extern const Gfx ddd_seg7_dl_0700BAE0[];
 extern const Gfx ddd_seg7_dl_0700CE48[];
 extern const Gfx ddd_seg7_dl_0700D2A0[];
 extern const Collision ddd_seg7_area_1_collision[];
+extern const struct BakedCollision ddd_seg7_area_1_collision_baked;
 extern const Collision ddd_seg7_area_2_collision[];
+extern const struct BakedCollision ddd_seg7_area_2_collision_baked;
 extern const MacroObject ddd_seg7_area_1_macro_objs[];
 extern const MacroObject ddd_seg7_area_2_macro_objs[];
 extern const Collision ddd_seg7_collision_submarine[];
@@ -27,7 +27,13 @@
 #include "levels/ddd/areas/2/6/model.inc.c"
 #include "levels/ddd/pole/model.inc.c"
 #include "levels/ddd/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ddd/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/ddd/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ddd/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/ddd/areas/1/macro.inc.c"
 #include "levels/ddd/areas/2/macro.inc.c"
 #include "levels/ddd/submarine/collision.inc.c"
@@ -77,6 +77,7 @@ extern const Gfx hmc_seg7_dl_070242A0[];
 extern const Texture *const hmc_seg7_painting_textures_07025518[];
 extern struct Painting cotmc_painting;
 extern const Collision hmc_seg7_collision_level[];
+extern const struct BakedCollision hmc_seg7_collision_level_baked;
 extern const MacroObject hmc_seg7_macro_objs[];
 extern const RoomData hmc_seg7_rooms[];
 extern const Collision hmc_seg7_collision_elevator[];
@@ -50,6 +50,9 @@
 #include "levels/hmc/rolling_rock_fragment_2/model.inc.c"
 #include "levels/hmc/areas/1/painting.inc.c"
 #include "levels/hmc/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/hmc/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/hmc/areas/1/macro.inc.c"
 #include "levels/hmc/areas/1/room.inc.c"
 #include "levels/hmc/elevator_platform/collision.inc.c"
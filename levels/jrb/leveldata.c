@@ -24,6 +24,9 @@
 #include "levels/jrb/falling_pillar/model.inc.c"
 #include "levels/jrb/falling_pillar_base/model.inc.c"
 #include "levels/jrb/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/jrb/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/jrb/areas/1/macro.inc.c"
 #include "levels/jrb/rock/collision.inc.c"
 #include "levels/jrb/floating_platform/collision.inc.c"
@@ -37,5 +40,8 @@
 #include "levels/jrb/areas/2/2/model.inc.c"
 #include "levels/jrb/areas/2/3/model.inc.c"
 #include "levels/jrb/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/jrb/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/jrb/areas/2/macro.inc.c"
 #include "levels/jrb/areas/2/movtext.inc.c"
@@ -41,6 +41,9 @@
 #include "levels/lll/sinking_rock_block/model.inc.c"
 #include "levels/lll/rolling_log/model.inc.c"
 #include "levels/lll/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/lll/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/lll/areas/1/macro.inc.c"
 #include "levels/lll/moving_octagonal_mesh_platform/collision.inc.c"
 #include "levels/lll/drawbridge_part/collision.inc.c"
@@ -62,6 +65,9 @@
 #include "levels/lll/areas/2/5/model.inc.c"
 #include "levels/lll/volcano_falling_trap/model.inc.c"
 #include "levels/lll/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/lll/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/lll/areas/2/macro.inc.c"
 #include "levels/lll/volcano_falling_trap/collision.inc.c"
 #include "levels/lll/areas/2/trajectory.inc.c"
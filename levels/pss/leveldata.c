@@ -18,4 +18,7 @@
 #include "levels/pss/areas/1/6/model.inc.c"
 #include "levels/pss/areas/1/7/model.inc.c"
 #include "levels/pss/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/pss/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/pss/areas/1/macro.inc.c"
@@ -101,6 +101,7 @@ extern const Collision rr_seg7_collision_07029FA4[];
 extern const Collision rr_seg7_collision_0702A32C[];
 extern const Collision rr_seg7_collision_0702A6B4[];
 extern const Collision rr_seg7_collision_level[];
+extern const struct BakedCollision rr_seg7_collision_level_baked;
 extern const MacroObject rr_seg7_macro_objs[];
 extern const Trajectory rr_seg7_trajectory_0702EC3C[];
 extern const Trajectory rr_seg7_trajectory_0702ECC0[];
@@ -12,4 +12,7 @@
 #include "levels/sa/areas/1/1/model.inc.c"
 #include "levels/sa/areas/1/2/model.inc.c"
 #include "levels/sa/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/sa/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/sa/areas/1/macro.inc.c"
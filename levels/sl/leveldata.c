@@ -25,9 +25,15 @@
 #include "levels/sl/areas/2/3/model.inc.c"
 #include "levels/sl/areas/2/4/model.inc.c"
 #include "levels/sl/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/sl/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/sl/areas/1/macro.inc.c"
 #include "levels/sl/snow_mound/collision.inc.c"
 #include "levels/sl/unused_cracked_ice/collision.inc.c"
 #include "levels/sl/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/sl/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/sl/areas/2/macro.inc.c"
 #include "levels/sl/areas/1/movtext.inc.c"
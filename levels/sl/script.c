@@ -80,7 +80,7 @@ const LevelScript level_sl_entry[] = {
         JUMP_LINK(script_func_local_3),
         WARP_NODE(/*id*/ 0xF0, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x36, /*flags*/ WARP_NO_CHECKPOINT),
         WARP_NODE(/*id*/ 0xF1, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x68, /*flags*/ WARP_NO_CHECKPOINT),
-        TERRAIN(/*terrainData*/ sl_seg7_area_1_collision),
+        TERRAIN_BAKED(/*terrainData*/ sl_seg7_area_1_collision),
         MACRO_OBJECTS(/*objList*/ sl_seg7_area_1_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0000, /*seq*/ SEQ_LEVEL_SNOW),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_SNOW),
@@ -94,7 +94,7 @@ const LevelScript level_sl_entry[] = {
         JUMP_LINK(script_func_local_4),
         WARP_NODE(/*id*/ 0xF0, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x36, /*flags*/ WARP_NO_CHECKPOINT),
         WARP_NODE(/*id*/ 0xF1, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x68, /*flags*/ WARP_NO_CHECKPOINT),
-        TERRAIN(/*terrainData*/ sl_seg7_area_2_collision),
+        TERRAIN_BAKED(/*terrainData*/ sl_seg7_area_2_collision),
         MACRO_OBJECTS(/*objList*/ sl_seg7_area_2_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0004, /*seq*/ SEQ_LEVEL_UNDERGROUND),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_SNOW),
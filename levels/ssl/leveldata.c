@@ -25,6 +25,9 @@
 #include "levels/ssl/pyramid_top/model.inc.c"
 #include "levels/ssl/tox_box/model.inc.c"
 #include "levels/ssl/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ssl/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/ssl/areas/1/macro.inc.c"
 #include "levels/ssl/pyramid_top/collision.inc.c"
 #include "levels/ssl/tox_box/collision.inc.c"
@@ -40,7 +43,13 @@
 #include "levels/ssl/pyramid_elevator/model.inc.c"
 #include "levels/ssl/eyerok_col/model.inc.c" // Blank file
 #include "levels/ssl/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ssl/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/ssl/areas/3/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ssl/areas/3/collision_baked.inc.c"
+#endif
 #include "levels/ssl/areas/2/macro.inc.c"
 #include "levels/ssl/areas/3/macro.inc.c"
 #include "levels/ssl/grindel/collision.inc.c"
@@ -23,8 +23,17 @@
 #include "levels/thi/areas/3/3/model.inc.c"
 #include "levels/thi/areas/3/4/model.inc.c"
 #include "levels/thi/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/thi/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/thi/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/thi/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/thi/areas/3/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/thi/areas/3/collision_baked.inc.c"
+#endif
 #include "levels/thi/areas/1/macro.inc.c"
 #include "levels/thi/areas/2/macro.inc.c"
 #include "levels/thi/areas/3/macro.inc.c"
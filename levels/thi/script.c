@@ -114,7 +114,7 @@ const LevelScript level_thi_entry[] = {
         JUMP_LINK(script_func_local_1),
         JUMP_LINK(script_func_local_5),
         JUMP_LINK(script_func_local_4),
-        TERRAIN(/*terrainData*/ thi_seg7_area_1_collision),
+        TERRAIN_BAKED(/*terrainData*/ thi_seg7_area_1_collision),
         MACRO_OBJECTS(/*objList*/ thi_seg7_area_1_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0000, /*seq*/ SEQ_LEVEL_GRASS),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_GRASS),
@@ -132,7 +132,7 @@ const LevelScript level_thi_entry[] = {
         JUMP_LINK(script_func_local_8),
         JUMP_LINK(script_func_local_2),
         JUMP_LINK(script_func_local_6),
-        TERRAIN(/*terrainData*/ thi_seg7_area_2_collision),
+        TERRAIN_BAKED(/*terrainData*/ thi_seg7_area_2_collision),
         MACRO_OBJECTS(/*objList*/ thi_seg7_area_2_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0000, /*seq*/ SEQ_LEVEL_GRASS),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_GRASS),
@@ -148,7 +148,7 @@ const LevelScript level_thi_entry[] = {
         WARP_NODE(/*id*/ 0xF0, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x37, /*flags*/ WARP_NO_CHECKPOINT),
         WARP_NODE(/*id*/ 0xF1, /*destLevel*/ LEVEL_CASTLE, /*destArea*/ 0x02, /*destNode*/ 0x69, /*flags*/ WARP_NO_CHECKPOINT),
         JUMP_LINK(script_func_local_3),
-        TERRAIN(/*terrainData*/ thi_seg7_area_3_collision),
+        TERRAIN_BAKED(/*terrainData*/ thi_seg7_area_3_collision),
         MACRO_OBJECTS(/*objList*/ thi_seg7_area_3_macro_objs),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0004, /*seq*/ SEQ_LEVEL_UNDERGROUND),
         TERRAIN_TYPE(/*terrainType*/ TERRAIN_GRASS),
@@ -14,5 +14,8 @@
 #include "levels/totwc/areas/1/3/model.inc.c"
 #include "levels/totwc/cloud/model.inc.c"
 #include "levels/totwc/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/totwc/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/totwc/areas/1/macro.inc.c"
 #include "levels/totwc/cloud/collision.inc.c" // Blank File
@@ -41,6 +41,7 @@ extern const Gfx ttc_seg7_dl_07012028[];
 extern const Gfx ttc_seg7_dl_07012148[];
 extern const Gfx ttc_seg7_dl_07012278[];
 extern const Collision ttc_seg7_collision_level[];
+extern const struct BakedCollision ttc_seg7_collision_level_baked;
 extern const Collision ttc_seg7_collision_07014F70[];
 extern const Collision ttc_seg7_collision_07015008[];
 extern const Collision ttc_seg7_collision_clock_pendulum[];
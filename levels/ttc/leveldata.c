@@ -29,6 +29,9 @@
 #include "levels/ttc/small_gear/model.inc.c"
 #include "levels/ttc/large_gear/model.inc.c"
 #include "levels/ttc/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ttc/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/ttc/rotating_cube/collision.inc.c"
 #include "levels/ttc/rotating_prism/collision.inc.c"
 #include "levels/ttc/pendulum/collision.inc.c"
@@ -77,6 +77,7 @@ extern const Gfx ttm_seg7_dl_07013608[];
 extern const Collision ttm_seg7_collision_pitoune_2[];
 extern const Collision ttm_seg7_collision_ukiki_cage[];
 extern const Collision ttm_seg7_area_1_collision[];
+extern const struct BakedCollision ttm_seg7_area_1_collision_baked;
 extern const MacroObject ttm_seg7_area_1_macro_objs[];
 extern const Trajectory ttm_seg7_trajectory_070170A0[];
 extern const struct MovtexQuadCollection ttm_movtex_puddle[];
@@ -101,8 +102,11 @@ extern const Gfx ttm_seg7_dl_0702AB90[];
 extern const Gfx ttm_seg7_dl_0702AC78[];
 extern const Gfx ttm_seg7_dl_0702BB60[];
 extern const Collision ttm_seg7_area_2_collision[];
+extern const struct BakedCollision ttm_seg7_area_2_collision_baked;
 extern const Collision ttm_seg7_area_3_collision[];
+extern const struct BakedCollision ttm_seg7_area_3_collision_baked;
 extern const Collision ttm_seg7_area_4_collision[];
+extern const struct BakedCollision ttm_seg7_area_4_collision_baked;
 extern const Collision ttm_seg7_collision_podium_warp[];
 extern const MacroObject ttm_seg7_area_2_macro_objs[];
 extern const MacroObject ttm_seg7_area_3_macro_objs[];
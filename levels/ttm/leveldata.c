@@ -46,6 +46,9 @@
 #include "levels/ttm/rolling_log/collision.inc.c"
 #include "levels/ttm/star_cage/collision.inc.c"
 #include "levels/ttm/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ttm/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/ttm/areas/1/macro.inc.c"
 #include "levels/ttm/areas/1/trajectory.inc.c"
 #include "levels/ttm/areas/1/movtext.inc.c"
@@ -62,8 +65,17 @@
 #include "levels/ttm/moon_smiley/model.inc.c"
 #include "levels/ttm/slide_exit_podium/model.inc.c"
 #include "levels/ttm/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ttm/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/ttm/areas/3/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ttm/areas/3/collision_baked.inc.c"
+#endif
 #include "levels/ttm/areas/4/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/ttm/areas/4/collision_baked.inc.c"
+#endif
 #include "levels/ttm/slide_exit_podium/collision.inc.c"
 #include "levels/ttm/areas/2/macro.inc.c"
 #include "levels/ttm/areas/3/macro.inc.c"
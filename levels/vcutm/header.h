@@ -14,6 +14,7 @@ extern const Gfx vcutm_seg7_dl_07008E10[];
 extern const Gfx vcutm_seg7_dl_070093E8[];
 extern const Gfx vcutm_seg7_dl_070096E0[];
 extern const Collision vcutm_seg7_collision[];
+extern const struct BakedCollision vcutm_seg7_collision_baked;
 extern const MacroObject vcutm_seg7_macro_objs[];
 extern const Collision vcutm_seg7_collision_0700AC44[];
 
@@ -15,5 +15,8 @@
 #include "levels/vcutm/areas/1/4/model.inc.c"
 #include "levels/vcutm/seesaw/model.inc.c"
 #include "levels/vcutm/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/vcutm/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/vcutm/areas/1/macro.inc.c"
 #include "levels/vcutm/seesaw/collision.inc.c"
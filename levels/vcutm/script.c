@@ -61,7 +61,7 @@ const LevelScript level_vcutm_entry[] = {
         JUMP_LINK(script_func_local_3),
         JUMP_LINK(script_func_local_1),
         JUMP_LINK(script_func_local_2),
-        TERRAIN(/*terrainData*/ vcutm_seg7_collision),
+        TERRAIN_BAKED(/*terrainData*/ vcutm_seg7_collision),
         MACRO_OBJECTS(/*objList*/ vcutm_seg7_macro_objs),
         SHOW_DIALOG(/*index*/ 0x00, DIALOG_129),
         SET_BACKGROUND_MUSIC(/*settingsPreset*/ 0x0000, /*seq*/ SEQ_LEVEL_SLIDE),
@@ -30,8 +30,10 @@ extern const Gfx wdw_seg7_dl_07013B70[];
 extern const Gfx wdw_seg7_dl_07013E40[];
 extern const Gfx wdw_seg7_dl_070140E0[];
 extern const Collision wdw_seg7_area_1_collision[];
+extern const struct BakedCollision wdw_seg7_area_1_collision_baked;
 extern const MacroObject wdw_seg7_area_1_macro_objs[];
 extern const Collision wdw_seg7_area_2_collision[];
+extern const struct BakedCollision wdw_seg7_area_2_collision_baked;
 extern const MacroObject wdw_seg7_area_2_macro_objs[];
 extern const Collision wdw_seg7_collision_square_floating_platform[];
 extern const Collision wdw_seg7_collision_arrow_lift[];
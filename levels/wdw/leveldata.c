@@ -24,8 +24,14 @@
 #include "levels/wdw/rectangular_floating_platform/model.inc.c"
 #include "levels/wdw/rotating_platform/model.inc.c"
 #include "levels/wdw/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/wdw/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/wdw/areas/1/macro.inc.c"
 #include "levels/wdw/areas/2/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/wdw/areas/2/collision_baked.inc.c"
+#endif
 #include "levels/wdw/areas/2/macro.inc.c"
 #include "levels/wdw/square_floating_platform/collision.inc.c"
 #include "levels/wdw/arrow_lift/collision.inc.c"
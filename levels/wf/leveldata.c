@@ -65,5 +65,8 @@
 #include "levels/wf/areas/1/10/collision.inc.c"
 #include "levels/wf/areas/1/11/collision.inc.c"
 #include "levels/wf/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/wf/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/wf/areas/1/macro.inc.c"
 #include "levels/wf/areas/1/movtext.inc.c"
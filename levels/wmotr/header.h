@@ -11,6 +11,7 @@ extern const Gfx wmotr_seg7_dl_0700C1F8[];
 extern const Gfx wmotr_seg7_dl_0700EFD8[];
 extern const Gfx wmotr_seg7_dl_07010608[];
 extern const Collision wmotr_seg7_collision[];
+extern const struct BakedCollision wmotr_seg7_collision_baked;
 extern const MacroObject wmotr_seg7_macro_objs[];
 
 // script
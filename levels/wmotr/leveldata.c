@@ -11,4 +11,7 @@
 #include "levels/wmotr/texture.inc.c"
 #include "levels/wmotr/areas/1/model.inc.c"
 #include "levels/wmotr/areas/1/collision.inc.c"
+#ifdef BAKED_COLLISION
+#include "levels/wmotr/areas/1/collision_baked.inc.c"
+#endif
 #include "levels/wmotr/areas/1/macro.inc.c"
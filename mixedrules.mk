@@ -0,0 +1,18 @@
+# Pick the codec of every segment. The plan is only rewritten when a choice changes, so the
+# segments whose codec stays the same aren't compressed again.
+$(BUILD_DIR)/segment_codecs.stamp: $(YAY0_FILES:.szp=.bin) $(SEGMENT_CODEC)
+	$(call print,Choosing codecs:,$(BUILD_DIR),$(BUILD_DIR)/segment_codecs.txt)
+	$(V)$(PYTHON) $(SEGMENT_CODEC) plan --tools $(TOOLS_DIR) $(SEGMENT_CODEC_FLAGS) --budget $(COMPRESS_BUDGET) -o $(BUILD_DIR)/segment_codecs.txt $(YAY0_FILES:.szp=.bin)
+	$(V)touch $@
+
+$(BUILD_DIR)/segment_codecs.txt: $(BUILD_DIR)/segment_codecs.stamp ;
+
+# Compress binary file
+$(BUILD_DIR)/%.szp: $(BUILD_DIR)/%.bin $(BUILD_DIR)/segment_codecs.txt
+	$(call print,Compressing:,$<,$@)
+	$(V)$(PYTHON) $(SEGMENT_CODEC) pack --tools $(TOOLS_DIR) $(SEGMENT_CODEC_FLAGS) --plan $(BUILD_DIR)/segment_codecs.txt $< $@
+
+# convert binary szp to object file
+$(BUILD_DIR)/%.szp.o: $(BUILD_DIR)/%.szp
+	$(call print,Converting segment to ELF:,$<,$@)
+	$(V)$(LD) -r -b binary $< -o $@
@@ -0,0 +1,667 @@
+/*
+ * Raw deflate decoder for gzip segments.
+ *
+ *   s32 inflate_segment(u8 *src, u8 *dst, u32 size);
+ *
+ * Decodes the deflate stream at src straight into the size bytes at dst and
+ * returns the number of bytes written, or -1 on a reserved block type. The
+ * output is its own window, so nothing is copied twice, and the input is read
+ * through a 64-bit bit buffer that is topped up two bytes at a time. Matches
+ * are copied a doubleword at a time where they don't overlap themselves that
+ * closely; one that ends mid-doubleword writes past its end, which is fine
+ * anywhere but the last 8 bytes of the output. Huffman codes up to
+ * LIT_BITS/DIST_BITS long are looked up in one step; the rare longer ones are
+ * decoded a bit at a time from the code counts.
+ *
+ * The data is trusted: codes aren't checked, and up to 8 bytes past the end
+ * of the stream may be read.
+ */
+#if defined(FAST_INFLATE) && (defined(GZIP) || defined(MIXED_COMPRESSION))
+
+# assembler directives
+.set noreorder # don't insert nops after branches
+.set gp=64
+
+.include "macros.inc"
+
+#define LIT_BITS  10
+#define DIST_BITS 7
+#define CODE_BITS 7
+
+/*
+ * Table entries:
+ *   literal      0x80000000 | byte << 16 | code length
+ *   length/dist  base << 16 | extra bits << 8 | code length
+ *   end of block 0x40 | code length
+ *   0            code longer than the table, decode it bit by bit
+ * dsrlv only looks at the low 6 bits, so an entry can be used as the shift.
+ */
+#define ENTRY_LITERAL 0x8000
+#define ENTRY_END     0x40
+
+/* Descriptor of a code, see .Lbuild */
+#define DESC_TABLE   0
+#define DESC_BITS    4
+#define DESC_COUNTS  8
+#define DESC_SYMBOLS 12
+#define DESC_LITERAL 16
+#define DESC_FIRST   20
+#define DESC_BASE    24
+#define DESC_EXTRA   28
+
+/* Stack frame */
+#define FRAME_RA    0
+#define FRAME_LAST  4
+#define FRAME_NLEN  8
+#define FRAME_NDIST 12
+
+/*
+ * $t0: bit buffer, next bit in bit 0
+ * $t1: bits in $t0
+ * $a0: input
+ * $a1: output
+ * $a2: start of the output
+ * $a3: last place in the output a whole doubleword fits
+ * $t8/$t9: literal/length and distance tables while decoding a block
+ */
+.section .text, "ax"
+
+glabel inflate_segment
+    addiu $sp, $sp, -16
+    sw    $ra, FRAME_RA($sp)
+    addu  $a3, $a1, $a2
+    addiu $a3, $a3, -8
+    move  $a2, $a1
+    move  $t0, $zero
+    move  $t1, $zero
+
+.Lblock:
+    jal   .Lfill
+     nop
+    andi  $t2, $t0, 1
+    sw    $t2, FRAME_LAST($sp)
+    andi  $t3, $t0, 6
+    srl   $t3, $t3, 1
+    dsrl  $t0, $t0, 3
+    beqz  $t3, .Lstored
+     addiu $t1, $t1, -3
+    li    $t2, 1
+    beq   $t3, $t2, .Lfixed
+     li    $t2, 2
+    beq   $t3, $t2, .Ldynamic
+     nop
+    b     .Lreturn
+     li    $v0, -1
+
+.Lblock_end:
+    lw    $t2, FRAME_LAST($sp)
+    beqz  $t2, .Lblock
+     subu  $v0, $a1, $a2
+.Lreturn:
+    lw    $ra, FRAME_RA($sp)
+    jr    $ra
+     addiu $sp, $sp, 16
+
+/* Stored block: the bytes after the next byte boundary are copied as they are */
+.Lstored:
+    andi  $t2, $t1, 7
+    dsrlv $t0, $t0, $t2
+    subu  $t1, $t1, $t2
+    srl   $t2, $t1, 3       # whole bytes still in the buffer go back to the input
+    subu  $a0, $a0, $t2
+    move  $t0, $zero
+    move  $t1, $zero
+    lbu   $t2, 0($a0)
+    lbu   $t3, 1($a0)
+    sll   $t3, $t3, 8
+    or    $t2, $t2, $t3     # length, the complement after it is skipped
+    addiu $a0, $a0, 4
+    addu  $t3, $a0, $t2
+.Lstored_copy:
+    beq   $a0, $t3, .Lblock_end
+     nop
+    lbu   $t4, 0($a0)
+    addiu $a0, $a0, 1
+    sb    $t4, 0($a1)
+    b     .Lstored_copy
+     addiu $a1, $a1, 1
+
+/* Fixed Huffman block: the tables are built from the code lengths in the spec */
+.Lfixed:
+    la    $t5, inflate_lengths
+    la    $t6, inflate_fixed_runs
+.Lfixed_run:
+    lbu   $t7, 0($t6)
+    beqz  $t7, .Lfixed_build
+     lbu   $t2, 1($t6)
+    addiu $t6, $t6, 2
+.Lfixed_fill:
+    addiu $t7, $t7, -1
+    sb    $t2, 0($t5)
+    bnez  $t7, .Lfixed_fill
+     addiu $t5, $t5, 1
+    b     .Lfixed_run
+     nop
+.Lfixed_build:
+    la    $v0, inflate_lengths
+    la    $t9, inflate_lit_desc
+    jal   .Lbuild
+     li    $v1, 288
+    la    $v0, inflate_lengths + 288
+    la    $t9, inflate_dist_desc
+    jal   .Lbuild
+     li    $v1, 30
+    b     .Lcodes
+     nop
+
+/* Dynamic Huffman block: the code lengths are themselves Huffman coded */
+.Ldynamic:
+    jal   .Lfill
+     nop
+    andi  $t2, $t0, 0x1F
+    addiu $t2, $t2, 257
+    sw    $t2, FRAME_NLEN($sp)
+    dsrl  $t0, $t0, 5
+    andi  $t3, $t0, 0x1F
+    addiu $t3, $t3, 1
+    sw    $t3, FRAME_NDIST($sp)
+    dsrl  $t0, $t0, 5
+    andi  $t4, $t0, 0xF
+    addiu $t4, $t4, 4       # code length codes sent
+    dsrl  $t0, $t0, 4
+    addiu $t1, $t1, -14
+
+    la    $t5, inflate_lengths
+    li    $t6, 19
+.Ldynamic_clear:
+    addiu $t6, $t6, -1
+    addu  $t7, $t5, $t6
+    bnez  $t6, .Ldynamic_clear
+     sb    $zero, 0($t7)
+
+    la    $t6, inflate_code_order
+.Ldynamic_order:
+    jal   .Lfill
+     lbu   $t7, 0($t6)
+    addu  $t7, $t7, $t5
+    andi  $t2, $t0, 7
+    sb    $t2, 0($t7)
+    dsrl  $t0, $t0, 3
+    addiu $t1, $t1, -3
+    addiu $t4, $t4, -1
+    bnez  $t4, .Ldynamic_order
+     addiu $t6, $t6, 1
+
+    move  $v0, $t5
+    la    $t9, inflate_code_desc
+    jal   .Lbuild
+     li    $v1, 19
+
+    lw    $t2, FRAME_NLEN($sp)
+    lw    $t3, FRAME_NDIST($sp)
+    la    $t5, inflate_lengths
+    addu  $t4, $t5, $t2
+    addu  $t4, $t4, $t3
+    la    $t8, inflate_dist_table
+.Ldynamic_lengths:
+    beq   $t5, $t4, .Ldynamic_build
+     nop
+    jal   .Lfill
+     nop
+    andi  $t2, $t0, (1 << CODE_BITS) - 1
+    sll   $t2, $t2, 2
+    addu  $t2, $t2, $t8
+    lw    $t3, 0($t2)
+    andi  $t2, $t3, 0x1F
+    dsrlv $t0, $t0, $t3
+    subu  $t1, $t1, $t2
+    srl   $t3, $t3, 16
+    andi  $t3, $t3, 0xFF
+    sltiu $t2, $t3, 16
+    beqz  $t2, .Ldynamic_repeat
+     sb    $t3, 0($t5)      # overwritten by the repeat if it is one
+    b     .Ldynamic_lengths
+     addiu $t5, $t5, 1
+.Ldynamic_repeat:
+    li    $t2, 16
+    bne   $t3, $t2, .Ldynamic_zeros
+     lbu   $t6, -1($t5)     # 16: the last length 3-6 times
+    andi  $t7, $t0, 3
+    addiu $t7, $t7, 3
+    dsrl  $t0, $t0, 2
+    b     .Ldynamic_fill
+     addiu $t1, $t1, -2
+.Ldynamic_zeros:
+    li    $t2, 17
+    bne   $t3, $t2, .Ldynamic_long_zeros
+     move  $t6, $zero
+    andi  $t7, $t0, 7       # 17: 3-10 zeros
+    addiu $t7, $t7, 3
+    dsrl  $t0, $t0, 3
+    b     .Ldynamic_fill
+     addiu $t1, $t1, -3
+.Ldynamic_long_zeros:
+    andi  $t7, $t0, 0x7F    # 18: 11-138 zeros
+    addiu $t7, $t7, 11
+    dsrl  $t0, $t0, 7
+    addiu $t1, $t1, -7
+.Ldynamic_fill:
+    addiu $t7, $t7, -1
+    sb    $t6, 0($t5)
+    bnez  $t7, .Ldynamic_fill
+     addiu $t5, $t5, 1
+    b     .Ldynamic_lengths
+     nop
+
+.Ldynamic_build:
+    la    $v0, inflate_lengths
+    la    $t9, inflate_lit_desc
+    jal   .Lbuild
+     lw    $v1, FRAME_NLEN($sp)
+    la    $v0, inflate_lengths
+    lw    $t2, FRAME_NLEN($sp)
+    addu  $v0, $v0, $t2
+    la    $t9, inflate_dist_desc
+    jal   .Lbuild
+     lw    $v1, FRAME_NDIST($sp)
+
+/*
+ * Decode literals and matches until the end of the block. The buffer is topped
+ * up to 49 bits first, enough for a length code, its extra bits, a distance
+ * code and its extra bits.
+ */
+.Lcodes:
+    la    $t8, inflate_lit_table
+    la    $t9, inflate_dist_table
+.Lcode:
+    sltiu $t3, $t1, 49
+    beqz  $t3, .Lcode_decode
+     andi  $t2, $t0, (1 << LIT_BITS) - 1
+.Lcode_fill:
+    lbu   $t2, 0($a0)
+    lbu   $t3, 1($a0)
+    addiu $a0, $a0, 2
+    sll   $t3, $t3, 8
+    or    $t2, $t2, $t3
+    dsllv $t2, $t2, $t1
+    addiu $t1, $t1, 16
+    sltiu $t3, $t1, 49
+    bnez  $t3, .Lcode_fill
+     or    $t0, $t0, $t2
+    andi  $t2, $t0, (1 << LIT_BITS) - 1
+.Lcode_decode:
+    sll   $t2, $t2, 2
+    addu  $t2, $t2, $t8
+    lw    $t3, 0($t2)
+    andi  $t4, $t3, 0x1F
+    dsrlv $t0, $t0, $t3
+    bgez  $t3, .Llength
+     subu  $t1, $t1, $t4
+.Lliteral:
+    srl   $t5, $t3, 16
+    sb    $t5, 0($a1)
+    b     .Lcode
+     addiu $a1, $a1, 1
+
+.Llength:
+    srl   $t5, $t3, 16      # base length
+    beqz  $t5, .Llength_special
+     srl   $t6, $t3, 8
+    andi  $t6, $t6, 0xF     # extra bits
+.Llength_extra:
+    li    $t7, 1
+    sllv  $t7, $t7, $t6
+    addiu $t7, $t7, -1
+    and   $t7, $t7, $t0
+    dsrlv $t0, $t0, $t6
+    subu  $t1, $t1, $t6
+    addu  $t5, $t5, $t7
+
+    andi  $t2, $t0, (1 << DIST_BITS) - 1
+    sll   $t2, $t2, 2
+    addu  $t2, $t2, $t9
+    lw    $t3, 0($t2)
+    andi  $t4, $t3, 0x1F
+    dsrlv $t0, $t0, $t3
+    subu  $t1, $t1, $t4
+    srl   $t6, $t3, 16      # base distance
+    beqz  $t6, .Ldistance_long
+     srl   $t4, $t3, 8
+    andi  $t4, $t4, 0xF     # extra bits
+.Ldistance_extra:
+    li    $t7, 1
+    sllv  $t7, $t7, $t4
+    addiu $t7, $t7, -1
+    and   $t7, $t7, $t0
+    dsrlv $t0, $t0, $t4
+    subu  $t1, $t1, $t4
+    addu  $t6, $t6, $t7
+
+    subu  $t7, $a1, $t6     # copy from
+    addu  $t5, $t5, $a1     # end of the match
+    sltiu $t2, $t6, 8
+    bnez  $t2, .Lcopy_bytes
+     sltu  $t2, $a3, $t5    # the doublewords would go past the end of the output
+    bnez  $t2, .Lcopy_bytes
+     addiu $t4, $t5, -8
+.Lcopy_doublewords:
+    ldl   $t2, 0($t7)
+    ldr   $t2, 7($t7)
+    addiu $t7, $t7, 8
+    sdl   $t2, 0($a1)
+    sdr   $t2, 7($a1)
+    sltu  $t2, $a1, $t4     # another doubleword after this one
+    bnez  $t2, .Lcopy_doublewords
+     addiu $a1, $a1, 8
+    b     .Lcode
+     move  $a1, $t5
+.Lcopy_bytes:               # matches are at least 3 bytes long
+    lbu   $t2, 0($t7)
+    addiu $t7, $t7, 1
+    addiu $a1, $a1, 1
+    bne   $a1, $t5, .Lcopy_bytes
+     sb    $t2, -1($a1)
+    b     .Lcode
+     nop
+
+.Llength_special:
+    andi  $t2, $t3, ENTRY_END
+    bnez  $t2, .Lblock_end
+     nop
+    la    $t2, inflate_lit_counts
+    la    $t3, inflate_lit_symbols
+    jal   .Lslow
+     nop
+    sltiu $t2, $v0, 256
+    bnez  $t2, .Lslow_literal
+     nop
+    addiu $v0, $v0, -257
+    bltz  $v0, .Lblock_end
+     nop
+    la    $t2, inflate_length_extra
+    addu  $t2, $t2, $v0
+    lbu   $t6, 0($t2)
+    la    $t2, inflate_length_base
+    sll   $v0, $v0, 1
+    addu  $t2, $t2, $v0
+    b     .Llength_extra
+     lhu   $t5, 0($t2)
+.Lslow_literal:
+    sb    $v0, 0($a1)
+    b     .Lcode
+     addiu $a1, $a1, 1
+
+.Ldistance_long:
+    la    $t2, inflate_dist_counts
+    la    $t3, inflate_dist_symbols
+    jal   .Lslow
+     nop
+    la    $t2, inflate_dist_extra
+    addu  $t2, $t2, $v0
+    lbu   $t4, 0($t2)
+    la    $t2, inflate_dist_base
+    sll   $v0, $v0, 1
+    addu  $t2, $t2, $v0
+    b     .Ldistance_extra
+     lhu   $t6, 0($t2)
+
+/*
+ * Decodes a code too long for its table, one bit at a time.
+ * $t2: code counts, $t3: symbols sorted by code
+ * Returns the symbol in $v0. Leaves $t5 alone.
+ */
+.Lslow:
+    move  $v0, $zero        # code so far
+    move  $v1, $zero        # first code of this length
+    addiu $t2, $t2, 2
+.Lslow_bit:
+    andi  $t7, $t0, 1
+    or    $v0, $v0, $t7
+    dsrl  $t0, $t0, 1
+    addiu $t1, $t1, -1
+    lhu   $t7, 0($t2)
+    addiu $t2, $t2, 2
+    subu  $t4, $v0, $v1
+    sltu  $t6, $t4, $t7
+    bnez  $t6, .Lslow_found
+     addu  $v1, $v1, $t7
+    sll   $v1, $v1, 1
+    sll   $v0, $v0, 1
+    sll   $t7, $t7, 1
+    b     .Lslow_bit
+     addu  $t3, $t3, $t7
+.Lslow_found:
+    sll   $t4, $t4, 1
+    addu  $t3, $t3, $t4
+    jr    $ra
+     lhu   $v0, 0($t3)
+
+/* Tops the bit buffer up to at least 57 bits */
+.Lfill:
+    sltiu $t2, $t1, 57
+    beqz  $t2, .Lfill_done
+     nop
+    lbu   $t2, 0($a0)
+    addiu $a0, $a0, 1
+    dsllv $t2, $t2, $t1
+    or    $t0, $t0, $t2
+    b     .Lfill
+     addiu $t1, $t1, 8
+.Lfill_done:
+    jr    $ra
+     nop
+
+/*
+ * Builds the lookup table of a code.
+ * $v0: code lengths, $v1: number of symbols, $t9: descriptor
+ * Symbols below DESC_LITERAL are literals, the ones from there to DESC_FIRST
+ * end the block, and the rest get a base and extra bits from DESC_BASE/DESC_EXTRA.
+ */
+.Lbuild:
+    lw    $t2, DESC_COUNTS($t9)
+    sw    $zero, 0($t2)
+    sw    $zero, 4($t2)
+    sw    $zero, 8($t2)
+    sw    $zero, 12($t2)
+    sw    $zero, 16($t2)
+    sw    $zero, 20($t2)
+    sw    $zero, 24($t2)
+    sw    $zero, 28($t2)
+    move  $t3, $zero
+.Lbuild_count:
+    beq   $t3, $v1, .Lbuild_offsets
+     addu  $t4, $v0, $t3
+    lbu   $t4, 0($t4)
+    sll   $t4, $t4, 1
+    addu  $t4, $t4, $t2
+    lhu   $t5, 0($t4)
+    addiu $t5, $t5, 1
+    sh    $t5, 0($t4)
+    b     .Lbuild_count
+     addiu $t3, $t3, 1
+
+    /* where the symbols of each length start once sorted */
+.Lbuild_offsets:
+    la    $t3, inflate_offsets
+    sh    $zero, 2($t3)
+    li    $t4, 1
+    move  $t5, $zero
+.Lbuild_offsets_loop:
+    sll   $t6, $t4, 1
+    addu  $t7, $t2, $t6
+    lhu   $t7, 0($t7)
+    addu  $t6, $t6, $t3
+    addiu $t4, $t4, 1
+    addu  $t5, $t5, $t7
+    sltiu $t7, $t4, 15
+    bnez  $t7, .Lbuild_offsets_loop
+     sh    $t5, 2($t6)
+
+    lw    $t2, DESC_SYMBOLS($t9)
+    move  $t4, $zero
+.Lbuild_sort:
+    beq   $t4, $v1, .Lbuild_clear
+     addu  $t5, $v0, $t4
+    lbu   $t5, 0($t5)
+    beqz  $t5, .Lbuild_sort_next
+     sll   $t5, $t5, 1
+    addu  $t5, $t5, $t3
+    lhu   $t6, 0($t5)
+    addiu $t7, $t6, 1
+    sh    $t7, 0($t5)
+    sll   $t6, $t6, 1
+    addu  $t6, $t6, $t2
+    sh    $t4, 0($t6)
+.Lbuild_sort_next:
+    b     .Lbuild_sort
+     addiu $t4, $t4, 1
+
+.Lbuild_clear:
+    lw    $t2, DESC_TABLE($t9)
+    lw    $t3, DESC_BITS($t9)
+    li    $t4, 4
+    sllv  $t4, $t4, $t3
+    addu  $t4, $t4, $t2
+.Lbuild_clear_loop:
+    addiu $t2, $t2, 8
+    bne   $t2, $t4, .Lbuild_clear_loop
+     sd    $zero, -8($t2)
+
+    /*
+     * Codes are handed out in order of length then symbol. $t6 holds the next
+     * code bit-reversed, which is how it shows up in the bit buffer.
+     */
+    lw    $v0, DESC_COUNTS($t9)
+    addiu $v0, $v0, 2
+    lw    $v1, DESC_SYMBOLS($t9)
+    li    $t4, 1            # code length
+    move  $t6, $zero
+.Lbuild_length:
+    lhu   $t5, 0($v0)       # codes of this length left
+.Lbuild_code:
+    beqz  $t5, .Lbuild_next_length
+     addiu $t5, $t5, -1
+    lw    $t3, DESC_BITS($t9)
+    sltu  $t2, $t3, $t4
+    bnez  $t2, .Lbuild_increment
+     lhu   $t2, 0($v1)
+
+    lw    $t3, DESC_LITERAL($t9)
+    sltu  $t7, $t2, $t3
+    beqz  $t7, .Lbuild_not_literal
+     sll   $t8, $t2, 16
+    lui   $t7, ENTRY_LITERAL
+    b     .Lbuild_store
+     or    $t8, $t8, $t7
+.Lbuild_not_literal:
+    lw    $t3, DESC_FIRST($t9)
+    sltu  $t7, $t2, $t3
+    bnez  $t7, .Lbuild_store
+     li    $t8, ENTRY_END
+    subu  $t2, $t2, $t3
+    lw    $t3, DESC_EXTRA($t9)
+    addu  $t3, $t3, $t2
+    lbu   $t8, 0($t3)
+    sll   $t8, $t8, 8
+    lw    $t3, DESC_BASE($t9)
+    sll   $t2, $t2, 1
+    addu  $t3, $t3, $t2
+    lhu   $t3, 0($t3)
+    sll   $t3, $t3, 16
+    or    $t8, $t8, $t3
+.Lbuild_store:
+    or    $t8, $t8, $t4
+    lw    $t3, DESC_BITS($t9)
+    li    $t2, 4
+    sllv  $t3, $t2, $t3     # size of the table
+    lw    $t2, DESC_TABLE($t9)
+    sll   $t7, $t6, 2
+    addu  $t2, $t2, $t7
+    addu  $t3, $t3, $t2     # first entry past the end
+    li    $t7, 4
+    sllv  $t7, $t7, $t4     # every entry ending in the code
+.Lbuild_fill:
+    sw    $t8, 0($t2)
+    addu  $t2, $t2, $t7
+    bne   $t2, $t3, .Lbuild_fill
+     nop
+
+.Lbuild_increment:
+    addiu $t7, $t4, -1
+    li    $t2, 1
+    sllv  $t2, $t2, $t7
+.Lbuild_increment_loop:
+    and   $t7, $t6, $t2
+    beqz  $t7, .Lbuild_increment_done
+     nop
+    b     .Lbuild_increment_loop
+     srl   $t2, $t2, 1
+.Lbuild_increment_done:
+    addiu $t7, $t2, -1
+    and   $t6, $t6, $t7
+    addu  $t6, $t6, $t2
+    b     .Lbuild_code
+     addiu $v1, $v1, 2
+.Lbuild_next_length:
+    addiu $t4, $t4, 1
+    sltiu $t2, $t4, 16
+    bnez  $t2, .Lbuild_length
+     addiu $v0, $v0, 2
+    jr    $ra
+     nop
+
+.section .data
+
+inflate_lit_desc:
+    .word inflate_lit_table, LIT_BITS, inflate_lit_counts, inflate_lit_symbols
+    .word 256, 257, inflate_length_base, inflate_length_extra
+inflate_dist_desc:
+    .word inflate_dist_table, DIST_BITS, inflate_dist_counts, inflate_dist_symbols
+    .word 0, 0, inflate_dist_base, inflate_dist_extra
+/* The code length code shares the distance table, it's done with before that's built */
+inflate_code_desc:
+    .word inflate_dist_table, CODE_BITS, inflate_dist_counts, inflate_dist_symbols
+    .word 19, 19, 0, 0
+
+.section .rodata
+
+.balign 2
+inflate_length_base:
+    .half 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31
+    .half 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258, 0, 0
+inflate_dist_base:
+    .half 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193
+    .half 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577, 0, 0
+inflate_length_extra:
+    .byte 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2
+    .byte 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0, 0, 0
+inflate_dist_extra:
+    .byte 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6
+    .byte 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 0, 0
+inflate_code_order:
+    .byte 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+/* count, length pairs of the fixed code: 288 literal/length codes, then 30 distance codes */
+inflate_fixed_runs:
+    .byte 144, 8, 112, 9, 24, 7, 8, 8, 30, 5, 0
+
+.section .bss
+
+.balign 8
+inflate_lit_table:
+    .space (1 << LIT_BITS) * 4
+inflate_dist_table:
+    .space (1 << DIST_BITS) * 4
+inflate_lit_counts:
+    .space 16 * 2
+inflate_dist_counts:
+    .space 16 * 2
+inflate_offsets:
+    .space 16 * 2
+inflate_lit_symbols:
+    .space 288 * 2
+inflate_dist_symbols:
+    .space 32 * 2
+inflate_lengths:
+    .space 320
+
+#endif
@@ -4,15 +4,16 @@
 
 #include "buffers/buffers.h"
 #include "slidec.h"
+#include "stream_decompress.h"
 #include "game/game_init.h"
 #include "game/main.h"
 #include "game/memory.h"
 #include "segment_symbols.h"
 #include "segments.h"
-#ifdef GZIP
+#if defined(GZIP) || defined(MIXED_COMPRESSION)
 #include <gzip.h>
 #endif
-#if defined(RNC1) || defined(RNC2)
+#if defined(RNC1) || defined(RNC2) || defined(MIXED_COMPRESSION)
 #include <rnc.h>
 #endif
 #ifdef UNF
@@ -369,6 +370,250 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
     return dest;
 }
 
+#ifdef STREAMED_DECOMPRESSION
+/**
+ * Decompress the block of ROM data from srcStart to srcEnd while it is
+ * DMAed, and return a pointer to an allocated buffer holding the
+ * decompressed data. Set the base address of segment to this address.
+ * Only a small buffer the data streams through is taken from the right
+ * side of the pool, instead of a copy of all of it.
+ */
+void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
+    void *dest = NULL;
+    struct DmaStream stream;
+    u8 *buffer = main_pool_alloc(STREAM_DECOMPRESS_BUFFER_SIZE, MEMORY_POOL_RIGHT);
+
+    if (buffer != NULL) {
+        u32 size = stream_decompress_open(&stream, buffer, srcStart, srcEnd);
+
+        dest = main_pool_alloc(size, MEMORY_POOL_LEFT);
+        if (dest != NULL) {
+            osSyncPrintf("start decompress\n");
+            stream_decompress(&stream, buffer, dest);
+            osSyncPrintf("end decompress\n");
+            set_segment_base_addr(segment, dest);
+        }
+        stream_decompress_close(&stream);
+        main_pool_free(buffer);
+    }
+#if PUPPYPRINT_DEBUG
+    ramsizeSegment[(segment + nameTable) - 2] = (s32)srcEnd - (s32)srcStart;
+#endif
+    return dest;
+}
+
+void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
+    struct DmaStream stream;
+    u8 *buffer = main_pool_alloc(STREAM_DECOMPRESS_BUFFER_SIZE, MEMORY_POOL_RIGHT);
+
+    if (buffer != NULL) {
+        stream_decompress_open(&stream, buffer, srcStart, srcEnd);
+        stream_decompress(&stream, buffer, gDecompressionHeap);
+        stream_decompress_close(&stream);
+        set_segment_base_addr(segment, gDecompressionHeap);
+        main_pool_free(buffer);
+    }
+    return gDecompressionHeap;
+}
+#elif defined(IN_PLACE_DECOMPRESSION)
+/**
+ * Read the trailer the build tools end compressed segments with: how much
+ * larger than the decompressed data a buffer has to be to decompress the
+ * segment in place, followed by the decompressed size.
+ */
+static s32 read_in_place_trailer(u8 *srcEnd, u32 *size, u32 *margin) {
+    u32 *trailer = dynamic_dma_read(srcEnd - 16, srcEnd, MEMORY_POOL_RIGHT, 0, 0);
+
+    if (trailer == NULL) {
+        return FALSE;
+    }
+    *margin = trailer[2];
+    *size = trailer[3];
+    main_pool_free(trailer);
+    return TRUE;
+}
+
+static void decompress_in_place(u8 *compressed, u8 *dest) {
+#ifdef RNC1
+    Propack_UnpackM1(compressed, dest);
+#elif RNC2
+    Propack_UnpackM2(compressed, dest);
+#elif YAY0
+    slidstart(compressed, dest);
+#elif MIO0
+    decompress(compressed, dest);
+#endif
+}
+
+/**
+ * Decompress the block of ROM data from srcStart to srcEnd and return a
+ * pointer to an allocated buffer holding the decompressed data. Set the
+ * base address of segment to this address.
+ * The compressed data is DMAed to the end of that buffer and decompressed
+ * forward into it. The margin keeps the output behind the data that is
+ * still to be read, and is given back afterwards.
+ */
+void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
+    void *dest = NULL;
+    u32 compSize = ALIGN16(srcEnd - srcStart);
+    u32 size, margin;
+
+    if (read_in_place_trailer(srcEnd, &size, &margin)) {
+        dest = main_pool_alloc(size + margin, MEMORY_POOL_LEFT);
+        if (dest != NULL) {
+            u8 *compressed = (u8 *) dest + size + margin - compSize;
+
+            dma_read(compressed, srcStart, srcEnd);
+            osSyncPrintf("start decompress\n");
+            decompress_in_place(compressed, dest);
+            osSyncPrintf("end decompress\n");
+            dest = main_pool_realloc(dest, size);
+            set_segment_base_addr(segment, dest);
+        }
+    }
+#if PUPPYPRINT_DEBUG
+    ramsizeSegment[(segment + nameTable) - 2] = (s32)srcEnd - (s32)srcStart;
+#endif
+    return dest;
+}
+
+void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
+    u32 compSize = ALIGN16(srcEnd - srcStart);
+    u32 size, margin;
+
+    if (read_in_place_trailer(srcEnd, &size, &margin)) {
+        u8 *buffer = NULL;
+        u8 *compressed;
+
+        if (size + margin <= DECOMPRESSION_HEAP_SIZE) {
+            compressed = gDecompressionHeap + size + margin - compSize;
+        } else {
+            // Not enough room left in the heap for the margin.
+            compressed = buffer = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+        }
+        if (compressed != NULL) {
+            dma_read(compressed, srcStart, srcEnd);
+            decompress_in_place(compressed, gDecompressionHeap);
+            set_segment_base_addr(segment, gDecompressionHeap);
+        }
+        if (buffer != NULL) {
+            main_pool_free(buffer);
+        }
+    }
+    return gDecompressionHeap;
+}
+#elif defined(MIXED_COMPRESSION)
+// Codec of a compressed segment, picked for it by tools/segment_codec.py.
+enum SegmentCodec {
+    SEGMENT_CODEC_NONE,
+    SEGMENT_CODEC_RNC1,
+    SEGMENT_CODEC_RNC2,
+    SEGMENT_CODEC_YAY0,
+    SEGMENT_CODEC_MIO0,
+    SEGMENT_CODEC_GZIP,
+};
+
+// Comes before the codec's own data, which starts 16 bytes in to stay aligned for DMAs.
+struct SegmentHeader {
+    /*0x00*/ u8 codec;
+    /*0x01*/ u8 filler1[3];
+    /*0x04*/ u32 size; // Decompressed size.
+    /*0x08*/ u8 filler8[8];
+};
+
+static s32 read_segment_header(u8 *srcStart, struct SegmentHeader *header) {
+    struct SegmentHeader *rom = dynamic_dma_read(srcStart, srcStart + sizeof(struct SegmentHeader), MEMORY_POOL_RIGHT, 0, 0);
+
+    if (rom == NULL) {
+        return FALSE;
+    }
+    *header = *rom;
+    main_pool_free(rom);
+    return TRUE;
+}
+
+static void decompress_segment(struct SegmentHeader *header, u8 *compressed, UNUSED u32 compSize, u8 *dest) {
+    switch (header->codec) {
+        case SEGMENT_CODEC_RNC1: Propack_UnpackM1(compressed, dest);                    break;
+        case SEGMENT_CODEC_RNC2: Propack_UnpackM2(compressed, dest);                    break;
+        case SEGMENT_CODEC_YAY0: slidstart(compressed, dest);                           break;
+        case SEGMENT_CODEC_MIO0: decompress(compressed, dest);                          break;
+#ifdef FAST_INFLATE
+        case SEGMENT_CODEC_GZIP: inflate_segment(compressed, dest, header->size);       break;
+#else
+        case SEGMENT_CODEC_GZIP: expand_gzip(compressed, dest, compSize, header->size); break;
+#endif
+    }
+}
+
+/**
+ * Decompress the block of ROM data from srcStart to srcEnd and return a
+ * pointer to an allocated buffer holding the decompressed data. Set the
+ * base address of segment to this address.
+ * Each segment starts with a header saying which codec it was compressed
+ * with. Segments that are stored uncompressed are DMAed straight to their
+ * buffer.
+ */
+void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
+    void *dest = NULL;
+    struct SegmentHeader header;
+
+    if (read_segment_header(srcStart, &header)) {
+        u8 *dataStart = srcStart + sizeof(struct SegmentHeader);
+
+        if (header.codec == SEGMENT_CODEC_NONE) {
+            dest = main_pool_alloc(header.size, MEMORY_POOL_LEFT);
+            if (dest != NULL) {
+                dma_read(dest, dataStart, srcEnd);
+            }
+        } else {
+            u32 compSize = ALIGN16(srcEnd - dataStart);
+            u8 *compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+
+            if (compressed != NULL) {
+                dma_read(compressed, dataStart, srcEnd);
+                dest = main_pool_alloc(header.size, MEMORY_POOL_LEFT);
+                if (dest != NULL) {
+                    osSyncPrintf("start decompress\n");
+                    decompress_segment(&header, compressed, compSize, dest);
+                    osSyncPrintf("end decompress\n");
+                }
+                main_pool_free(compressed);
+            }
+        }
+        if (dest != NULL) {
+            set_segment_base_addr(segment, dest);
+        }
+    }
+#if PUPPYPRINT_DEBUG
+    ramsizeSegment[(segment + nameTable) - 2] = (s32)srcEnd - (s32)srcStart;
+#endif
+    return dest;
+}
+
+void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
+    struct SegmentHeader header;
+
+    if (read_segment_header(srcStart, &header)) {
+        u8 *dataStart = srcStart + sizeof(struct SegmentHeader);
+
+        if (header.codec == SEGMENT_CODEC_NONE) {
+            dma_read(gDecompressionHeap, dataStart, srcEnd);
+        } else {
+            u32 compSize = ALIGN16(srcEnd - dataStart);
+            u8 *compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+
+            if (compressed != NULL) {
+                dma_read(compressed, dataStart, srcEnd);
+                decompress_segment(&header, compressed, compSize, gDecompressionHeap);
+                main_pool_free(compressed);
+            }
+        }
+        set_segment_base_addr(segment, gDecompressionHeap);
+    }
+    return gDecompressionHeap;
+}
+#else
 /**
  * Decompress the block of ROM data from srcStart to srcEnd and return a
  * pointer to an allocated buffer holding the decompressed data. Set the
@@ -400,7 +645,9 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
 #endif
         if (dest != NULL) {
             osSyncPrintf("start decompress\n");
-#ifdef GZIP
+#if defined(GZIP) && defined(FAST_INFLATE)
+            inflate_segment(compressed, dest, *size);
+#elif GZIP
             expand_gzip(compressed, dest, compSize, (u32)size);
 #elif RNC1
             Propack_UnpackM1(compressed, dest);
@@ -441,7 +688,9 @@ void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
 #else
         dma_read(compressed, srcStart, srcEnd);
 #endif
-#ifdef GZIP
+#if defined(GZIP) && defined(FAST_INFLATE)
+        inflate_segment(compressed, gDecompressionHeap, *size);
+#elif GZIP
         expand_gzip(compressed, gDecompressionHeap, compSize, (u32)size);
 #elif RNC1
         Propack_UnpackM1(compressed, gDecompressionHeap);
@@ -457,6 +706,7 @@ void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd) {
     }
     return gDecompressionHeap;
 }
+#endif
 
 void load_engine_code_segment(void) {
     void *startAddr = (void *) _engineSegmentStart;
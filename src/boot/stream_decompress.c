@@ -0,0 +1,453 @@
+#include <ultra64.h>
+
+#include "sm64.h"
+#include "game/memory.h"
+#include "stream_decompress.h"
+#ifdef GZIP
+#include <gzip.h>
+#endif
+
+#ifdef STREAMED_DECOMPRESSION
+
+#define ALIGN16(val) (((val) + 0xF) & ~0xF)
+
+/**
+ * Starts the DMA of the next chunk of the stream into the chunk at index, if there is one left.
+ */
+static void dma_stream_queue_chunk(struct DmaStream *stream, u32 index) {
+    u8 *chunk = stream->chunks + (index * DMA_STREAM_CHUNK_SIZE);
+    u32 size = ALIGN16(stream->romEnd - stream->romPos);
+
+    if (stream->romPos >= stream->romEnd) {
+        return;
+    }
+    if (size > DMA_STREAM_CHUNK_SIZE) {
+        size = DMA_STREAM_CHUNK_SIZE;
+    }
+
+    osInvalDCache(chunk, size);
+    osPiStartDma(&stream->ioMesgs[index], OS_MESG_PRI_NORMAL, OS_READ, (uintptr_t) stream->romPos, chunk, size,
+                 &stream->queue);
+    stream->chunkEnds[index] = chunk + size;
+    stream->romPos += size;
+    stream->numQueued++;
+}
+
+/**
+ * Starts streaming srcStart to srcEnd from ROM through buffer. All but one of the chunks are DMAed right away.
+ */
+static void dma_stream_open(struct DmaStream *stream, u8 *buffer, u8 *srcStart, u8 *srcEnd) {
+    u32 i;
+
+    osCreateMesgQueue(&stream->queue, stream->mesgBuf, DMA_STREAM_NUM_CHUNKS);
+    stream->chunks = buffer + DMA_STREAM_GUARD_SIZE;
+    stream->pos = stream->chunks;
+    stream->end = stream->chunks;
+    stream->romPos = srcStart;
+    stream->romEnd = srcEnd;
+    stream->numRead = 0;
+    stream->numQueued = 0;
+
+    for (i = 0; i < DMA_STREAM_NUM_CHUNKS - 1; i++) {
+        dma_stream_queue_chunk(stream, i);
+    }
+}
+
+/**
+ * Waits for the next chunk, which the unread bytes of the current one are kept in front of. Does nothing once the
+ * last chunk has been reached.
+ */
+void dma_stream_advance(struct DmaStream *stream) {
+    u32 index = (stream->numRead % DMA_STREAM_NUM_CHUNKS);
+    u8 *chunk = stream->chunks + (index * DMA_STREAM_CHUNK_SIZE);
+
+    if (stream->numRead == stream->numQueued) {
+        return;
+    }
+
+    // PI DMAs finish in the order they were started.
+    osRecvMesg(&stream->queue, NULL, OS_MESG_BLOCK);
+
+    if (index == 0 && stream->numRead != 0) {
+        u32 left = (stream->end - stream->pos);
+
+        bcopy(stream->pos, (chunk - left), left);
+        stream->pos = (chunk - left);
+    }
+    stream->end = stream->chunkEnds[index];
+    stream->numRead++;
+
+    // The chunk two before the new one has been read entirely by now.
+    if (stream->numRead >= 2) {
+        dma_stream_queue_chunk(stream, ((stream->numRead + DMA_STREAM_NUM_CHUNKS - 3) % DMA_STREAM_NUM_CHUNKS));
+    }
+}
+
+/**
+ * Copies size bytes from the stream to dest.
+ */
+static void dma_stream_read(struct DmaStream *stream, u8 *dest, u32 size) {
+    while (size != 0) {
+        u32 copySize = (stream->end - stream->pos);
+
+        if (copySize == 0) {
+            dma_stream_advance(stream);
+            copySize = (stream->end - stream->pos);
+            if (copySize == 0) {
+                return;
+            }
+        }
+        if (copySize > size) {
+            copySize = size;
+        }
+
+        bcopy(stream->pos, dest, copySize);
+        stream->pos += copySize;
+        dest += copySize;
+        size -= copySize;
+    }
+}
+
+static u32 read_u32_be(u8 *src) {
+    return ((src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3]);
+}
+
+#if defined(RNC1) || defined(RNC2)
+
+#define RNC_HEADER_SIZE 0x12
+
+/**
+ * Both RNC methods mix bits with whole bytes, which are read from the stream as they come up in the bits. Only the
+ * bits of the last 16 (method 1) or 8 (method 2) bits read that haven't been used yet are kept in bitBuffer.
+ */
+struct RncStream {
+    struct DmaStream *dma;
+    u32 bitBuffer;
+    s32 bitCount;
+};
+
+static u8 rnc_read_byte(struct RncStream *rnc) {
+    DMA_STREAM_ENSURE(rnc->dma, 1);
+    return *rnc->dma->pos++;
+}
+
+/**
+ * Copies count bytes from offset bytes before dest. They can overlap, repeating the bytes copied.
+ */
+static u8 *rnc_copy_match(u8 *dest, u32 offset, u32 count) {
+    u8 *src = (dest - offset);
+
+    while (count--) {
+        *dest++ = *src++;
+    }
+    return dest;
+}
+
+#endif // RNC1 || RNC2
+
+#ifdef RNC1
+
+#define RNC1_TABLE_SIZE 16
+
+/**
+ * Huffman table of RNC method 1. Entry i stands for 0 and 1 when i < 2, and otherwise for i - 1 bits following the
+ * code that are added to 1 << (i - 1).
+ */
+struct Rnc1Table {
+    u16 codes[RNC1_TABLE_SIZE]; // Bit reversed, since bits are read starting at the lowest.
+    u8 numBits[RNC1_TABLE_SIZE];
+};
+
+static u32 rnc1_read_bits(struct RncStream *rnc, s32 count) {
+    u32 bits;
+
+    if (count <= rnc->bitCount) {
+        bits = (rnc->bitBuffer & ((1 << count) - 1));
+        rnc->bitBuffer >>= count;
+        rnc->bitCount -= count;
+    } else {
+        struct DmaStream *dma = rnc->dma;
+        s32 rest = (count - rnc->bitCount);
+        u32 word;
+
+        DMA_STREAM_ENSURE(dma, 2);
+        word = (dma->pos[0] | (dma->pos[1] << 8));
+        dma->pos += 2;
+
+        bits = (rnc->bitBuffer | ((word & ((1 << rest) - 1)) << rnc->bitCount));
+        rnc->bitBuffer = (word >> rest);
+        rnc->bitCount = (16 - rest);
+    }
+    return bits;
+}
+
+/**
+ * Returns the next 16 bits without using them up.
+ */
+static u32 rnc1_peek_bits(struct RncStream *rnc) {
+    struct DmaStream *dma = rnc->dma;
+
+    DMA_STREAM_ENSURE(dma, 2);
+    return (rnc->bitBuffer | ((dma->pos[0] | (dma->pos[1] << 8)) << rnc->bitCount));
+}
+
+static void rnc1_read_table(struct RncStream *rnc, struct Rnc1Table *table) {
+    s32 numEntries = rnc1_read_bits(rnc, 5);
+    u32 code = 0;
+    s32 numBits, i, j;
+
+    bzero(table->numBits, sizeof(table->numBits));
+    if (numEntries > RNC1_TABLE_SIZE) {
+        numEntries = RNC1_TABLE_SIZE;
+    }
+    for (i = 0; i < numEntries; i++) {
+        table->numBits[i] = rnc1_read_bits(rnc, 4);
+    }
+
+    // Codes are given out shortest first, in the order of the entries.
+    for (numBits = 1; numBits <= 16; numBits++) {
+        for (i = 0; i < numEntries; i++) {
+            if (table->numBits[i] == numBits) {
+                u32 value = (code >> (32 - numBits));
+                u32 reversed = 0;
+
+                for (j = 0; j < numBits; j++) {
+                    reversed = ((reversed << 1) | ((value >> j) & 1));
+                }
+                table->codes[i] = reversed;
+                code += (1 << (32 - numBits));
+            }
+        }
+    }
+}
+
+static u32 rnc1_decode(struct RncStream *rnc, struct Rnc1Table *table) {
+    u32 bits = rnc1_peek_bits(rnc);
+    s32 i;
+
+    for (i = 0; i < RNC1_TABLE_SIZE; i++) {
+        s32 numBits = table->numBits[i];
+
+        if (numBits != 0 && table->codes[i] == (bits & ((1 << numBits) - 1))) {
+            rnc1_read_bits(rnc, numBits);
+            if (i < 2) {
+                return i;
+            }
+            return (rnc1_read_bits(rnc, (i - 1)) | (1 << (i - 1)));
+        }
+    }
+    return 0;
+}
+
+/**
+ * Same as Propack_UnpackM1, without the header, which the stream has been moved past.
+ */
+static void rnc1_unpack(struct RncStream *rnc, u8 *dest, u8 *destEnd) {
+    struct Rnc1Table literalTable, offsetTable, lengthTable;
+
+    // Lock and key flags.
+    rnc1_read_bits(rnc, 2);
+
+    while (dest < destEnd) {
+        s32 numBlocks;
+
+        rnc1_read_table(rnc, &literalTable);
+        rnc1_read_table(rnc, &offsetTable);
+        rnc1_read_table(rnc, &lengthTable);
+        numBlocks = rnc1_read_bits(rnc, 16);
+
+        // Each block is literal bytes followed by a match, except for the last, which has no match.
+        while (numBlocks--) {
+            u32 numLiterals = rnc1_decode(rnc, &literalTable);
+
+            if (numLiterals != 0) {
+                dma_stream_read(rnc->dma, dest, numLiterals);
+                dest += numLiterals;
+            }
+            if (numBlocks != 0) {
+                u32 offset = (rnc1_decode(rnc, &offsetTable) + 1);
+                u32 count = (rnc1_decode(rnc, &lengthTable) + 2);
+
+                dest = rnc_copy_match(dest, offset, count);
+            }
+        }
+    }
+}
+
+#endif // RNC1
+
+#ifdef RNC2
+
+static u32 rnc2_read_bit(struct RncStream *rnc) {
+    u32 bit;
+
+    if (rnc->bitCount == 0) {
+        rnc->bitBuffer = rnc_read_byte(rnc);
+        rnc->bitCount = 8;
+    }
+    bit = ((rnc->bitBuffer >> 7) & 1);
+    rnc->bitBuffer <<= 1;
+    rnc->bitCount--;
+    return bit;
+}
+
+static u32 rnc2_read_bits(struct RncStream *rnc, s32 count) {
+    u32 bits = 0;
+
+    while (count--) {
+        bits = ((bits << 1) | rnc2_read_bit(rnc));
+    }
+    return bits;
+}
+
+static u32 rnc2_read_count(struct RncStream *rnc) {
+    u32 count = (rnc2_read_bit(rnc) + 4);
+
+    if (rnc2_read_bit(rnc)) {
+        count = (((count - 1) << 1) + rnc2_read_bit(rnc));
+    }
+    return count;
+}
+
+static u32 rnc2_read_offset(struct RncStream *rnc) {
+    u32 offset = 0;
+
+    if (rnc2_read_bit(rnc)) {
+        offset = rnc2_read_bit(rnc);
+        if (rnc2_read_bit(rnc)) {
+            offset = (((offset << 1) | rnc2_read_bit(rnc)) | 4);
+            if (!rnc2_read_bit(rnc)) {
+                offset = ((offset << 1) | rnc2_read_bit(rnc));
+            }
+        } else if (offset == 0) {
+            offset = (rnc2_read_bit(rnc) + 2);
+        }
+    }
+    return (((offset << 8) | rnc_read_byte(rnc)) + 1);
+}
+
+/**
+ * Same as Propack_UnpackM2, without the header, which the stream has been moved past.
+ */
+static void rnc2_unpack(struct RncStream *rnc, u8 *dest, u8 *destEnd) {
+    // Lock and key flags.
+    rnc2_read_bits(rnc, 2);
+
+    while (dest < destEnd) {
+        while (TRUE) {
+            u32 count, offset;
+
+            if (!rnc2_read_bit(rnc)) {
+                *dest++ = rnc_read_byte(rnc);
+                continue;
+            }
+
+            if (rnc2_read_bit(rnc)) {
+                if (rnc2_read_bit(rnc)) {
+                    if (rnc2_read_bit(rnc)) {
+                        count = (rnc_read_byte(rnc) + 8);
+                        if (count == 8) {
+                            // End of a chunk.
+                            rnc2_read_bit(rnc);
+                            break;
+                        }
+                    } else {
+                        count = 3;
+                    }
+                    offset = rnc2_read_offset(rnc);
+                } else {
+                    count = 2;
+                    offset = (rnc_read_byte(rnc) + 1);
+                }
+            } else {
+                count = rnc2_read_count(rnc);
+                if (count == 9) {
+                    count = ((rnc2_read_bits(rnc, 4) << 2) + 12);
+                    dma_stream_read(rnc->dma, dest, count);
+                    dest += count;
+                    continue;
+                }
+                offset = rnc2_read_offset(rnc);
+            }
+            dest = rnc_copy_match(dest, offset, count);
+        }
+    }
+}
+
+#endif // RNC2
+
+#ifdef GZIP
+
+/**
+ * Hands inflate the rest of the current chunk, or the next one.
+ */
+static unsigned char *gzip_read_block(void *arg, unsigned int *size) {
+    struct DmaStream *stream = arg;
+    u8 *block;
+
+    if (stream->pos == stream->end) {
+        dma_stream_advance(stream);
+    }
+    block = stream->pos;
+    *size = (stream->end - stream->pos);
+    stream->pos = stream->end;
+    return ((*size != 0) ? block : NULL);
+}
+
+#endif // GZIP
+
+/**
+ * Starts DMAing the compressed data from srcStart to srcEnd through buffer, which must be
+ * STREAM_DECOMPRESS_BUFFER_SIZE bytes, and returns the size it decompresses to.
+ */
+u32 stream_decompress_open(struct DmaStream *stream, u8 *buffer, u8 *srcStart, u8 *srcEnd) {
+#ifdef GZIP
+    // The size is at the end of the file, read it into the window before inflate needs it.
+    u8 *window = (buffer + DMA_STREAM_BUFFER_SIZE);
+
+    dma_read(window, (srcEnd - 0x10), srcEnd);
+    dma_stream_open(stream, buffer, srcStart, srcEnd);
+    return read_u32_be(window + 0xC);
+#else
+    // Unpacked size in the header, which comes after the "RNC" and method bytes.
+    dma_stream_open(stream, buffer, srcStart, srcEnd);
+    DMA_STREAM_ENSURE(stream, RNC_HEADER_SIZE);
+    return read_u32_be(stream->pos + 4);
+#endif
+}
+
+/**
+ * Decompresses the stream into dest as it arrives.
+ */
+void stream_decompress(struct DmaStream *stream, UNUSED u8 *buffer, u8 *dest) {
+#ifdef GZIP
+    u32 size = read_u32_be(buffer + DMA_STREAM_BUFFER_SIZE + 0xC);
+
+    expand_gzip_stream(dest, size, gzip_read_block, stream, (buffer + DMA_STREAM_BUFFER_SIZE));
+#else
+    struct RncStream rnc;
+    u32 size = read_u32_be(stream->pos + 4);
+
+    rnc.dma = stream;
+    rnc.bitBuffer = 0;
+    rnc.bitCount = 0;
+    stream->pos += RNC_HEADER_SIZE;
+#ifdef RNC1
+    rnc1_unpack(&rnc, dest, (dest + size));
+#else
+    rnc2_unpack(&rnc, dest, (dest + size));
+#endif
+#endif
+}
+
+/**
+ * Waits for the DMAs still going to the buffer, so it can be freed.
+ */
+void stream_decompress_close(struct DmaStream *stream) {
+    while (stream->numRead < stream->numQueued) {
+        osRecvMesg(&stream->queue, NULL, OS_MESG_BLOCK);
+        stream->numRead++;
+    }
+}
+
+#endif // STREAMED_DECOMPRESSION
@@ -0,0 +1,56 @@
+#ifndef STREAM_DECOMPRESS_H
+#define STREAM_DECOMPRESS_H
+
+#include <ultra64.h>
+
+#include "config.h"
+
+#ifdef STREAMED_DECOMPRESSION
+
+// Compressed data is DMAed in chunks, the decoder reads one while the ones after it are still being transferred.
+#define DMA_STREAM_CHUNK_SIZE  0x1000
+#define DMA_STREAM_NUM_CHUNKS  4
+// A line in front of the chunks, where the end of the last one is moved to when reading wraps around.
+#define DMA_STREAM_GUARD_SIZE  0x10
+#define DMA_STREAM_BUFFER_SIZE (DMA_STREAM_GUARD_SIZE + (DMA_STREAM_NUM_CHUNKS * DMA_STREAM_CHUNK_SIZE))
+
+#ifdef GZIP
+// Inflate keeps the last 32KB it wrote to resume from between chunks.
+#define STREAM_DECOMPRESS_WINDOW_SIZE 0x8000
+#else
+#define STREAM_DECOMPRESS_WINDOW_SIZE 0
+#endif
+
+// Size of the buffer passed to stream_decompress_open.
+#define STREAM_DECOMPRESS_BUFFER_SIZE (DMA_STREAM_BUFFER_SIZE + STREAM_DECOMPRESS_WINDOW_SIZE)
+
+struct DmaStream {
+    /*0x00*/ u8 *pos;       // Next byte to read.
+    /*0x04*/ u8 *end;       // End of what has arrived of the chunk being read.
+    /*0x08*/ u8 *chunks;
+    /*0x0C*/ u8 *romPos;    // Where the next chunk is DMAed from.
+    /*0x10*/ u8 *romEnd;
+    /*0x14*/ u32 numRead;   // Chunks that have arrived so far, the one being read included.
+    /*0x18*/ u32 numQueued; // Chunks DMAed so far.
+    /*0x1C*/ u8 *chunkEnds[DMA_STREAM_NUM_CHUNKS];
+    /*0x2C*/ OSMesgQueue queue;
+    /*0x44*/ OSMesg mesgBuf[DMA_STREAM_NUM_CHUNKS];
+    /*0x54*/ OSIoMesg ioMesgs[DMA_STREAM_NUM_CHUNKS];
+};
+
+void dma_stream_advance(struct DmaStream *stream);
+
+// Makes sure at least size bytes can be read at stream->pos, unless the data ends before that.
+#define DMA_STREAM_ENSURE(stream, size) {                   \
+    if ((stream)->end - (stream)->pos < (size)) {           \
+        dma_stream_advance(stream);                         \
+    }                                                       \
+}
+
+u32 stream_decompress_open(struct DmaStream *stream, u8 *buffer, u8 *srcStart, u8 *srcEnd);
+void stream_decompress(struct DmaStream *stream, u8 *buffer, u8 *dest);
+void stream_decompress_close(struct DmaStream *stream);
+
+#endif // STREAMED_DECOMPRESSION
+
+#endif // STREAM_DECOMPRESS_H
@@ -9,7 +9,7 @@
 #include "config.h"
 #include "audio/synthesis.h"
 
-ALIGNED8 u8 gDecompressionHeap[0xD000];
+ALIGNED8 u8 gDecompressionHeap[DECOMPRESSION_HEAP_SIZE];
 ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(AUDIO_HEAP_SIZE)];
 
 ALIGNED8 u8 gIdleThreadStack[0x800];
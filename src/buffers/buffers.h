@@ -8,6 +8,8 @@
 #include "game/game_init.h"
 #include "config.h"
 
+#define DECOMPRESSION_HEAP_SIZE 0xD000
+
 extern u8 gDecompressionHeap[];
 
 extern u8 gAudioHeap[];
@@ -813,6 +813,181 @@ static BhvCommandProc BehaviorCmdTable[] = {
     /*BHV_CMD_SPAWN_WATER_DROPLET   */ bhv_cmd_spawn_water_droplet,
 };
 
+#ifdef BEHAVIOR_SCRIPT_PREDECODE
+/**
+ * Pre-decoded behavior loops.
+ *
+ * Most objects spend their whole life in a BEGIN_LOOP body made of CALL_NATIVE and a few field
+ * commands, and every frame the interpreter decodes each of those commands through
+ * BehaviorCmdTable again, then pops and pushes the loop address in END_LOOP. The first time an
+ * object starts a frame at a script address, the commands from there up to the END_LOOP are
+ * decoded into a list of ops with their arguments and native function pointers pulled out, which
+ * run_bhv_loop then runs directly. Addresses that don't start such a body are remembered too, so
+ * they are only looked at once. Decoded loops are dropped on every level load.
+ */
+#define BHV_LOOP_TABLE_SIZE 256 // Must be a power of 2.
+#define BHV_LOOP_MAX_PROBES 8
+#define BHV_LOOP_POOL_SIZE  512
+#define BHV_LOOP_MAX_OPS    16
+
+struct BhvLoopOp {
+    u8 cmd; // BHV_CMD_*, with BIT_CLEAR turned into an AND with the inverted mask.
+    u8 field;
+    s16 rate; // ANIMATE_TEXTURE only.
+    union {
+        NativeBhvFunc func;
+        s32 asS32;
+        f32 asF32;
+    } arg;
+};
+
+struct BhvLoop {
+    const BehaviorScript *start; // The first command of the loop body, NULL if this entry is free.
+    u16 firstOp;
+    u8 numOps; // 0 if the commands at start aren't a loop body that can be decoded.
+    u8 onlyNative; // Whether every op is a CALL_NATIVE.
+};
+
+static struct BhvLoop sBhvLoops[BHV_LOOP_TABLE_SIZE];
+static struct BhvLoopOp sBhvLoopOps[BHV_LOOP_POOL_SIZE];
+static s32 sNumBhvLoopOps;
+static struct BhvLoop *sLastBhvLoop = &sBhvLoops[0]; // Objects with the same behavior tend to update one after another.
+
+void clear_bhv_loops(void) {
+    s32 i;
+
+    for (i = 0; i < BHV_LOOP_TABLE_SIZE; i++) {
+        sBhvLoops[i].start = NULL;
+    }
+    sNumBhvLoopOps = 0;
+    sLastBhvLoop = &sBhvLoops[0];
+}
+
+/**
+ * Decodes the commands at start, if they are CALL_NATIVE and field commands followed by an END_LOOP.
+ * Otherwise the loop is left with no ops.
+ */
+static void decode_bhv_loop(struct BhvLoop *loop, const BehaviorScript *start) {
+    const BehaviorScript *cmd = start;
+    struct BhvLoopOp *op = &sBhvLoopOps[sNumBhvLoopOps];
+    s32 numOps = 0;
+
+    loop->start = start;
+    loop->firstOp = sNumBhvLoopOps;
+    loop->numOps = 0;
+    loop->onlyNative = TRUE;
+
+    while ((*cmd >> 24) != BHV_CMD_END_LOOP) {
+        if (numOps >= BHV_LOOP_MAX_OPS || sNumBhvLoopOps + numOps >= BHV_LOOP_POOL_SIZE) {
+            return;
+        }
+
+        op->cmd = (*cmd >> 24);
+        op->field = ((*cmd >> 16) & 0xFF);
+
+        switch (op->cmd) {
+            case BHV_CMD_CALL_NATIVE:
+                op->arg.func = (NativeBhvFunc) cmd[1];
+                cmd += 2;
+                break;
+            case BHV_CMD_SET_INT:
+            case BHV_CMD_ADD_INT:
+                op->arg.asS32 = (s16)(*cmd & 0xFFFF);
+                cmd++;
+                break;
+            case BHV_CMD_OR_INT:
+                op->arg.asS32 = (*cmd & 0xFFFF);
+                cmd++;
+                break;
+            case BHV_CMD_BIT_CLEAR:
+                op->arg.asS32 = ((*cmd & 0xFFFF) ^ 0xFFFF);
+                cmd++;
+                break;
+            case BHV_CMD_SET_FLOAT:
+            case BHV_CMD_ADD_FLOAT:
+                op->arg.asF32 = (s16)(*cmd & 0xFFFF);
+                cmd++;
+                break;
+            case BHV_CMD_ANIMATE_TEXTURE:
+                op->rate = (s16)(*cmd & 0xFFFF);
+                cmd++;
+                break;
+            default:
+                return;
+        }
+
+        if (op->cmd != BHV_CMD_CALL_NATIVE) {
+            loop->onlyNative = FALSE;
+        }
+        op++;
+        numOps++;
+    }
+
+    loop->numOps = numOps;
+    sNumBhvLoopOps += numOps;
+}
+
+/**
+ * Finds the decoded loop starting at start, decoding it if it hasn't been seen yet.
+ * Returns NULL if the table is too full around it.
+ */
+static struct BhvLoop *get_bhv_loop(const BehaviorScript *start) {
+    uintptr_t addr = (uintptr_t) start;
+    s32 hash = ((addr >> 2) ^ (addr >> 10));
+    s32 i;
+
+    if (sLastBhvLoop->start == start) {
+        return sLastBhvLoop;
+    }
+
+    for (i = 0; i < BHV_LOOP_MAX_PROBES; i++) {
+        struct BhvLoop *loop = &sBhvLoops[(hash + i) & (BHV_LOOP_TABLE_SIZE - 1)];
+
+        if (loop->start == NULL) {
+            decode_bhv_loop(loop, start);
+        }
+        if (loop->start == start) {
+            sLastBhvLoop = loop;
+            return loop;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Runs a decoded loop body. Same as running its commands and the END_LOOP through the command table.
+ */
+static void run_bhv_loop(const struct BhvLoop *loop) {
+    const struct BhvLoopOp *op = &sBhvLoopOps[loop->firstOp];
+    const struct BhvLoopOp *end = (op + loop->numOps);
+
+    if (loop->onlyNative) {
+        for (; op < end; op++) {
+            op->arg.func();
+        }
+        return;
+    }
+
+    for (; op < end; op++) {
+        switch (op->cmd) {
+            case BHV_CMD_CALL_NATIVE:     op->arg.func();                                break;
+            case BHV_CMD_SET_INT:         cur_obj_set_int(op->field, op->arg.asS32);     break;
+            case BHV_CMD_ADD_INT:         cur_obj_add_int(op->field, op->arg.asS32);     break;
+            case BHV_CMD_OR_INT:          cur_obj_or_int(op->field, op->arg.asS32);      break;
+            case BHV_CMD_BIT_CLEAR:       cur_obj_and_int(op->field, op->arg.asS32);     break;
+            case BHV_CMD_SET_FLOAT:       cur_obj_set_float(op->field, op->arg.asF32);   break;
+            case BHV_CMD_ADD_FLOAT:       cur_obj_add_float(op->field, op->arg.asF32);   break;
+            case BHV_CMD_ANIMATE_TEXTURE:
+                if ((gGlobalTimer % op->rate) == 0) {
+                    cur_obj_add_int(op->field, 1);
+                }
+                break;
+        }
+    }
+}
+#endif
+
 // Execute the behavior script of the current object, process the object flags, and other miscellaneous code for updating objects.
 void cur_obj_update(void) {
     u32 objFlags = o->oFlags;
@@ -843,6 +1018,18 @@ void cur_obj_update(void) {
     // Execute the behavior script.
     gCurBhvCommand = o->curBhvCommand;
 
+#ifdef BEHAVIOR_SCRIPT_PREDECODE
+    // The END_LOOP at the end of a decoded body jumps back to the address on top of the stack,
+    // so the body can only be run directly if that is where it starts.
+    struct BhvLoop *loop = NULL;
+    if (o->bhvStackIndex != 0 && o->bhvStack[o->bhvStackIndex - 1] == (uintptr_t) gCurBhvCommand) {
+        loop = get_bhv_loop(gCurBhvCommand);
+    }
+
+    if (loop != NULL && loop->numOps != 0) {
+        run_bhv_loop(loop);
+    } else
+#endif
     do {
         bhvCmdProc = BehaviorCmdTable[*gCurBhvCommand >> 24];
         bhvProcResult = bhvCmdProc();
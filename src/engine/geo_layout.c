@@ -43,6 +43,7 @@ GeoLayoutCommandProc GeoLayoutJumpTable[] = {
     /*GEO_CMD_NOP_1F                    */ geo_layout_cmd_nop3,
     /*GEO_CMD_NODE_CULLING_RADIUS       */ geo_layout_cmd_node_culling_radius,
     /*GEO_CMD_NODE_BONE                 */ geo_layout_cmd_bone,
+    /*GEO_CMD_NODE_ROOMS                */ geo_layout_cmd_node_rooms,
 };
 
 struct GraphNode gObjParentGraphNode;
@@ -775,6 +776,20 @@ void geo_layout_cmd_bone(void) {
     gGeoLayoutCommand = (u8 *) cmdPos;
 }
 
+/*
+  0x22: Create a rooms scene graph node (GraphNodeRooms).
+   cmd+0x02: s16 numRooms
+   cmd+0x04: const RoomVisibility *visibility
+*/
+void geo_layout_cmd_node_rooms(void) {
+    struct GraphNodeRooms *graphNode =
+        init_graph_node_rooms(gGraphNodePool, NULL, cur_geo_cmd_s16(0x02), cur_geo_cmd_ptr(0x04));
+
+    register_scene_graph_node(&graphNode->node);
+
+    gGeoLayoutCommand += 0x08 << CMD_SIZE_SHIFT;
+}
+
 struct GraphNode *process_geo_layout(struct AllocOnlyPool *pool, void *segptr) {
     // set by register_scene_graph_node when gCurGraphNodeIndex is 0
     // and gCurRootGraphNode is NULL
@@ -83,6 +83,7 @@ void geo_layout_cmd_copy_view(void);
 void geo_layout_cmd_node_held_obj(void);
 void geo_layout_cmd_node_culling_radius(void);
 void geo_layout_cmd_bone(void);
+void geo_layout_cmd_node_rooms(void);
 
 struct GraphNode *process_geo_layout(struct AllocOnlyPool *pool, void *segptr);
 
@@ -335,6 +335,25 @@ struct GraphNodeCullingRadius *init_graph_node_culling_radius(struct AllocOnlyPo
     return graphNode;
 }
 
+/**
+ * Allocates and returns a newly created rooms node
+ */
+struct GraphNodeRooms *init_graph_node_rooms(struct AllocOnlyPool *pool,
+                                             struct GraphNodeRooms *graphNode,
+                                             s16 numRooms, const RoomVisibility *visibility) {
+    if (pool != NULL) {
+        graphNode = alloc_only_pool_alloc(pool, sizeof(struct GraphNodeRooms));
+    }
+
+    if (graphNode != NULL) {
+        init_scene_graph_node_links(&graphNode->node, GRAPH_NODE_TYPE_ROOMS);
+        graphNode->numRooms = numRooms;
+        graphNode->visibility = visibility;
+    }
+
+    return graphNode;
+}
+
 /**
  * Allocates and returns a newly created animated part node
  */
@@ -399,6 +418,298 @@ struct GraphNodeBillboard *init_graph_node_billboard(struct AllocOnlyPool *pool,
     return graphNode;
 }
 
+#if defined(DISPLAY_LIST_CULLING) || defined(DISPLAY_LIST_INSTANCING)
+/**
+ * Like segmented_to_virtual, but returns NULL for addresses in segments that aren't set yet,
+ * such as ones a geo function sets while rendering.
+ */
+static void *resolve_display_list_address(uintptr_t addr) {
+#ifndef NO_SEGMENTED_MEMORY
+    s32 segment = ((addr >> 24) & 0x0F);
+
+    if ((addr & 0x80000000) == 0 && segment != 0 && get_segment_base_addr(segment) == (void *) 0x80000000) {
+        return NULL;
+    }
+    if ((addr & 0x80000000) == 0) {
+        return segmented_to_virtual((void *) (addr & 0x0FFFFFFF));
+    }
+#endif
+    return (void *) addr;
+}
+#endif
+
+#ifdef DISPLAY_LIST_CULLING
+#define DL_BOUNDS_MAX_DEPTH    10
+#define DL_BOUNDS_MAX_COMMANDS 0x4000
+
+struct DisplayListBounds {
+    Vec3s min;
+    Vec3s max;
+    s32 numVertices;
+    s32 numCommands;
+    s32 unresolved; // Something couldn't be followed, like a segment that isn't loaded yet.
+    s32 hasMatrix;  // The vertices after a G_MTX aren't where the node's own matrix puts them.
+};
+
+/**
+ * Grows bounds by the vertices loaded by a display list and the display lists it calls or branches to.
+ */
+static void add_display_list_bounds(struct DisplayListBounds *bounds, const Gfx *dl, s32 depth) {
+    uintptr_t rdpHalf1 = 0;
+
+    dl = resolve_display_list_address((uintptr_t) dl);
+    if (dl == NULL) {
+        bounds->unresolved = TRUE;
+        return;
+    }
+
+    while (bounds->numCommands++ < DL_BOUNDS_MAX_COMMANDS) {
+        u32 w0 = dl->words.w0;
+        uintptr_t w1 = dl->words.w1;
+
+        switch (w0 >> 24) {
+            case (u8) G_VTX: {
+#ifdef F3DEX_GBI_2
+                s32 numVertices = ((w0 >> 12) & 0xFF);
+#elif defined(F3DEX_GBI)
+                s32 numVertices = ((w0 >> 10) & 0x3F);
+#else
+                s32 numVertices = ((w0 & 0xFFFF) / sizeof(Vtx));
+#endif
+                Vtx *vtx = resolve_display_list_address(w1);
+                s32 i;
+
+                if (vtx == NULL) {
+                    bounds->unresolved = TRUE;
+                    return;
+                }
+
+                for (i = 0; i < numVertices; i++) {
+                    s16 *pos = vtx[i].v.ob;
+                    s32 j;
+
+                    if (bounds->numVertices++ == 0) {
+                        vec3s_copy(bounds->min, pos);
+                        vec3s_copy(bounds->max, pos);
+                    } else {
+                        for (j = 0; j < 3; j++) {
+                            bounds->min[j] = MIN(bounds->min[j], pos[j]);
+                            bounds->max[j] = MAX(bounds->max[j], pos[j]);
+                        }
+                    }
+                }
+                break;
+            }
+            case (u8) G_MTX:
+                bounds->hasMatrix = TRUE;
+                return;
+            case (u8) G_DL:
+                if (depth >= DL_BOUNDS_MAX_DEPTH) {
+                    bounds->unresolved = TRUE;
+                    return;
+                }
+                add_display_list_bounds(bounds, (const Gfx *) w1, depth + 1);
+                if (((w0 >> 16) & 0xFF) == G_DL_NOPUSH) {
+                    return;
+                }
+                break;
+#ifdef F3DEX_GBI_SHARED
+            case (u8) G_RDPHALF_1:
+                rdpHalf1 = w1;
+                break;
+            case (u8) G_BRANCH_Z:
+                // Either branch can be taken depending on the distance.
+                if (depth >= DL_BOUNDS_MAX_DEPTH || rdpHalf1 == 0) {
+                    bounds->unresolved = TRUE;
+                    return;
+                }
+                add_display_list_bounds(bounds, (const Gfx *) rdpHalf1, depth + 1);
+                break;
+#endif
+            case (u8) G_ENDDL:
+                return;
+        }
+
+        dl++;
+    }
+}
+
+static void init_display_list_culling(struct GraphNodeDisplayList *graphNode) {
+    struct DisplayListBounds bounds = { .numVertices = 0, .numCommands = 0, .unresolved = FALSE, .hasMatrix = FALSE };
+    Vec3f halfSize;
+    s32 i;
+
+    graphNode->cullingRadius = 0;
+
+    if (graphNode->displayList == NULL) {
+        return;
+    }
+
+    add_display_list_bounds(&bounds, graphNode->displayList, 0);
+
+    // Leave display lists that couldn't be fully scanned, load their own matrices or don't load vertices uncullable.
+    if (bounds.unresolved || bounds.hasMatrix || bounds.numVertices == 0 || bounds.numCommands > DL_BOUNDS_MAX_COMMANDS) {
+        return;
+    }
+
+    for (i = 0; i < 3; i++) {
+        graphNode->cullingCenter[i] = ((bounds.min[i] + bounds.max[i]) / 2);
+        halfSize[i] = (bounds.max[i] - bounds.min[i]) / 2.0f;
+    }
+
+    // Rounded up, and +1 for the rounding of the center.
+    graphNode->cullingRadius = MIN(vec3_mag(halfSize) + 2.0f, 0xFFFF);
+}
+#endif
+
+#ifdef DISPLAY_LIST_INSTANCING
+#define DL_INSTANCE_MAX_DEPTH    4
+#define DL_INSTANCE_MAX_COMMANDS 128
+
+static Gfx sFlatDisplayList[DL_INSTANCE_MAX_COMMANDS];
+
+/**
+ * Copies the commands a display list runs into sFlatDisplayList, following the display lists it calls
+ * and branches to. Returns the new number of commands, or -1 if the display list can't be instanced.
+ */
+static s32 flatten_display_list(const Gfx *dl, s32 numCommands, s32 depth) {
+    dl = resolve_display_list_address((uintptr_t) dl);
+    if (dl == NULL) {
+        return -1;
+    }
+
+    while (TRUE) {
+        u32 w0 = dl->words.w0;
+
+        switch (w0 >> 24) {
+            case (u8) G_DL:
+                if (depth >= DL_INSTANCE_MAX_DEPTH) {
+                    return -1;
+                }
+                if (((w0 >> 16) & 0xFF) == G_DL_NOPUSH) {
+                    dl = resolve_display_list_address(dl->words.w1);
+                    if (dl == NULL) {
+                        return -1;
+                    }
+                    depth++;
+                    continue;
+                }
+                numCommands = flatten_display_list((const Gfx *) dl->words.w1, numCommands, depth + 1);
+                if (numCommands < 0) {
+                    return -1;
+                }
+                break;
+            case (u8) G_ENDDL:
+                return numCommands;
+            case (u8) G_MOVEWORD:
+#ifdef F3DEX_GBI_2
+                if (((w0 >> 16) & 0xFF) == G_MW_SEGMENT) {
+#else
+                if ((w0 & 0xFF) == G_MW_SEGMENT) {
+#endif
+                    return -1;
+                }
+                // fallthrough
+            default:
+                if (numCommands >= DL_INSTANCE_MAX_COMMANDS) {
+                    return -1;
+                }
+                sFlatDisplayList[numCommands++] = *dl;
+                break;
+            // These depend on where they are in the display list.
+            case (u8) G_MTX:
+            case (u8) G_POPMTX:
+            case (u8) G_CULLDL:
+            case (u8) G_BRANCH_Z:
+            case (u8) G_RDPHALF_1:
+                return -1;
+        }
+
+        dl++;
+    }
+}
+
+static s32 is_geometry_command(u8 cmd) {
+    switch (cmd) {
+        case (u8) G_VTX:
+        case (u8) G_TRI1:
+        case (u8) G_TRI2:
+#ifdef F3DEX_GBI_2
+        case (u8) G_QUAD:
+#endif
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * Display lists that set up a single material, draw their triangles and then reset some state can be
+ * split into those three parts, so the master list can draw every instance of the node with one setup:
+ * setup, then the matrix and geometry of each instance, then the reset. instanceLists holds the three
+ * parts, each ending with G_ENDDL.
+ */
+static void init_display_list_instancing(struct AllocOnlyPool *pool, struct GraphNodeDisplayList *graphNode) {
+    s32 numCommands, firstGeometry, lastGeometry, i;
+    Gfx *lists;
+
+    graphNode->instanceLists = NULL;
+
+    if (pool == NULL || graphNode->displayList == NULL) {
+        return;
+    }
+
+    numCommands = flatten_display_list(graphNode->displayList, 0, 0);
+    if (numCommands < 0) {
+        return;
+    }
+
+    for (firstGeometry = 0; firstGeometry < numCommands; firstGeometry++) {
+        if (is_geometry_command(sFlatDisplayList[firstGeometry].words.w0 >> 24)) {
+            break;
+        }
+    }
+    for (lastGeometry = numCommands - 1; lastGeometry > firstGeometry; lastGeometry--) {
+        if (is_geometry_command(sFlatDisplayList[lastGeometry].words.w0 >> 24)) {
+            break;
+        }
+    }
+
+    // Nothing to share, or nothing to draw.
+    if (firstGeometry == 0 || firstGeometry == numCommands) {
+        return;
+    }
+
+    // Anything else between the triangles, like a second material, would leak into the next instance.
+    for (i = firstGeometry; i <= lastGeometry; i++) {
+        if (!is_geometry_command(sFlatDisplayList[i].words.w0 >> 24)) {
+            return;
+        }
+    }
+
+    lists = alloc_only_pool_alloc(pool, (numCommands + 3) * sizeof(Gfx) + 4);
+    if (lists == NULL) {
+        return;
+    }
+    // Display lists have to be 8 byte aligned, the pool only aligns to 4.
+    lists = (Gfx *) (((uintptr_t) lists + 7) & ~7);
+
+    graphNode->instanceLists = lists;
+    graphNode->instanceBodyOffset = (firstGeometry + 1);
+    graphNode->instanceTailOffset = (lastGeometry + 3);
+
+    for (i = 0; i < numCommands; i++) {
+        if (i == firstGeometry || i == lastGeometry + 1) {
+            gSPEndDisplayList(lists++);
+        }
+        *lists++ = sFlatDisplayList[i];
+    }
+    if (lastGeometry + 1 == numCommands) {
+        gSPEndDisplayList(lists++);
+    }
+    gSPEndDisplayList(lists++);
+}
+#endif
+
 /**
  * Allocates and returns a newly created displaylist node
  */
@@ -413,6 +724,12 @@ struct GraphNodeDisplayList *init_graph_node_display_list(struct AllocOnlyPool *
         init_scene_graph_node_links(&graphNode->node, GRAPH_NODE_TYPE_DISPLAY_LIST);
         SET_GRAPH_NODE_LAYER(graphNode->node.flags, drawingLayer);
         graphNode->displayList = displayList;
+#ifdef DISPLAY_LIST_CULLING
+        init_display_list_culling(graphNode);
+#endif
+#ifdef DISPLAY_LIST_INSTANCING
+        init_display_list_instancing(pool, graphNode);
+#endif
     }
 
     return graphNode;
@@ -801,6 +1118,59 @@ s32 retrieve_animation_index(s32 frame, u16 **attributes) {
     return result;
 }
 
+#ifdef COMPRESSED_ANIMATIONS
+/**
+ * Retrieves a value of an animation with ANIM_FLAG_COMPRESSED, written by tools/anim_compress.py.
+ * The attribute pairs are either a constant with the value in the second s16, raw values like
+ * uncompressed animations, or delta coded values. Delta coded attributes are split into blocks
+ * of ANIM_DELTA_BLOCK_FRAMES frames, each an s16 key value followed by an s8 delta per frame,
+ * two per s16, so at most ANIM_DELTA_BLOCK_FRAMES - 1 deltas are added to get any frame.
+ */
+s16 retrieve_compressed_animation_value(s32 frame, u16 **attributes, const s16 *values) {
+    u16 header = (*attributes)[0];
+    u16 offset = (*attributes)[1];
+
+    *attributes += 2;
+
+    if (header == ANIM_ATTRIBUTE_CONSTANT) {
+        return offset;
+    }
+
+    frame = CLAMP(frame, 0, ANIM_ATTRIBUTE_FRAMES(header) - 1);
+    if (!(header & ANIM_ATTRIBUTE_DELTA)) {
+        return values[offset + frame];
+    }
+
+    s32 shift = ANIM_ATTRIBUTE_SHIFT(header);
+    s32 numDeltas = frame % ANIM_DELTA_BLOCK_FRAMES;
+    const s16 *block = &values[offset + (frame / ANIM_DELTA_BLOCK_FRAMES) * ANIM_DELTA_BLOCK_SIZE];
+    const s16 *deltas = &block[1];
+    s32 value = block[0];
+
+    for (; numDeltas >= 2; numDeltas -= 2) {
+        value += ((*deltas >> 8) + (s8) *deltas) << shift;
+        deltas++;
+    }
+    if (numDeltas != 0) {
+        value += (*deltas >> 8) << shift;
+    }
+
+    return value;
+}
+#endif
+
+/**
+ * Retrieves the value of an attribute at a frame and advances the attribute pointer to the next one.
+ */
+s16 retrieve_animation_value(s32 frame, u16 **attributes, const s16 *values, UNUSED s32 animFlags) {
+#ifdef COMPRESSED_ANIMATIONS
+    if (animFlags & ANIM_FLAG_COMPRESSED) {
+        return retrieve_compressed_animation_value(frame, attributes, values);
+    }
+#endif
+    return values[retrieve_animation_index(frame, attributes)];
+}
+
 /**
  * Update the animation frame of an object. The animation flags determine
  * whether it plays forwards or backwards, and whether it stops or loops at
@@ -876,9 +1246,9 @@ UNUSED void geo_retreive_animation_translation(struct GraphNodeObject *obj, Vec3
             frame = 0;
         }
 
-        position[0] = (f32) values[retrieve_animation_index(frame, &attribute)];
-        position[1] = (f32) values[retrieve_animation_index(frame, &attribute)];
-        position[2] = (f32) values[retrieve_animation_index(frame, &attribute)];
+        position[0] = (f32) retrieve_animation_value(frame, &attribute, values, animation->flags);
+        position[1] = (f32) retrieve_animation_value(frame, &attribute, values, animation->flags);
+        position[2] = (f32) retrieve_animation_value(frame, &attribute, values, animation->flags);
     } else {
         vec3_zero(position);
     }
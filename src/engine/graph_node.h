@@ -74,6 +74,7 @@ enum GraphNodeTypes {
     GRAPH_NODE_TYPE_BACKGROUND,
     GRAPH_NODE_TYPE_HELD_OBJ,
     GRAPH_NODE_TYPE_CULLING_RADIUS,
+    GRAPH_NODE_TYPE_ROOMS,
     GRAPH_NODE_TYPE_ROOT,
     GRAPH_NODE_TYPE_START,
 };
@@ -106,6 +107,7 @@ enum GraphNodeTypes {
     GRAPH_NODE_TYPE_BACKGROUND           = (0x2C | GRAPH_NODE_TYPE_FUNCTIONAL),
     GRAPH_NODE_TYPE_HELD_OBJ             = (0x2E | GRAPH_NODE_TYPE_FUNCTIONAL),
     GRAPH_NODE_TYPE_CULLING_RADIUS       =  0x2F,
+    GRAPH_NODE_TYPE_ROOMS                =  0x30,
 
     GRAPH_NODE_TYPES_MASK                =  0xFF,
 };
@@ -181,6 +183,18 @@ struct DisplayListNode {
     struct DisplayListNode *next;
 };
 
+#ifdef DISPLAY_LIST_INSTANCING
+/** Every instance of a display list node drawn on one layer of the master list.
+ */
+struct DisplayListInstances {
+    struct GraphNodeDisplayList *model;
+    struct DisplayListNode *head;
+    struct DisplayListNode *tail;
+    s32 count;
+    struct DisplayListInstances *next;
+};
+#endif
+
 /** GraphNode that manages the 8 top-level display lists that will be drawn
  *  Each list has its own render mode, so for example water is drawn in a
  *  different master list than opaque objects.
@@ -190,6 +204,9 @@ struct GraphNodeMasterList {
     /*0x00*/ struct GraphNode node;
     /*0x14*/ struct DisplayListNode *listHeads[GRAPH_NODE_NUM_UCODES][LAYER_COUNT];
     /*0x34*/ struct DisplayListNode *listTails[GRAPH_NODE_NUM_UCODES][LAYER_COUNT];
+#ifdef DISPLAY_LIST_INSTANCING
+    struct DisplayListInstances *instanceHeads[GRAPH_NODE_NUM_UCODES][LAYER_COUNT];
+#endif
 };
 
 /** Simply used as a parent to group multiple children.
@@ -317,6 +334,15 @@ struct GraphNodeBillboard {
 struct GraphNodeDisplayList {
     /*0x00*/ struct GraphNode node;
     /*0x14*/ void *displayList;
+#ifdef DISPLAY_LIST_CULLING
+    /*0x18*/ Vec3s cullingCenter;
+    /*0x1E*/ u16 cullingRadius; // 0 if the display list has no vertices, which is never culled.
+#endif
+#ifdef DISPLAY_LIST_INSTANCING
+    Gfx *instanceLists; // Setup, geometry and reset parts of the display list, NULL if it can't be split.
+    u8 instanceBodyOffset;
+    u8 instanceTailOffset;
+#endif
 };
 
 /** GraphNode part that scales itself and its children.
@@ -395,6 +421,21 @@ struct GraphNodeCullingRadius {
     // u8 filler[2];
 };
 
+// Number of words in a row of a GraphNodeRooms visibility table.
+#define ROOM_VISIBILITY_WORDS(numRooms) (((numRooms) + 31) / 32)
+
+/** GraphNode that only renders the children that can be seen from the rooms Mario
+ *  and the camera are in. Child i is the geometry of room i + 1. The visibility
+ *  table has a row of ROOM_VISIBILITY_WORDS(numRooms) words per room, with bit
+ *  (j - 1) set if room j can be seen from it.
+ */
+struct GraphNodeRooms {
+    /*0x00*/ struct GraphNode node;
+    /*0x14*/ const RoomVisibility *visibility; // segmented address
+    /*0x18*/ s16 numRooms;
+    // u8 filler[2];
+};
+
 extern struct GraphNodeMasterList  *gCurGraphNodeMasterList;
 extern struct GraphNodePerspective *gCurGraphNodeCamFrustum;
 extern struct GraphNodeCamera      *gCurGraphNodeCamera;
@@ -422,6 +463,7 @@ struct GraphNodeRotation            *init_graph_node_rotation            (struct
 struct GraphNodeScale               *init_graph_node_scale               (struct AllocOnlyPool *pool, struct GraphNodeScale               *graphNode, s32 drawingLayer, void *displayList, f32 scale);
 struct GraphNodeObject              *init_graph_node_object              (struct AllocOnlyPool *pool, struct GraphNodeObject              *graphNode, struct GraphNode *sharedChild, Vec3f pos, Vec3s angle, Vec3f scale);
 struct GraphNodeCullingRadius       *init_graph_node_culling_radius      (struct AllocOnlyPool *pool, struct GraphNodeCullingRadius       *graphNode, s16 radius);
+struct GraphNodeRooms               *init_graph_node_rooms               (struct AllocOnlyPool *pool, struct GraphNodeRooms               *graphNode, s16 numRooms, const RoomVisibility *visibility);
 struct GraphNodeAnimatedPart        *init_graph_node_animated_part       (struct AllocOnlyPool *pool, struct GraphNodeAnimatedPart        *graphNode, s32 drawingLayer, void *displayList, Vec3s translation);
 struct GraphNodeBone                *init_graph_node_bone                (struct AllocOnlyPool *pool, struct GraphNodeBone                *graphNode, s32 drawingLayer, void *displayList, Vec3s translation, Vec3s rotation);
 struct GraphNodeBillboard           *init_graph_node_billboard           (struct AllocOnlyPool *pool, struct GraphNodeBillboard           *graphNode, s32 drawingLayer, void *displayList, Vec3s translation);
@@ -446,6 +488,10 @@ void geo_obj_init_animation(struct GraphNodeObject *graphNode, struct Animation
 void geo_obj_init_animation_accel(struct GraphNodeObject *graphNode, struct Animation **animPtrAddr, u32 animAccel);
 
 s32  retrieve_animation_index(s32 frame, u16 **attributes);
+#ifdef COMPRESSED_ANIMATIONS
+s16  retrieve_compressed_animation_value(s32 frame, u16 **attributes, const s16 *values);
+#endif
+s16  retrieve_animation_value(s32 frame, u16 **attributes, const s16 *values, s32 animFlags);
 
 s32  geo_update_animation_frame(struct AnimInfo *obj, s32 *accelAssist);
 void geo_retreive_animation_translation(struct GraphNodeObject *obj, Vec3f position);
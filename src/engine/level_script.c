@@ -28,6 +28,7 @@
 #include "game/puppycam2.h"
 #include "game/puppyprint.h"
 #include "game/puppylights.h"
+#include "game/rendering_graph_node.h"
 
 #include "config.h"
 
@@ -359,6 +360,9 @@ static void level_cmd_clear_level(void) {
     clear_objects();
     clear_area_graph_nodes();
     clear_areas();
+#ifdef FLAT_GEO_LAYOUTS
+    geo_clear_flat_layouts();
+#endif
     main_pool_pop_state();
     unmap_tlbs();
 
@@ -369,6 +373,10 @@ static void level_cmd_alloc_level_pool(void) {
     if (sLevelPool == NULL) {
         sLevelPool = alloc_only_pool_init(main_pool_available() - sizeof(struct AllocOnlyPool),
                                           MEMORY_POOL_LEFT);
+#ifdef FLAT_GEO_LAYOUTS
+        // Layouts flattened into the previous level pool are gone.
+        geo_clear_flat_layouts();
+#endif
     }
 
     sCurrentCmd = CMD_NEXT;
@@ -399,6 +407,10 @@ static void level_cmd_begin_area(void) {
             (struct GraphNodeRoot *) process_geo_layout(sLevelPool, geoLayoutAddr);
         struct GraphNodeCamera *node = (struct GraphNodeCamera *) screenArea->views[0];
 
+#ifdef FLAT_GEO_LAYOUTS
+        geo_flatten_layout(sLevelPool, &screenArea->node);
+#endif
+
         sCurrAreaIndex = areaIndex;
         screenArea->areaIndex = areaIndex;
         gAreas[areaIndex].graphNode = screenArea;
@@ -437,6 +449,9 @@ static void level_cmd_load_model_from_geo(void) {
 
     if (model < MODEL_ID_COUNT) {
         gLoadedGraphNodes[model] = process_geo_layout(sLevelPool, geo);
+#ifdef FLAT_GEO_LAYOUTS
+        geo_flatten_layout(sLevelPool, gLoadedGraphNodes[model]);
+#endif
     }
 
     sCurrentCmd = CMD_NEXT;
@@ -645,6 +660,8 @@ static void level_cmd_set_terrain_data(void) {
         gAreas[sCurrAreaIndex].terrainData = alloc_only_pool_alloc(sLevelPool, size);
         memcpy(gAreas[sCurrAreaIndex].terrainData, data, size);
 #endif
+        // TERRAIN_BAKED adds a pointer to the area's baked collision.
+        gAreas[sCurrAreaIndex].bakedTerrain = (sCurrentCmd->size >= 0x0C) ? segmented_to_virtual(CMD_GET(void *, 8)) : NULL;
     }
     sCurrentCmd = CMD_NEXT;
 }
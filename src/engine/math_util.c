@@ -647,22 +647,22 @@ void mtxf_align_terrain_normal(Mat4 dest, Vec3f upDir, Vec3f pos, s32 yaw) {
  * 'radius' is the distance from each triangle vertex to the center
  */
 void mtxf_align_terrain_triangle(Mat4 mtx, Vec3f pos, s32 yaw, f32 radius) {
-    struct Surface *floor;
+    struct FloorResult floors[3];
+    Vec3f points[3];
     Vec3f point0, point1, point2;
     Vec3f forward;
     Vec3f xColumn, yColumn, zColumn;
     f32 minY   = (-radius * 3);
     f32 height = (pos[1] + 150);
 
-    point0[0] = (pos[0] + (radius * sins(yaw + DEGREES( 60))));
-    point0[2] = (pos[2] + (radius * coss(yaw + DEGREES( 60))));
-    point0[1] = find_floor(point0[0], height, point0[2], &floor);
-    point1[0] = (pos[0] + (radius * sins(yaw + DEGREES(180))));
-    point1[2] = (pos[2] + (radius * coss(yaw + DEGREES(180))));
-    point1[1] = find_floor(point1[0], height, point1[2], &floor);
-    point2[0] = (pos[0] + (radius * sins(yaw + DEGREES(-60))));
-    point2[2] = (pos[2] + (radius * coss(yaw + DEGREES(-60))));
-    point2[1] = find_floor(point2[0], height, point2[2], &floor);
+    vec3f_set(points[0], (pos[0] + (radius * sins(yaw + DEGREES( 60)))), height, (pos[2] + (radius * coss(yaw + DEGREES( 60)))));
+    vec3f_set(points[1], (pos[0] + (radius * sins(yaw + DEGREES(180)))), height, (pos[2] + (radius * coss(yaw + DEGREES(180)))));
+    vec3f_set(points[2], (pos[0] + (radius * sins(yaw + DEGREES(-60)))), height, (pos[2] + (radius * coss(yaw + DEGREES(-60)))));
+    find_floors_batch(points, 3, floors);
+
+    vec3f_set(point0, points[0][0], floors[0].height, points[0][2]);
+    vec3f_set(point1, points[1][0], floors[1].height, points[1][2]);
+    vec3f_set(point2, points[2][0], floors[2].height, points[2][2]);
 
     if ((point0[1] - pos[1]) < minY) point0[1] = pos[1];
     if ((point1[1] - pos[1]) < minY) point1[1] = pos[1];
@@ -1487,6 +1487,7 @@ void find_surface_on_ray(Vec3f orig, Vec3f dir, struct Surface **hit_surface, Ve
 
 // Constructs a float in registers, which can be faster than gcc's default of loading a float from rodata.
 // Especially fast for halfword floats, which get loaded with a `lui` + `mtc1`.
+#ifdef TARGET_N64
 static ALWAYS_INLINE float construct_float(const float f)
 {
     u32 r;
@@ -1523,6 +1524,9 @@ static ALWAYS_INLINE float construct_float(const float f)
                          : "r"(r));
     return f_out;
 }
+#else
+#define construct_float(f) (f)
+#endif
 
 // Converts a floating point matrix to a fixed point matrix
 // Makes some assumptions about certain fields in the matrix, which will always be true for valid matrices.
@@ -1564,3 +1568,34 @@ void mtxf_to_mtx_fast(s16* dst, float* src)
     //  to set the top half.
     dst[15] = 1;
 }
+
+/**
+ * Converts a batch of matrices the same way as mtxf_to_mtx_fast, but in place: each Mtx holds the
+ * float matrix it is converted from, which is the same size. Converting them all in one loop keeps
+ * the loop in the instruction cache instead of evicting the scene graph code once per matrix.
+ * The N64 has no paired single instructions, so this is a plain FPU loop. All twelve values that
+ * aren't always 0 or 1 are converted before anything is written back over them.
+ */
+void mtxf_to_mtx_batch(Mtx **mtxs, s32 count) {
+    float scale = construct_float(65536.0f / WORLD_SCALE);
+    s32 fixed[12];
+    s32 i;
+
+    while (count-- > 0) {
+        s16 *dst = (s16 *) *mtxs++;
+        float *src = (float *) dst;
+
+        // Row r, column c of the first three columns is src[r * 4 + c], or i + i / 3.
+        for (i = 0; i < 12; i++) {
+            fixed[i] = (s32)(src[i + i / 3] * scale);
+        }
+        for (i = 0; i < 12; i++) {
+            dst[i + i / 3 +  0] = (s16)(fixed[i] >> 16);
+            dst[i + i / 3 + 16] = (s16)(fixed[i] >>  0);
+        }
+
+        // Column 4, 1.0 at the bottom.
+        dst[ 3] = 0; dst[ 7] = 0; dst[11] = 0; dst[15] = 1;
+        dst[19] = 0; dst[23] = 0; dst[27] = 0; dst[31] = 0;
+    }
+}
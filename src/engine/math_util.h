@@ -453,20 +453,28 @@ extern f32 gSineTable[];
 
 /// From Wiseguy
 ALWAYS_INLINE s32 roundf(f32 in) {
+#ifdef TARGET_N64
     f32 tmp;
     s32 out;
     __asm__("round.w.s %0,%1" : "=f" (tmp) : "f" (in ));
     __asm__("mfc1      %0,%1" : "=r" (out) : "f" (tmp));
     return out;
+#else
+    return __builtin_lrintf(in);
+#endif
 }
 // backwards compatibility
 #define round_float(in) roundf(in)
 
 /// Absolute value
 ALWAYS_INLINE f32 absf(f32 in) {
+#ifdef TARGET_N64
     f32 out;
     __asm__("abs.s %0,%1" : "=f" (out) : "f" (in));
     return out;
+#else
+    return __builtin_fabsf(in);
+#endif
 }
 ALWAYS_INLINE s32 absi(s32 in) {
     return ABS(in);
@@ -556,6 +564,7 @@ ALWAYS_INLINE void mtxf_to_mtx(register void *dest, register void *src) {
     mtxf_to_mtx_fast((s16*)dest, (float*)src);
     // guMtxF2L(src, dest);
 }
+void mtxf_to_mtx_batch(Mtx **mtxs, s32 count);
 
 void mtxf_rotate_xy(Mtx *mtx, s32 angle);
 void linear_mtxf_mul_vec3f(Mat4 m, Vec3f dst, Vec3f v);
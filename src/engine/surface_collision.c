@@ -10,6 +10,80 @@
 #include "surface_load.h"
 #include "game/puppyprint.h"
 
+/**************************************************
+ *                 STATIC PARTITION               *
+ **************************************************/
+
+#ifdef STATIC_SURFACE_TREE
+/**
+ * Descends a static cell's quadtree to the leaf containing a position.
+ */
+static struct SurfaceTreeNode *find_static_surface_tree_leaf(s32 rootIndex, s32 x, s32 z) {
+    struct SurfaceTreeNode *node = &sSurfaceTreeNodePool[rootIndex];
+    // Position within the cell.
+    s32 localX = ((x + LEVEL_BOUNDARY_MAX) & (CELL_SIZE - 1));
+    s32 localZ = ((z + LEVEL_BOUNDARY_MAX) & (CELL_SIZE - 1));
+    s32 half = (CELL_SIZE >> 1);
+
+    while (node->children != 0) {
+        s32 child = 0;
+
+        if (localX >= half) {
+            localX -= half;
+            child |= 1;
+        }
+        if (localZ >= half) {
+            localZ -= half;
+            child |= 2;
+        }
+
+        node = &sSurfaceTreeNodePool[node->children + child];
+        half >>= 1;
+    }
+
+    return node;
+}
+#endif
+
+/**
+ * Returns the static surface list to check for a position. Cells with a lot of floors
+ * or ceilings are split into a quadtree when the area is loaded, in which case only
+ * the list of the leaf containing the position is returned.
+ */
+struct SurfaceNode *get_static_surface_list(s32 x, s32 z, s32 listIndex) {
+    s32 cellX = GET_CELL_COORD(x);
+    s32 cellZ = GET_CELL_COORD(z);
+
+#ifdef STATIC_SURFACE_TREE
+    if (listIndex < NUM_SURFACE_TREE_PARTITIONS && gStaticSurfaceTreeRoots[cellZ][cellX][listIndex] != 0) {
+        return find_static_surface_tree_leaf(gStaticSurfaceTreeRoots[cellZ][cellX][listIndex], x, z)->list;
+    }
+#endif
+
+    return gStaticSurfacePartition[cellZ][cellX][listIndex].next;
+}
+
+#ifdef PACKED_STATIC_SURFACES
+#define get_plane_height_at_location(xPos, zPos, plane) (-(((xPos) * (plane)[0]) + ((zPos) * (plane)[2]) + (plane)[3]) / (plane)[1])
+
+/**
+ * Returns the packed range of static surfaces to check for a position, holding the same
+ * surfaces in the same order as get_static_surface_list. Only valid if gStaticSurfacesPacked is set.
+ */
+static struct PackedSurfaceRange *get_static_surface_range(s32 x, s32 z, s32 listIndex) {
+    s32 cellX = GET_CELL_COORD(x);
+    s32 cellZ = GET_CELL_COORD(z);
+
+#ifdef STATIC_SURFACE_TREE
+    if (listIndex < NUM_SURFACE_TREE_PARTITIONS && gStaticSurfaceTreeRoots[cellZ][cellX][listIndex] != 0) {
+        return &find_static_surface_tree_leaf(gStaticSurfaceTreeRoots[cellZ][cellX][listIndex], x, z)->packed;
+    }
+#endif
+
+    return &gStaticPackedRanges[cellZ][cellX][listIndex];
+}
+#endif
+
 /**************************************************
  *                      WALLS                     *
  **************************************************/
@@ -21,29 +95,105 @@
         d00 = (((vert)[0] * v) - v2[0]);        \
         d01 = (((vert)[2] * v) - v2[2]);        \
         invDenom = sqrtf(sqr(d00) + sqr(d01));  \
-        offset   = (invDenom - margin_radius);  \
+        offset   = (invDenom - *margin_radius); \
         if (offset > 0.0f) next_step;           \
         goto check_collision;                   \
     }                                           \
     next_step;                                  \
 }
 
+/**
+ * Checks a single wall against a position and gives its wall push.
+ * Returns whether the wall collided with the position.
+ */
+static ALWAYS_INLINE s32 check_wall_collision(Vec3f pos, f32 radius, f32 *margin_radius, TerrainData type, s8 flags,
+                                              f32 nx, f32 ny, f32 nz, f32 originOffset,
+                                              Vec3t vertex1, Vec3t vertex2, Vec3t vertex3) {
+    const f32 corner_threshold = -0.9f;
+    register f32 offset;
+    Vec3f v0, v1, v2;
+    register f32 d00, d01, d11, d20, d21;
+    register f32 invDenom;
+    register f32 v, w;
+
+    // Determine if checking for the camera or not.
+    if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+        if (flags & SURFACE_FLAG_NO_CAM_COLLISION) return FALSE;
+    } else {
+        // Ignore camera only surfaces.
+        if (type == SURFACE_CAMERA_BOUNDARY) return FALSE;
+
+        // If an object can pass through a vanish cap wall, pass through.
+        if (type == SURFACE_VANISH_CAP_WALLS && o != NULL) {
+            // If an object can pass through a vanish cap wall, pass through.
+            if (o->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE) return FALSE;
+            // If Mario has a vanish cap, pass through the vanish cap wall.
+            if (o == gMarioObject && gMarioState->flags & MARIO_VANISH_CAP) return FALSE;
+        }
+    }
+
+    // Dot of normal and pos, + origin offset
+    offset = (nx * pos[0]) + (ny * pos[1]) + (nz * pos[2]) + originOffset;
+
+    // Exclude surfaces outside of the radius.
+    if (offset < -radius || offset > radius) return FALSE;
+
+    vec3_diff(v0, vertex2, vertex1);
+    vec3_diff(v1, vertex3, vertex1);
+    vec3_diff(v2, pos,     vertex1);
+
+    // Face
+    d00 = vec3_dot(v0, v0);
+    d01 = vec3_dot(v0, v1);
+    d11 = vec3_dot(v1, v1);
+    d20 = vec3_dot(v2, v0);
+    d21 = vec3_dot(v2, v1);
+
+    invDenom = (d00 * d11) - (d01 * d01);
+    if (FLT_IS_NONZERO(invDenom)) invDenom = 1.0f / invDenom;
+
+    v = ((d11 * d20) - (d01 * d21)) * invDenom;
+    if (v < 0.0f || v > 1.0f) goto edge_1_2;
+
+    w = ((d00 * d21) - (d01 * d20)) * invDenom;
+    if (w < 0.0f || w > 1.0f || v + w > 1.0f) goto edge_1_2;
+
+    pos[0] += nx * (radius - offset);
+    pos[2] += nz * (radius - offset);
+    return TRUE;
+
+edge_1_2:
+    if (offset < 0) return FALSE;
+    CALC_OFFSET(v0, goto edge_1_3);
+
+edge_1_3:
+    CALC_OFFSET(v1, goto edge_2_3);
+
+edge_2_3:
+    vec3_diff(v1, vertex3, vertex2);
+    vec3_diff(v2, pos, vertex2);
+    CALC_OFFSET(v1, return FALSE);
+
+check_collision:
+    if (FLT_IS_NONZERO(invDenom)) invDenom = (offset / invDenom);
+    pos[0] += (d00 *= invDenom);
+    pos[2] += (d01 *= invDenom);
+    *margin_radius += 0.01f;
+    if ((d00 * nx) + (d01 * nz) < (corner_threshold * offset)) return FALSE;
+
+    return TRUE;
+}
+#undef CALC_OFFSET
+
 /**
  * Iterate through the list of walls until all walls are checked and
  * have given their wall push.
  */
 static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struct WallCollisionData *data) {
-    const f32 corner_threshold = -0.9f;
     register struct Surface *surf;
-    register f32 offset;
     register f32 radius = data->radius;
 
     Vec3f pos = { data->x, data->y + data->offsetY, data->z };
-    Vec3f v0, v1, v2;
-    register f32 d00, d01, d11, d20, d21;
-    register f32 invDenom;
-    register f32 v, w;
-    register TerrainData type = SURFACE_DEFAULT;
     s32 numCols = 0;
 
     // Max collision radius = 200
@@ -57,79 +207,66 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
     while (surfaceNode != NULL) {
         surf        = surfaceNode->surface;
         surfaceNode = surfaceNode->next;
-        type        = surf->type;
 
         // Exclude a large number of walls immediately to optimize.
         if (pos[1] < surf->lowerY || pos[1] > surf->upperY) continue;
 
-        // Determine if checking for the camera or not.
-        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
-            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) continue;
-        } else {
-            // Ignore camera only surfaces.
-            if (type == SURFACE_CAMERA_BOUNDARY) continue;
-
-            // If an object can pass through a vanish cap wall, pass through.
-            if (type == SURFACE_VANISH_CAP_WALLS && o != NULL) {
-                // If an object can pass through a vanish cap wall, pass through.
-                if (o->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE) continue;
-                // If Mario has a vanish cap, pass through the vanish cap wall.
-                if (o == gMarioObject && gMarioState->flags & MARIO_VANISH_CAP) continue;
-            }
+        if (!check_wall_collision(pos, radius, &margin_radius, surf->type, surf->flags,
+                                  surf->normal.x, surf->normal.y, surf->normal.z, surf->originOffset,
+                                  surf->vertex1, surf->vertex2, surf->vertex3)) {
+            continue;
         }
 
-        // Dot of normal and pos, + origin offset
-        offset = (surf->normal.x * pos[0]) + (surf->normal.y * pos[1]) + (surf->normal.z * pos[2]) + surf->originOffset;
-
-        // Exclude surfaces outside of the radius.
-        if (offset < -radius || offset > radius) continue;
-    
-        vec3_diff(v0, surf->vertex2, surf->vertex1);
-        vec3_diff(v1, surf->vertex3, surf->vertex1);
-        vec3_diff(v2, pos,           surf->vertex1);
-
-        // Face
-        d00 = vec3_dot(v0, v0);
-        d01 = vec3_dot(v0, v1);
-        d11 = vec3_dot(v1, v1);
-        d20 = vec3_dot(v2, v0);
-        d21 = vec3_dot(v2, v1);
+        if (data->numWalls < MAX_REFERENCED_WALLS) {
+            data->walls[data->numWalls++] = surf;
+        }
+        numCols++;
 
-        invDenom = (d00 * d11) - (d01 * d01);
-        if (FLT_IS_NONZERO(invDenom)) invDenom = 1.0f / invDenom;
+        if (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST) {
+            break;
+        }
+    }
+    data->x = pos[0];
+    data->z = pos[2];
+    return numCols;
+}
 
-        v = ((d11 * d20) - (d01 * d21)) * invDenom;
-        if (v < 0.0f || v > 1.0f) goto edge_1_2;
+#ifdef PACKED_STATIC_SURFACES
+/**
+ * find_wall_collisions_from_list for a packed range of static walls.
+ */
+static s32 find_wall_collisions_from_packed(struct PackedSurfaceRange *range, struct WallCollisionData *data) {
+    register s32 entry = range->start;
+    register s32 end = (entry + range->count);
+    register s32 i;
+    register f32 radius = data->radius;
 
-        w = ((d00 * d21) - (d01 * d20)) * invDenom;
-        if (w < 0.0f || w > 1.0f || v + w > 1.0f) goto edge_1_2;
+    Vec3f pos = { data->x, data->y + data->offsetY, data->z };
+    s32 numCols = 0;
 
-        pos[0] += surf->normal.x * (radius - offset);
-        pos[2] += surf->normal.z * (radius - offset);
-        goto hasCollision;
+    // Max collision radius = 200
+    if (radius > 200) {
+        radius = 200;
+    }
 
-    edge_1_2:
-        if (offset < 0) continue;
-        CALC_OFFSET(v0, goto edge_1_3);
+    f32 margin_radius = radius - 1.0f;
 
-    edge_1_3:
-        CALC_OFFSET(v1, goto edge_2_3);
+    for (; entry < end; entry++) {
+        // Exclude a large number of walls immediately to optimize.
+        if (pos[1] < gPackedSurfaces.bounds[entry][0] || pos[1] > gPackedSurfaces.bounds[entry][1]) continue;
 
-    edge_2_3:
-        vec3_diff(v1, surf->vertex3, surf->vertex2);
-        vec3_diff(v2, pos, surf->vertex2);
-        CALC_OFFSET(v1, continue);
+        i = gPackedSurfaces.surfaces[entry];
+        f32 *plane = gPackedSurfaces.plane[i];
+        Vec3t *vertices = gPackedSurfaces.vertices[i];
 
-    check_collision:
-        if (FLT_IS_NONZERO(invDenom)) invDenom = (offset / invDenom);
-        pos[0] += (d00 *= invDenom);
-        pos[2] += (d01 *= invDenom);
-        margin_radius += 0.01f;
-        if ((d00 * surf->normal.x) + (d01 * surf->normal.z) < (corner_threshold * offset)) continue;
+        if (!check_wall_collision(pos, radius, &margin_radius, gPackedSurfaces.type[i], gPackedSurfaces.flags[i],
+                                  plane[0], plane[1], plane[2], plane[3],
+                                  vertices[0], vertices[1], vertices[2])) {
+            continue;
+        }
 
-    hasCollision:
         if (data->numWalls < MAX_REFERENCED_WALLS) {
-            data->walls[data->numWalls++] = surf;
+            data->walls[data->numWalls++] = &sSurfacePool[i];
         }
         numCols++;
 
@@ -141,7 +278,7 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
     data->z = pos[2];
     return numCols;
 }
-#undef CALC_OFFSET
+#endif
 
 /**
  * Formats the position and wall search for find_wall_collisions.
@@ -193,8 +330,15 @@ s32 find_wall_collisions(struct WallCollisionData *colData) {
     }
 
     // Check for surfaces that are a part of level geometry.
-    node = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS].next;
-    numCollisions += find_wall_collisions_from_list(node, colData);
+#ifdef PACKED_STATIC_SURFACES
+    if (gStaticSurfacesPacked) {
+        numCollisions += find_wall_collisions_from_packed(get_static_surface_range(x, z, SPATIAL_PARTITION_WALLS), colData);
+    } else
+#endif
+    {
+        node = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS].next;
+        numCollisions += find_wall_collisions_from_list(node, colData);
+    }
 
     gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
 #ifdef VANILLA_DEBUG
@@ -235,24 +379,24 @@ void add_ceil_margin(s32 *x, s32 *z, Vec3s target1, Vec3s target2, f32 margin) {
     *z += diff_z * invDenom;
 }
 
-static s32 check_within_ceil_triangle_bounds(s32 x, s32 z, struct Surface *surf, f32 margin) {
-    s32 addMargin = surf->type != SURFACE_HANGABLE && !FLT_IS_NONZERO(margin);
+static s32 check_within_ceil_triangle_bounds(s32 x, s32 z, Vec3t vertex1, Vec3t vertex2, Vec3t vertex3, TerrainData type, f32 margin) {
+    s32 addMargin = type != SURFACE_HANGABLE && !FLT_IS_NONZERO(margin);
     Vec3i vx, vz;
-    vx[0] = surf->vertex1[0];
-    vz[0] = surf->vertex1[2];
-    if (addMargin) add_ceil_margin(&vx[0], &vz[0], surf->vertex2, surf->vertex3, margin);
+    vx[0] = vertex1[0];
+    vz[0] = vertex1[2];
+    if (addMargin) add_ceil_margin(&vx[0], &vz[0], vertex2, vertex3, margin);
 
-    vx[1] = surf->vertex2[0];
-    vz[1] = surf->vertex2[2];
-    if (addMargin) add_ceil_margin(&vx[1], &vz[1], surf->vertex3, surf->vertex1, margin);
+    vx[1] = vertex2[0];
+    vz[1] = vertex2[2];
+    if (addMargin) add_ceil_margin(&vx[1], &vz[1], vertex3, vertex1, margin);
 
     // Checking if point is in bounds of the triangle laterally.
     if (((vz[0] - z) * (vx[1] - vx[0]) - (vx[0] - x) * (vz[1] - vz[0])) > 0) return FALSE;
 
     // Slight optimization by checking these later.
-    vx[2] = surf->vertex3[0];
-    vz[2] = surf->vertex3[2];
-    if (addMargin) add_ceil_margin(&vx[2], &vz[2], surf->vertex1, surf->vertex2, margin);
+    vx[2] = vertex3[0];
+    vz[2] = vertex3[2];
+    if (addMargin) add_ceil_margin(&vx[2], &vz[2], vertex1, vertex2, margin);
 
     if (((vz[1] - z) * (vx[2] - vx[1]) - (vx[1] - x) * (vz[2] - vz[1])) > 0) return FALSE;
     if (((vz[2] - z) * (vx[0] - vx[2]) - (vx[2] - x) * (vz[0] - vz[2])) > 0) return FALSE;
@@ -288,7 +432,7 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
         }
 
         // Check that the point is within the triangle bounds
-        if (!check_within_ceil_triangle_bounds(x, z, surf, 1.5f)) continue;
+        if (!check_within_ceil_triangle_bounds(x, z, surf->vertex1, surf->vertex2, surf->vertex3, type, 1.5f)) continue;
 
         // Find the height of the ceil at the given location
         height = get_surface_height_at_location(x, z, surf);
@@ -311,6 +455,62 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
     return ceil;
 }
 
+#ifdef PACKED_STATIC_SURFACES
+/**
+ * find_ceil_from_list for a packed range of static ceilings.
+ */
+static struct Surface *find_ceil_from_packed(struct PackedSurfaceRange *range, s32 x, s32 y, s32 z, f32 *pheight) {
+    register s32 entry = range->start;
+    register s32 end = (entry + range->count);
+    register s32 i;
+    register f32 height;
+    struct Surface *ceil = NULL;
+    SurfaceType type = SURFACE_DEFAULT;
+    *pheight = CELL_HEIGHT_LIMIT;
+
+    for (; entry < end; entry++) {
+        // Exclude all ceilings below the point
+        if (y > gPackedSurfaces.bounds[entry][1]) continue;
+
+        i = gPackedSurfaces.surfaces[entry];
+        type = gPackedSurfaces.type[i];
+
+        // Determine if checking for the camera or not
+        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+            if (gPackedSurfaces.flags[i] & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        } else if (type == SURFACE_CAMERA_BOUNDARY) {
+            // Ignore camera only surfaces
+            continue;
+        }
+
+        Vec3t *vertices = gPackedSurfaces.vertices[i];
+
+        // Check that the point is within the triangle bounds
+        if (!check_within_ceil_triangle_bounds(x, z, vertices[0], vertices[1], vertices[2], type, 1.5f)) continue;
+
+        // Find the height of the ceil at the given location
+        height = get_plane_height_at_location(x, z, gPackedSurfaces.plane[i]);
+
+        // Exclude ceilings above the previous lowest ceiling
+        if (height > *pheight) continue;
+
+        // Checks for ceiling interaction
+        if (y > height) continue;
+
+        // Use the current ceiling
+        *pheight = height;
+        ceil = &sSurfacePool[i];
+
+        // Exit the loop if it's not possible for another ceiling to be closer
+        // to the original point, or if COLLISION_FLAG_RETURN_FIRST.
+        if (height == y || (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST)) break;
+    }
+    return ceil;
+}
+#endif
+
 /**
  * Find the lowest ceiling above a given position and return the height.
  */
@@ -346,8 +546,15 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
     }
 
     // Check for surfaces that are a part of level geometry.
-    surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS].next;
-    ceil = find_ceil_from_list(surfaceList, x, y, z, &height);
+#ifdef PACKED_STATIC_SURFACES
+    if (gStaticSurfacesPacked) {
+        ceil = find_ceil_from_packed(get_static_surface_range(x, z, SPATIAL_PARTITION_CEILS), x, y, z, &height);
+    } else
+#endif
+    {
+        surfaceList = get_static_surface_list(x, z, SPATIAL_PARTITION_CEILS);
+        ceil = find_ceil_from_list(surfaceList, x, y, z, &height);
+    }
 
     // Use the lower ceiling.
     if (includeDynamic && height >= dynamicHeight) {
@@ -372,17 +579,17 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
  *                     FLOORS                     *
  **************************************************/
 
-static s32 check_within_floor_triangle_bounds(s32 x, s32 z, struct Surface *surf) {
+static s32 check_within_floor_triangle_bounds(s32 x, s32 z, Vec3t vertex1, Vec3t vertex2, Vec3t vertex3) {
     Vec3i vx, vz;
-    vx[0] = surf->vertex1[0];
-    vz[0] = surf->vertex1[2];
-    vx[1] = surf->vertex2[0];
-    vz[1] = surf->vertex2[2];
+    vx[0] = vertex1[0];
+    vz[0] = vertex1[2];
+    vx[1] = vertex2[0];
+    vz[1] = vertex2[2];
 
     if (((vz[0] - z) * (vx[1] - vx[0]) - (vx[0] - x) * (vz[1] - vz[0])) < 0) return FALSE;
 
-    vx[2] = surf->vertex3[0];
-    vz[2] = surf->vertex3[2];
+    vx[2] = vertex3[0];
+    vz[2] = vertex3[2];
 
     if (((vz[1] - z) * (vx[2] - vx[1]) - (vx[1] - x) * (vz[2] - vz[1])) < 0) return FALSE;
     if (((vz[2] - z) * (vx[0] - vx[2]) - (vx[2] - x) * (vz[0] - vz[2])) < 0) return FALSE;
@@ -404,6 +611,10 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
         surfaceNode = surfaceNode->next;
         type        = surf->type;
 
+        // Floor lists are sorted from highest to lowest upperY, and no floor can be higher than its
+        // upperY at any point, so once it's below the highest floor found, no later floor can be used.
+        if (surf->upperY < *pheight) break;
+
         // To prevent the Merry-Go-Round room from loading when Mario passes above the hole that leads
         // there, SURFACE_INTANGIBLE is used. This prevent the wrong room from loading, but can also allow
         // Mario to pass through.
@@ -423,7 +634,7 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
         // Exclude all floors above the point.
         if (bufferY < surf->lowerY) continue;
         // Check that the point is within the triangle bounds.
-        if (!check_within_floor_triangle_bounds(x, z, surf)) continue;
+        if (!check_within_floor_triangle_bounds(x, z, surf->vertex1, surf->vertex2, surf->vertex3)) continue;
 
         // Get the height of the floor under the current location.
         height = get_surface_height_at_location(x, z, surf);
@@ -445,10 +656,73 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
     return floor;
 }
 
+#ifdef PACKED_STATIC_SURFACES
+/**
+ * find_floor_from_list for a packed range of static floors.
+ */
+static struct Surface *find_floor_from_packed(struct PackedSurfaceRange *range, s32 x, s32 y, s32 z, f32 *pheight) {
+    register s32 entry = range->start;
+    register s32 end = (entry + range->count);
+    register s32 i;
+    register SurfaceType type = SURFACE_DEFAULT;
+    register f32 height;
+    register s32 bufferY = y + FIND_FLOOR_BUFFER;
+    struct Surface *floor = NULL;
+
+    for (; entry < end; entry++) {
+        // Floor lists are sorted from highest to lowest upperY, see find_floor_from_list.
+        if (gPackedSurfaces.bounds[entry][1] < *pheight) break;
+
+        // Exclude all floors above the point.
+        if (bufferY < gPackedSurfaces.bounds[entry][0]) continue;
+
+        i = gPackedSurfaces.surfaces[entry];
+        type = gPackedSurfaces.type[i];
+
+        // Ignore intangible floors, see find_floor_from_list.
+        if (!(gCollisionFlags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && (type == SURFACE_INTANGIBLE)) {
+            continue;
+        }
+
+        // Determine if we are checking for the camera or not.
+        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+            if (gPackedSurfaces.flags[i] & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        } else if (type == SURFACE_CAMERA_BOUNDARY) {
+            continue; // If we are not checking for the camera, ignore camera only floors.
+        }
+
+        Vec3t *vertices = gPackedSurfaces.vertices[i];
+
+        // Check that the point is within the triangle bounds.
+        if (!check_within_floor_triangle_bounds(x, z, vertices[0], vertices[1], vertices[2])) continue;
+
+        // Get the height of the floor under the current location.
+        height = get_plane_height_at_location(x, z, gPackedSurfaces.plane[i]);
+
+        // Exclude floors lower than the previous highest floor.
+        if (height < *pheight) continue;
+
+        // Checks for floor interaction with a FIND_FLOOR_BUFFER unit buffer.
+        if (bufferY < height) continue;
+
+        // Use the current floor
+        *pheight = height;
+        floor = &sSurfacePool[i];
+
+        // Exit the loop if it's not possible for another floor to be closer
+        // to the original point, or if COLLISION_FLAG_RETURN_FIRST.
+        if ((height == bufferY) || (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST)) break;
+    }
+    return floor;
+}
+#endif
+
 // Generic triangle bounds func
 ALWAYS_INLINE static s32 check_within_bounds_y_norm(s32 x, s32 z, struct Surface *surf) {
-    if (surf->normal.y >= NORMAL_FLOOR_THRESHOLD) return check_within_floor_triangle_bounds(x, z, surf);
-    return check_within_ceil_triangle_bounds(x, z, surf, 0);
+    if (surf->normal.y >= NORMAL_FLOOR_THRESHOLD) return check_within_floor_triangle_bounds(x, z, surf->vertex1, surf->vertex2, surf->vertex3);
+    return check_within_ceil_triangle_bounds(x, z, surf->vertex1, surf->vertex2, surf->vertex3, surf->type, 0);
 }
 
 /**
@@ -541,6 +815,49 @@ f32 unused_find_dynamic_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfl
     return floorHeight;
 }
 
+#ifdef FIND_FLOOR_CACHE_SIZE
+// The collision flags that change which floor is found.
+#define FLOOR_CACHE_FLAGS (COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_CAMERA | COLLISION_FLAG_INCLUDE_INTANGIBLE | COLLISION_FLAG_EXCLUDE_DYNAMIC)
+
+/**
+ * A floor found at a point, valid until the surface partitions change.
+ */
+struct FloorCacheEntry {
+    s32 x, y, z;
+    u32 flags;   // The FLOOR_CACHE_FLAGS that were set.
+    u32 version; // gSurfacePartitionVersion when the floor was found.
+    f32 height;
+    struct Surface *floor;
+};
+
+static struct FloorCacheEntry sFloorCache[FIND_FLOOR_CACHE_SIZE];
+
+/**
+ * Returns the cache entry a point maps to.
+ */
+static struct FloorCacheEntry *get_floor_cache_entry(s32 x, s32 y, s32 z) {
+    u32 hash = (((u32) x * 73856093) ^ ((u32) y * 19349663) ^ ((u32) z * 83492791));
+
+    return &sFloorCache[(hash >> 16) & (FIND_FLOOR_CACHE_SIZE - 1)];
+}
+
+static s32 is_floor_cache_hit(struct FloorCacheEntry *entry, s32 x, s32 y, s32 z, u32 flags) {
+    return (entry->version == gSurfacePartitionVersion
+            && entry->x == x && entry->y == y && entry->z == z
+            && entry->flags == flags);
+}
+
+static void set_floor_cache_entry(struct FloorCacheEntry *entry, s32 x, s32 y, s32 z, u32 flags, f32 height, struct Surface *floor) {
+    entry->x = x;
+    entry->y = y;
+    entry->z = z;
+    entry->flags = flags;
+    entry->version = gSurfacePartitionVersion;
+    entry->height = height;
+    entry->floor = floor;
+}
+#endif
+
 /**
  * Find the highest floor under a given position and return the height.
  */
@@ -570,6 +887,17 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
 
     s32 includeDynamic = !(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
 
+#ifdef FIND_FLOOR_CACHE_SIZE
+    u32 cacheFlags = (gCollisionFlags & FLOOR_CACHE_FLAGS);
+    struct FloorCacheEntry *cacheEntry = get_floor_cache_entry(x, y, z);
+
+    if (is_floor_cache_hit(cacheEntry, x, y, z, cacheFlags)) {
+        floor  = cacheEntry->floor;
+        height = cacheEntry->height;
+        goto found;
+    }
+#endif
+
     if (includeDynamic) {
         // Check for surfaces belonging to objects.
         surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next;
@@ -580,8 +908,15 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     }
 
     // Check for surfaces that are a part of level geometry.
-    surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next;
-    floor = find_floor_from_list(surfaceList, x, y, z, &height);
+#ifdef PACKED_STATIC_SURFACES
+    if (gStaticSurfacesPacked) {
+        floor = find_floor_from_packed(get_static_surface_range(x, z, SPATIAL_PARTITION_FLOORS), x, y, z, &height);
+    } else
+#endif
+    {
+        surfaceList = get_static_surface_list(x, z, SPATIAL_PARTITION_FLOORS);
+        floor = find_floor_from_list(surfaceList, x, y, z, &height);
+    }
 
     // Use the higher floor.
     if (includeDynamic && height <= dynamicHeight) {
@@ -589,6 +924,10 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
         height = dynamicHeight;
     }
 
+#ifdef FIND_FLOOR_CACHE_SIZE
+    set_floor_cache_entry(cacheEntry, x, y, z, cacheFlags, height, floor);
+found:
+#endif
     // To prevent accidentally leaving the floor tangible, stop checking for it.
     gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
     // If a floor was missed, increment the debug counter.
@@ -605,6 +944,330 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     return height;
 }
 
+/**
+ * A point checked by find_floors_batch.
+ */
+struct FloorBatchPoint {
+    s32 x, y, z;
+    s32 cell; // Index of the cell the point is in, the points are sorted by it.
+    f32 height;
+    struct Surface *floor;
+    f32 dynamicHeight;
+    struct Surface *dynamicFloor;
+    struct SurfaceNode *staticList;
+#ifdef PACKED_STATIC_SURFACES
+    struct PackedSurfaceRange *staticRange;
+#endif
+    struct FloorResult *result;
+#ifdef FIND_FLOOR_CACHE_SIZE
+    struct FloorCacheEntry *cacheEntry;
+#endif
+};
+
+/**
+ * find_floor_from_list for several points at once, walking the list a single time.
+ * Each point is dropped once find_floor_from_list would have stopped for it.
+ */
+static void find_floors_from_list(struct SurfaceNode *surfaceNode, struct FloorBatchPoint **points, s32 numPoints) {
+    struct FloorBatchPoint *active[FIND_FLOORS_BATCH_SIZE];
+    register struct Surface *surf;
+    register struct FloorBatchPoint *point;
+    register SurfaceType type = SURFACE_DEFAULT;
+    register f32 height;
+    register s32 bufferY;
+    s32 numActive = numPoints;
+    s32 i;
+
+    // A single point doesn't need the bookkeeping.
+    if (numPoints == 1) {
+        point = points[0];
+        point->floor = find_floor_from_list(surfaceNode, point->x, point->y, point->z, &point->height);
+        return;
+    }
+
+    for (i = 0; i < numPoints; i++) {
+        active[i] = points[i];
+    }
+
+    while (surfaceNode != NULL && numActive > 0) {
+        surf = surfaceNode->surface;
+        surfaceNode = surfaceNode->next;
+        type        = surf->type;
+
+        // The same type checks as find_floor_from_list. It stops at the first surface below its highest
+        // floor before checking the type, but since the list is sorted every later surface is below it too.
+        if (!(gCollisionFlags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && (type == SURFACE_INTANGIBLE)) {
+            continue;
+        }
+
+        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        } else if (type == SURFACE_CAMERA_BOUNDARY) {
+            continue;
+        }
+
+        for (i = 0; i < numActive; i++) {
+            point = active[i];
+
+            // No later floor can be higher than the highest floor found.
+            if (surf->upperY < point->height) {
+                active[i--] = active[--numActive];
+                continue;
+            }
+
+            bufferY = point->y + FIND_FLOOR_BUFFER;
+
+            if (bufferY < surf->lowerY) continue;
+            if (!check_within_floor_triangle_bounds(point->x, point->z, surf->vertex1, surf->vertex2, surf->vertex3)) continue;
+
+            height = get_surface_height_at_location(point->x, point->z, surf);
+
+            if (height < point->height) continue;
+            if (bufferY < height) continue;
+
+            point->height = height;
+            point->floor = surf;
+
+            if ((height == bufferY) || (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST)) {
+                active[i--] = active[--numActive];
+            }
+        }
+    }
+}
+
+#ifdef PACKED_STATIC_SURFACES
+/**
+ * find_floor_from_packed for several points at once, see find_floors_from_list.
+ */
+static void find_floors_from_packed(struct PackedSurfaceRange *range, struct FloorBatchPoint **points, s32 numPoints) {
+    struct FloorBatchPoint *active[FIND_FLOORS_BATCH_SIZE];
+    register s32 entry = range->start;
+    register s32 end = (entry + range->count);
+    register s32 surfIndex;
+    register struct FloorBatchPoint *point;
+    register SurfaceType type = SURFACE_DEFAULT;
+    register f32 height;
+    register s32 bufferY;
+    s32 numActive = numPoints;
+    s32 i;
+
+    if (numPoints == 1) {
+        point = points[0];
+        point->floor = find_floor_from_packed(range, point->x, point->y, point->z, &point->height);
+        return;
+    }
+
+    for (i = 0; i < numPoints; i++) {
+        active[i] = points[i];
+    }
+
+    for (; entry < end && numActive > 0; entry++) {
+        surfIndex = gPackedSurfaces.surfaces[entry];
+        type = gPackedSurfaces.type[surfIndex];
+
+        if (!(gCollisionFlags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && (type == SURFACE_INTANGIBLE)) {
+            continue;
+        }
+
+        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+            if (gPackedSurfaces.flags[surfIndex] & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        } else if (type == SURFACE_CAMERA_BOUNDARY) {
+            continue;
+        }
+
+        Vec3t *vertices = gPackedSurfaces.vertices[surfIndex];
+
+        for (i = 0; i < numActive; i++) {
+            point = active[i];
+
+            if (gPackedSurfaces.bounds[entry][1] < point->height) {
+                active[i--] = active[--numActive];
+                continue;
+            }
+
+            bufferY = point->y + FIND_FLOOR_BUFFER;
+
+            if (bufferY < gPackedSurfaces.bounds[entry][0]) continue;
+            if (!check_within_floor_triangle_bounds(point->x, point->z, vertices[0], vertices[1], vertices[2])) continue;
+
+            height = get_plane_height_at_location(point->x, point->z, gPackedSurfaces.plane[surfIndex]);
+
+            if (height < point->height) continue;
+            if (bufferY < height) continue;
+
+            point->height = height;
+            point->floor = &sSurfacePool[surfIndex];
+
+            if ((height == bufferY) || (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST)) {
+                active[i--] = active[--numActive];
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * Whether two points of a batch use the same static floor list.
+ */
+static s32 is_same_static_floor_list(struct FloorBatchPoint *a, struct FloorBatchPoint *b) {
+#ifdef PACKED_STATIC_SURFACES
+    if (gStaticSurfacesPacked) {
+        return (a->staticRange == b->staticRange);
+    }
+#endif
+    return (a->staticList == b->staticList);
+}
+
+/**
+ * Finds the floors of up to FIND_FLOORS_BATCH_SIZE points, see find_floors_batch.
+ */
+static void find_floors_batch_chunk(Vec3f *points, s32 numPoints, struct FloorResult *results) {
+    struct FloorBatchPoint batch[FIND_FLOORS_BATCH_SIZE];
+    struct FloorBatchPoint *sorted[FIND_FLOORS_BATCH_SIZE];
+    struct FloorBatchPoint *group[FIND_FLOORS_BATCH_SIZE];
+    struct FloorBatchPoint *point;
+    s32 includeDynamic = !(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
+    s32 numSorted = 0;
+    s32 start, end, numGroup;
+    s32 i, j;
+#ifdef FIND_FLOOR_CACHE_SIZE
+    u32 cacheFlags = (gCollisionFlags & FLOOR_CACHE_FLAGS);
+#endif
+
+    for (i = 0; i < numPoints; i++) {
+        point = &batch[numSorted];
+        point->x = points[i][0];
+        point->y = points[i][1];
+        point->z = points[i][2];
+        point->result = &results[i];
+
+        results[i].floor = NULL;
+        results[i].height = FLOOR_LOWER_LIMIT;
+
+        if (is_outside_level_bounds(point->x, point->z)) {
+            continue;
+        }
+
+#ifdef VANILLA_DEBUG
+        gNumCalls.floor++;
+#endif
+#ifdef FIND_FLOOR_CACHE_SIZE
+        point->cacheEntry = get_floor_cache_entry(point->x, point->y, point->z);
+
+        if (is_floor_cache_hit(point->cacheEntry, point->x, point->y, point->z, cacheFlags)) {
+            results[i].floor = point->cacheEntry->floor;
+            results[i].height = point->cacheEntry->height;
+            if (results[i].floor == NULL) {
+                gNumFindFloorMisses++;
+            }
+            continue;
+        }
+#endif
+
+        point->cell = ((GET_CELL_COORD(point->z) * NUM_CELLS) + GET_CELL_COORD(point->x));
+        point->height = FLOOR_LOWER_LIMIT;
+        point->floor = NULL;
+
+        // Insertion sort by cell.
+        for (j = numSorted; j > 0 && sorted[j - 1]->cell > point->cell; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = point;
+        numSorted++;
+    }
+
+    for (start = 0; start < numSorted; start = end) {
+        s32 cell = sorted[start]->cell;
+        s32 cellX = (cell % NUM_CELLS);
+        s32 cellZ = (cell / NUM_CELLS);
+
+        for (end = start + 1; end < numSorted && sorted[end]->cell == cell; end++);
+
+        // Check for surfaces belonging to objects, for every point in the cell at once.
+        if (includeDynamic) {
+            find_floors_from_list(gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next, &sorted[start], (end - start));
+        }
+
+        for (i = start; i < end; i++) {
+            point = sorted[i];
+            point->dynamicHeight = point->height;
+            point->dynamicFloor = point->floor;
+            point->floor = NULL;
+#ifdef PACKED_STATIC_SURFACES
+            if (gStaticSurfacesPacked) {
+                point->staticRange = get_static_surface_range(point->x, point->z, SPATIAL_PARTITION_FLOORS);
+            } else
+#endif
+            {
+                point->staticList = get_static_surface_list(point->x, point->z, SPATIAL_PARTITION_FLOORS);
+            }
+        }
+
+        // Cells split into quadtrees can have different static lists, walk each one once.
+        for (i = start; i < end; i++) {
+            if (sorted[i] == NULL) continue;
+
+            numGroup = 0;
+            for (j = i; j < end; j++) {
+                if (sorted[j] != NULL && is_same_static_floor_list(sorted[i], sorted[j])) {
+                    group[numGroup++] = sorted[j];
+                    if (j != i) sorted[j] = NULL;
+                }
+            }
+            sorted[i] = NULL;
+
+#ifdef PACKED_STATIC_SURFACES
+            if (gStaticSurfacesPacked) {
+                find_floors_from_packed(group[0]->staticRange, group, numGroup);
+            } else
+#endif
+            {
+                find_floors_from_list(group[0]->staticList, group, numGroup);
+            }
+
+            for (j = 0; j < numGroup; j++) {
+                point = group[j];
+
+                // Use the higher floor.
+                if (includeDynamic && point->height <= point->dynamicHeight) {
+                    point->floor  = point->dynamicFloor;
+                    point->height = point->dynamicHeight;
+                }
+
+                point->result->floor = point->floor;
+                point->result->height = point->height;
+#ifdef FIND_FLOOR_CACHE_SIZE
+                set_floor_cache_entry(point->cacheEntry, point->x, point->y, point->z, cacheFlags, point->height, point->floor);
+#endif
+                if (point->floor == NULL) {
+                    gNumFindFloorMisses++;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Finds the highest floor under each of several points, giving the same results as calling
+ * find_floor for each of them. Points are grouped by cell so every cell list is only walked once
+ * for all of its points, and points checked since the surfaces last changed come from the floor cache.
+ * The collision flags apply to every point, and are cleared afterwards like in find_floor.
+ */
+void find_floors_batch(Vec3f *points, s32 numPoints, struct FloorResult *results) {
+    s32 i;
+
+    for (i = 0; i < numPoints; i += FIND_FLOORS_BATCH_SIZE) {
+        find_floors_batch_chunk(&points[i], MIN(FIND_FLOORS_BATCH_SIZE, (numPoints - i)), &results[i]);
+    }
+
+    // To prevent accidentally leaving the floor tangible, stop checking for it.
+    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
+}
+
 f32 find_room_floor(f32 x, f32 y, f32 z, struct Surface **pfloor) {
     gCollisionFlags |= (COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
     return find_floor(x, y, z, pfloor);
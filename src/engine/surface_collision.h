@@ -42,6 +42,18 @@ struct WallCollisionData {
     /*0x18*/ struct Surface *walls[MAX_REFERENCED_WALLS];
 };
 
+// The most points find_floors_batch checks together, larger batches are split.
+#define FIND_FLOORS_BATCH_SIZE 8
+
+/**
+ * The floor found under a point by find_floors_batch, NULL if there is none.
+ */
+struct FloorResult {
+    struct Surface *floor;
+    f32 height;
+};
+
+struct SurfaceNode *get_static_surface_list(s32 x, s32 z, s32 listIndex);
 s32 f32_find_wall_collision(f32 *xPtr, f32 *yPtr, f32 *zPtr, f32 offsetY, f32 radius);
 s32 find_wall_collisions(struct WallCollisionData *colData);
 void resolve_and_return_wall_collisions(Vec3f pos, f32 offset, f32 radius, struct WallCollisionData *collisionData);
@@ -54,6 +66,7 @@ ALWAYS_INLINE f32 find_mario_ceil(Vec3f pos, f32 height, struct Surface **ceil)
 
 f32 find_floor_height(f32 x, f32 y, f32 z);
 f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor);
+void find_floors_batch(Vec3f *points, s32 numPoints, struct FloorResult *results);
 f32 find_room_floor(f32 x, f32 y, f32 z, struct Surface **pfloor);
 s32 find_water_level_and_floor(s32 x, s32 y, s32 z, struct Surface **pfloor);
 s32 find_water_level(s32 x, s32 z);
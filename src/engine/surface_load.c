@@ -14,6 +14,7 @@
 #include "game/object_list_processor.h"
 #include "surface_load.h"
 #include "game/puppyprint.h"
+#include "string.h"
 
 #include "config.h"
 
@@ -30,6 +31,24 @@ SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
 struct SurfaceNode *sSurfaceNodePool;
 struct Surface *sSurfacePool;
 
+#ifdef STATIC_SURFACE_TREE
+/**
+ * Quadtrees for static cells with a lot of floors or ceilings.
+ */
+u16 gStaticSurfaceTreeRoots[NUM_CELLS][NUM_CELLS][NUM_SURFACE_TREE_PARTITIONS];
+struct SurfaceTreeNode *sSurfaceTreeNodePool;
+s32 gSurfaceTreeNodesAllocated;
+#endif
+
+#ifdef PACKED_STATIC_SURFACES
+/**
+ * Packed copies of the static surfaces and their floor, ceiling and wall lists.
+ */
+struct PackedSurfaces gPackedSurfaces;
+struct PackedSurfaceRange gStaticPackedRanges[NUM_CELLS][NUM_CELLS][NUM_PACKED_PARTITIONS];
+u8 gStaticSurfacesPacked = FALSE;
+#endif
+
 /**
  * The size of the surface node pool (SURFACE_NODE_POOL_SIZE).
  */
@@ -42,10 +61,62 @@ s32 sSurfacePoolSize = SURFACE_POOL_SIZE;
 
 u8 gSurfacePoolError = 0x0;
 
+#ifdef FIND_FLOOR_CACHE_SIZE
+/**
+ * Changed whenever a surface is added to, moved in or removed from either partition,
+ * which invalidates every cached floor.
+ */
+u32 gSurfacePartitionVersion = 1;
+#endif
+
+#ifdef BAKED_COLLISION
+/**
+ * Whether the static surfaces of the area being loaded came from baked collision,
+ * in which case the surface data in the terrain data is skipped.
+ */
+static u8 sSkipStaticSurfaces = FALSE;
+#endif
+
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+/**
+ * The surfaces of a surface object. They stay in the dynamic partition until the object
+ * moves, stops loading them or unloads.
+ */
+struct DynamicSurfaces {
+    TerrainData *collisionData; // The collision data the surfaces were loaded from
+    f32 transform[4][3];        // The scaled object transform the surfaces were loaded with
+    s16 numSurfaces;
+    u8 loaded;                  // Whether they were loaded since the last unload_stale_dynamic_surfaces
+    struct Surface surfaces[];
+};
+
+/**
+ * Each surface object's surfaces, by object pool index, allocated from sDynamicSurfacePool.
+ */
+static struct DynamicSurfaces *sObjectSurfaces[OBJECT_POOL_CAPACITY];
+static struct MemoryPool *sDynamicSurfacePool;
+
+/**
+ * Nodes removed from the dynamic partition, reused before allocating new ones.
+ */
+static struct SurfaceNode *sFreeSurfaceNodes = NULL;
+#endif
+
 /**
  * Allocate the part of the surface node pool to contain a surface node.
  */
 static struct SurfaceNode *alloc_surface_node(void) {
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+    if (sFreeSurfaceNodes != NULL) {
+        struct SurfaceNode *freeNode = sFreeSurfaceNodes;
+
+        sFreeSurfaceNodes = freeNode->next;
+        freeNode->next = NULL;
+
+        return freeNode;
+    }
+#endif
+
     struct SurfaceNode *node = &sSurfaceNodePool[gSurfaceNodesAllocated++];
 
     node->next = NULL;
@@ -99,7 +170,43 @@ static void clear_spatial_partition(SpatialPartitionCell *cells) {
  */
 static void clear_static_surfaces(void) {
     clear_spatial_partition(&gStaticSurfacePartition[0][0]);
+#ifdef PACKED_STATIC_SURFACES
+    gStaticSurfacesPacked = FALSE;
+#endif
+}
+
+/**
+ * Returns which of a cell's lists a surface goes in.
+ */
+static s32 get_surface_list_index(struct Surface *surface) {
+    if (SURFACE_IS_NEW_WATER(surface->type)) {
+        return SPATIAL_PARTITION_WATER;
+    } else if (surface->normal.y > NORMAL_FLOOR_THRESHOLD) {
+        return SPATIAL_PARTITION_FLOORS;
+    } else if (surface->normal.y < NORMAL_CEIL_THRESHOLD) {
+        return SPATIAL_PARTITION_CEILS;
+    } else {
+        return SPATIAL_PARTITION_WALLS;
+    }
+}
+
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+/**
+ * Frees the surfaces of every surface object. Doesn't clear the dynamic partition.
+ */
+static void free_dynamic_surfaces(void) {
+    s32 i;
+
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        if (sObjectSurfaces[i] != NULL) {
+            mem_pool_free(sDynamicSurfacePool, sObjectSurfaces[i]);
+            sObjectSurfaces[i] = NULL;
+        }
+    }
+
+    sFreeSurfaceNodes = NULL;
 }
+#endif
 
 /**
  * Add a surface to the correct cell list of surfaces.
@@ -112,17 +219,11 @@ static void add_surface_to_cell(s32 dynamic, s32 cellX, s32 cellZ, struct Surfac
     struct SurfaceNode *list;
     s32 priority;
     s32 sortDir = 1; // highest to lowest, then insertion order (water and floors)
-    s32 listIndex;
+    s32 listIndex = get_surface_list_index(surface);
 
-    if (SURFACE_IS_NEW_WATER(surface->type)) {
-        listIndex = SPATIAL_PARTITION_WATER;
-    } else if (surface->normal.y > NORMAL_FLOOR_THRESHOLD) {
-        listIndex = SPATIAL_PARTITION_FLOORS;
-    } else if (surface->normal.y < NORMAL_CEIL_THRESHOLD) {
-        listIndex = SPATIAL_PARTITION_CEILS;
+    if (listIndex == SPATIAL_PARTITION_CEILS) {
         sortDir = -1; // lowest to highest, then insertion order
-    } else {
-        listIndex = SPATIAL_PARTITION_WALLS;
+    } else if (listIndex == SPATIAL_PARTITION_WALLS) {
         sortDir = 0; // insertion order
     }
 
@@ -204,6 +305,29 @@ static s32 upper_cell_index(s32 coord) {
     return MIN((NUM_CELLS - 1), index);
 }
 
+/**
+ * An inclusive range of cells.
+ */
+struct CellBounds {
+    s32 minX, maxX;
+    s32 minZ, maxZ;
+};
+
+/**
+ * Finds the range of cells (with a buffer) a surface is added to.
+ */
+static void get_surface_cell_bounds(struct Surface *surface, struct CellBounds *bounds) {
+    s32 minX, maxX, minZ, maxZ;
+
+    min_max_3i(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0], &minX, &maxX);
+    min_max_3i(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2], &minZ, &maxZ);
+
+    bounds->minX = lower_cell_index(minX);
+    bounds->maxX = upper_cell_index(maxX);
+    bounds->minZ = lower_cell_index(minZ);
+    bounds->maxZ = upper_cell_index(maxZ);
+}
+
 /**
  * Every level is split into 16x16 cells, this takes a surface, finds
  * the appropriate cells (with a buffer), and adds the surface to those
@@ -212,36 +336,34 @@ static s32 upper_cell_index(s32 coord) {
  * @param dynamic Boolean determining whether the surface is static or dynamic
  */
 static void add_surface(struct Surface *surface, s32 dynamic) {
+    struct CellBounds bounds;
     s32 cellZ, cellX;
-    s32 minX, maxX, minZ, maxZ;
 
-    min_max_3i(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0], &minX, &maxX);
-    min_max_3i(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2], &minZ, &maxZ);
-
-    s32 minCellX = lower_cell_index(minX);
-    s32 maxCellX = upper_cell_index(maxX);
-    s32 minCellZ = lower_cell_index(minZ);
-    s32 maxCellZ = upper_cell_index(maxZ);
+    get_surface_cell_bounds(surface, &bounds);
+#ifdef FIND_FLOOR_CACHE_SIZE
+    gSurfacePartitionVersion++;
+#endif
 
-    for (cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
-        for (cellX = minCellX; cellX <= maxCellX; cellX++) {
+    for (cellZ = bounds.minZ; cellZ <= bounds.maxZ; cellZ++) {
+        for (cellX = bounds.minX; cellX <= bounds.maxX; cellX++) {
             add_surface_to_cell(dynamic, cellX, cellZ, surface);
         }
     }
 }
 
 /**
- * Initializes a Surface struct using the given vertex data
+ * Sets a surface's vertices, normal, origin offset and height range from the given vertex data
+ * @param surface The surface to set
  * @param vertexData The raw data containing vertex positions
  * @param vertexIndices Helper which tells positions in vertexData to start reading vertices
  */
-static struct Surface *read_surface_data(TerrainData *vertexData, TerrainData **vertexIndices) {
+static void read_surface_geometry(struct Surface *surface, TerrainData *vertexData, TerrainData *vertexIndices) {
     Vec3t v[3];
     Vec3f n;
     Vec3t offset;
     s16 min, max;
 
-    vec3_prod_val(offset, (*vertexIndices), 3);
+    vec3_prod_val(offset, vertexIndices, 3);
 
     vec3s_copy(v[0], (vertexData + offset[0]));
     vec3s_copy(v[1], (vertexData + offset[1]));
@@ -251,8 +373,6 @@ static struct Surface *read_surface_data(TerrainData *vertexData, TerrainData **
 
     vec3f_normalize(n);
 
-    struct Surface *surface = alloc_surface();
-
     vec3s_copy(surface->vertex1, v[0]);
     vec3s_copy(surface->vertex2, v[1]);
     vec3s_copy(surface->vertex3, v[2]);
@@ -266,6 +386,17 @@ static struct Surface *read_surface_data(TerrainData *vertexData, TerrainData **
     min_max_3s(v[0][1], v[1][1], v[2][1], &min, &max);
     surface->lowerY = (min - SURFACE_VERTICAL_BUFFER);
     surface->upperY = (max + SURFACE_VERTICAL_BUFFER);
+}
+
+/**
+ * Initializes a Surface struct using the given vertex data
+ * @param vertexData The raw data containing vertex positions
+ * @param vertexIndices Helper which tells positions in vertexData to start reading vertices
+ */
+static struct Surface *read_surface_data(TerrainData *vertexData, TerrainData **vertexIndices) {
+    struct Surface *surface = alloc_surface();
+
+    read_surface_geometry(surface, vertexData, *vertexIndices);
 
     return surface;
 }
@@ -333,6 +464,17 @@ static void load_static_surfaces(TerrainData **data, TerrainData *vertexData, s3
 
     s32 numSurfaces = *(*data)++;
 
+#ifdef BAKED_COLLISION
+    if (sSkipStaticSurfaces) {
+#ifdef ALL_SURFACES_HAVE_FORCE
+        *data += 4 * numSurfaces;
+#else
+        *data += (3 + hasForce) * numSurfaces;
+#endif
+        return;
+    }
+#endif
+
     for (i = 0; i < numSurfaces; i++) {
         if (*surfaceRooms != NULL) {
             room = *(*surfaceRooms)++;
@@ -368,6 +510,305 @@ static void load_static_surfaces(TerrainData **data, TerrainData *vertexData, s3
     }
 }
 
+#ifdef STATIC_SURFACE_TREE
+/**
+ * Which of the four children of the square [minX, minX + 2 * half) x [minZ, minZ + 2 * half) a surface's
+ * bounding box overlaps, one bit per child in child order. Any integer position inside a floor or ceiling
+ * triangle is inside its bounding box, so a child only needs the surfaces with its bit set to return
+ * the same results as its cell.
+ */
+static s32 surface_tree_child_mask(struct Surface *surf, s32 minX, s32 minZ, s32 half) {
+    s32 surfMinX, surfMaxX, surfMinZ, surfMaxZ;
+    s32 maskX = 0, maskZ = 0;
+
+    // Triangles with no area from above pass the triangle bounds check anywhere along
+    // the line through them, so they have to stay in every node of the cell.
+    if (((surf->vertex2[0] - surf->vertex1[0]) * (surf->vertex3[2] - surf->vertex1[2]))
+        == ((surf->vertex3[0] - surf->vertex1[0]) * (surf->vertex2[2] - surf->vertex1[2]))) {
+        return 0xF;
+    }
+
+    min_max_3i(surf->vertex1[0], surf->vertex2[0], surf->vertex3[0], &surfMinX, &surfMaxX);
+    min_max_3i(surf->vertex1[2], surf->vertex2[2], surf->vertex3[2], &surfMinZ, &surfMaxZ);
+
+    if (surfMaxX >= minX          && surfMinX < (minX + half))     maskX |= 0x1;
+    if (surfMaxX >= (minX + half) && surfMinX < (minX + 2 * half)) maskX |= 0x2;
+    if (surfMaxZ >= minZ          && surfMinZ < (minZ + half))     maskZ |= 0x3;
+    if (surfMaxZ >= (minZ + half) && surfMinZ < (minZ + 2 * half)) maskZ |= 0xC;
+
+    return ((maskX * 0x5) & maskZ);
+}
+
+/**
+ * Splits a tree node into four children if that lets at least one of them check fewer surfaces.
+ * Each child gets its own copy of the overlapping part of the parent's list, in the same order,
+ * so the sorting find_floor and find_ceil rely on is kept.
+ */
+static void split_surface_tree_node(s32 nodeIndex, s32 minX, s32 minZ, s32 size, s32 depth) {
+    struct SurfaceTreeNode *node = &sSurfaceTreeNodePool[nodeIndex];
+    struct SurfaceNode *list;
+    struct SurfaceNode **tails[4];
+    s32 half = (size >> 1);
+    s32 childCounts[4] = { 0 };
+    s32 i, mask, numNodes = 0;
+    s32 reduces = FALSE;
+
+    if (depth >= STATIC_SURFACE_TREE_MAX_DEPTH
+        || node->numSurfaces <= STATIC_SURFACE_TREE_LEAF_SIZE
+        || gSurfaceTreeNodesAllocated + 4 > STATIC_SURFACE_TREE_NODE_POOL_SIZE) {
+        return;
+    }
+
+    for (list = node->list; list != NULL; list = list->next) {
+        mask = surface_tree_child_mask(list->surface, minX, minZ, half);
+        for (i = 0; i < 4; i++) {
+            childCounts[i] += ((mask >> i) & 1);
+        }
+    }
+
+    for (i = 0; i < 4; i++) {
+        numNodes += childCounts[i];
+        if (childCounts[i] < node->numSurfaces) {
+            reduces = TRUE;
+        }
+    }
+
+    // Always leave a quarter of the node pool to dynamic surfaces.
+    if (!reduces || (gSurfaceNodesAllocated + numNodes) > (sSurfaceNodePoolSize - (sSurfaceNodePoolSize >> 2))) {
+        return;
+    }
+
+    node->children = gSurfaceTreeNodesAllocated;
+    gSurfaceTreeNodesAllocated += 4;
+
+    for (i = 0; i < 4; i++) {
+        struct SurfaceTreeNode *child = &sSurfaceTreeNodePool[node->children + i];
+
+        child->children = 0;
+        child->numSurfaces = childCounts[i];
+        child->list = NULL;
+        tails[i] = &child->list;
+    }
+
+    // The parent's list is only walked once more, filling all four children at the same time.
+    for (list = node->list; list != NULL; list = list->next) {
+        mask = surface_tree_child_mask(list->surface, minX, minZ, half);
+        for (i = 0; i < 4; i++) {
+            if (mask & (1 << i)) {
+                struct SurfaceNode *newNode = alloc_surface_node();
+                newNode->surface = list->surface;
+                *tails[i] = newNode;
+                tails[i] = &newNode->next;
+            }
+        }
+    }
+
+    for (i = 0; i < 4; i++) {
+        split_surface_tree_node(node->children + i, minX + (i & 1) * half, minZ + (i >> 1) * half, half, depth + 1);
+    }
+}
+
+/**
+ * Builds the quadtrees for every static cell with more than STATIC_SURFACE_TREE_LEAF_SIZE
+ * floors or ceilings. Must run after all static surfaces are added.
+ */
+static void build_static_surface_trees(void) {
+    s32 cellX, cellZ, listIndex;
+    struct SurfaceNode *list;
+
+    // Node 0 is never used, since a root index of 0 means the cell isn't split.
+    gSurfaceTreeNodesAllocated = 1;
+    bzero(gStaticSurfaceTreeRoots, sizeof(gStaticSurfaceTreeRoots));
+
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < NUM_SURFACE_TREE_PARTITIONS; listIndex++) {
+                s32 numSurfaces = 0;
+
+                for (list = gStaticSurfacePartition[cellZ][cellX][listIndex].next; list != NULL; list = list->next) {
+                    numSurfaces++;
+                }
+
+                if (numSurfaces <= STATIC_SURFACE_TREE_LEAF_SIZE
+                    || gSurfaceTreeNodesAllocated >= STATIC_SURFACE_TREE_NODE_POOL_SIZE) {
+                    continue;
+                }
+
+                s32 rootIndex = gSurfaceTreeNodesAllocated++;
+                struct SurfaceTreeNode *root = &sSurfaceTreeNodePool[rootIndex];
+
+                // The root shares the cell's list, only its children need new nodes.
+                root->children = 0;
+                root->numSurfaces = numSurfaces;
+                root->list = gStaticSurfacePartition[cellZ][cellX][listIndex].next;
+
+                split_surface_tree_node(rootIndex, ((cellX * CELL_SIZE) - LEVEL_BOUNDARY_MAX),
+                                        ((cellZ * CELL_SIZE) - LEVEL_BOUNDARY_MAX), CELL_SIZE, 0);
+
+                // Splitting failed, so checking the cell list directly is just as fast.
+                if (root->children == 0) {
+                    gSurfaceTreeNodesAllocated--;
+                    continue;
+                }
+
+                gStaticSurfaceTreeRoots[cellZ][cellX][listIndex] = rootIndex;
+            }
+        }
+    }
+}
+#endif
+
+#ifdef PACKED_STATIC_SURFACES
+/**
+ * Appends a surface list to the packed entries. Returns FALSE if there is no room left.
+ */
+static s32 pack_surface_list(struct SurfaceNode *list, struct PackedSurfaceRange *range, s32 *numEntries) {
+    range->start = *numEntries;
+
+    for (; list != NULL; list = list->next) {
+        struct Surface *surf = list->surface;
+
+        if (*numEntries >= PACKED_SURFACE_ENTRY_POOL_SIZE) {
+            return FALSE;
+        }
+
+        gPackedSurfaces.bounds[*numEntries][0] = surf->lowerY;
+        gPackedSurfaces.bounds[*numEntries][1] = surf->upperY;
+        gPackedSurfaces.surfaces[*numEntries] = (surf - sSurfacePool);
+        (*numEntries)++;
+    }
+
+    range->count = (*numEntries - range->start);
+    return TRUE;
+}
+
+/**
+ * Copies the static surfaces and every floor, ceiling and wall list that gets checked into
+ * gPackedSurfaces. Must run after all static surfaces are added and the quadtrees are built.
+ * If the area doesn't fit, gStaticSurfacesPacked is left FALSE and the lists are used instead.
+ */
+static void pack_static_surfaces(void) {
+    s32 i, cellX, cellZ, listIndex;
+    s32 numEntries = 0;
+
+    if (gSurfacesAllocated > PACKED_SURFACE_POOL_SIZE) {
+        return;
+    }
+
+    for (i = 0; i < gSurfacesAllocated; i++) {
+        struct Surface *surf = &sSurfacePool[i];
+
+        gPackedSurfaces.type[i] = surf->type;
+        gPackedSurfaces.flags[i] = surf->flags;
+        vec3_copy(gPackedSurfaces.vertices[i][0], surf->vertex1);
+        vec3_copy(gPackedSurfaces.vertices[i][1], surf->vertex2);
+        vec3_copy(gPackedSurfaces.vertices[i][2], surf->vertex3);
+        gPackedSurfaces.plane[i][0] = surf->normal.x;
+        gPackedSurfaces.plane[i][1] = surf->normal.y;
+        gPackedSurfaces.plane[i][2] = surf->normal.z;
+        gPackedSurfaces.plane[i][3] = surf->originOffset;
+    }
+
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < NUM_PACKED_PARTITIONS; listIndex++) {
+                struct PackedSurfaceRange *range = &gStaticPackedRanges[cellZ][cellX][listIndex];
+                struct SurfaceNode *list = gStaticSurfacePartition[cellZ][cellX][listIndex].next;
+
+#ifdef STATIC_SURFACE_TREE
+                // Split cells are checked through their leaves instead.
+                if (listIndex < NUM_SURFACE_TREE_PARTITIONS && gStaticSurfaceTreeRoots[cellZ][cellX][listIndex] != 0) {
+                    list = NULL;
+                }
+#endif
+                if (!pack_surface_list(list, range, &numEntries)) {
+                    return;
+                }
+            }
+        }
+    }
+
+#ifdef STATIC_SURFACE_TREE
+    for (i = 1; i < gSurfaceTreeNodesAllocated; i++) {
+        struct SurfaceTreeNode *node = &sSurfaceTreeNodePool[i];
+
+        if (node->children == 0 && !pack_surface_list(node->list, &node->packed, &numEntries)) {
+            return;
+        }
+    }
+#endif
+
+    gStaticSurfacesPacked = TRUE;
+}
+#endif
+
+#ifdef BAKED_COLLISION
+/**
+ * Copies the surfaces and partition of baked collision into the surface pools, giving the same
+ * result as loading the area's terrain data. Returns FALSE if it doesn't fit in the pools.
+ */
+static s32 load_baked_static_surfaces(const struct BakedCollision *baked) {
+    const struct Surface *surfaces = segmented_to_virtual((void *) baked->surfaces);
+    const u16 *nodes = segmented_to_virtual((void *) baked->nodes);
+    const struct BakedSurfaceList *lists = segmented_to_virtual((void *) baked->lists);
+    struct SurfaceNode *node = sSurfaceNodePool;
+    s32 i, j;
+
+    if (baked->numSurfaces >= sSurfacePoolSize || baked->numNodes >= sSurfaceNodePoolSize) {
+        return FALSE;
+    }
+#ifdef STATIC_SURFACE_TREE
+    if (baked->numTreeNodes + 1 > STATIC_SURFACE_TREE_NODE_POOL_SIZE) {
+        return FALSE;
+    }
+#endif
+
+    memcpy(sSurfacePool, surfaces, baked->numSurfaces * sizeof(struct Surface));
+    gSurfacesAllocated = baked->numSurfaces;
+
+    for (i = 0; i < baked->numLists; i++) {
+        u16 cell = lists[i].cell;
+
+        if (cell != BAKED_TREE_LIST) {
+            ((struct SurfaceNode *) gStaticSurfacePartition)[cell].next = node;
+        }
+
+        for (j = 0; j < lists[i].count; j++) {
+            node->surface = &sSurfacePool[*nodes++];
+            node->next = (node + 1);
+            node++;
+        }
+
+        (node - 1)->next = NULL;
+    }
+
+    gSurfaceNodesAllocated = baked->numNodes;
+
+#ifdef STATIC_SURFACE_TREE
+    const struct BakedSurfaceTreeNode *treeNodes = segmented_to_virtual((void *) baked->treeNodes);
+    const struct BakedSurfaceTreeRoot *treeRoots = segmented_to_virtual((void *) baked->treeRoots);
+
+    bzero(gStaticSurfaceTreeRoots, sizeof(gStaticSurfaceTreeRoots));
+
+    for (i = 0; i < baked->numTreeNodes; i++) {
+        struct SurfaceTreeNode *treeNode = &sSurfaceTreeNodePool[i + 1];
+
+        treeNode->children = treeNodes[i].children;
+        treeNode->numSurfaces = treeNodes[i].numSurfaces;
+        treeNode->list = (treeNodes[i].numSurfaces != 0) ? &sSurfaceNodePool[treeNodes[i].list] : NULL;
+    }
+
+    for (i = 0; i < baked->numTreeRoots; i++) {
+        ((u16 *) gStaticSurfaceTreeRoots)[treeRoots[i].cell] = treeRoots[i].node;
+    }
+
+    gSurfaceTreeNodesAllocated = (baked->numTreeNodes + 1);
+#endif
+
+    return TRUE;
+}
+#endif
+
 /**
  * Read the data for vertices for reference by triangles.
  */
@@ -401,6 +842,23 @@ static void load_environmental_regions(TerrainData **data) {
 void alloc_surface_pools(void) {
     sSurfaceNodePool = main_pool_alloc(sSurfaceNodePoolSize * sizeof(struct SurfaceNode), MEMORY_POOL_LEFT);
     sSurfacePool = main_pool_alloc(sSurfacePoolSize * sizeof(struct Surface), MEMORY_POOL_LEFT);
+#ifdef STATIC_SURFACE_TREE
+    sSurfaceTreeNodePool = main_pool_alloc(STATIC_SURFACE_TREE_NODE_POOL_SIZE * sizeof(struct SurfaceTreeNode), MEMORY_POOL_LEFT);
+#endif
+#ifdef PACKED_STATIC_SURFACES
+    gPackedSurfaces.bounds   = main_pool_alloc(PACKED_SURFACE_ENTRY_POOL_SIZE * sizeof(gPackedSurfaces.bounds[0]),   MEMORY_POOL_LEFT);
+    gPackedSurfaces.surfaces = main_pool_alloc(PACKED_SURFACE_ENTRY_POOL_SIZE * sizeof(gPackedSurfaces.surfaces[0]), MEMORY_POOL_LEFT);
+    gPackedSurfaces.type     = main_pool_alloc(PACKED_SURFACE_POOL_SIZE * sizeof(gPackedSurfaces.type[0]),     MEMORY_POOL_LEFT);
+    gPackedSurfaces.flags    = main_pool_alloc(PACKED_SURFACE_POOL_SIZE * sizeof(gPackedSurfaces.flags[0]),    MEMORY_POOL_LEFT);
+    gPackedSurfaces.vertices = main_pool_alloc(PACKED_SURFACE_POOL_SIZE * sizeof(gPackedSurfaces.vertices[0]), MEMORY_POOL_LEFT);
+    gPackedSurfaces.plane    = main_pool_alloc(PACKED_SURFACE_POOL_SIZE * sizeof(gPackedSurfaces.plane[0]),    MEMORY_POOL_LEFT);
+    gStaticSurfacesPacked = FALSE;
+#endif
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+    sDynamicSurfacePool = mem_pool_init(DYNAMIC_SURFACE_POOL_SIZE * sizeof(struct Surface), MEMORY_POOL_LEFT);
+    bzero(sObjectSurfaces, sizeof(sObjectSurfaces));
+    sFreeSurfaceNodes = NULL;
+#endif
 
     gCCMEnteredSlide = FALSE;
     reset_red_coins_collected();
@@ -467,17 +925,30 @@ u32 get_area_terrain_size(TerrainData *data) {
  * Process the level file, loading in vertices, surfaces, some objects, and environmental
  * boxes (water, gas, JRB fog).
  */
-void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16 *macroObjects) {
+void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16 *macroObjects, UNUSED const struct BakedCollision *baked) {
     s32 terrainLoadType;
     TerrainData *vertexData = NULL;
 
     // Initialize the data for this.
     gEnvironmentRegions = NULL;
+#ifdef FIND_FLOOR_CACHE_SIZE
+    gSurfacePartitionVersion++;
+#endif
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+    // Dynamic surface nodes are allocated after the static ones, so objects have to load their surfaces again.
+    free_dynamic_surfaces();
+    clear_spatial_partition(&gDynamicSurfacePartition[0][0]);
+#endif
     gSurfaceNodesAllocated = 0;
     gSurfacesAllocated = 0;
 
     clear_static_surfaces();
 
+#ifdef BAKED_COLLISION
+    // Only the special objects and environment regions still need to be read from the terrain data.
+    sSkipStaticSurfaces = (baked != NULL && load_baked_static_surfaces(baked));
+#endif
+
     // A while loop iterating through each section of the level data. Sections of data
     // are prefixed by a terrain "type." This type is reused for surfaces as the surface
     // type.
@@ -502,6 +973,17 @@ void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16
         }
     }
 
+#ifdef STATIC_SURFACE_TREE
+#ifdef BAKED_COLLISION
+    // Baked collision comes with its quadtrees.
+    if (!sSkipStaticSurfaces)
+#endif
+    build_static_surface_trees();
+#endif
+#ifdef PACKED_STATIC_SURFACES
+    pack_static_surfaces();
+#endif
+
     if (macroObjects != NULL && *macroObjects != -1) {
         // If the first macro object presetID is within the range [0, 29].
         // Generally an early spawning method, every object is in BBH (the first level).
@@ -523,30 +1005,40 @@ void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16
  */
 void clear_dynamic_surfaces(void) {
     if (!(gTimeStopState & TIME_STOP_ACTIVE)) {
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+        free_dynamic_surfaces();
+#endif
         gSurfacesAllocated = gNumStaticSurfaces;
         gSurfaceNodesAllocated = gNumStaticSurfaceNodes;
+#ifdef FIND_FLOOR_CACHE_SIZE
+        gSurfacePartitionVersion++;
+#endif
 
         clear_spatial_partition(&gDynamicSurfacePartition[0][0]);
     }
 }
 
 /**
- * Applies an object's transformation to the object's vertices.
+ * Gets the object's transformation scaled by the object's scale, which its vertices are transformed by.
  */
-void transform_object_vertices(TerrainData **data, TerrainData *vertexData) {
+static void get_object_collision_transform(Mat4 dest) {
     Mat4 *objectTransform = &o->transform;
 
-    register s32 numVertices = *(*data)++;
-
-    register TerrainData *vertices = *data;
-
     if (o->header.gfx.throwMatrix == NULL) {
         o->header.gfx.throwMatrix = objectTransform;
         obj_build_transform_from_pos_and_angle(o, O_POS_INDEX, O_FACE_ANGLE_INDEX);
     }
 
-    Mat4 transform;
-    mtxf_scale_vec3f(transform, *objectTransform, o->header.gfx.scale);
+    mtxf_scale_vec3f(dest, *objectTransform, o->header.gfx.scale);
+}
+
+/**
+ * Applies an object's transformation to the object's vertices.
+ */
+void transform_object_vertices(TerrainData **data, TerrainData *vertexData, Mat4 transform) {
+    register s32 numVertices = *(*data)++;
+
+    register TerrainData *vertices = *data;
 
     // Go through all vertices, rotating and translating them to transform the object.
     Vec3f pos;
@@ -565,8 +1057,10 @@ void transform_object_vertices(TerrainData **data, TerrainData *vertexData) {
 
 /**
  * Load in the surfaces for the o. This includes setting the flags, exertion, and room.
+ * With INCREMENTAL_DYNAMIC_SURFACES, the surfaces are read into the object's dynamic surfaces
+ * at *surfaces instead of being allocated from the surface pool.
  */
-void load_object_surfaces(TerrainData **data, TerrainData *vertexData) {
+void load_object_surfaces(TerrainData **data, TerrainData *vertexData, UNUSED struct Surface **surfaces) {
     s32 i;
 
     s32 surfaceType = *(*data)++;
@@ -583,7 +1077,13 @@ void load_object_surfaces(TerrainData **data, TerrainData *vertexData) {
     RoomData room = (o->behavior == segmented_to_virtual(bhvDddWarp)) ? 5 : 0;
 
     for (i = 0; i < numSurfaces; i++) {
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+        struct Surface *surface = (*surfaces)++;
+
+        read_surface_geometry(surface, vertexData, *data);
+#else
         struct Surface *surface = read_surface_data(vertexData, data);
+#endif
 
         if (surface != NULL) {
             surface->object = o;
@@ -599,7 +1099,7 @@ void load_object_surfaces(TerrainData **data, TerrainData *vertexData) {
             }
 #endif
 
-            surface->flags |= flags;
+            surface->flags = flags;
             surface->room = room;
             add_surface(surface, TRUE);
         }
@@ -616,6 +1116,252 @@ void load_object_surfaces(TerrainData **data, TerrainData *vertexData) {
     }
 }
 
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+/**
+ * Removes a surface from one of the lists of a dynamic cell, keeping its node for reuse.
+ */
+static void remove_surface_from_cell(s32 cellX, s32 cellZ, s32 listIndex, struct Surface *surface) {
+    struct SurfaceNode *list = &gDynamicSurfacePartition[cellZ][cellX][listIndex];
+
+    while (list->next != NULL) {
+        struct SurfaceNode *node = list->next;
+
+        if (node->surface == surface) {
+            list->next = node->next;
+            node->next = sFreeSurfaceNodes;
+            sFreeSurfaceNodes = node;
+            return;
+        }
+
+        list = node;
+    }
+}
+
+/**
+ * Removes a dynamic surface from every cell it was added to.
+ */
+static void remove_dynamic_surface(struct Surface *surface) {
+    struct CellBounds bounds;
+    s32 listIndex = get_surface_list_index(surface);
+    s32 cellZ, cellX;
+
+    get_surface_cell_bounds(surface, &bounds);
+#ifdef FIND_FLOOR_CACHE_SIZE
+    gSurfacePartitionVersion++;
+#endif
+
+    for (cellZ = bounds.minZ; cellZ <= bounds.maxZ; cellZ++) {
+        for (cellX = bounds.minX; cellX <= bounds.maxX; cellX++) {
+            remove_surface_from_cell(cellX, cellZ, listIndex, surface);
+        }
+    }
+}
+
+#define CELL_IN_BOUNDS(bounds, cellX, cellZ) \
+    ((cellX) >= (bounds).minX && (cellX) <= (bounds).maxX && (cellZ) >= (bounds).minZ && (cellZ) <= (bounds).maxZ)
+
+/**
+ * Moves a dynamic surface to its new geometry, only updating the cells it leaves and enters.
+ * Cells it stays in keep its node, unless it moved to a different list or its place in the
+ * list's sort order changed.
+ */
+static void move_dynamic_surface(struct Surface *surface, struct Surface *moved) {
+    struct CellBounds oldBounds, newBounds;
+    s32 oldListIndex = get_surface_list_index(surface);
+    s32 newListIndex = get_surface_list_index(moved);
+    s32 cellZ, cellX;
+
+    // Walls are in insertion order, every other list is sorted by upperY.
+    s32 keepNodes = (oldListIndex == newListIndex
+                     && (newListIndex == SPATIAL_PARTITION_WALLS || surface->upperY == moved->upperY));
+
+    get_surface_cell_bounds(surface, &oldBounds);
+    get_surface_cell_bounds(moved, &newBounds);
+#ifdef FIND_FLOOR_CACHE_SIZE
+    gSurfacePartitionVersion++;
+#endif
+
+    for (cellZ = oldBounds.minZ; cellZ <= oldBounds.maxZ; cellZ++) {
+        for (cellX = oldBounds.minX; cellX <= oldBounds.maxX; cellX++) {
+            if (!keepNodes || !CELL_IN_BOUNDS(newBounds, cellX, cellZ)) {
+                remove_surface_from_cell(cellX, cellZ, oldListIndex, surface);
+            }
+        }
+    }
+
+    *surface = *moved;
+
+    for (cellZ = newBounds.minZ; cellZ <= newBounds.maxZ; cellZ++) {
+        for (cellX = newBounds.minX; cellX <= newBounds.maxX; cellX++) {
+            if (!keepNodes || !CELL_IN_BOUNDS(oldBounds, cellX, cellZ)) {
+                add_surface_to_cell(TRUE, cellX, cellZ, surface);
+            }
+        }
+    }
+}
+
+/**
+ * Moves the object's loaded surfaces to their newly transformed vertices.
+ */
+static void move_object_surfaces(TerrainData *data, TerrainData *vertexData, struct Surface *surfaces) {
+    struct Surface moved;
+    s32 i;
+
+    while (*data != TERRAIN_LOAD_CONTINUE) {
+#ifndef ALL_SURFACES_HAVE_FORCE
+        TerrainData hasForce = surface_has_force(*data);
+#endif
+        s32 numSurfaces = *(++data);
+
+        data++;
+
+        for (i = 0; i < numSurfaces; i++) {
+            moved = *surfaces;
+            read_surface_geometry(&moved, vertexData, data);
+            move_dynamic_surface(surfaces++, &moved);
+
+#ifdef ALL_SURFACES_HAVE_FORCE
+            data += 4;
+#else
+            data += (3 + hasForce);
+#endif
+        }
+    }
+}
+
+/**
+ * Counts the surfaces in an object's collision data, starting after its vertices.
+ */
+static s32 count_object_surfaces(TerrainData *data) {
+    s32 count = 0;
+
+    while (*data != TERRAIN_LOAD_CONTINUE) {
+#ifndef ALL_SURFACES_HAVE_FORCE
+        TerrainData hasForce = surface_has_force(*data);
+#endif
+        s32 numSurfaces = *(++data);
+
+        count += numSurfaces;
+
+#ifdef ALL_SURFACES_HAVE_FORCE
+        data += 1 + (4 * numSurfaces);
+#else
+        data += 1 + ((3 + hasForce) * numSurfaces);
+#endif
+    }
+
+    return count;
+}
+
+/**
+ * Removes an object's surfaces from the dynamic partition and frees them.
+ */
+void unload_object_surfaces(struct Object *obj) {
+    struct DynamicSurfaces **objSurfaces = &sObjectSurfaces[obj - gObjectPool];
+    struct DynamicSurfaces *dynamic = *objSurfaces;
+    s32 i;
+
+    if (dynamic != NULL) {
+        for (i = 0; i < dynamic->numSurfaces; i++) {
+            remove_dynamic_surface(&dynamic->surfaces[i]);
+        }
+
+        gSurfacesAllocated -= dynamic->numSurfaces;
+
+        mem_pool_free(sDynamicSurfacePool, dynamic);
+        *objSurfaces = NULL;
+    }
+}
+
+/**
+ * Unloads the surfaces of every object that didn't load them since the last call,
+ * because it was out of range, in a different room or stopped loading them.
+ */
+void unload_stale_dynamic_surfaces(void) {
+    s32 i;
+
+    if (gTimeStopState & TIME_STOP_ACTIVE) {
+        return;
+    }
+
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        struct DynamicSurfaces *dynamic = sObjectSurfaces[i];
+
+        if (dynamic != NULL) {
+            if (dynamic->loaded) {
+                dynamic->loaded = FALSE;
+            } else {
+                unload_object_surfaces(&gObjectPool[i]);
+            }
+        }
+    }
+}
+
+/**
+ * Loads the object's surfaces into the dynamic partition if they aren't there yet,
+ * or moves them if the object's transform changed since they were loaded.
+ */
+static void load_object_dynamic_surfaces(TerrainData *collisionData, TerrainData *vertexData) {
+    struct DynamicSurfaces *dynamic = sObjectSurfaces[o - gObjectPool];
+    Mat4 transform;
+    s32 i;
+
+    get_object_collision_transform(transform);
+
+    if (dynamic != NULL && dynamic->collisionData != o->collisionData) {
+        unload_object_surfaces(o);
+        dynamic = NULL;
+    }
+
+    if (dynamic != NULL) {
+        dynamic->loaded = TRUE;
+
+        for (i = 0; i < 4; i++) {
+            if (memcmp(dynamic->transform[i], transform[i], sizeof(dynamic->transform[i])) != 0) {
+                break;
+            }
+        }
+
+        // The surfaces are already where the transform puts them.
+        if (i == 4) {
+            return;
+        }
+    }
+
+    collisionData++;
+    transform_object_vertices(&collisionData, vertexData, transform);
+
+    if (dynamic == NULL) {
+        s32 numSurfaces = count_object_surfaces(collisionData);
+
+        dynamic = mem_pool_alloc(sDynamicSurfacePool, sizeof(struct DynamicSurfaces) + (numSurfaces * sizeof(struct Surface)));
+        if (dynamic == NULL) {
+            gSurfacePoolError |= NOT_ENOUGH_ROOM_FOR_SURFACES;
+            return;
+        }
+
+        dynamic->collisionData = o->collisionData;
+        dynamic->numSurfaces = numSurfaces;
+        dynamic->loaded = TRUE;
+        sObjectSurfaces[o - gObjectPool] = dynamic;
+        gSurfacesAllocated += numSurfaces;
+
+        struct Surface *surfaces = dynamic->surfaces;
+
+        // TERRAIN_LOAD_CONTINUE acts as an "end" to the terrain data.
+        while (*collisionData != TERRAIN_LOAD_CONTINUE) {
+            load_object_surfaces(&collisionData, vertexData, &surfaces);
+        }
+    } else {
+        move_object_surfaces(collisionData, vertexData, dynamic->surfaces);
+    }
+
+    for (i = 0; i < 4; i++) {
+        vec3f_copy(dynamic->transform[i], transform[i]);
+    }
+}
+#endif
+
 #ifdef AUTO_COLLISION_DISTANCE
 static void get_optimal_coll_dist(struct Object *obj) {
     register f32 thisVertDist, maxDist = 0.0f;
@@ -668,13 +1414,21 @@ void load_object_collision_model(void) {
         && (marioDist < o->oCollisionDistance)
         && !(o->activeFlags & ACTIVE_FLAG_IN_DIFFERENT_ROOM)
     ) {
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+        load_object_dynamic_surfaces(collisionData, vertexData);
+#else
+        Mat4 transform;
+
+        get_object_collision_transform(transform);
+
         collisionData++;
-        transform_object_vertices(&collisionData, vertexData);
+        transform_object_vertices(&collisionData, vertexData, transform);
 
         // TERRAIN_LOAD_CONTINUE acts as an "end" to the terrain data.
         while (*collisionData != TERRAIN_LOAD_CONTINUE) {
-            load_object_surfaces(&collisionData, vertexData);
+            load_object_surfaces(&collisionData, vertexData, NULL);
         }
+#endif
     }
     COND_BIT((marioDist < o->oDrawingDistance), o->header.gfx.node.flags, GRAPH_RENDER_ACTIVE);
 }
@@ -12,6 +12,9 @@
 #define NORMAL_CEIL_THRESHOLD -NORMAL_FLOOR_THRESHOLD
 
 extern u8 gSurfacePoolError;
+#ifdef FIND_FLOOR_CACHE_SIZE
+extern u32 gSurfacePartitionVersion;
+#endif
 
 struct SurfaceNode {
     struct SurfaceNode *next;
@@ -30,6 +33,109 @@ typedef struct SurfaceNode SpatialPartitionCell[NUM_SPATIAL_PARTITIONS];
 
 extern SpatialPartitionCell gStaticSurfacePartition[NUM_CELLS][NUM_CELLS];
 extern SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
+
+#ifdef PACKED_STATIC_SURFACES
+// Water is rare enough that it always uses the cell lists.
+#define NUM_PACKED_PARTITIONS (SPATIAL_PARTITION_WALLS + 1)
+
+/**
+ * A run of entries in gPackedSurfaces, in the same order as the list it was packed from.
+ */
+struct PackedSurfaceRange {
+    u16 start;
+    u16 count;
+};
+
+/**
+ * The static surfaces of the area in structure-of-arrays form, built once they are all loaded.
+ * Entries are the surface lists back to back, each with a copy of its surface's height bounds,
+ * so the rest of a surface is only read once it passes the height check.
+ */
+struct PackedSurfaces {
+    // Per entry.
+    s16 (*bounds)[2]; // lowerY, upperY
+    u16 *surfaces;    // Index of the surface in sSurfacePool.
+    // Per surface, indexed the same as sSurfacePool.
+    TerrainData *type;
+    s8 *flags;
+    Vec3t (*vertices)[3];
+    f32 (*plane)[4]; // normal.x, normal.y, normal.z, originOffset
+};
+
+extern struct PackedSurfaces gPackedSurfaces;
+extern struct PackedSurfaceRange gStaticPackedRanges[NUM_CELLS][NUM_CELLS][NUM_PACKED_PARTITIONS];
+// Whether the current area's static surfaces fit in gPackedSurfaces.
+extern u8 gStaticSurfacesPacked;
+#endif
+
+#ifdef STATIC_SURFACE_TREE
+// Only floors and ceilings are split, walls and water always use the cell lists.
+#define NUM_SURFACE_TREE_PARTITIONS (SPATIAL_PARTITION_CEILS + 1)
+
+/**
+ * A quadtree node covering a square part of a static cell. Children are stored
+ * consecutively in the order (-X -Z), (+X -Z), (-X +Z), (+X +Z).
+ */
+struct SurfaceTreeNode {
+    u16 children; // Index of the first child in sSurfaceTreeNodePool, 0 for leaves.
+    u16 numSurfaces;
+    struct SurfaceNode *list; // The surfaces overlapping this node, in cell list order.
+#ifdef PACKED_STATIC_SURFACES
+    struct PackedSurfaceRange packed; // The same surfaces in gPackedSurfaces, only set for leaves.
+#endif
+};
+
+// Index of each cell's root node in sSurfaceTreeNodePool, 0 for cells that aren't split.
+extern u16 gStaticSurfaceTreeRoots[NUM_CELLS][NUM_CELLS][NUM_SURFACE_TREE_PARTITIONS];
+extern struct SurfaceTreeNode *sSurfaceTreeNodePool;
+extern s32 gSurfaceTreeNodesAllocated;
+#endif
+
+#ifdef BAKED_COLLISION
+/**
+ * A static surface list in baked collision. The nodes of every list are stored back to back.
+ */
+struct BakedSurfaceList {
+    u16 cell;  // ((cellZ * NUM_CELLS) + cellX) * NUM_SPATIAL_PARTITIONS + listIndex, or BAKED_TREE_LIST.
+    u16 count;
+};
+
+// The list belongs to a quadtree node instead of a cell.
+#define BAKED_TREE_LIST 0xFFFF
+
+#ifdef STATIC_SURFACE_TREE
+struct BakedSurfaceTreeNode {
+    u16 children;
+    u16 numSurfaces;
+    u32 list; // Index of the first node of the list.
+};
+
+struct BakedSurfaceTreeRoot {
+    u16 cell; // ((cellZ * NUM_CELLS) + cellX) * NUM_SURFACE_TREE_PARTITIONS + listIndex
+    u16 node;
+};
+#endif
+
+/**
+ * An area's static surfaces and partition, as built by load_area_terrain, generated at build time
+ * by tools/collision_bench/bake_collision. Only valid for the collision config it was baked with.
+ */
+struct BakedCollision {
+    s32 numSurfaces;
+    s32 numNodes;
+    s32 numLists;
+    const struct Surface *surfaces;
+    const u16 *nodes; // The index of each node's surface.
+    const struct BakedSurfaceList *lists;
+#ifdef STATIC_SURFACE_TREE
+    s32 numTreeNodes;
+    s32 numTreeRoots;
+    const struct BakedSurfaceTreeNode *treeNodes; // Starts at node 1, like sSurfaceTreeNodePool.
+    const struct BakedSurfaceTreeRoot *treeRoots;
+#endif
+};
+#endif
+
 extern struct SurfaceNode *sSurfaceNodePool;
 extern struct Surface *sSurfacePool;
 extern s32 sSurfaceNodePoolSize;
@@ -39,8 +145,13 @@ void alloc_surface_pools(void);
 #ifdef NO_SEGMENTED_MEMORY
 u32 get_area_terrain_size(TerrainData *data);
 #endif
-void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, MacroObject *macroObjects);
+struct BakedCollision;
+void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, MacroObject *macroObjects, const struct BakedCollision *baked);
 void clear_dynamic_surfaces(void);
 void load_object_collision_model(void);
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+void unload_object_surfaces(struct Object *obj);
+void unload_stale_dynamic_surfaces(void);
+#endif
 
 #endif // SURFACE_LOAD_H
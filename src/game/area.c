@@ -190,6 +190,7 @@ void clear_areas(void) {
         gAreaData[i].terrainType = TERRAIN_GRASS;
         gAreaData[i].graphNode = NULL;
         gAreaData[i].terrainData = NULL;
+        gAreaData[i].bakedTerrain = NULL;
         gAreaData[i].surfaceRooms = NULL;
         gAreaData[i].macroObjects = NULL;
         gAreaData[i].warpNodes = NULL;
@@ -235,7 +236,7 @@ void load_area(s32 index) {
 
         if (gCurrentArea->terrainData != NULL) {
             load_area_terrain(index, gCurrentArea->terrainData, gCurrentArea->surfaceRooms,
-                              gCurrentArea->macroObjects);
+                              gCurrentArea->macroObjects, gCurrentArea->bakedTerrain);
         }
 
         if (gCurrentArea->objectSpawnInfos != NULL) {
@@ -378,7 +379,9 @@ void play_transition_after_delay(s16 transType, s16 time, u8 red, u8 green, u8 b
 void render_game(void) {
     if (gCurrentArea != NULL && !gWarpTransition.pauseRendering) {
         if (gCurrentArea->graphNode) {
+            profiler_trace_begin(PROFILER_TRACE_GRAPH, 0);
             geo_process_root(gCurrentArea->graphNode, gViewportOverride, gViewportClip, gFBSetColor);
+            profiler_trace_end(PROFILER_TRACE_GRAPH);
         }
 
         gSPViewport(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(&gViewport));
@@ -77,6 +77,7 @@ struct Area {
     /*0x34*/ u8 dialog[2]; // Level start dialog number (set by level script cmd 0x30)
     /*0x36*/ u16 musicParam;
     /*0x38*/ u16 musicParam2;
+    /*0x3C*/ const struct BakedCollision *bakedTerrain; // prebuilt surfaces for terrainData (set from level script cmd 0x2E with TERRAIN_BAKED)
 };
 
 // All the transition data to be used in screen_transition.c
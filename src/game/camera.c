@@ -1954,9 +1954,12 @@ s16 update_default_camera(struct Camera *c) {
     Vec3f tempPos;
     Vec3f cPos;
     struct Surface *marioFloor;
-    struct Surface *cFloor;
-    struct Surface *tempFloor;
     struct Surface *ceil;
+    // The point under the camera, then points along the line from the camera to Mario.
+    Vec3f floorPoints[6];
+    struct FloorResult floors[6];
+    s32 numFloorPoints = 0;
+    s32 i;
     f32 camFloorHeight;
     f32 tempFloorHeight;
     f32 marioFloorHeight;
@@ -2139,13 +2142,18 @@ s16 update_default_camera(struct Camera *c) {
 
     marioFloorHeight = 125.f + sMarioGeometry.currFloorHeight;
     marioFloor = sMarioGeometry.currFloor;
-    camFloorHeight = find_floor(cPos[0], cPos[1] + 50.f, cPos[2], &cFloor) + 125.f;
+    vec3f_set(floorPoints[numFloorPoints++], cPos[0], cPos[1] + 50.f, cPos[2]);
     for (scale = 0.1f; scale < 1.f; scale += 0.2f) {
-        scale_along_line(tempPos, cPos, sMarioCamState->pos, scale);
-        tempFloorHeight = find_floor(tempPos[0], tempPos[1], tempPos[2], &tempFloor) + 125.f;
-        if (tempFloor != NULL && tempFloorHeight > marioFloorHeight) {
+        scale_along_line(floorPoints[numFloorPoints++], cPos, sMarioCamState->pos, scale);
+    }
+    find_floors_batch(floorPoints, numFloorPoints, floors);
+
+    camFloorHeight = floors[0].height + 125.f;
+    for (i = 1; i < numFloorPoints; i++) {
+        tempFloorHeight = floors[i].height + 125.f;
+        if (floors[i].floor != NULL && tempFloorHeight > marioFloorHeight) {
             marioFloorHeight = tempFloorHeight;
-            marioFloor = tempFloor;
+            marioFloor = floors[i].floor;
         }
     }
 
@@ -188,9 +188,9 @@ s16 find_mario_anim_flags_and_translation(struct Object *obj, s32 yaw, Vec3s tra
     f32 s = (f32) sins(yaw);
     f32 c = (f32) coss(yaw);
 
-    dx = *(animValues + (retrieve_animation_index(animFrame, &animIndex))) / 4.0f;
-    translation[1] = *(animValues + (retrieve_animation_index(animFrame, &animIndex))) / 4.0f;
-    dz = *(animValues + (retrieve_animation_index(animFrame, &animIndex))) / 4.0f;
+    dx = retrieve_animation_value(animFrame, &animIndex, animValues, curAnim->flags) / 4.0f;
+    translation[1] = retrieve_animation_value(animFrame, &animIndex, animValues, curAnim->flags) / 4.0f;
+    dz = retrieve_animation_value(animFrame, &animIndex, animValues, curAnim->flags) / 4.0f;
 
     translation[0] = ( dx * c) + (dz * s);
     translation[2] = (-dx * s) + (dz * c);
@@ -612,7 +612,6 @@ f32 find_floor_height_relative_polar(struct MarioState *m, s16 angleFromMario, f
  * Returns the slope of the floor based off points around Mario.
  */
 s16 find_floor_slope(struct MarioState *m, s16 yawOffset) {
-    struct Surface *floor = m->floor;
     f32 forwardFloorY, backwardFloorY;
     f32 forwardYDelta, backwardYDelta;
     s16 result;
@@ -621,20 +620,22 @@ s16 find_floor_slope(struct MarioState *m, s16 yawOffset) {
     f32 z = coss(m->faceAngle[1] + yawOffset) * 5.0f;
 #ifdef FAST_FLOOR_ALIGN
     if (absf(m->forwardVel) > FAST_FLOOR_ALIGN) {
-        forwardFloorY  = get_surface_height_at_location(m->pos[0] + x, m->pos[2] + z, floor);
-        backwardFloorY = get_surface_height_at_location(m->pos[0] - x, m->pos[2] - z, floor);
-    } else {
-        forwardFloorY  = find_floor(m->pos[0] + x, m->pos[1] + 100.0f, m->pos[2] + z, &floor);
-        if (floor == NULL)  forwardFloorY = m->floorHeight; // handle OOB slopes
-        backwardFloorY = find_floor(m->pos[0] - x, m->pos[1] + 100.0f, m->pos[2] - z, &floor);
-        if (floor == NULL) backwardFloorY = m->floorHeight; // handle OOB slopes
-    }
-#else
-    forwardFloorY  = find_floor(m->pos[0] + x, m->pos[1] + 100.0f, m->pos[2] + z, &floor);
-    if (floor == NULL)  forwardFloorY = m->floorHeight; // handle OOB slopes
-    backwardFloorY = find_floor(m->pos[0] - x, m->pos[1] + 100.0f, m->pos[2] - z, &floor);
-    if (floor == NULL) backwardFloorY = m->floorHeight; // handle OOB slopes
+        forwardFloorY  = get_surface_height_at_location(m->pos[0] + x, m->pos[2] + z, m->floor);
+        backwardFloorY = get_surface_height_at_location(m->pos[0] - x, m->pos[2] - z, m->floor);
+    } else
 #endif
+    {
+        Vec3f points[2];
+        struct FloorResult floors[2];
+
+        vec3f_set(points[0], m->pos[0] + x, m->pos[1] + 100.0f, m->pos[2] + z);
+        vec3f_set(points[1], m->pos[0] - x, m->pos[1] + 100.0f, m->pos[2] - z);
+        find_floors_batch(points, 2, floors);
+
+        // handle OOB slopes
+        forwardFloorY  = (floors[0].floor != NULL) ? floors[0].height : m->floorHeight;
+        backwardFloorY = (floors[1].floor != NULL) ? floors[1].height : m->floorHeight;
+    }
 
     forwardYDelta = forwardFloorY - m->pos[1];
     backwardYDelta = m->pos[1] - backwardFloorY;
@@ -162,7 +162,283 @@ void check_destructive_object_collision(void) {
     }
 }
 
+#ifdef OBJECT_COLLISION_GRID
+/**
+ * A uniform grid over the tangible objects of every list checked for collisions, built once
+ * per frame so each object is only checked against the objects near it. Cells are hashed into
+ * OBJECT_GRID_NUM_BUCKETS buckets, and objects that don't fit in 2x2 cells are kept apart and
+ * checked against everything.
+ */
+#define OBJECT_GRID_CELL_SHIFT  9 // 512 unit cells
+#define OBJECT_GRID_BUCKET_BITS 4 // 16x16 buckets, repeating every 8192 units
+#define OBJECT_GRID_NUM_BUCKETS (1 << (OBJECT_GRID_BUCKET_BITS * 2))
+#define OBJECT_GRID_MAX_CELLS   4
+#define OBJECT_GRID_COORD_LIMIT 1048576.0f
+#define OBJECT_GRID_NONE        -1
+
+// Object indices, positions in a list and check stamps are u16: there is at most one check per
+// object, and an object pool that fits in RAM has far fewer than 0x10000 objects.
+
+#define OBJECT_GRID_BUCKET_MASK ((1 << OBJECT_GRID_BUCKET_BITS) - 1)
+#define OBJECT_GRID_BUCKET(cellX, cellZ) \
+    (((cellX) & OBJECT_GRID_BUCKET_MASK) | (((cellZ) & OBJECT_GRID_BUCKET_MASK) << OBJECT_GRID_BUCKET_BITS))
+
+struct ObjectGridEntry {
+    s32 next;
+    u16 object; // Index of the object in gObjectPool.
+};
+
+struct ObjectGridInfo {
+    u8 list;   // The object list the object is in.
+    u16 order; // The object's position in its list.
+    u16 stamp; // The last check the object was a candidate for, so objects in several cells are only checked once.
+};
+
+struct ObjectGridBounds {
+    s32 minX, maxX;
+    s32 minZ, maxZ;
+};
+
+static s32 sObjectGridBuckets[OBJECT_GRID_NUM_BUCKETS];
+static struct ObjectGridEntry sObjectGridEntries[OBJECT_POOL_CAPACITY * OBJECT_GRID_MAX_CELLS];
+static struct ObjectGridInfo sObjectGridInfo[OBJECT_POOL_CAPACITY];
+static u16 sLargeObjects[OBJECT_POOL_CAPACITY];
+static s32 sNumLargeObjects;
+static s32 sNumObjectGridEntries;
+static u16 sObjectGridStamp;
+
+/**
+ * The objects to check an object against, sorted in the order the object lists would check them.
+ */
+static struct Object *sGridCandidates[OBJECT_POOL_CAPACITY];
+static s32 sGridCandidateKeys[OBJECT_POOL_CAPACITY];
+static s32 sNumGridCandidates;
+
+// The lists each kind of object is checked against, in order. Objects are only checked
+// against the objects after them in their own list, which is always the first one.
+static const u8 sPlayerCollisionLists[] = {
+    OBJ_LIST_PLAYER, OBJ_LIST_POLELIKE, OBJ_LIST_LEVEL, OBJ_LIST_GENACTOR,
+    OBJ_LIST_PUSHABLE, OBJ_LIST_SURFACE, OBJ_LIST_DESTRUCTIVE,
+};
+static const u8 sDestructiveCollisionLists[] = {
+    OBJ_LIST_DESTRUCTIVE, OBJ_LIST_GENACTOR, OBJ_LIST_PUSHABLE, OBJ_LIST_SURFACE,
+};
+static const u8 sPushableCollisionLists[] = {
+    OBJ_LIST_PUSHABLE,
+};
+
+/**
+ * Finds the cells an object's hitbox overlaps. Returns whether it fits in the grid.
+ */
+static s32 get_object_grid_bounds(struct Object *obj, struct ObjectGridBounds *bounds) {
+    // Hitboxes overlap if their radii summed are larger than their distance, so use the
+    // absolute radius in case of a negative one.
+    f32 radius = absf(obj->hitboxRadius);
+    f32 x = obj->oPosX;
+    f32 z = obj->oPosZ;
+
+    // Written so NaN doesn't fit either. Those objects are checked against everything, like the lists do.
+    if (!(radius < OBJECT_GRID_COORD_LIMIT)
+        || !(x > -OBJECT_GRID_COORD_LIMIT && x < OBJECT_GRID_COORD_LIMIT)
+        || !(z > -OBJECT_GRID_COORD_LIMIT && z < OBJECT_GRID_COORD_LIMIT)) {
+        return FALSE;
+    }
+
+    bounds->minX = ((s32) (x - radius) >> OBJECT_GRID_CELL_SHIFT);
+    bounds->maxX = ((s32) (x + radius) >> OBJECT_GRID_CELL_SHIFT);
+    bounds->minZ = ((s32) (z - radius) >> OBJECT_GRID_CELL_SHIFT);
+    bounds->maxZ = ((s32) (z + radius) >> OBJECT_GRID_CELL_SHIFT);
+
+    return (((bounds->maxX - bounds->minX + 1) * (bounds->maxZ - bounds->minZ + 1)) <= OBJECT_GRID_MAX_CELLS);
+}
+
+/**
+ * clear_object_collision, which also adds the list's tangible objects to the grid. Intangibility
+ * timers run out in here, so the grid matches what the list checks would see.
+ */
+static void clear_object_collision_into_grid(s32 list) {
+    struct Object *listHead = (struct Object *) &gObjectLists[list];
+    struct Object *obj = (struct Object *) listHead->header.next;
+    struct ObjectGridBounds bounds;
+    s32 order = 0;
+    s32 cellX, cellZ;
+
+    for (; obj != listHead; obj = (struct Object *) obj->header.next) {
+        s32 index = (obj - gObjectPool);
+        struct ObjectGridInfo *info = &sObjectGridInfo[index];
+
+        obj->numCollidedObjs = 0;
+        obj->collidedObjInteractTypes = 0;
+        if (obj->oIntangibleTimer > 0) {
+            obj->oIntangibleTimer--;
+        }
+
+        info->list = list;
+        info->order = order++;
+        info->stamp = 0;
+
+        if (obj->oIntangibleTimer != 0) {
+            continue;
+        }
+
+        if (!get_object_grid_bounds(obj, &bounds)) {
+            sLargeObjects[sNumLargeObjects++] = index;
+            continue;
+        }
+
+        for (cellZ = bounds.minZ; cellZ <= bounds.maxZ; cellZ++) {
+            for (cellX = bounds.minX; cellX <= bounds.maxX; cellX++) {
+                s32 bucket = OBJECT_GRID_BUCKET(cellX, cellZ);
+
+                sObjectGridEntries[sNumObjectGridEntries].object = index;
+                sObjectGridEntries[sNumObjectGridEntries].next = sObjectGridBuckets[bucket];
+                sObjectGridBuckets[bucket] = sNumObjectGridEntries++;
+            }
+        }
+    }
+}
+
+/**
+ * Clears the collisions of every list checked for collisions and adds their objects to the grid.
+ */
+static void build_object_collision_grid(void) {
+    s32 i;
+
+    for (i = 0; i < OBJECT_GRID_NUM_BUCKETS; i++) {
+        sObjectGridBuckets[i] = OBJECT_GRID_NONE;
+    }
+    sNumObjectGridEntries = 0;
+    sNumLargeObjects = 0;
+    sObjectGridStamp = 0;
+
+    // Same order as detect_object_collisions clears them in.
+    clear_object_collision_into_grid(OBJ_LIST_POLELIKE);
+    clear_object_collision_into_grid(OBJ_LIST_PLAYER);
+    clear_object_collision_into_grid(OBJ_LIST_PUSHABLE);
+    clear_object_collision_into_grid(OBJ_LIST_GENACTOR);
+    clear_object_collision_into_grid(OBJ_LIST_LEVEL);
+    clear_object_collision_into_grid(OBJ_LIST_SURFACE);
+    clear_object_collision_into_grid(OBJ_LIST_DESTRUCTIVE);
+}
+
+/**
+ * Adds an object to the candidates of the current check, if it is in one of the checked lists.
+ * @param ranks The position of each list in the checked lists, 0xFF if it isn't checked.
+ * @param minOrder Objects in the first list have to come after this position.
+ */
+static void add_grid_candidate(s32 index, const u8 *ranks, s32 minOrder) {
+    struct ObjectGridInfo *info = &sObjectGridInfo[index];
+    s32 rank, key, i;
+
+    if (info->stamp == sObjectGridStamp) {
+        return;
+    }
+    info->stamp = sObjectGridStamp;
+
+    rank = ranks[info->list];
+    if (rank == 0xFF || (rank == 0 && info->order <= minOrder)) {
+        return;
+    }
+
+    // Insertion sort by list, then position in the list.
+    key = ((rank << 16) | info->order);
+    for (i = sNumGridCandidates; i > 0 && sGridCandidateKeys[i - 1] > key; i--) {
+        sGridCandidates[i] = sGridCandidates[i - 1];
+        sGridCandidateKeys[i] = sGridCandidateKeys[i - 1];
+    }
+    sGridCandidates[i] = &gObjectPool[index];
+    sGridCandidateKeys[i] = key;
+    sNumGridCandidates++;
+}
+
+/**
+ * Checks an object against the objects of the given lists near it, in the same order as
+ * calling check_collision_in_list for each list.
+ */
+static void check_collision_in_grid(struct Object *a, const u8 *lists, s32 numLists) {
+    struct ObjectGridBounds bounds;
+    u8 ranks[NUM_OBJ_LISTS];
+    s32 i, entry, cellX, cellZ;
+
+    if (a->oIntangibleTimer != 0) {
+        return;
+    }
+
+    if (!get_object_grid_bounds(a, &bounds)) {
+        check_collision_in_list(a, (struct Object *) a->header.next, (struct Object *) &gObjectLists[lists[0]]);
+        for (i = 1; i < numLists; i++) {
+            check_collision_in_list(a, (struct Object *) gObjectLists[lists[i]].next, (struct Object *) &gObjectLists[lists[i]]);
+        }
+        return;
+    }
+
+    for (i = 0; i < NUM_OBJ_LISTS; i++) {
+        ranks[i] = 0xFF;
+    }
+    for (i = 0; i < numLists; i++) {
+        ranks[lists[i]] = i;
+    }
+
+    sObjectGridStamp++;
+    sNumGridCandidates = 0;
+    s32 minOrder = sObjectGridInfo[a - gObjectPool].order;
+
+    for (cellZ = bounds.minZ; cellZ <= bounds.maxZ; cellZ++) {
+        for (cellX = bounds.minX; cellX <= bounds.maxX; cellX++) {
+            entry = sObjectGridBuckets[OBJECT_GRID_BUCKET(cellX, cellZ)];
+
+            for (; entry != OBJECT_GRID_NONE; entry = sObjectGridEntries[entry].next) {
+                add_grid_candidate(sObjectGridEntries[entry].object, ranks, minOrder);
+            }
+        }
+    }
+
+    for (i = 0; i < sNumLargeObjects; i++) {
+        add_grid_candidate(sLargeObjects[i], ranks, minOrder);
+    }
+
+    // Every candidate is tangible, see build_object_collision_grid.
+    for (i = 0; i < sNumGridCandidates; i++) {
+        struct Object *b = sGridCandidates[i];
+
+        if (detect_object_hitbox_overlap(a, b) && b->hurtboxRadius != 0.0f) {
+            detect_object_hurtbox_overlap(a, b);
+        }
+    }
+}
+
+/**
+ * check_player_object_collision, check_destructive_object_collision and
+ * check_pushable_object_collision, using the grid.
+ */
+static void check_object_collisions_in_grid(void) {
+    struct Object *listHead;
+    struct Object *obj;
+
+    listHead = (struct Object *) &gObjectLists[OBJ_LIST_PLAYER];
+    for (obj = (struct Object *) listHead->header.next; obj != listHead; obj = (struct Object *) obj->header.next) {
+        check_collision_in_grid(obj, sPlayerCollisionLists, ARRAY_COUNT(sPlayerCollisionLists));
+    }
+
+    listHead = (struct Object *) &gObjectLists[OBJ_LIST_DESTRUCTIVE];
+    for (obj = (struct Object *) listHead->header.next; obj != listHead; obj = (struct Object *) obj->header.next) {
+        if (obj->oDistanceToMario < 2000.0f && !(obj->activeFlags & ACTIVE_FLAG_DESTRUCTIVE_OBJ_DONT_DESTROY)) {
+            check_collision_in_grid(obj, sDestructiveCollisionLists, ARRAY_COUNT(sDestructiveCollisionLists));
+        }
+    }
+
+    listHead = (struct Object *) &gObjectLists[OBJ_LIST_PUSHABLE];
+    for (obj = (struct Object *) listHead->header.next; obj != listHead; obj = (struct Object *) obj->header.next) {
+        check_collision_in_grid(obj, sPushableCollisionLists, ARRAY_COUNT(sPushableCollisionLists));
+    }
+}
+#endif
+
 void detect_object_collisions(void) {
+#ifdef OBJECT_COLLISION_GRID
+    build_object_collision_grid();
+    check_object_collisions_in_grid();
+#else
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_POLELIKE]);
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PLAYER]);
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PUSHABLE]);
@@ -173,4 +449,5 @@ void detect_object_collisions(void) {
     check_player_object_collision();
     check_destructive_object_collision();
     check_pushable_object_collision();
+#endif
 }
@@ -122,6 +122,35 @@ Gfx *geo_switch_anim_state(s32 callContext, struct GraphNode *node, UNUSED void
     return NULL;
 }
 
+/**
+ * Sets gMarioCurrentRoom to the room of the floor Mario is on, and returns that floor.
+ * Returns NULL and leaves the room unchanged if there is no Mario or no floor.
+ */
+struct Surface *update_mario_current_room(void) {
+    struct Surface *floor;
+
+    if (gMarioObject == NULL) {
+        return NULL;
+    }
+
+#ifdef ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS
+    if (gCurrLevelNum == LEVEL_BBH) {
+        // In BBH, check for a floor manually, since there is an intangible floor. In custom hacks this can be removed.
+        find_room_floor(gMarioObject->oPosX, gMarioObject->oPosY, gMarioObject->oPosZ, &floor);
+    } else {
+        // Since no intangible floors are nearby, use Mario's floor instead.
+        floor = gMarioState->floor;
+    }
+#else
+    floor = gMarioState->floor;
+#endif
+    if (floor) {
+        gMarioCurrentRoom = floor->room;
+    }
+
+    return floor;
+}
+
 Gfx *geo_switch_area(s32 callContext, struct GraphNode *node, UNUSED void *context) {
     struct Surface *floor;
     struct GraphNodeSwitchCase *switchCase = (struct GraphNodeSwitchCase *) node;
@@ -130,19 +159,8 @@ Gfx *geo_switch_area(s32 callContext, struct GraphNode *node, UNUSED void *conte
         if (gMarioObject == NULL) {
             switchCase->selectedCase = 0;
         } else {
-#ifdef ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS
-            if (gCurrLevelNum == LEVEL_BBH) {
-                // In BBH, check for a floor manually, since there is an intangible floor. In custom hacks this can be removed.
-                find_room_floor(gMarioObject->oPosX, gMarioObject->oPosY, gMarioObject->oPosZ, &floor);
-            } else {
-                // Since no intangible floors are nearby, use Mario's floor instead.
-                floor = gMarioState->floor;
-            }
-#else
-            floor = gMarioState->floor;
-#endif
+            floor = update_mario_current_room();
             if (floor) {
-                gMarioCurrentRoom = floor->room;
                 s16 roomCase = floor->room - 1;
                 print_debug_top_down_objectinfo("areainfo %d", floor->room);
 
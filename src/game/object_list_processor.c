@@ -294,7 +294,9 @@ s32 update_objects_starting_at(struct ObjectNode *objList, struct ObjectNode *fi
         gCurrentObject = (struct Object *) firstObj;
 
         gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
+        profiler_trace_begin(PROFILER_TRACE_BEHAVIOR, (uintptr_t) gCurrentObject->behavior);
         cur_obj_update();
+        profiler_trace_end(PROFILER_TRACE_BEHAVIOR);
 
         firstObj = firstObj->next;
         count++;
@@ -341,7 +343,9 @@ s32 update_objects_during_time_stop(struct ObjectNode *objList, struct ObjectNod
         // Only update if unfrozen
         if (unfrozen) {
             gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
+            profiler_trace_begin(PROFILER_TRACE_BEHAVIOR, (uintptr_t) gCurrentObject->behavior);
             cur_obj_update();
+            profiler_trace_end(PROFILER_TRACE_BEHAVIOR);
         } else {
             gCurrentObject->header.gfx.node.flags &= ~GRAPH_RENDER_HAS_ANIMATION;
         }
@@ -541,6 +545,9 @@ void clear_objects(void) {
     gObjectLists = gObjectListArray;
 
     clear_dynamic_surfaces();
+#ifdef BEHAVIOR_SCRIPT_PREDECODE
+    clear_bhv_loops();
+#endif
 }
 
 /**
@@ -616,6 +623,7 @@ UNUSED static u16 unused_get_elapsed_time(u64 *cycleCounts, s32 index) {
  * and object surface management.
  */
 void update_objects(UNUSED s32 unused) {
+    profiler_trace_begin(PROFILER_TRACE_OBJECTS, 0);
 
     gTimeStopState &= ~TIME_STOP_MARIO_OPENED_DOOR;
 
@@ -628,11 +636,19 @@ void update_objects(UNUSED s32 unused) {
 
     gObjectLists = gObjectListArray;
 
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+    // Update spawners and objects with surfaces, which keep their surfaces loaded until they move
+    update_terrain_objects();
+
+    // If time stop is not active, unload the surfaces of objects that didn't load them
+    unload_stale_dynamic_surfaces();
+#else
     // If time stop is not active, unload object surfaces
     clear_dynamic_surfaces();
 
     // Update spawners and objects with surfaces
     update_terrain_objects();
+#endif
 
     // If Mario was touching a moving platform at the end of last frame, apply
     // displacement now
@@ -641,7 +657,9 @@ void update_objects(UNUSED s32 unused) {
     apply_mario_platform_displacement();
 
     // Detect which objects are intersecting
+    profiler_trace_begin(PROFILER_TRACE_COLLISION, 0);
     detect_object_collisions();
+    profiler_trace_end(PROFILER_TRACE_COLLISION);
 
     // Update all other objects that haven't been updated yet
     update_non_terrain_objects();
@@ -665,4 +683,5 @@ void update_objects(UNUSED s32 unused) {
     gPrevFrameObjectCount = gObjectCounter;
     
     profiler_update(PROFILER_TIME_BEHAVIOR_AFTER_MARIO);
+    profiler_trace_end(PROFILER_TRACE_OBJECTS);
 }
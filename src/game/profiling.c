@@ -1,6 +1,10 @@
 #include <ultra64.h>
 #include <PR/os_internal_reg.h>
 #include "game_init.h"
+#include "main.h"
+#ifdef UNF
+#include "usb/usb.h"
+#endif
 
 #include "profiling.h"
 #include "fasttext.h"
@@ -27,6 +31,81 @@ u32 audio_start;
 u32 audio_buffer_index;
 u32 preempted_time;
 
+#ifdef PROFILER_TRACE
+static struct ProfilerTrace sProfilerTraces[2];
+static struct ProfilerTrace *sCurTrace = &sProfilerTraces[0];
+static u32 sTraceFrameStartVblank;
+
+/**
+ * The most recent frame that took longer than two vblanks. Events are recorded into the other buffer
+ * until the next slow frame replaces it.
+ */
+struct ProfilerTrace *gProfilerTraceSlowFrame = NULL;
+
+static void trace_add_event(enum ProfilerTraceZone zone, u32 isEnd, u32 arg) {
+    // Events come from the game and audio threads and from the scheduler.
+    u32 saved = __osDisableInt();
+    struct ProfilerTrace *trace = sCurTrace;
+
+    if (trace->numEvents < PROFILER_TRACE_BUFFER_SIZE) {
+        struct ProfilerTraceEvent *event = &trace->events[trace->numEvents++];
+
+        event->time = osGetCount();
+        event->zone = zone;
+        event->isEnd = isEnd;
+        event->pad = 0;
+        event->arg = arg;
+    } else {
+        trace->numDropped++;
+    }
+
+    __osRestoreInt(saved);
+}
+
+void profiler_trace_begin(enum ProfilerTraceZone zone, u32 arg) {
+    trace_add_event(zone, FALSE, arg);
+}
+
+void profiler_trace_end(enum ProfilerTraceZone zone) {
+    trace_add_event(zone, TRUE, 0);
+}
+
+static void trace_next_frame() {
+    struct ProfilerTrace *trace = sCurTrace;
+    struct ProfilerTrace *next;
+
+    // Nothing has been recorded before the first frame.
+    if (trace->magic == PROFILER_TRACE_MAGIC) {
+        profiler_trace_end(PROFILER_TRACE_FRAME);
+
+        if (gNumVblanks - sTraceFrameStartVblank > 2) {
+            gProfilerTraceSlowFrame = trace;
+#ifdef UNF
+            usb_write(DATATYPE_RAWBINARY, trace,
+                      (sizeof(*trace) - sizeof(trace->events)) + (trace->numEvents * sizeof(trace->events[0])));
+#endif
+        }
+    }
+
+    next = (gProfilerTraceSlowFrame == &sProfilerTraces[0]) ? &sProfilerTraces[1] : &sProfilerTraces[0];
+
+    u32 saved = __osDisableInt();
+    next->magic = PROFILER_TRACE_MAGIC;
+    next->version = PROFILER_TRACE_VERSION;
+    next->eventSize = sizeof(next->events[0]);
+    next->frame = gGlobalTimer;
+    next->numEvents = 0;
+    next->numDropped = 0;
+    sCurTrace = next;
+    __osRestoreInt(saved);
+
+    sTraceFrameStartVblank = gNumVblanks;
+    profiler_trace_begin(PROFILER_TRACE_FRAME, gGlobalTimer);
+}
+#else
+#define trace_next_frame()
+#endif
+
 static void buffer_update(ProfileTimeData* data, u32 new, int buffer_index) {
     u32 old = data->counts[buffer_index];
     data->total -= old;
@@ -56,6 +135,7 @@ void profiler_update(enum ProfilerTime which) {
 
 void profiler_rsp_started(enum ProfilerRSPTime which) {
     rsp_pending_times[which] = osGetCount();
+    profiler_trace_begin(PROFILER_TRACE_RSP_GFX + which, 0);
 }
 
 void profiler_rsp_completed(enum ProfilerRSPTime which) {
@@ -63,6 +143,7 @@ void profiler_rsp_completed(enum ProfilerRSPTime which) {
     int cur_index = rsp_buffer_indices[which];
     u32 time = osGetCount() - rsp_pending_times[which];
     rsp_pending_times[which] = 0;
+    profiler_trace_end(PROFILER_TRACE_RSP_GFX + which);
 
     buffer_update(cur_data, time, cur_index);
     cur_index++;
@@ -74,15 +155,18 @@ void profiler_rsp_completed(enum ProfilerRSPTime which) {
 
 void profiler_rsp_resumed() {
     rsp_pending_times[PROFILER_RSP_GFX] = osGetCount() - rsp_pending_times[PROFILER_RSP_GFX];
+    profiler_trace_begin(PROFILER_TRACE_RSP_GFX, 0);
 }
 
-// This ends up being the same math as resumed, so we just use resumed for both
-// void profiler_rsp_yielded() {
-//     rsp_pending_times[PROFILER_RSP_GFX] = osGetCount() - rsp_pending_times[PROFILER_RSP_GFX];
-// }
+// This ends up being the same math as resumed, only the trace event differs
+void profiler_rsp_yielded() {
+    rsp_pending_times[PROFILER_RSP_GFX] = osGetCount() - rsp_pending_times[PROFILER_RSP_GFX];
+    profiler_trace_end(PROFILER_TRACE_RSP_GFX);
+}
 
 void profiler_audio_started() {
     audio_start = osGetCount();
+    profiler_trace_begin(PROFILER_TRACE_AUDIO, 0);
 }
 
 void profiler_audio_completed() {
@@ -90,6 +174,7 @@ void profiler_audio_completed() {
     u32 time = osGetCount() - audio_start;
     u32 cur_index = audio_buffer_index;
 
+    profiler_trace_end(PROFILER_TRACE_AUDIO);
     preempted_time = time;
     buffer_update(cur_data, time, cur_index);
     cur_index++;
@@ -266,6 +351,8 @@ void profiler_print_times() {
 }
 
 void profiler_frame_setup() {
+    trace_next_frame();
+
     profile_buffer_index++;
     preempted_time = 0;
 
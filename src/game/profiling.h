@@ -33,6 +33,52 @@ enum ProfilerRSPTime {
     PROFILER_RSP_COUNT
 };
 
+// Must match sZoneNames in tools/profiler_trace_to_json.py.
+enum ProfilerTraceZone {
+    PROFILER_TRACE_FRAME,
+    PROFILER_TRACE_OBJECTS,
+    PROFILER_TRACE_BEHAVIOR, // Arg is the object's behavior.
+    PROFILER_TRACE_COLLISION,
+    PROFILER_TRACE_GRAPH,
+    PROFILER_TRACE_AUDIO,
+    PROFILER_TRACE_RSP_GFX,
+    PROFILER_TRACE_RSP_AUDIO,
+    PROFILER_TRACE_ZONE_COUNT
+};
+
+#ifdef PROFILER_TRACE
+#define PROFILER_TRACE_MAGIC       0x50545243 // "PTRC"
+#define PROFILER_TRACE_VERSION     1
+#define PROFILER_TRACE_BUFFER_SIZE 2048
+
+struct ProfilerTraceEvent {
+    u32 time; // osGetCount()
+    u8 zone;
+    u8 isEnd;
+    u16 pad;
+    u32 arg;
+};
+
+// One frame of events. Only the header and the first numEvents events are sent over USB.
+struct ProfilerTrace {
+    u32 magic;
+    u16 version;
+    u16 eventSize;
+    u32 frame; // gGlobalTimer
+    u32 numEvents;
+    u32 numDropped; // Events that didn't fit.
+    struct ProfilerTraceEvent events[PROFILER_TRACE_BUFFER_SIZE];
+};
+
+extern struct ProfilerTrace *gProfilerTraceSlowFrame;
+
+void profiler_trace_begin(enum ProfilerTraceZone zone, u32 arg);
+void profiler_trace_end(enum ProfilerTraceZone zone);
+#else
+#define profiler_trace_begin(zone, arg)
+#define profiler_trace_end(zone)
+#endif
+
 #ifdef USE_PROFILER
 void profiler_update(enum ProfilerTime which);
 void profiler_print_times();
@@ -40,12 +86,9 @@ void profiler_frame_setup();
 void profiler_rsp_started(enum ProfilerRSPTime which);
 void profiler_rsp_completed(enum ProfilerRSPTime which);
 void profiler_rsp_resumed();
+void profiler_rsp_yielded();
 void profiler_audio_started();
 void profiler_audio_completed();
-// See profiling.c to see why profiler_rsp_yielded isn't its own function
-static ALWAYS_INLINE void profiler_rsp_yielded() {
-    profiler_rsp_resumed();
-}
 #else
 #define profiler_update(which)
 #define profiler_print_times()
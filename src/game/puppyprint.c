@@ -38,6 +38,7 @@ a modern game engine's developer's console.
 #include "puppyprint.h"
 #include "level_update.h"
 #include "object_list_processor.h"
+#include "spawn_object.h"
 #include "engine/surface_load.h"
 #include "audio/data.h"
 #include "audio/heap.h"
@@ -521,7 +522,12 @@ void print_basic_profiling(void) {
 void puppyprint_render_standard(void) {
     char textBytes[80];
 
-    sprintf(textBytes, "OBJ: %d/%d", gObjectCounter, OBJECT_POOL_CAPACITY);
+    if (gObjectPoolOverflowCount != 0) {
+        // Spawns that were dropped because the pool was full.
+        sprintf(textBytes, "OBJ: %d/%d (%d lost)", gObjectCounter, OBJECT_POOL_CAPACITY, gObjectPoolOverflowCount);
+    } else {
+        sprintf(textBytes, "OBJ: %d/%d", gObjectCounter, OBJECT_POOL_CAPACITY);
+    }
     print_small_text((SCREEN_WIDTH - 16), 16, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
 
 #ifndef ENABLE_CREDITS_BENCHMARK
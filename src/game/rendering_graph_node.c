@@ -2,6 +2,7 @@
 
 #include "area.h"
 #include "engine/math_util.h"
+#include "engine/surface_collision.h"
 #include "game_init.h"
 #include "gfx_dimensions.h"
 #include "main.h"
@@ -14,6 +15,8 @@
 #include "puppyprint.h"
 #include "debug_box.h"
 #include "level_update.h"
+#include "object_helpers.h"
+#include "object_list_processor.h"
 #include "behavior_data.h"
 #include "string.h"
 #include "color_presets.h"
@@ -51,6 +54,25 @@ ALIGNED16 Mat4 gMatStack[32];
 ALIGNED16 Mtx *gMatStackFixed[32];
 f32 sAspectRatio;
 
+#ifdef DISPLAY_LIST_CULLING
+// Tangents of half the horizontal and vertical fov of the current frustum, and the matching plane normal scales.
+static f32 sCullTanHalfFovX, sCullTanHalfFovY;
+static f32 sCullSecHalfFovX, sCullSecHalfFovY;
+#endif
+
+#ifdef BATCHED_MATRIX_CONVERSION
+#define MTX_BATCH_SIZE 512
+
+/**
+ * Mtxs still holding the float matrix they are converted from, see geo_get_fixed_matrix.
+ * They are all converted by mtxf_to_mtx_batch once the master list has been traversed.
+ */
+static Mtx *sMtxBatch[MTX_BATCH_SIZE];
+static s32 sMtxBatchCount;
+// Bit per matrix stack level, set when that level's matrix is the same as its parent's.
+static u32 sMatStackSharesParent;
+#endif
+
 /**
  * Animation nodes have state in global variables, so this struct captures
  * the animation state so a 'context switch' can be made when rendering the
@@ -75,6 +97,33 @@ s16 gCurrAnimFrame;
 f32 gCurrAnimTranslationMultiplier;
 u16 *gCurrAnimAttribute;
 s16 *gCurrAnimData;
+#ifdef COMPRESSED_ANIMATIONS
+u8 gCurrAnimCompressed;
+#endif
+
+#ifdef ANIMATION_POSE_CACHE
+#define POSE_CACHE_SIZE 16
+#define POSE_CACHE_MAX_VALUES 192 // 32 animated parts
+
+/**
+ * Values of one animation decoded at one frame. Objects showing the same frame of the same
+ * animation, such as a group of goombas, share an entry, so the lookups in the index table
+ * are only done by the first of them. Entries are only valid for the frame they were made in,
+ * since Mario's animations are all loaded into the same struct Animation.
+ */
+struct AnimPose {
+    struct Animation *anim;
+    u16 *attributes; // Start of the index table
+    u32 timestamp;
+    s16 frame;
+    s16 numValues; // Values decoded so far, in index table order
+    s16 values[POSE_CACHE_MAX_VALUES];
+};
+
+static struct AnimPose sPoseCache[POSE_CACHE_SIZE];
+static struct AnimPose *sCurrAnimPose;
+static u32 sPoseCacheTimestamp;
+#endif
 
 struct AllocOnlyPool *gDisplayListHeap;
 
@@ -268,6 +317,43 @@ void switch_ucode(s32 ucode) {
 }
 #endif
 
+#ifdef DISPLAY_LIST_INSTANCING
+/**
+ * Draws every instance of a display list node on a layer. The setup part of the display list runs
+ * once, then each instance loads its matrix and draws the geometry, and the reset part runs last.
+ */
+static void geo_process_instances(struct DisplayListInstances *instances, UNUSED s32 isSilhouette) {
+    struct GraphNodeDisplayList *model = instances->model;
+    struct DisplayListNode *currList = instances->head;
+    Gfx *lists = model->instanceLists;
+
+ #if SILHOUETTE
+    if (isSilhouette) {
+        gSPDisplayList(gDisplayListHead++, dl_silhouette_begin);
+    }
+ #endif
+    if (instances->count == 1) {
+        gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(currList->transform),
+                  (G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH));
+        gSPDisplayList(gDisplayListHead++, currList->displayList);
+    } else {
+        gSPDisplayList(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(lists));
+        while (currList != NULL) {
+            gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(currList->transform),
+                      (G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH));
+            gSPDisplayList(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(&lists[model->instanceBodyOffset]));
+            currList = currList->next;
+        }
+        gSPDisplayList(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(&lists[model->instanceTailOffset]));
+    }
+ #if SILHOUETTE
+    if (isSilhouette) {
+        gSPDisplayList(gDisplayListHead++, dl_silhouette_end);
+    }
+ #endif
+}
+#endif
+
 /**
  * Process a master list node. This has been modified, so now it runs twice, for each microcode.
  * It iterates through the first 5 layers of if the first index using F3DLX2.Rej, then it switches
@@ -278,6 +364,9 @@ void switch_ucode(s32 ucode) {
 void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
     struct RenderPhase *renderPhase;
     struct DisplayListNode *currList;
+#ifdef DISPLAY_LIST_INSTANCING
+    struct DisplayListInstances *instances;
+#endif
     s32 currLayer     = LAYER_FIRST;
     s32 startLayer    = LAYER_FIRST;
     s32 endLayer      = LAYER_LAST;
@@ -299,6 +388,11 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
  #endif
 #endif // F3DEX_GBI_2
 
+#if defined(F3DEX_GBI_2) && !defined(OBJECTS_REJ)
+    // The RSP reads lookAt when it runs this, so once for the whole master list is enough.
+    gSPLookAt(gDisplayListHead++, &lookAt);
+#endif
+
     // Loop through the render phases
     for (phaseIndex = RENDER_PHASE_FIRST; phaseIndex < RENDER_PHASE_END; phaseIndex++) {
         // Get the render phase information.
@@ -320,6 +414,18 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
         for (currLayer = startLayer; currLayer <= endLayer; currLayer++) {
             // Set 'currList' to the first DisplayListNode on the current layer.
             currList = node->listHeads[ucode][currLayer];
+#ifdef DISPLAY_LIST_INSTANCING
+            instances = node->instanceHeads[ucode][currLayer];
+            // Don't set the render mode for layers that have nothing to draw.
+            if (currList == NULL && instances == NULL) {
+                continue;
+            }
+#else
+            // Don't set the render mode for layers that have nothing to draw.
+            if (currList == NULL) {
+                continue;
+            }
+#endif
 #if defined(DISABLE_AA) || !SILHOUETTE
             // Set the render mode for the current layer.
             gDPSetRenderMode(gDisplayListHead++, mode1List->modes[currLayer],
@@ -358,6 +464,16 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
                 // Move to the next DisplayListNode.
                 currList = currList->next;
             }
+#ifdef DISPLAY_LIST_INSTANCING
+            // Instanced display lists are drawn after the rest of the layer.
+            for (; instances != NULL; instances = instances->next) {
+ #if SILHOUETTE
+                geo_process_instances(instances, (phaseIndex == RENDER_PHASE_SILHOUETTE));
+ #else
+                geo_process_instances(instances, FALSE);
+ #endif
+            }
+#endif
         }
     }
 
@@ -379,19 +495,14 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
 }
 
 /**
- * Appends the display list to one of the master lists based on the layer
- * parameter. Look at the RenderModeContainer struct to see the corresponding
- * render modes of layers.
+ * Returns the layer a display list of the current object is drawn on, and sets ucode to the microcode.
  */
-void geo_append_display_list(void *displayList, s32 layer) {
-    s32 ucode = GRAPH_NODE_UCODE_DEFAULT;
-#ifdef F3DEX_GBI_2
-    gSPLookAt(gDisplayListHead++, &lookAt);
-#endif
+static s32 geo_get_master_list_layer(s32 layer, s32 *ucode) {
+    *ucode = GRAPH_NODE_UCODE_DEFAULT;
 #if defined(OBJECTS_REJ) || SILHOUETTE
     if (gCurGraphNodeObject != NULL) {
  #ifdef OBJECTS_REJ
-        ucode = gCurGraphNodeObject->ucode;
+        *ucode = gCurGraphNodeObject->ucode;
  #endif
  #if SILHOUETTE
         if (gCurGraphNodeObject->node.flags & GRAPH_RENDER_SILHOUETTE) {
@@ -409,11 +520,59 @@ void geo_append_display_list(void *displayList, s32 layer) {
  #endif // SILHOUETTE
     }
 #endif // F3DEX_GBI_2 || SILHOUETTE
+    return layer;
+}
+
+#ifdef BATCHED_MATRIX_CONVERSION
+/**
+ * Returns the Mtx of the current matrix stack level, allocating it the first time a display list
+ * is drawn with it. The float matrix is kept in the Mtx until mtxf_to_mtx_batch converts it, since
+ * gMatStack is overwritten by the next sibling. Levels that are the same as their parent share
+ * the parent's Mtx, like inc_mat_stack does without the batch.
+ */
+static Mtx *geo_get_fixed_matrix(void) {
+    s32 index = gMatStackIndex;
+    s32 i;
+
+    while (gMatStackFixed[index] == NULL && (sMatStackSharesParent & (1 << index))) {
+        index--;
+    }
+
+    if (gMatStackFixed[index] == NULL) {
+        Mtx *mtx = alloc_display_list(sizeof(*mtx));
+
+        if (sMtxBatchCount < MTX_BATCH_SIZE) {
+            mtxf_copy((void *) mtx, gMatStack[index]);
+            sMtxBatch[sMtxBatchCount++] = mtx;
+        } else {
+            mtxf_to_mtx(mtx, gMatStack[index]);
+        }
+        gMatStackFixed[index] = mtx;
+    }
+
+    for (i = index + 1; i <= gMatStackIndex; i++) {
+        gMatStackFixed[i] = gMatStackFixed[index];
+    }
+    return gMatStackFixed[gMatStackIndex];
+}
+#else
+#define geo_get_fixed_matrix() gMatStackFixed[gMatStackIndex]
+#endif
+
+/**
+ * Appends the display list to one of the master lists based on the layer
+ * parameter. Look at the RenderModeContainer struct to see the corresponding
+ * render modes of layers.
+ */
+void geo_append_display_list(void *displayList, s32 layer) {
+    s32 ucode;
+
+    layer = geo_get_master_list_layer(layer, &ucode);
     if (gCurGraphNodeMasterList != NULL) {
         struct DisplayListNode *listNode =
             alloc_only_pool_alloc(gDisplayListHeap, sizeof(struct DisplayListNode));
 
-        listNode->transform = gMatStackFixed[gMatStackIndex];
+        listNode->transform = geo_get_fixed_matrix();
         listNode->displayList = displayList;
         listNode->next = NULL;
         if (gCurGraphNodeMasterList->listHeads[ucode][layer] == NULL) {
@@ -425,19 +584,137 @@ void geo_append_display_list(void *displayList, s32 layer) {
     }
 }
 
+#ifdef DISPLAY_LIST_INSTANCING
+/**
+ * Set once a generated list has drawn something for the current object. Its display lists after that
+ * can depend on the state it set, like the boo's alpha, so they are drawn in place.
+ */
+static s32 sGeneratedListDrawn = FALSE;
+
+/**
+ * Only the order within z-buffered layers doesn't matter, except for decals which are drawn over
+ * whatever is below them.
+ */
+static s32 layer_can_be_instanced(s32 layer) {
+    return (layer >= LAYER_ZB_FIRST && layer <= LAYER_ZB_LAST && layer != LAYER_OPAQUE_DECAL
+ #if SILHOUETTE
+            && layer != LAYER_ALPHA_DECAL
+ #endif
+    );
+}
+
+/**
+ * Adds the current matrix as an instance of a display list node with instanceLists, to be drawn
+ * together with the node's other instances on the layer. Returns FALSE if the node has to be drawn
+ * on its own instead.
+ */
+static s32 geo_append_display_list_instance(struct GraphNodeDisplayList *node) {
+    struct GraphNodeMasterList *masterList = gCurGraphNodeMasterList;
+    struct DisplayListInstances *instances;
+    struct DisplayListNode *listNode;
+    s32 ucode;
+    s32 layer = geo_get_master_list_layer(GET_GRAPH_NODE_LAYER(node->node.flags), &ucode);
+
+    if (masterList == NULL || !(masterList->node.flags & GRAPH_RENDER_Z_BUFFER) || !layer_can_be_instanced(layer)) {
+        return FALSE;
+    }
+
+    for (instances = masterList->instanceHeads[ucode][layer]; instances != NULL; instances = instances->next) {
+        if (instances->model == node) {
+            break;
+        }
+    }
+
+    if (instances == NULL) {
+        instances = alloc_only_pool_alloc(gDisplayListHeap, sizeof(struct DisplayListInstances));
+        instances->model = node;
+        instances->head = NULL;
+        instances->count = 0;
+        instances->next = masterList->instanceHeads[ucode][layer];
+        masterList->instanceHeads[ucode][layer] = instances;
+    }
+
+    listNode = alloc_only_pool_alloc(gDisplayListHeap, sizeof(struct DisplayListNode));
+    listNode->transform = geo_get_fixed_matrix();
+    listNode->displayList = node->displayList;
+    listNode->next = NULL;
+    if (instances->head == NULL) {
+        instances->head = listNode;
+    } else {
+        instances->tail->next = listNode;
+    }
+    instances->tail = listNode;
+    instances->count++;
+
+    return TRUE;
+}
+#endif
+
+/**
+ * Pushes the matrix a node has computed into gMatStack[gMatStackIndex + 1]. Nodes that don't actually
+ * transform anything, like zero translations and unrotated animated parts, share their parent's Mtx
+ * instead of converting and allocating an identical one.
+ */
 static void inc_mat_stack() {
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
+    u32 *newMtx = (u32 *) gMatStack[gMatStackIndex + 1];
+    u32 *parentMtx = (u32 *) gMatStack[gMatStackIndex];
+    s32 i;
+
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+
+    for (i = 0; i < 16; i++) {
+        if (newMtx[i] != parentMtx[i]) {
+            break;
+        }
+    }
+
+#ifdef BATCHED_MATRIX_CONVERSION
+    // Allocated and converted once a display list is drawn with it, see geo_get_fixed_matrix.
+    gMatStackFixed[gMatStackIndex] = NULL;
+    if (i == 16) {
+        sMatStackSharesParent |= (1 << gMatStackIndex);
+    } else {
+        sMatStackSharesParent &= ~(1 << gMatStackIndex);
+    }
+#else
+    if (i == 16) {
+        gMatStackFixed[gMatStackIndex] = gMatStackFixed[gMatStackIndex - 1];
+    } else {
+        Mtx *mtx = alloc_display_list(sizeof(*mtx));
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+        gMatStackFixed[gMatStackIndex] = mtx;
+    }
+#endif
 }
 
-static void append_dl_and_return(struct GraphNodeDisplayList *node) {
-    if (node->displayList != NULL) {
-        geo_append_display_list(node->displayList, GET_GRAPH_NODE_LAYER(node->node.flags));
+/**
+ * Processes the children of the given GraphNode if it has any
+ */
+void geo_try_process_children(struct GraphNode *node) {
+    if (node->children != NULL) {
+        geo_process_node_and_siblings(node->children);
     }
-    if (node->node.children != NULL) {
-        geo_process_node_and_siblings(node->node.children);
+}
+
+/**
+ * Appends the display list of a node whose struct starts like GraphNodeDisplayList, if it has one.
+ * Always returns TRUE, so the node's children are processed when it is part of a flat list.
+ */
+static s32 geo_append_node_display_list(struct GraphNode *node) {
+    void *displayList = ((struct GraphNodeDisplayList *) node)->displayList;
+
+    if (displayList != NULL) {
+        geo_append_display_list(displayList, GET_GRAPH_NODE_LAYER(node->flags));
+    }
+    return TRUE;
+}
+
+/**
+ * Processes the children of a node that pushed a matrix, then pops it.
+ */
+static void geo_process_children_and_pop(struct GraphNode *node) {
+    if (node->children != NULL) {
+        geo_process_node_and_siblings(node->children);
     }
     gMatStackIndex--;
 }
@@ -453,9 +730,16 @@ void geo_process_master_list(struct GraphNodeMasterList *node) {
         for (ucode = 0; ucode < GRAPH_NODE_NUM_UCODES; ucode++) {
             for (layer = LAYER_FIRST; layer < LAYER_COUNT; layer++) {
                 node->listHeads[ucode][layer] = NULL;
+#ifdef DISPLAY_LIST_INSTANCING
+                node->instanceHeads[ucode][layer] = NULL;
+#endif
             }
         }
         geo_process_node_and_siblings(node->node.children);
+#ifdef BATCHED_MATRIX_CONVERSION
+        mtxf_to_mtx_batch(sMtxBatch, sMtxBatchCount);
+        sMtxBatchCount = 0;
+#endif
         geo_process_master_list_sub(gCurGraphNodeMasterList);
         gCurGraphNodeMasterList = NULL;
     }
@@ -502,6 +786,12 @@ void geo_process_perspective(struct GraphNodePerspective *node) {
 #endif
 
         guPerspective(mtx, &perspNorm, node->fov, sAspectRatio, node->near / (f32)WORLD_SCALE, node->far / (f32)WORLD_SCALE, 1.0f);
+#ifdef DISPLAY_LIST_CULLING
+        sCullTanHalfFovY = tans(degrees_to_angle(node->fov / 2.0f));
+        sCullTanHalfFovX = sCullTanHalfFovY * sAspectRatio;
+        sCullSecHalfFovY = sqrtf(1.0f + sqr(sCullTanHalfFovY));
+        sCullSecHalfFovX = sqrtf(1.0f + sqr(sCullTanHalfFovX));
+#endif
         gSPPerspNormalize(gDisplayListHead++, perspNorm);
 
         gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(mtx), G_MTX_PROJECTION | G_MTX_LOAD | G_MTX_NOPUSH);
@@ -518,16 +808,19 @@ void geo_process_perspective(struct GraphNodePerspective *node) {
  * of this node are only processed if that distance is within the render
  * range of this node.
  */
-void geo_process_level_of_detail(struct GraphNodeLevelOfDetail *node) {
+static s32 geo_level_of_detail_is_in_range(struct GraphNode *graphNode) {
+    struct GraphNodeLevelOfDetail *node = (struct GraphNodeLevelOfDetail *) graphNode;
 #ifdef AUTO_LOD
     f32 distanceFromCam = gIsConsole ? -gMatStack[gMatStackIndex][3][2] : 50.0f;
 #else
     f32 distanceFromCam = -gMatStack[gMatStackIndex][3][2];
 #endif
 
-    if ((f32)node->minDistance <= distanceFromCam
-        && distanceFromCam < (f32)node->maxDistance
-        && node->node.children != 0) {
+    return ((f32)node->minDistance <= distanceFromCam && distanceFromCam < (f32)node->maxDistance);
+}
+
+void geo_process_level_of_detail(struct GraphNodeLevelOfDetail *node) {
+    if (geo_level_of_detail_is_in_range(&node->node) && node->node.children != 0) {
         geo_process_node_and_siblings(node->node.children);
     }
 }
@@ -552,6 +845,56 @@ void geo_process_switch(struct GraphNodeSwitchCase *node) {
     }
 }
 
+/**
+ * Returns the visibility row of a room, or NULL if it isn't one of the node's rooms.
+ */
+static const RoomVisibility *get_room_visibility(struct GraphNodeRooms *node, const RoomVisibility *visibility, s32 room) {
+    if (room < 1 || room > node->numRooms) {
+        return NULL;
+    }
+
+    return &visibility[(room - 1) * ROOM_VISIBILITY_WORDS(node->numRooms)];
+}
+
+/**
+ * Process a rooms node. Only the children of rooms that can be seen from Mario's room or
+ * the camera's room are processed, everything is processed if neither is in a room.
+ * Children past the node's last room have no visibility bits and are always processed.
+ */
+void geo_process_rooms(struct GraphNodeRooms *node) {
+    const RoomVisibility *visibility = segmented_to_virtual(node->visibility);
+    struct GraphNode *firstChild = node->node.children;
+    struct GraphNode *child = firstChild;
+    const RoomVisibility *marioRooms, *cameraRooms;
+    struct Surface *cameraFloor = NULL;
+    s32 i = 0;
+
+    update_mario_current_room();
+    marioRooms = get_room_visibility(node, visibility, gMarioCurrentRoom);
+
+    // The camera is often still in the previous room when Mario walks through a door.
+    if (gCurGraphNodeCamera != NULL) {
+        find_room_floor(gCurGraphNodeCamera->pos[0], gCurGraphNodeCamera->pos[1], gCurGraphNodeCamera->pos[2], &cameraFloor);
+    }
+    cameraRooms = (cameraFloor != NULL) ? get_room_visibility(node, visibility, cameraFloor->room) : NULL;
+
+    if (child == NULL) {
+        return;
+    }
+
+    do {
+        u32 bit = (1 << (i % 32));
+
+        if (i >= node->numRooms
+            || (marioRooms == NULL && cameraRooms == NULL)
+            || (marioRooms != NULL && (marioRooms[i / 32] & bit))
+            || (cameraRooms != NULL && (cameraRooms[i / 32] & bit))) {
+            geo_process_node_and_siblings(child);
+        }
+        i++;
+    } while ((child = child->next) != firstChild);
+}
+
 /**
  * Process a camera node.
  */
@@ -585,14 +928,20 @@ void geo_process_camera(struct GraphNodeCamera *node) {
  * the float and fixed point matrix stacks.
  * For the rest it acts as a normal display list node.
  */
-void geo_process_translation_rotation(struct GraphNodeTranslationRotation *node) {
+static s32 geo_draw_translation_rotation(struct GraphNode *graphNode) {
+    struct GraphNodeTranslationRotation *node = (struct GraphNodeTranslationRotation *) graphNode;
     Vec3f translation;
 
     vec3s_to_vec3f(translation, node->translation);
     mtxf_rotate_zxy_and_translate_and_mul(node->rotation, translation, gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex]);
 
     inc_mat_stack();
-    append_dl_and_return((struct GraphNodeDisplayList *)node);
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_translation_rotation(struct GraphNodeTranslationRotation *node) {
+    geo_draw_translation_rotation(&node->node);
+    geo_process_children_and_pop(&node->node);
 }
 
 /**
@@ -600,14 +949,20 @@ void geo_process_translation_rotation(struct GraphNodeTranslationRotation *node)
  * translation is created and pushed on both the float and fixed point matrix stacks.
  * For the rest it acts as a normal display list node.
  */
-void geo_process_translation(struct GraphNodeTranslation *node) {
+static s32 geo_draw_translation(struct GraphNode *graphNode) {
+    struct GraphNodeTranslation *node = (struct GraphNodeTranslation *) graphNode;
     Vec3f translation;
 
     vec3s_to_vec3f(translation, node->translation);
     mtxf_rotate_zxy_and_translate_and_mul(gVec3sZero, translation, gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex]);
 
     inc_mat_stack();
-    append_dl_and_return((struct GraphNodeDisplayList *)node);
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_translation(struct GraphNodeTranslation *node) {
+    geo_draw_translation(&node->node);
+    geo_process_children_and_pop(&node->node);
 }
 
 /**
@@ -615,11 +970,18 @@ void geo_process_translation(struct GraphNodeTranslation *node) {
  * rotation is created and pushed on both the float and fixed point matrix stacks.
  * For the rest it acts as a normal display list node.
  */
-void geo_process_rotation(struct GraphNodeRotation *node) {
+static s32 geo_draw_rotation(struct GraphNode *graphNode) {
+    struct GraphNodeRotation *node = (struct GraphNodeRotation *) graphNode;
+
     mtxf_rotate_zxy_and_translate_and_mul(node->rotation, gVec3fZero, gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex]);
 
     inc_mat_stack();
-    append_dl_and_return(((struct GraphNodeDisplayList *)node));
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_rotation(struct GraphNodeRotation *node) {
+    geo_draw_rotation(&node->node);
+    geo_process_children_and_pop(&node->node);
 }
 
 /**
@@ -627,14 +989,20 @@ void geo_process_rotation(struct GraphNodeRotation *node) {
  * scale is created and pushed on both the float and fixed point matrix stacks.
  * For the rest it acts as a normal display list node.
  */
-void geo_process_scale(struct GraphNodeScale *node) {
+static s32 geo_draw_scale(struct GraphNode *graphNode) {
+    struct GraphNodeScale *node = (struct GraphNodeScale *) graphNode;
     Vec3f scaleVec;
 
     vec3f_set(scaleVec, node->scale, node->scale, node->scale);
     mtxf_scale_vec3f(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], scaleVec);
 
     inc_mat_stack();
-    append_dl_and_return((struct GraphNodeDisplayList *)node);
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_scale(struct GraphNodeScale *node) {
+    geo_draw_scale(&node->node);
+    geo_process_children_and_pop(&node->node);
 }
 
 /**
@@ -643,7 +1011,8 @@ void geo_process_scale(struct GraphNodeScale *node) {
  * point matrix stacks.
  * For the rest it acts as a normal display list node.
  */
-void geo_process_billboard(struct GraphNodeBillboard *node) {
+static s32 geo_draw_billboard(struct GraphNode *graphNode) {
+    struct GraphNodeBillboard *node = (struct GraphNodeBillboard *) graphNode;
     Vec3f translation;
     Vec3f scale = { 1.0f, 1.0f, 1.0f };
 
@@ -658,7 +1027,70 @@ void geo_process_billboard(struct GraphNodeBillboard *node) {
     mtxf_billboard(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], translation, scale, gCurGraphNodeCamera->roll);
 
     inc_mat_stack();
-    append_dl_and_return((struct GraphNodeDisplayList *)node);
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_billboard(struct GraphNodeBillboard *node) {
+    geo_draw_billboard(&node->node);
+    geo_process_children_and_pop(&node->node);
+}
+
+#ifdef DISPLAY_LIST_CULLING
+/**
+ * Tests a display list node's bounding sphere against all six planes of the current frustum.
+ */
+static s32 display_list_is_in_view(struct GraphNodeDisplayList *node) {
+    Mat4 *mtx = &gMatStack[gMatStackIndex];
+    struct GraphNodePerspective *frustum = gCurGraphNodeCamFrustum;
+    f32 maxScaleSq = 0.0f;
+    Vec3f center, pos;
+    f32 radius, depth;
+    s32 i;
+
+    // Orthographic nodes such as the skybox.
+    if (frustum == NULL) {
+        return TRUE;
+    }
+
+    vec3s_to_vec3f(center, node->cullingCenter);
+    linear_mtxf_mul_vec3f_and_translate(*mtx, pos, center);
+
+    for (i = 0; i < 3; i++) {
+        f32 scaleSq = vec3_sumsq((*mtx)[i]);
+        maxScaleSq = MAX(maxScaleSq, scaleSq);
+    }
+    radius = node->cullingRadius * sqrtf(maxScaleSq);
+    depth = -pos[2];
+
+    if (depth + radius < frustum->near || depth - radius > frustum->far) {
+        return FALSE;
+    }
+    if (ABS(pos[0]) - (depth * sCullTanHalfFovX) > radius * sCullSecHalfFovX) {
+        return FALSE;
+    }
+    if (ABS(pos[1]) - (depth * sCullTanHalfFovY) > radius * sCullSecHalfFovY) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+#endif
+
+static s32 geo_draw_display_list(struct GraphNode *graphNode) {
+    UNUSED struct GraphNodeDisplayList *node = (struct GraphNodeDisplayList *) graphNode;
+
+#ifdef DISPLAY_LIST_CULLING
+    // Children can have their own transforms, so they are still processed.
+    if (node->cullingRadius != 0 && !display_list_is_in_view(node)) {
+        return TRUE;
+    }
+#endif
+#ifdef DISPLAY_LIST_INSTANCING
+    if (node->instanceLists != NULL && !sGeneratedListDrawn && geo_append_display_list_instance(node)) {
+        return TRUE;
+    }
+#endif
+    return geo_append_node_display_list(graphNode);
 }
 
 /**
@@ -667,9 +1099,8 @@ void geo_process_billboard(struct GraphNodeBillboard *node) {
  * parent node. It processes its children if it has them.
  */
 void geo_process_display_list(struct GraphNodeDisplayList *node) {
-    append_dl_and_return((struct GraphNodeDisplayList *)node);
-
-    gMatStackIndex++;
+    geo_draw_display_list(&node->node);
+    geo_try_process_children(&node->node);
 }
 
 /**
@@ -682,6 +1113,9 @@ void geo_process_generated_list(struct GraphNodeGenerated *node) {
 
         if (list != NULL) {
             geo_append_display_list((void *) VIRTUAL_TO_PHYSICAL(list), GET_GRAPH_NODE_LAYER(node->fnNode.node.flags));
+#ifdef DISPLAY_LIST_INSTANCING
+            sGeneratedListDrawn = TRUE;
+#endif
         }
     }
     if (node->fnNode.node.children != NULL) {
@@ -727,38 +1161,85 @@ void geo_process_background(struct GraphNodeBackground *node) {
     }
 }
 
+/**
+ * Decodes the value of the current animation at the attribute and advances the attribute past it.
+ */
+static s16 geo_decode_anim_value(u16 **attribute) {
+#ifdef COMPRESSED_ANIMATIONS
+    if (gCurrAnimCompressed) {
+        return retrieve_compressed_animation_value(gCurrAnimFrame, attribute, gCurrAnimData);
+    }
+#endif
+    return gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, attribute)];
+}
+
+#ifdef ANIMATION_POSE_CACHE
+/**
+ * Returns the pose cache entry for an animation at a frame, emptying it first if it held something else.
+ */
+static struct AnimPose *geo_get_anim_pose(struct Animation *anim, u16 *attributes, s16 frame) {
+    struct AnimPose *pose = &sPoseCache[((uintptr_t) anim / sizeof(struct Animation) + frame) % POSE_CACHE_SIZE];
+
+    if (pose->timestamp != sPoseCacheTimestamp || pose->anim != anim || pose->frame != frame
+        || pose->attributes != attributes) {
+        pose->anim = anim;
+        pose->attributes = attributes;
+        pose->timestamp = sPoseCacheTimestamp;
+        pose->frame = frame;
+        pose->numValues = 0;
+    }
+    return pose;
+}
+#endif
+
+/**
+ * Returns the next value of the current animation and advances gCurrAnimAttribute past it.
+ */
+static s16 geo_next_anim_value(void) {
+#ifdef ANIMATION_POSE_CACHE
+    struct AnimPose *pose = sCurrAnimPose;
+    s32 slot = (gCurrAnimAttribute - pose->attributes) >> 1;
+
+    if (slot < POSE_CACHE_MAX_VALUES) {
+        if (slot >= pose->numValues) {
+            // Values that were skipped over are decoded too, the next object to use this pose may need them.
+            u16 *attribute = pose->attributes + (pose->numValues * 2);
+
+            while (pose->numValues <= slot) {
+                pose->values[pose->numValues++] = geo_decode_anim_value(&attribute);
+            }
+        }
+        gCurrAnimAttribute += 2;
+        return pose->values[slot];
+    }
+#endif
+    return geo_decode_anim_value(&gCurrAnimAttribute);
+}
+
 /**
  * Render an animated part. The current animation state is not part of the node
  * but set in global variables. If an animated part is skipped, everything afterwards desyncs.
  */
-void geo_process_animated_part(struct GraphNodeAnimatedPart *node) {
+static s32 geo_draw_animated_part(struct GraphNode *graphNode) {
+    struct GraphNodeAnimatedPart *node = (struct GraphNodeAnimatedPart *) graphNode;
     Vec3s rotation = { 0, 0, 0 };
     Vec3f translation = { node->translation[0], node->translation[1], node->translation[2] };
 
     if (gCurrAnimType == ANIM_TYPE_TRANSLATION) {
-        translation[0] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        translation[1] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        translation[2] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
+        translation[0] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
+        translation[1] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
+        translation[2] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
         gCurrAnimType = ANIM_TYPE_ROTATION;
     } else {
         if (gCurrAnimType == ANIM_TYPE_LATERAL_TRANSLATION) {
-            translation[0] +=
-                gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                * gCurrAnimTranslationMultiplier;
+            translation[0] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
             gCurrAnimAttribute += 2;
-            translation[2] +=
-                gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                * gCurrAnimTranslationMultiplier;
+            translation[2] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
             gCurrAnimType = ANIM_TYPE_ROTATION;
         } else {
             if (gCurrAnimType == ANIM_TYPE_VERTICAL_TRANSLATION) {
                 gCurrAnimAttribute += 2;
-                translation[1] +=
-                    gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                    * gCurrAnimTranslationMultiplier;
+                translation[1] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
                 gCurrAnimAttribute += 2;
                 gCurrAnimType = ANIM_TYPE_ROTATION;
             } else if (gCurrAnimType == ANIM_TYPE_NO_TRANSLATION) {
@@ -769,48 +1250,45 @@ void geo_process_animated_part(struct GraphNodeAnimatedPart *node) {
     }
 
     if (gCurrAnimType == ANIM_TYPE_ROTATION) {
-        rotation[0] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
-        rotation[1] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
-        rotation[2] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
+        rotation[0] = geo_next_anim_value();
+        rotation[1] = geo_next_anim_value();
+        rotation[2] = geo_next_anim_value();
     }
 
     mtxf_rotate_xyz_and_translate_and_mul(rotation, translation, gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex]);
 
     inc_mat_stack();
-    append_dl_and_return(((struct GraphNodeDisplayList *)node));
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_animated_part(struct GraphNodeAnimatedPart *node) {
+    geo_draw_animated_part(&node->node);
+    geo_process_children_and_pop(&node->node);
 }
 
 /**
  * Render an animated part that has an initial rotation value
  */
-void geo_process_bone(struct GraphNodeBone *node) {
+static s32 geo_draw_bone(struct GraphNode *graphNode) {
+    struct GraphNodeBone *node = (struct GraphNodeBone *) graphNode;
     Vec3s rotation    = { node->rotation[0],    node->rotation[1],    node->rotation[2]    };
     Vec3f translation = { node->translation[0], node->translation[1], node->translation[2] };
 
     if (gCurrAnimType == ANIM_TYPE_TRANSLATION) {
-        translation[0] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        translation[1] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        translation[2] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
+        translation[0] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
+        translation[1] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
+        translation[2] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
         gCurrAnimType = ANIM_TYPE_ROTATION;
     } else {
         if (gCurrAnimType == ANIM_TYPE_LATERAL_TRANSLATION) {
-            translation[0] +=
-                gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                * gCurrAnimTranslationMultiplier;
+            translation[0] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
             gCurrAnimAttribute += 2;
-            translation[2] +=
-                gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                * gCurrAnimTranslationMultiplier;
+            translation[2] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
             gCurrAnimType = ANIM_TYPE_ROTATION;
         } else {
             if (gCurrAnimType == ANIM_TYPE_VERTICAL_TRANSLATION) {
                 gCurrAnimAttribute += 2;
-                translation[1] +=
-                    gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                    * gCurrAnimTranslationMultiplier;
+                translation[1] += geo_next_anim_value() * gCurrAnimTranslationMultiplier;
                 gCurrAnimAttribute += 2;
                 gCurrAnimType = ANIM_TYPE_ROTATION;
             } else if (gCurrAnimType == ANIM_TYPE_NO_TRANSLATION) {
@@ -821,15 +1299,20 @@ void geo_process_bone(struct GraphNodeBone *node) {
     }
 
     if (gCurrAnimType == ANIM_TYPE_ROTATION) {
-        rotation[0] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
-        rotation[1] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
-        rotation[2] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
+        rotation[0] += geo_next_anim_value();
+        rotation[1] += geo_next_anim_value();
+        rotation[2] += geo_next_anim_value();
     }
 
     mtxf_rotate_xyz_and_translate_and_mul(rotation, translation, gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex]);
 
     inc_mat_stack();
-    append_dl_and_return((struct GraphNodeDisplayList *)node);
+    return geo_append_node_display_list(graphNode);
+}
+
+void geo_process_bone(struct GraphNodeBone *node) {
+    geo_draw_bone(&node->node);
+    geo_process_children_and_pop(&node->node);
 }
 
 /**
@@ -857,6 +1340,12 @@ void geo_set_animation_globals(struct AnimInfo *node, s32 hasAnimation) {
     gCurrAnimEnabled = (anim->flags & ANIM_FLAG_DISABLED) == 0;
     gCurrAnimAttribute = segmented_to_virtual((void *) anim->index);
     gCurrAnimData = segmented_to_virtual((void *) anim->values);
+#ifdef COMPRESSED_ANIMATIONS
+    gCurrAnimCompressed = (anim->flags & ANIM_FLAG_COMPRESSED) != 0;
+#endif
+#ifdef ANIMATION_POSE_CACHE
+    sCurrAnimPose = geo_get_anim_pose(anim, gCurrAnimAttribute, gCurrAnimFrame);
+#endif
 
     if (anim->animYTransDivisor == 0) {
         gCurrAnimTranslationMultiplier = 1.0f;
@@ -870,8 +1359,10 @@ void geo_set_animation_globals(struct AnimInfo *node, s32 hasAnimation) {
  * translation of the first animated component and rotated according to
  * the floor below it.
  */
-void geo_process_shadow(struct GraphNodeShadow *node) {
+static s32 geo_draw_shadow(UNUSED struct GraphNode *graphNode) {
 #ifndef DISABLE_SHADOWS
+    struct GraphNodeShadow *node = (struct GraphNodeShadow *) graphNode;
+
     if (gCurGraphNodeCamera != NULL && gCurGraphNodeObject != NULL) {
         Vec3f shadowPos;
         f32 shadowScale;
@@ -899,10 +1390,10 @@ void geo_process_shadow(struct GraphNodeShadow *node) {
 
             f32 animScale = gCurrAnimTranslationMultiplier * objScale;
             Vec3f animOffset;
-            animOffset[0] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)] * animScale;
+            animOffset[0] = geo_next_anim_value() * animScale;
             animOffset[1] = 0.0f;
             gCurrAnimAttribute += 2;
-            animOffset[2] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)] * animScale;
+            animOffset[2] = geo_next_anim_value() * animScale;
             gCurrAnimAttribute -= 6;
 
             // simple matrix rotation so the shadow offset rotates along with the object
@@ -930,9 +1421,12 @@ void geo_process_shadow(struct GraphNodeShadow *node) {
         }
     }
 #endif
-    if (node->node.children != NULL) {
-        geo_process_node_and_siblings(node->node.children);
-    }
+    return TRUE;
+}
+
+void geo_process_shadow(struct GraphNodeShadow *node) {
+    geo_draw_shadow(&node->node);
+    geo_try_process_children(&node->node);
 }
 
 /**
@@ -1081,6 +1575,9 @@ void geo_process_object(struct Object *node) {
                 if (hitboxView) visualise_object_hitbox(node);
 #endif
                 gCurGraphNodeObject = (struct GraphNodeObject *) node;
+#ifdef DISPLAY_LIST_INSTANCING
+                sGeneratedListDrawn = FALSE;
+#endif
                 node->header.gfx.sharedChild->parent = &node->header.gfx.node;
                 geo_process_node_and_siblings(node->header.gfx.sharedChild);
                 node->header.gfx.sharedChild->parent = NULL;
@@ -1149,6 +1646,20 @@ void geo_process_held_object(struct GraphNodeHeldObject *node) {
         gGeoTempState.translationMultiplier = gCurrAnimTranslationMultiplier;
         gGeoTempState.attribute = gCurrAnimAttribute;
         gGeoTempState.data = gCurrAnimData;
+#ifdef ANIMATION_POSE_CACHE
+        // The held object's animation can take over the holder's pose cache entry, so the entry is looked up again after.
+        struct Animation *poseAnim = NULL;
+        u16 *poseAttributes = NULL;
+        s16 poseFrame = 0;
+        if (sCurrAnimPose != NULL) {
+            poseAnim = sCurrAnimPose->anim;
+            poseAttributes = sCurrAnimPose->attributes;
+            poseFrame = sCurrAnimPose->frame;
+        }
+#endif
+#ifdef COMPRESSED_ANIMATIONS
+        u8 compressed = gCurrAnimCompressed;
+#endif
         gCurrAnimType = ANIM_TYPE_NONE;
         gCurGraphNodeHeldObject = (void *) node;
         if (node->objNode->header.gfx.animInfo.curAnim != NULL) {
@@ -1163,6 +1674,14 @@ void geo_process_held_object(struct GraphNodeHeldObject *node) {
         gCurrAnimTranslationMultiplier = gGeoTempState.translationMultiplier;
         gCurrAnimAttribute = gGeoTempState.attribute;
         gCurrAnimData = gGeoTempState.data;
+#ifdef ANIMATION_POSE_CACHE
+        if (poseAnim != NULL) {
+            sCurrAnimPose = geo_get_anim_pose(poseAnim, poseAttributes, poseFrame);
+        }
+#endif
+#ifdef COMPRESSED_ANIMATIONS
+        gCurrAnimCompressed = compressed;
+#endif
         gMatStackIndex--;
     }
 
@@ -1172,14 +1691,237 @@ void geo_process_held_object(struct GraphNodeHeldObject *node) {
 }
 
 /**
- * Processes the children of the given GraphNode if it has any
+ * Processes an active node that isn't drawn children first.
  */
-void geo_try_process_children(struct GraphNode *node) {
-    if (node->children != NULL) {
-        geo_process_node_and_siblings(node->children);
+static void geo_process_node(struct GraphNode *node) {
+    switch (node->type) {
+        case GRAPH_NODE_TYPE_ORTHO_PROJECTION:     geo_process_ortho_projection    ((struct GraphNodeOrthoProjection     *) node); break;
+        case GRAPH_NODE_TYPE_PERSPECTIVE:          geo_process_perspective         ((struct GraphNodePerspective         *) node); break;
+        case GRAPH_NODE_TYPE_MASTER_LIST:          geo_process_master_list         ((struct GraphNodeMasterList          *) node); break;
+        case GRAPH_NODE_TYPE_LEVEL_OF_DETAIL:      geo_process_level_of_detail     ((struct GraphNodeLevelOfDetail       *) node); break;
+        case GRAPH_NODE_TYPE_SWITCH_CASE:          geo_process_switch              ((struct GraphNodeSwitchCase          *) node); break;
+        case GRAPH_NODE_TYPE_ROOMS:                geo_process_rooms               ((struct GraphNodeRooms               *) node); break;
+        case GRAPH_NODE_TYPE_CAMERA:               geo_process_camera              ((struct GraphNodeCamera              *) node); break;
+        case GRAPH_NODE_TYPE_TRANSLATION_ROTATION: geo_process_translation_rotation((struct GraphNodeTranslationRotation *) node); break;
+        case GRAPH_NODE_TYPE_TRANSLATION:          geo_process_translation         ((struct GraphNodeTranslation         *) node); break;
+        case GRAPH_NODE_TYPE_ROTATION:             geo_process_rotation            ((struct GraphNodeRotation            *) node); break;
+        case GRAPH_NODE_TYPE_OBJECT:               geo_process_object              ((struct Object                       *) node); break;
+        case GRAPH_NODE_TYPE_ANIMATED_PART:        geo_process_animated_part       ((struct GraphNodeAnimatedPart        *) node); break;
+        case GRAPH_NODE_TYPE_BILLBOARD:            geo_process_billboard           ((struct GraphNodeBillboard           *) node); break;
+        case GRAPH_NODE_TYPE_DISPLAY_LIST:         geo_process_display_list        ((struct GraphNodeDisplayList         *) node); break;
+        case GRAPH_NODE_TYPE_SCALE:                geo_process_scale               ((struct GraphNodeScale               *) node); break;
+        case GRAPH_NODE_TYPE_SHADOW:               geo_process_shadow              ((struct GraphNodeShadow              *) node); break;
+        case GRAPH_NODE_TYPE_OBJECT_PARENT:        geo_process_object_parent       ((struct GraphNodeObjectParent        *) node); break;
+        case GRAPH_NODE_TYPE_GENERATED_LIST:       geo_process_generated_list      ((struct GraphNodeGenerated           *) node); break;
+        case GRAPH_NODE_TYPE_BACKGROUND:           geo_process_background          ((struct GraphNodeBackground          *) node); break;
+        case GRAPH_NODE_TYPE_HELD_OBJ:             geo_process_held_object         ((struct GraphNodeHeldObject          *) node); break;
+        case GRAPH_NODE_TYPE_BONE:                 geo_process_bone                ((struct GraphNodeBone                *) node); break;
+        default:                                   geo_try_process_children        ((struct GraphNode                    *) node); break;
+    }
+}
+
+#ifdef FLAT_GEO_LAYOUTS
+#define GEO_FLAT_LIST_TABLE_SIZE 512
+#define GEO_FLAT_LIST_SLOT(firstNode) (((uintptr_t) (firstNode) >> 3) % GEO_FLAT_LIST_TABLE_SIZE)
+
+/**
+ * Processes a node of a flat list, without its children. Returns whether its children are processed.
+ */
+typedef s32 (*GeoFlatFunc)(struct GraphNode *node);
+
+struct GeoFlatNode {
+    struct GraphNode *node;
+    GeoFlatFunc func;
+    u16 numDescendants; // Entries after this one that belong to its subtree
+    u8 depth;           // Matrices pushed by the node's ancestors in the list
+    u8 pad;
+};
+
+/**
+ * A sibling list laid out depth first with its subtrees, made by geo_flatten_layout when the geo
+ * layout is loaded. The nodes stay where they are and are still read every frame, so flags,
+ * selected cases and geo function changes to them apply as usual.
+ */
+struct GeoFlatList {
+    struct GraphNode *firstNode;
+    s32 numNodes;
+    struct GeoFlatNode nodes[];
+};
+
+// Indexed by GEO_FLAT_LIST_SLOT, lists whose slot is taken are processed the usual way.
+static struct GeoFlatList *sGeoFlatLists[GEO_FLAT_LIST_TABLE_SIZE];
+
+static s32 geo_flat_group(UNUSED struct GraphNode *node) {
+    return TRUE;
+}
+
+/**
+ * Nodes the flat list doesn't know, which are processed with their children as usual.
+ */
+static s32 geo_flat_fallback(struct GraphNode *node) {
+    geo_process_node(node);
+    return FALSE;
+}
+
+/**
+ * Returns the function that processes a node in a flat list, or NULL if it has to fall back to
+ * geo_process_node. Sets pushesMatrix if the node's children are drawn with a matrix it pushes.
+ */
+static GeoFlatFunc geo_get_flat_func(struct GraphNode *node, s32 *pushesMatrix) {
+    *pushesMatrix = FALSE;
+
+    switch (node->type) {
+        case GRAPH_NODE_TYPE_START:
+        case GRAPH_NODE_TYPE_CULLING_RADIUS:  return geo_flat_group;
+        case GRAPH_NODE_TYPE_LEVEL_OF_DETAIL: return geo_level_of_detail_is_in_range;
+        case GRAPH_NODE_TYPE_DISPLAY_LIST:    return geo_draw_display_list;
+        case GRAPH_NODE_TYPE_SHADOW:          return geo_draw_shadow;
+    }
+
+    *pushesMatrix = TRUE;
+
+    switch (node->type) {
+        case GRAPH_NODE_TYPE_TRANSLATION_ROTATION: return geo_draw_translation_rotation;
+        case GRAPH_NODE_TYPE_TRANSLATION:          return geo_draw_translation;
+        case GRAPH_NODE_TYPE_ROTATION:             return geo_draw_rotation;
+        case GRAPH_NODE_TYPE_SCALE:                return geo_draw_scale;
+        case GRAPH_NODE_TYPE_BILLBOARD:            return geo_draw_billboard;
+        case GRAPH_NODE_TYPE_ANIMATED_PART:        return geo_draw_animated_part;
+        case GRAPH_NODE_TYPE_BONE:                 return geo_draw_bone;
+    }
+
+    *pushesMatrix = FALSE;
+    return NULL;
+}
+
+static s32 geo_count_flat_nodes(struct GraphNode *firstNode, s32 singleNode) {
+    struct GraphNode *node = firstNode;
+    s32 pushesMatrix;
+    s32 count = 0;
+
+    do {
+        count++;
+        if (node->children != NULL && geo_get_flat_func(node, &pushesMatrix) != NULL) {
+            count += geo_count_flat_nodes(node->children, FALSE);
+        }
+    } while (!singleNode && (node = node->next) != firstNode);
+
+    return count;
+}
+
+static void geo_flatten_list(struct AllocOnlyPool *pool, struct GraphNode *firstNode, s32 singleNode);
+
+/**
+ * Flattens the children of a node that falls back to geo_process_node, which calls
+ * geo_process_node_and_siblings on them.
+ */
+static void geo_flatten_children(struct AllocOnlyPool *pool, struct GraphNode *node) {
+    struct GraphNode *child = node->children;
+
+    switch (node->type) {
+        // Children of these can be added and removed at runtime, e.g. mirror Mario.
+        case GRAPH_NODE_TYPE_GENERATED_LIST:
+        case GRAPH_NODE_TYPE_OBJECT:
+            break;
+        // Only one child at a time is processed.
+        case GRAPH_NODE_TYPE_SWITCH_CASE:
+        case GRAPH_NODE_TYPE_ROOMS:
+            do {
+                geo_flatten_list(pool, child, TRUE);
+            } while ((child = child->next) != node->children);
+            break;
+        default:
+            geo_flatten_list(pool, child, FALSE);
+            break;
+    }
+}
+
+static struct GeoFlatNode *geo_fill_flat_nodes(struct AllocOnlyPool *pool, struct GeoFlatNode *entry,
+                                               struct GraphNode *firstNode, s32 depth, s32 singleNode) {
+    struct GraphNode *node = firstNode;
+    s32 pushesMatrix;
+
+    do {
+        struct GeoFlatNode *nodeEntry = entry++;
+        GeoFlatFunc func = geo_get_flat_func(node, &pushesMatrix);
+
+        nodeEntry->node = node;
+        nodeEntry->func = (func != NULL) ? func : geo_flat_fallback;
+        nodeEntry->depth = depth;
+        if (node->children != NULL) {
+            if (func != NULL) {
+                entry = geo_fill_flat_nodes(pool, entry, node->children, depth + pushesMatrix, FALSE);
+            } else {
+                geo_flatten_children(pool, node);
+            }
+        }
+        nodeEntry->numDescendants = entry - nodeEntry - 1;
+    } while (!singleNode && (node = node->next) != firstNode);
+
+    return entry;
+}
+
+static void geo_flatten_list(struct AllocOnlyPool *pool, struct GraphNode *firstNode, s32 singleNode) {
+    s32 numNodes = geo_count_flat_nodes(firstNode, singleNode);
+    struct GeoFlatList *list =
+        alloc_only_pool_alloc(pool, sizeof(struct GeoFlatList) + numNodes * sizeof(struct GeoFlatNode));
+
+    list->firstNode = firstNode;
+    list->numNodes = numNodes;
+    geo_fill_flat_nodes(pool, list->nodes, firstNode, 0, singleNode);
+    sGeoFlatLists[GEO_FLAT_LIST_SLOT(firstNode)] = list;
+}
+
+/**
+ * Lays out a geo layout processed by process_geo_layout as flat lists, allocated from the same pool.
+ * Lists nested in nodes that need to process their children themselves, such as switch cases,
+ * get their own flat lists.
+ */
+void geo_flatten_layout(struct AllocOnlyPool *pool, struct GraphNode *root) {
+    if (root != NULL) {
+        geo_flatten_list(pool, root, FALSE);
     }
 }
 
+/**
+ * Forgets all flat lists. Called when the pool they were allocated from is freed.
+ */
+void geo_clear_flat_layouts(void) {
+    bzero(sGeoFlatLists, sizeof(sGeoFlatLists));
+}
+
+/**
+ * Processes a flat list in a single loop. The matrix stack is set to each node's depth instead of
+ * being popped after its children, and subtrees that aren't drawn are skipped over.
+ */
+static void geo_process_flat_list(struct GeoFlatList *list) {
+    struct GeoFlatNode *entry = list->nodes;
+    struct GeoFlatNode *end = entry + list->numNodes;
+    s16 baseIndex = gMatStackIndex;
+
+    while (entry < end) {
+        struct GraphNode *node = entry->node;
+
+        gMatStackIndex = baseIndex + entry->depth;
+        if (!(node->flags & GRAPH_RENDER_ACTIVE)) {
+            if (node->type == GRAPH_NODE_TYPE_OBJECT) {
+                ((struct GraphNodeObject *) node)->throwMatrix = NULL;
+            }
+            entry += entry->numDescendants + 1;
+        } else if (node->flags & GRAPH_RENDER_CHILDREN_FIRST) {
+            geo_try_process_children(node);
+            entry += entry->numDescendants + 1;
+        } else if (entry->func(node)) {
+            entry++;
+        } else {
+            entry += entry->numDescendants + 1;
+        }
+    }
+
+    gMatStackIndex = baseIndex;
+}
+#endif
+
 /**
  * Process a generic geo node and its siblings.
  * The first argument is the start node, and all its siblings will
@@ -1190,10 +1932,20 @@ void geo_process_node_and_siblings(struct GraphNode *firstNode) {
     struct GraphNode *curGraphNode = firstNode;
     struct GraphNode *parent = curGraphNode->parent;
 
+#ifdef FLAT_GEO_LAYOUTS
+    struct GeoFlatList *flatList = sGeoFlatLists[GEO_FLAT_LIST_SLOT(firstNode)];
+
+    if (flatList != NULL && flatList->firstNode == firstNode) {
+        geo_process_flat_list(flatList);
+        return;
+    }
+#endif
+
     // In the case of a switch node, exactly one of the children of the node is
-    // processed instead of all children like usual
+    // processed instead of all children like usual. Rooms nodes process their
+    // visible children one by one.
     if (parent != NULL) {
-        iterateChildren = (parent->type != GRAPH_NODE_TYPE_SWITCH_CASE);
+        iterateChildren = (parent->type != GRAPH_NODE_TYPE_SWITCH_CASE && parent->type != GRAPH_NODE_TYPE_ROOMS);
     }
 
     do {
@@ -1201,29 +1953,7 @@ void geo_process_node_and_siblings(struct GraphNode *firstNode) {
             if (curGraphNode->flags & GRAPH_RENDER_CHILDREN_FIRST) {
                 geo_try_process_children(curGraphNode);
             } else {
-                switch (curGraphNode->type) {
-                    case GRAPH_NODE_TYPE_ORTHO_PROJECTION:     geo_process_ortho_projection    ((struct GraphNodeOrthoProjection     *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_PERSPECTIVE:          geo_process_perspective         ((struct GraphNodePerspective         *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_MASTER_LIST:          geo_process_master_list         ((struct GraphNodeMasterList          *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_LEVEL_OF_DETAIL:      geo_process_level_of_detail     ((struct GraphNodeLevelOfDetail       *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_SWITCH_CASE:          geo_process_switch              ((struct GraphNodeSwitchCase          *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_CAMERA:               geo_process_camera              ((struct GraphNodeCamera              *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_TRANSLATION_ROTATION: geo_process_translation_rotation((struct GraphNodeTranslationRotation *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_TRANSLATION:          geo_process_translation         ((struct GraphNodeTranslation         *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_ROTATION:             geo_process_rotation            ((struct GraphNodeRotation            *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_OBJECT:               geo_process_object              ((struct Object                       *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_ANIMATED_PART:        geo_process_animated_part       ((struct GraphNodeAnimatedPart        *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_BILLBOARD:            geo_process_billboard           ((struct GraphNodeBillboard           *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_DISPLAY_LIST:         geo_process_display_list        ((struct GraphNodeDisplayList         *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_SCALE:                geo_process_scale               ((struct GraphNodeScale               *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_SHADOW:               geo_process_shadow              ((struct GraphNodeShadow              *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_OBJECT_PARENT:        geo_process_object_parent       ((struct GraphNodeObjectParent        *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_GENERATED_LIST:       geo_process_generated_list      ((struct GraphNodeGenerated           *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_BACKGROUND:           geo_process_background          ((struct GraphNodeBackground          *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_HELD_OBJ:             geo_process_held_object         ((struct GraphNodeHeldObject          *) curGraphNode); break;
-                    case GRAPH_NODE_TYPE_BONE:                 geo_process_bone                ((struct GraphNodeBone                *) curGraphNode); break;
-                    default:                                   geo_try_process_children        ((struct GraphNode                    *) curGraphNode); break;
-                }
+                geo_process_node(curGraphNode);
             }
         } else {
             if (curGraphNode->type == GRAPH_NODE_TYPE_OBJECT) {
@@ -1247,6 +1977,12 @@ void geo_process_root(struct GraphNodeRoot *node, Vp *b, Vp *c, s32 clearColor)
         initialMatrix = alloc_display_list(sizeof(*initialMatrix));
         gMatStackIndex = 0;
         gCurrAnimType = ANIM_TYPE_NONE;
+#ifdef ANIMATION_POSE_CACHE
+        sPoseCacheTimestamp++;
+#endif
+#ifdef DISPLAY_LIST_INSTANCING
+        sGeneratedListDrawn = FALSE;
+#endif
         vec3s_set(viewport->vp.vtrans, node->x * 4, node->y * 4, 511);
         vec3s_set(viewport->vp.vscale, node->width * 4, node->height * 4, 511);
 
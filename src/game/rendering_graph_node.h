@@ -86,5 +86,9 @@ enum AnimType {
 
 void geo_process_node_and_siblings(struct GraphNode *firstNode);
 void geo_process_root(struct GraphNodeRoot *node, Vp *b, Vp *c, s32 clearColor);
+#ifdef FLAT_GEO_LAYOUTS
+void geo_flatten_layout(struct AllocOnlyPool *pool, struct GraphNode *root);
+void geo_clear_flat_layouts(void);
+#endif
 
 #endif // RENDERING_GRAPH_NODE_H
@@ -1,10 +1,11 @@
-#include <PR/ultratypes.h>
+#include <ultra64.h>
 
 #include "audio/external.h"
 #include "engine/geo_layout.h"
 #include "engine/graph_node.h"
 #include "engine/math_util.h"
 #include "engine/surface_collision.h"
+#include "engine/surface_load.h"
 #include "level_table.h"
 #include "object_constants.h"
 #include "object_fields.h"
@@ -102,30 +103,60 @@ void unload_object(struct Object *obj) {
 
     obj->header.gfx.node.flags &= ~(GRAPH_RENDER_BILLBOARD | GRAPH_RENDER_ACTIVE);
 
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+    unload_object_surfaces(obj);
+#endif
+
     deallocate_object(&gFreeObjectList, &obj->header);
 }
 
+/**
+ * The number of times an object couldn't be spawned because the pool was full of objects that can't
+ * be unloaded.
+ */
+u32 gObjectPoolOverflowCount;
+
+/**
+ * Handed out instead of a pool slot when the pool is exhausted, so the caller can still set up the
+ * object it asked for. It isn't in any object list or in the scene graph, so it never updates or renders.
+ */
+static struct Object sOverflowObject;
+static struct GraphNode sOverflowGraphNode;
+
+static struct Object *allocate_overflow_object(void) {
+    struct Object *obj = &sOverflowObject;
+
+    gObjectPoolOverflowCount++;
+
+    if (obj->header.gfx.node.parent == NULL) {
+        geo_add_child(&sOverflowGraphNode, &obj->header.gfx.node);
+    }
+    obj->header.next = &obj->header;
+    obj->header.prev = &obj->header;
+
+    return obj;
+}
+
 /**
  * Attempt to allocate a new object slot into the given object list, freeing
- * an unimportant object if necessary. If this is not possible, hang using an
- * infinite loop.
+ * an unimportant object if necessary. If this is not possible, the spawn is
+ * counted in gObjectPoolOverflowCount and an object that does nothing is
+ * returned instead.
  */
 struct Object *allocate_object(struct ObjectNode *objList) {
-    s32 i;
     struct Object *obj = try_allocate_object(objList, &gFreeObjectList);
 
     // The object list is full if the newly created pointer is NULL.
     // If this happens, we first attempt to unload unimportant objects
     // in order to finish allocating the object.
     if (obj == NULL) {
-        // Look for an unimportant object to kick out.
+        // Look for an unimportant object to kick out. Objects are appended to
+        // their list, so this is the oldest one.
         struct Object *unimportantObj = find_unimportant_object();
 
         // If no unimportant object exists, then the object pool is exhausted.
         if (unimportantObj == NULL) {
-            // We've met with a terrible fate.
-            while (TRUE) {
-            }
+            obj = allocate_overflow_object();
         } else {
             // If an unimportant object does exist, unload it and take its slot.
             unload_object(unimportantObj);
@@ -147,15 +178,9 @@ struct Object *allocate_object(struct ObjectNode *objList) {
     obj->collidedObjInteractTypes = 0;
     obj->numCollidedObjs = 0;
 
+    bzero(&obj->rawData, sizeof(obj->rawData));
 #if IS_64_BIT
-    for (i = 0; i < MAX_OBJECT_FIELDS; i++) {
-        obj->rawData.asS32[i] = 0;
-        obj->ptrData.asVoidPtr[i] = NULL;
-    }
-#else
-    for (i = 0; i < MAX_OBJECT_FIELDS; i++) {
-        obj->rawData.asS32[i] = 0;
-    }
+    bzero(&obj->ptrData, sizeof(obj->ptrData));
 #endif
 
     obj->unused1 = 0;
@@ -196,6 +221,11 @@ struct Object *allocate_object(struct ObjectNode *objList) {
     obj->oLightID = 0xFFFF;
 #endif
 
+    if (obj == &sOverflowObject) {
+        // Anything that watches this object for it to despawn sees it as gone.
+        obj->activeFlags = ACTIVE_FLAG_DEACTIVATED;
+    }
+
     return obj;
 }
 
@@ -221,7 +251,7 @@ struct Object *create_object(const BehaviorScript *bhvScript) {
     obj->curBhvCommand = bhvScript;
     obj->behavior = bhvScript;
 
-    if (objListIndex == OBJ_LIST_UNIMPORTANT) {
+    if (objListIndex == OBJ_LIST_UNIMPORTANT && (obj->activeFlags & ACTIVE_FLAG_ACTIVE)) {
         obj->activeFlags |= ACTIVE_FLAG_UNIMPORTANT;
     }
 
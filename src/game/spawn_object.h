@@ -3,6 +3,8 @@
 
 #include "types.h"
 
+extern u32 gObjectPoolOverflowCount;
+
 void init_free_object_list(void);
 void clear_object_lists(struct ObjectNode *objLists);
 void unload_object(struct Object *obj);
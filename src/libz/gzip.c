@@ -14,6 +14,13 @@ static void *myalloc(voidpf opaque, unsigned int nItems, unsigned int size)
 {
     void *ptr;
 
+    /*
+     * expand_gzip_stream passes its own buffer for the window
+     */
+    if (opaque != Z_NULL && nItems * size == (1U << MAX_WBITS)) {
+        return opaque;
+    }
+
     ptr = &gzip_mem[gzip_mem_next];
     gzip_mem_next += nItems*size;
 
@@ -72,3 +79,52 @@ expand_gzip(char *in, char *outbuf, unsigned int inLength, unsigned int outbufLe
     return d_stream.total_out;
 
 }
+
+/*
+ * Same as expand_gzip, but the input is handed over in blocks by read, which returns NULL once there are no more.
+ * Blocks are used up before the next one is read. Inflating in more than one call needs the 32KB window, which is
+ * passed in instead of being allocated.
+ */
+int
+expand_gzip_stream(char *outbuf, unsigned int outbufLength, unsigned char *(*read)(void *arg, unsigned int *size),
+                   void *arg, char *window)
+{
+    int err;
+    z_stream d_stream; /* decompression stream */
+
+    d_stream.zalloc = (alloc_func) myalloc;
+    d_stream.zfree = (free_func) myfree;
+    d_stream.opaque = (voidpf)window;
+
+    d_stream.next_in  = Z_NULL;
+    d_stream.avail_in = 0;
+    d_stream.next_out = outbuf;
+    d_stream.avail_out = outbufLength;
+
+    err = inflateInit2(&d_stream, -MAX_WBITS);
+    if (err != Z_OK) {
+        return err;
+    }
+
+    do {
+        if (d_stream.avail_in == 0) {
+            d_stream.next_in = read(arg, &d_stream.avail_in);
+            if (d_stream.next_in == Z_NULL) {
+                break;
+            }
+        }
+        err = inflate(&d_stream, Z_NO_FLUSH);
+    } while (err == Z_OK);
+
+    if (err != Z_OK && err != Z_STREAM_END) {
+        inflateEnd(&d_stream);
+        return err;
+    }
+
+    err = inflateEnd(&d_stream);
+    if (err != Z_OK) {
+        return err;
+    }
+
+    return d_stream.total_out;
+}
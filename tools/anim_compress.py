@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+Converts animations to the compact format read by retrieve_compressed_animation_value in
+src/engine/graph_node.c. mario_anims_converter.py uses it for Mario's animations with COMPRESS_ANIMS=1.
+
+struct Animation keeps its layout, index still has a pair of u16s per attribute and values is still an
+s16 array, but with ANIM_FLAG_COMPRESSED the pairs are read differently:
+
+  (0x0000, value)                                 same value on every frame, kept in the pair itself
+  (numFrames, offset)                             raw values, values[offset + frame] as before
+  (0x8000 | shift << 12 | numFrames, offset)      delta coded, in blocks of 15 frames starting at
+                                                  values[offset]: an s16 key value and 14 s8 deltas
+                                                  packed two per s16, high byte first. Each delta is
+                                                  shifted left by shift before it is added.
+
+Frames at the end of an attribute that repeat the one before it are dropped, the last frame is held
+anyway. Identical attribute data is only stored once per animation.
+
+Deltas are lossless unless a maximum error is given, in which case rotations whose deltas don't fit
+in 8 bits are quantized: the smallest shift that keeps every frame within the error is used. Errors
+don't add up from frame to frame, since the deltas are taken from the decoded values. The root
+translation is always kept exact, Mario's position follows it.
+
+Run on its own, it prints how much smaller the given animation files get:
+  anim_compress.py [--max-error <n>] <anim.inc.c>...
+"""
+import re
+import sys
+
+ANIM_FLAG_COMPRESSED = 0x100
+
+ATTRIBUTE_CONSTANT = 0x0000
+ATTRIBUTE_DELTA = 0x8000
+MAX_FRAMES = 0xFFF
+MAX_SHIFT = 7
+
+BLOCK_FRAMES = 15
+BLOCK_SIZE = 8
+
+# The first three attributes are the root translation, everything after that is rotations.
+NUM_TRANSLATION_ATTRIBUTES = 3
+
+
+def to_s16(value):
+    value &= 0xFFFF
+    return value - 0x10000 if value >= 0x8000 else value
+
+
+def attribute_frames(indices, values, attribute):
+    num_frames, offset = indices[attribute * 2], indices[attribute * 2 + 1]
+    if num_frames == 0:
+        # retrieve_animation_index reads the value before offset on every frame.
+        return [values[offset - 1]]
+    frames = values[offset:offset + num_frames]
+    while len(frames) > 1 and frames[-1] == frames[-2]:
+        frames.pop()
+    return frames
+
+
+def encode_delta(frames, shift, max_error):
+    data = []
+    for start in range(0, len(frames), BLOCK_FRAMES):
+        decoded = frames[start]
+        deltas = []
+        for value in frames[start + 1:start + BLOCK_FRAMES]:
+            delta = to_s16(value - decoded)
+            delta = max(-0x80, min(0x7F, (delta + ((1 << shift) >> 1)) >> shift))
+            decoded = to_s16(decoded + (delta << shift))
+            if abs(to_s16(value - decoded)) > max_error:
+                return None
+            deltas.append(delta)
+
+        data.append(frames[start])
+        if len(deltas) % 2 != 0:
+            deltas.append(0)
+        for i in range(0, len(deltas), 2):
+            data.append(to_s16(((deltas[i] & 0xFF) << 8) | (deltas[i + 1] & 0xFF)))
+    return data
+
+
+def encode_attribute(frames, max_error):
+    """
+    Returns the header and the data of one attribute, with the data None for constant attributes.
+    """
+    if len(frames) == 1:
+        return ATTRIBUTE_CONSTANT, frames[0] & 0xFFFF, None
+
+    best = (len(frames), frames)
+    if len(frames) <= MAX_FRAMES:
+        for shift in range(0, MAX_SHIFT + 1 if max_error > 0 else 1):
+            data = encode_delta(frames, shift, max_error)
+            if data is not None:
+                if len(data) < len(best[1]):
+                    best = (ATTRIBUTE_DELTA | (shift << 12) | len(frames), data)
+                break
+    return best[0], None, best[1]
+
+
+def decode_attribute(header, offset, values, frame):
+    """
+    Same as retrieve_compressed_animation_value.
+    """
+    if header == ATTRIBUTE_CONSTANT:
+        return to_s16(offset)
+
+    frame = max(0, min(frame, (header & MAX_FRAMES) - 1))
+    if not (header & ATTRIBUTE_DELTA):
+        return values[offset + frame]
+
+    shift = (header >> 12) & MAX_SHIFT
+    block = offset + (frame // BLOCK_FRAMES) * BLOCK_SIZE
+    value = values[block]
+    for i in range(frame % BLOCK_FRAMES):
+        word = values[block + 1 + i // 2]
+        delta = to_s16(word) >> 8 if i % 2 == 0 else to_s16(word << 8) >> 8
+        value = to_s16(value + (delta << shift))
+    return value
+
+
+def compress_animation(indices, values, max_error=0):
+    """
+    Takes the index and value arrays of an animation as lists of ints and returns the compressed ones.
+    """
+    values = [to_s16(v) for v in values]
+    new_indices = []
+    new_values = []
+    offsets = {}
+
+    for attribute in range(len(indices) // 2):
+        error = max_error if attribute >= NUM_TRANSLATION_ATTRIBUTES else 0
+        frames = attribute_frames(indices, values, attribute)
+        header, offset, data = encode_attribute(frames, error)
+        if data is not None:
+            key = (header, tuple(data))
+            if key not in offsets:
+                offsets[key] = len(new_values)
+                new_values.extend(data)
+            offset = offsets[key]
+            if offset > 0xFFFF:
+                raise ValueError("animation data too large to compress")
+        new_indices += [header, offset]
+
+        # Every frame the attribute can be shown at has to come back out within the error.
+        num_frames, original_offset = indices[attribute * 2], indices[attribute * 2 + 1]
+        for frame in range(max(num_frames, 1) + 1):
+            original = values[original_offset + min(frame, num_frames - 1)]
+            decoded = decode_attribute(header, offset, new_values, frame)
+            if abs(to_s16(original - decoded)) > error:
+                raise ValueError("attribute {} decodes to {} instead of {} on frame {}".format(
+                    attribute, decoded, original, frame))
+
+    return new_indices, new_values
+
+
+def parse_array(text):
+    text = re.sub(r"//.*|/\*.*?\*/", "", text, flags=re.S)
+    return [int(token, 0) for token in re.findall(r"-?(?:0x[0-9A-Fa-f]+|\d+)", text)]
+
+
+def parse_anim_file(path):
+    """
+    Returns (indices, values) for every distinct pair of arrays the file's animations use.
+    """
+    with open(path) as f:
+        text = f.read()
+
+    arrays = {}
+    for match in re.finditer(r"(?:u16|s16)\s+(\w+)\[\]\s*=\s*\{(.*?)\};", text, re.S):
+        arrays[match.group(1)] = parse_array(match.group(2))
+
+    pairs = []
+    for match in re.finditer(r"struct Animation\s+\w+(?:\[\])?\s*=\s*\{(.*?)\};", text, re.S):
+        fields = [field.strip() for field in match.group(1).split(",")]
+        values, indices = fields[6], fields[7]
+        if (indices, values) not in pairs and indices in arrays and values in arrays:
+            pairs.append((indices, values))
+    return [(arrays[indices], arrays[values]) for indices, values in pairs]
+
+
+def main():
+    args = sys.argv[1:]
+    max_error = 0
+    if len(args) >= 2 and args[0] == "--max-error":
+        max_error = int(args[1])
+        args = args[2:]
+    if not args or args[0] in ("-h", "--help"):
+        print("Usage: {} [--max-error <n>] <anim.inc.c>...".format(sys.argv[0]))
+        sys.exit(0 if args else 1)
+
+    total_before = total_after = 0
+    for path in args:
+        before = after = 0
+        for indices, values in parse_anim_file(path):
+            new_indices, new_values = compress_animation(indices, values, max_error)
+            before += (len(indices) + len(values)) * 2
+            after += (len(new_indices) + len(new_values)) * 2
+        if len(args) > 1:
+            print("{:<48} {:7d} {:7d}".format(path, before, after))
+        total_before += before
+        total_after += after
+
+    print("{} bytes -> {} bytes ({:.1f}%)".format(total_before, total_after,
+                                                   100.0 * total_after / max(total_before, 1)))
+
+
+if __name__ == "__main__":
+    main()
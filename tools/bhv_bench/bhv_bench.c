@@ -0,0 +1,310 @@
+/**
+ * bhv_bench: host-native check and benchmark for the behavior script interpreter.
+ *
+ * data/behavior_data.c and src/engine/behavior_script.c are compiled for the host, the latter
+ * twice: once as configured, and once without BEHAVIOR_SCRIPT_PREDECODE as the reference
+ * (cur_obj_update_reference). The native functions scripts call are empty stubs, see
+ * gen_bhv_stubs.py, so what is measured is the cost of running the scripts themselves.
+ *
+ * Every script in behavior_data.c that starts with BEGIN is run on a few objects for a number of
+ * frames through both interpreters, along with a few scripts of the bench's own for commands
+ * behavior_data.c never uses. The objects are compared byte for byte after every frame, then both
+ * interpreters are timed over the same frames.
+ *
+ * Build with `make -C tools/bhv_bench`, then run `./bhv_bench -h` for usage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "engine/behavior_script.h"
+#include "engine/math_util.h"
+#include "engine/surface_collision.h"
+#include "game/area.h"
+#include "game/game_init.h"
+#include "game/memory.h"
+#include "game/object_helpers.h"
+#include "game/object_list_processor.h"
+
+#include "bhv_bench.h"
+
+#define MAX_BENCH_OBJECTS 64
+
+struct BenchOptions {
+    s32 numObjects;
+    s32 numFrames;
+    s32 numTimedRuns;
+    s32 verbose;
+};
+
+struct Object *gCurrentObject;
+struct Object *gMarioObject;
+const BehaviorScript *gCurBhvCommand;
+u32 gGlobalTimer;
+
+static struct GraphNode *sLoadedGraphNodes[0x10000];
+struct GraphNode **gLoadedGraphNodes = sLoadedGraphNodes;
+
+// Scripts for commands behavior_data.c doesn't use, in the same encoding.
+#define BENCH_CMD(cmd, field, value) (((cmd) << 24) | ((field) << 16) | ((value) & 0xFFFF))
+#define BENCH_CMD_B(cmd)             ((cmd) << 24)
+
+// BIT_CLEAR clears the upper half of the field as well, which a decoded loop has to match.
+static const BehaviorScript sBitClearScript[] = {
+    BENCH_CMD(BHV_CMD_BEGIN, OBJ_LIST_DEFAULT, 0),
+    BENCH_CMD_B(BHV_CMD_BEGIN_LOOP),
+        BENCH_CMD(BHV_CMD_SET_INT, 0x31, -1),   // oAction = 0xFFFFFFFF
+        BENCH_CMD(BHV_CMD_BIT_CLEAR, 0x31, 0x00F0),
+        BENCH_CMD(BHV_CMD_ADD_INT, 0x31, 1),
+    BENCH_CMD_B(BHV_CMD_END_LOOP),
+};
+
+static const struct BenchScript sBenchOnlyScripts[] = {
+    { "bench_bit_clear", sBitClearScript },
+};
+
+static struct Object sReferenceObjects[MAX_BENCH_OBJECTS];
+static struct Object sObjects[MAX_BENCH_OBJECTS];
+static struct Object sMario;
+static struct Object sSpawnedObject;
+static u32 sRandomState;
+
+static f64 get_time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**************************************************
+ *               HOST REPLACEMENTS                *
+ **************************************************/
+
+// Everything else scripts and cur_obj_update call is an empty stub.
+
+u32 random_u16(void) {
+    // xorshift32, reseeded the same way for both interpreters.
+    sRandomState ^= sRandomState << 13;
+    sRandomState ^= sRandomState >> 17;
+    sRandomState ^= sRandomState << 5;
+    return (sRandomState & 0xFFFF);
+}
+
+f32 random_float(void) {
+    return random_u16() / (f32) 0x10000;
+}
+
+f32 dist_between_objects(struct Object *obj1, struct Object *obj2) {
+    f32 dx = obj2->oPosX - obj1->oPosX;
+    f32 dy = obj2->oPosY - obj1->oPosY;
+    f32 dz = obj2->oPosZ - obj1->oPosZ;
+
+    return sqrtf(sqr(dx) + sqr(dy) + sqr(dz));
+}
+
+s32 obj_angle_to_object(UNUSED struct Object *obj1, UNUSED struct Object *obj2) {
+    return 0;
+}
+
+f32 find_floor_height(UNUSED f32 x, UNUSED f32 y, UNUSED f32 z) {
+    return 0.0f;
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+struct Object *spawn_object_at_origin(UNUSED struct Object *parent, UNUSED s32 unusedArg, UNUSED ModelID32 model,
+                                      UNUSED const BehaviorScript *behavior) {
+    return &sSpawnedObject;
+}
+
+void vec3f_copy(Vec3f dest, const Vec3f src) {
+    vec3_copy(dest, src);
+}
+
+void vec3i_copy(Vec3i dest, const Vec3i src) {
+    vec3_copy(dest, src);
+}
+
+/**************************************************
+ *                     BENCH                      *
+ **************************************************/
+
+static void init_objects(struct Object *objects, s32 numObjects, const BehaviorScript *script) {
+    s32 i;
+
+    memset(objects, 0, numObjects * sizeof(struct Object));
+    for (i = 0; i < numObjects; i++) {
+        struct Object *obj = &objects[i];
+
+        obj->activeFlags = ACTIVE_FLAG_ACTIVE;
+        obj->curBhvCommand = script;
+        obj->behavior = script;
+        obj->parentObj = &sMario;
+        obj->oPosX = i * 150.0f;
+        obj->oPosZ = i * -75.0f;
+        obj->oRoom = -1;
+        obj->oIntangibleTimer = -1;
+        obj->oDrawingDistance = 4000.0f;
+        obj->oBehParams = i;
+        obj->oBehParams2ndByte = i;
+    }
+}
+
+static void run_frame(struct Object *objects, s32 numObjects, s32 frame, void (*update)(void)) {
+    s32 i;
+
+    gGlobalTimer = frame;
+    for (i = 0; i < numObjects; i++) {
+        sRandomState = ((frame * MAX_BENCH_OBJECTS + i) * 0x9E3779B9) | 1;
+        gCurrentObject = &objects[i];
+        update();
+    }
+}
+
+/**
+ * Runs a script through both interpreters. Returns whether the objects match on every frame.
+ */
+static s32 run_script(const struct BenchScript *bench, struct BenchOptions *opts, f64 *referenceNs, f64 *decodedNs) {
+    f64 start, scriptReferenceNs = 0.0, scriptDecodedNs = 0.0;
+    s32 frame, run;
+
+#ifdef BEHAVIOR_SCRIPT_PREDECODE
+    // Like a level load, so scripts don't fill the decoded loop table for each other.
+    clear_bhv_loops();
+#endif
+    init_objects(sReferenceObjects, opts->numObjects, bench->script);
+    init_objects(sObjects, opts->numObjects, bench->script);
+
+    for (frame = 0; frame < opts->numFrames; frame++) {
+        run_frame(sReferenceObjects, opts->numObjects, frame, cur_obj_update_reference);
+        run_frame(sObjects, opts->numObjects, frame, cur_obj_update);
+
+        if (memcmp(sReferenceObjects, sObjects, opts->numObjects * sizeof(struct Object)) != 0) {
+            fprintf(stderr, "%s: objects differ on frame %d\n", bench->name, frame);
+            return FALSE;
+        }
+    }
+
+    for (run = 0; run < opts->numTimedRuns; run++) {
+        init_objects(sReferenceObjects, opts->numObjects, bench->script);
+        start = get_time_ns();
+        for (frame = 0; frame < opts->numFrames; frame++) {
+            run_frame(sReferenceObjects, opts->numObjects, frame, cur_obj_update_reference);
+        }
+        scriptReferenceNs += get_time_ns() - start;
+
+        init_objects(sObjects, opts->numObjects, bench->script);
+        start = get_time_ns();
+        for (frame = 0; frame < opts->numFrames; frame++) {
+            run_frame(sObjects, opts->numObjects, frame, cur_obj_update);
+        }
+        scriptDecodedNs += get_time_ns() - start;
+    }
+
+    if (opts->verbose) {
+        f64 numUpdates = (f64) opts->numTimedRuns * opts->numFrames * opts->numObjects;
+
+        printf("%-40s %8.1f %8.1f\n", bench->name, scriptReferenceNs / numUpdates, scriptDecodedNs / numUpdates);
+    }
+
+    *referenceNs += scriptReferenceNs;
+    *decodedNs += scriptDecodedNs;
+    return TRUE;
+}
+
+/**************************************************
+ *                      MAIN                      *
+ **************************************************/
+
+static void usage(const char *name) {
+    printf("Usage: %s [options]\n"
+           "  -o <count>    objects per script (default 16, max %d)\n"
+           "  -f <frames>   frames per script (default 120)\n"
+           "  -t <count>    timed runs per script (default 5)\n"
+           "  -v            print the time per object update of every script\n",
+           name, MAX_BENCH_OBJECTS);
+}
+
+int main(int argc, char *argv[]) {
+    struct BenchOptions opts = {
+        .numObjects = 16,
+        .numFrames = 120,
+        .numTimedRuns = 5,
+        .verbose = FALSE,
+    };
+    f64 referenceNs = 0.0, decodedNs = 0.0;
+    s32 i, numScripts = 0, numMismatches = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (strcmp(arg, "-v") == 0) {
+            opts.verbose = TRUE;
+            continue;
+        }
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        switch (arg[1]) {
+            case 'o': opts.numObjects   = CLAMP(atoi(value), 1, MAX_BENCH_OBJECTS); break;
+            case 'f': opts.numFrames    = MAX(1, atoi(value));                      break;
+            case 't': opts.numTimedRuns = MAX(1, atoi(value));                      break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    gMarioObject = &sMario;
+    if (opts.verbose) {
+        printf("%-40s %8s %8s\n", "script", "ref ns", "ns");
+    }
+
+    for (i = 0; i < gNumBenchScripts; i++) {
+        // Scripts that don't start with BEGIN are only ever called or jumped into from other scripts.
+        if ((gBenchScripts[i].script[0] >> 24) != BHV_CMD_BEGIN) {
+            continue;
+        }
+
+        if (!run_script(&gBenchScripts[i], &opts, &referenceNs, &decodedNs)) {
+            numMismatches++;
+        }
+        numScripts++;
+    }
+    for (i = 0; i < (s32) ARRAY_COUNT(sBenchOnlyScripts); i++) {
+        if (!run_script(&sBenchOnlyScripts[i], &opts, &referenceNs, &decodedNs)) {
+            numMismatches++;
+        }
+        numScripts++;
+    }
+
+    f64 numUpdates = (f64) numScripts * opts.numTimedRuns * opts.numFrames * opts.numObjects;
+
+    printf("%d scripts, %d objects each, %d frames\n", numScripts, opts.numObjects, opts.numFrames);
+    printf("reference:  %8.1f ns per object update\n", referenceNs / numUpdates);
+    printf("decoded:    %8.1f ns per object update (%.2fx)\n", decodedNs / numUpdates,
+           (decodedNs > 0.0) ? (referenceNs / decodedNs) : 0.0);
+
+    if (numMismatches > 0) {
+        printf("\n%d script(s) where the objects differ from the reference\n", numMismatches);
+        return EXIT_FAILURE;
+    }
+
+    printf("objects match the reference on every frame\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+#ifndef BHV_BENCH_H
+#define BHV_BENCH_H
+
+#include <PR/ultratypes.h>
+
+#include "types.h"
+
+struct BenchScript {
+    const char *name;
+    const BehaviorScript *script;
+};
+
+// Every script in data/behavior_data.c, see gen_bhv_stubs.py.
+extern const struct BenchScript gBenchScripts[];
+extern const s32 gNumBenchScripts;
+
+// cur_obj_update without BEHAVIOR_SCRIPT_PREDECODE.
+void cur_obj_update_reference(void);
+
+#endif // BHV_BENCH_H
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+Writes bhv_stubs.c for bhv_bench.
+
+Every symbol the engine objects use that no object defines gets an empty function: the native
+functions behavior scripts call, and the models, animations and collision data they point to.
+Scripts only store the addresses of the latter, so an empty function works for both. Scripts
+are the symbols starting with "bhv" that behavior_data.o defines.
+
+Usage: gen_bhv_stubs.py <output> <behavior_data.o> <engine objects...> -- <host objects...>
+"""
+
+import subprocess
+import sys
+
+
+def read_symbols(path):
+    defined = {}
+    undefined = set()
+    out = subprocess.run(["nm", path], check=True, capture_output=True, text=True).stdout
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 2 and parts[0] == "U":
+            undefined.add(parts[1])
+        elif len(parts) == 3:
+            defined[parts[2]] = parts[1]
+    return defined, undefined
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__.strip())
+
+    output, behavior_data = sys.argv[1], sys.argv[2]
+    engine_objects = sys.argv[2:]
+    host_objects = []
+    if "--" in engine_objects:
+        split = engine_objects.index("--")
+        engine_objects, host_objects = engine_objects[:split], engine_objects[split + 1:]
+
+    defined = {}
+    undefined = set()
+    for path in engine_objects + host_objects:
+        d, u = read_symbols(path)
+        defined.update(d)
+        if path in engine_objects:
+            undefined |= u
+
+    scripts = sorted(name for name, kind in read_symbols(behavior_data)[0].items()
+                     if name.startswith("bhv") and kind in "DdRr")
+    stubs = sorted(name for name in undefined - defined.keys() if not name.startswith("_"))
+
+    with open(output, "w") as f:
+        f.write("// Generated by gen_bhv_stubs.py, do not edit.\n\n")
+        f.write('#include "bhv_bench.h"\n\n')
+        for name in stubs:
+            f.write(f"void {name}(void) {{}}\n")
+        f.write("\n")
+        for name in scripts:
+            f.write(f"extern const BehaviorScript {name}[];\n")
+        f.write("\nconst struct BenchScript gBenchScripts[] = {\n")
+        for name in scripts:
+            f.write(f'    {{ "{name}", {name} }},\n')
+        f.write("};\n")
+        f.write("const s32 gNumBenchScripts = ARRAY_COUNT(gBenchScripts);\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,4 @@
+// Force-included before src/engine/behavior_script.c for the reference interpreter.
+// config.h is only included once, so the option stays off for the rest of the file.
+#include "config.h"
+#undef BEHAVIOR_SCRIPT_PREDECODE
@@ -0,0 +1,580 @@
+/**
+ * bake_collision: build-time baker for static area collision.
+ *
+ * Every area's collision.inc.c is loaded through the same load_area_terrain the game uses,
+ * compiled for the host with the game's collision config. The surfaces, cell lists and
+ * quadtrees it builds are then written out as C data (a struct BakedCollision per area),
+ * which the game copies straight into its surface pools instead of computing normals,
+ * sorting surfaces into cells and building quadtrees on every area load.
+ *
+ * With -v every area is loaded both ways and the results are compared, surface by surface
+ * and list entry by list entry, and both load times are reported. When built with
+ * HOST_BAKED_LEVELS (`make verify`), the compared baked collision is the generated C data
+ * itself rather than the baker's in-memory copy of it.
+ *
+ * Build with `make -C tools/collision_bench bake_collision`, then run `./bake_collision -h` for usage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "game/object_list_processor.h"
+#include "engine/math_util.h"
+#include "engine/surface_collision.h"
+#include "engine/surface_load.h"
+
+#include "host_collision.h"
+
+// After ultra64.h, which has struct fields named errno.
+#include <errno.h>
+
+#ifndef BAKED_COLLISION
+#error "bake_collision must be built with -DBAKED_COLLISION"
+#endif
+
+/**
+ * An area's baked collision along with the arrays it points to.
+ */
+struct BakedArea {
+    struct BakedCollision baked;
+    struct Surface *surfaces;
+    u16 *nodes;
+    struct BakedSurfaceList *lists;
+#ifdef STATIC_SURFACE_TREE
+    struct BakedSurfaceTreeNode *treeNodes;
+    struct BakedSurfaceTreeRoot *treeRoots;
+#endif
+    s32 *nodeIndices; // Baked index of each node in sSurfaceNodePool, or -1.
+};
+
+static void *bake_alloc(size_t count, size_t size) {
+    void *buf = calloc(MAX(count, 1), size);
+
+    if (buf == NULL) {
+        fprintf(stderr, "bake_collision: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return buf;
+}
+
+static void free_baked_area(struct BakedArea *area) {
+    free(area->surfaces);
+    free(area->nodes);
+    free(area->lists);
+#ifdef STATIC_SURFACE_TREE
+    free(area->treeNodes);
+    free(area->treeRoots);
+#endif
+    free(area->nodeIndices);
+    memset(area, 0, sizeof(*area));
+}
+
+static f64 get_time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**************************************************
+ *                     BAKING                     *
+ **************************************************/
+
+/**
+ * Appends a static surface list to the baked nodes. Returns the index of its first node.
+ */
+static s32 bake_surface_list(struct BakedArea *area, struct SurfaceNode *node, u16 cell) {
+    struct BakedCollision *baked = &area->baked;
+    s32 start = baked->numNodes;
+
+    for (; node != NULL; node = node->next) {
+        area->nodeIndices[node - sSurfaceNodePool] = baked->numNodes;
+        area->nodes[baked->numNodes++] = (node->surface - sSurfacePool);
+    }
+
+    area->lists[baked->numLists].cell = cell;
+    area->lists[baked->numLists].count = (baked->numNodes - start);
+    baked->numLists++;
+
+    return start;
+}
+
+/**
+ * Bakes the static surfaces and partition of the currently loaded area.
+ * Nodes are stored list by list: every cell list first, then the quadtree lists.
+ */
+static s32 bake_current_area(struct BakedArea *area, const char *name) {
+    struct BakedCollision *baked = &area->baked;
+    s32 cellX, cellZ, listIndex, i;
+
+    memset(area, 0, sizeof(*area));
+
+    if (gNumStaticSurfaces > 0xFFFF || sqr(NUM_CELLS) * NUM_SPATIAL_PARTITIONS >= BAKED_TREE_LIST) {
+        fprintf(stderr, "%s: too many surfaces or cells to bake\n", name);
+        return FALSE;
+    }
+
+    area->surfaces = bake_alloc(gNumStaticSurfaces, sizeof(struct Surface));
+    area->nodes = bake_alloc(gNumStaticSurfaceNodes, sizeof(u16));
+    area->lists = bake_alloc(gNumStaticSurfaceNodes, sizeof(struct BakedSurfaceList));
+    area->nodeIndices = bake_alloc(sSurfaceNodePoolSize, sizeof(s32));
+    memset(area->nodeIndices, 0xFF, sSurfaceNodePoolSize * sizeof(s32));
+
+    memcpy(area->surfaces, sSurfacePool, gNumStaticSurfaces * sizeof(struct Surface));
+    baked->numSurfaces = gNumStaticSurfaces;
+
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < NUM_SPATIAL_PARTITIONS; listIndex++) {
+                struct SurfaceNode *list = gStaticSurfacePartition[cellZ][cellX][listIndex].next;
+
+                if (list != NULL) {
+                    bake_surface_list(area, list, (((cellZ * NUM_CELLS) + cellX) * NUM_SPATIAL_PARTITIONS) + listIndex);
+                }
+            }
+        }
+    }
+
+#ifdef STATIC_SURFACE_TREE
+    baked->numTreeNodes = (gSurfaceTreeNodesAllocated - 1);
+    area->treeNodes = bake_alloc(baked->numTreeNodes, sizeof(struct BakedSurfaceTreeNode));
+    area->treeRoots = bake_alloc(sqr(NUM_CELLS) * NUM_SURFACE_TREE_PARTITIONS, sizeof(struct BakedSurfaceTreeRoot));
+
+    for (i = 0; i < baked->numTreeNodes; i++) {
+        struct SurfaceTreeNode *node = &sSurfaceTreeNodePool[i + 1];
+        struct BakedSurfaceTreeNode *bakedNode = &area->treeNodes[i];
+
+        bakedNode->children = node->children;
+        bakedNode->numSurfaces = node->numSurfaces;
+
+        if (node->list == NULL) {
+            bakedNode->list = 0;
+        } else if (area->nodeIndices[node->list - sSurfaceNodePool] >= 0) {
+            // Roots share their cell's list.
+            bakedNode->list = area->nodeIndices[node->list - sSurfaceNodePool];
+        } else {
+            bakedNode->list = bake_surface_list(area, node->list, BAKED_TREE_LIST);
+        }
+    }
+
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < NUM_SURFACE_TREE_PARTITIONS; listIndex++) {
+                if (gStaticSurfaceTreeRoots[cellZ][cellX][listIndex] != 0) {
+                    struct BakedSurfaceTreeRoot *root = &area->treeRoots[baked->numTreeRoots++];
+
+                    root->cell = (((cellZ * NUM_CELLS) + cellX) * NUM_SURFACE_TREE_PARTITIONS) + listIndex;
+                    root->node = gStaticSurfaceTreeRoots[cellZ][cellX][listIndex];
+                }
+            }
+        }
+    }
+
+    baked->treeNodes = area->treeNodes;
+    baked->treeRoots = area->treeRoots;
+#endif
+
+    // Every static node has to be part of a baked list, or the node counts won't match.
+    if (baked->numNodes != gNumStaticSurfaceNodes) {
+        fprintf(stderr, "%s: baked %d of %d surface nodes\n", name, baked->numNodes, gNumStaticSurfaceNodes);
+        return FALSE;
+    }
+
+    baked->surfaces = area->surfaces;
+    baked->nodes = area->nodes;
+    baked->lists = area->lists;
+
+    return TRUE;
+}
+
+/**************************************************
+ *                     OUTPUT                     *
+ **************************************************/
+
+/**
+ * Creates every directory in a path, like mkdir -p.
+ */
+static s32 make_dirs(const char *path) {
+    char buf[512];
+    char *c;
+
+    snprintf(buf, sizeof(buf), "%s", path);
+
+    for (c = buf + 1; *c != '\0'; c++) {
+        if (*c == '/') {
+            *c = '\0';
+            if (mkdir(buf, 0777) != 0 && errno != EEXIST) {
+                return FALSE;
+            }
+            *c = '/';
+        }
+    }
+
+    return (mkdir(buf, 0777) == 0 || errno == EEXIST);
+}
+
+/**
+ * Prints a float as an exact hex float literal, so the game gets the same bits.
+ */
+static void write_f32(FILE *file, f32 value) {
+    fprintf(file, "%af", (double) value);
+}
+
+static void write_surface(FILE *file, struct Surface *surf) {
+    fprintf(file, "    { .type = 0x%04X, .force = %d, .flags = 0x%02X, .room = %d, .lowerY = %d, .upperY = %d,\n",
+            (u16) surf->type, surf->force, (u8) surf->flags, surf->room, surf->lowerY, surf->upperY);
+    fprintf(file, "      .vertex1 = { %d, %d, %d }, .vertex2 = { %d, %d, %d }, .vertex3 = { %d, %d, %d },\n",
+            surf->vertex1[0], surf->vertex1[1], surf->vertex1[2],
+            surf->vertex2[0], surf->vertex2[1], surf->vertex2[2],
+            surf->vertex3[0], surf->vertex3[1], surf->vertex3[2]);
+    fprintf(file, "      .normal = { ");
+    write_f32(file, surf->normal.x);
+    fprintf(file, ", ");
+    write_f32(file, surf->normal.y);
+    fprintf(file, ", ");
+    write_f32(file, surf->normal.z);
+    fprintf(file, " }, .originOffset = ");
+    write_f32(file, surf->originOffset);
+    fprintf(file, ", .object = NULL },\n");
+}
+
+/**
+ * Writes a pointer field of a struct BakedCollision, NULL for empty arrays.
+ */
+static void write_array_field(FILE *file, const char *field, const char *sym, const char *suffix, s32 count) {
+    if (count > 0) {
+        fprintf(file, "    .%s = %s_baked_%s,\n", field, sym, suffix);
+    } else {
+        fprintf(file, "    .%s = NULL,\n", field);
+    }
+}
+
+/**
+ * Writes an area's baked collision to <dir>/<level>/areas/<area>/collision_baked.inc.c.
+ */
+static s32 write_baked_area(const char *dir, const struct HostLevel *level, struct BakedArea *area) {
+    struct BakedCollision *baked = &area->baked;
+    const char *sym = level->collisionName;
+    char path[512];
+    char levelName[64];
+    const char *areaName = strchr(level->name, '/');
+    FILE *file;
+    s32 i;
+
+    if (areaName == NULL) {
+        return FALSE;
+    }
+    snprintf(levelName, sizeof(levelName), "%.*s", (int) (areaName - level->name), level->name);
+    areaName++;
+
+    snprintf(path, sizeof(path), "%s/%s/areas/%s", dir, levelName, areaName);
+    if (!make_dirs(path)) {
+        perror(path);
+        return FALSE;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s/areas/%s/collision_baked.inc.c", dir, levelName, areaName);
+    file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return FALSE;
+    }
+
+    fprintf(file, "// Baked from levels/%s/areas/%s/collision.inc.c by tools/collision_bench/bake_collision, do not edit.\n", levelName, areaName);
+    fprintf(file, "// %d surfaces, %d surface nodes", baked->numSurfaces, baked->numNodes);
+#ifdef STATIC_SURFACE_TREE
+    fprintf(file, ", %d quadtree nodes", baked->numTreeNodes);
+#endif
+    fprintf(file, ".\n\n#include \"engine/surface_load.h\"\n\n");
+
+    // Baked data only matches the config it was built with.
+    fprintf(file, "#if (NUM_CELLS != %d) || (CELL_SIZE != %d) || (SURFACE_NODE_POOL_SIZE != %d)", (s32) NUM_CELLS, (s32) CELL_SIZE, (s32) SURFACE_NODE_POOL_SIZE);
+#ifdef STATIC_SURFACE_TREE
+    fprintf(file, " \\\n    || !defined(STATIC_SURFACE_TREE) || (STATIC_SURFACE_TREE_LEAF_SIZE != %d) \\\n"
+                  "    || (STATIC_SURFACE_TREE_MAX_DEPTH != %d) || (STATIC_SURFACE_TREE_NODE_POOL_SIZE != %d)",
+            STATIC_SURFACE_TREE_LEAF_SIZE, STATIC_SURFACE_TREE_MAX_DEPTH, STATIC_SURFACE_TREE_NODE_POOL_SIZE);
+#else
+    fprintf(file, " || defined(STATIC_SURFACE_TREE)");
+#endif
+    fprintf(file, "\n#error \"%s was baked with a different collision config\"\n#endif\n\n", path);
+
+    if (baked->numSurfaces > 0) {
+        fprintf(file, "static const struct Surface %s_baked_surfaces[] = {\n", sym);
+        for (i = 0; i < baked->numSurfaces; i++) {
+            write_surface(file, &area->surfaces[i]);
+        }
+        fprintf(file, "};\n\n");
+    }
+
+    if (baked->numNodes > 0) {
+        fprintf(file, "static const u16 %s_baked_nodes[] = {", sym);
+        for (i = 0; i < baked->numNodes; i++) {
+            fprintf(file, "%s%d,", ((i % 16) == 0) ? "\n    " : " ", area->nodes[i]);
+        }
+        fprintf(file, "\n};\n\n");
+
+        fprintf(file, "static const struct BakedSurfaceList %s_baked_lists[] = {", sym);
+        for (i = 0; i < baked->numLists; i++) {
+            fprintf(file, "%s{ 0x%04X, %d },", ((i % 8) == 0) ? "\n    " : " ", area->lists[i].cell, area->lists[i].count);
+        }
+        fprintf(file, "\n};\n\n");
+    }
+
+#ifdef STATIC_SURFACE_TREE
+    if (baked->numTreeNodes > 0) {
+        fprintf(file, "static const struct BakedSurfaceTreeNode %s_baked_tree_nodes[] = {", sym);
+        for (i = 0; i < baked->numTreeNodes; i++) {
+            struct BakedSurfaceTreeNode *node = &area->treeNodes[i];
+            fprintf(file, "%s{ %d, %d, %d },", ((i % 8) == 0) ? "\n    " : " ", node->children, node->numSurfaces, node->list);
+        }
+        fprintf(file, "\n};\n\n");
+    }
+
+    if (baked->numTreeRoots > 0) {
+        fprintf(file, "static const struct BakedSurfaceTreeRoot %s_baked_tree_roots[] = {", sym);
+        for (i = 0; i < baked->numTreeRoots; i++) {
+            fprintf(file, "%s{ 0x%04X, %d },", ((i % 8) == 0) ? "\n    " : " ", area->treeRoots[i].cell, area->treeRoots[i].node);
+        }
+        fprintf(file, "\n};\n\n");
+    }
+#endif
+
+    fprintf(file, "const struct BakedCollision %s_baked = {\n", sym);
+    fprintf(file, "    .numSurfaces = %d,\n", baked->numSurfaces);
+    fprintf(file, "    .numNodes = %d,\n", baked->numNodes);
+    fprintf(file, "    .numLists = %d,\n", baked->numLists);
+    write_array_field(file, "surfaces", sym, "surfaces", baked->numSurfaces);
+    write_array_field(file, "nodes", sym, "nodes", baked->numNodes);
+    write_array_field(file, "lists", sym, "lists", baked->numLists);
+#ifdef STATIC_SURFACE_TREE
+    fprintf(file, "    .numTreeNodes = %d,\n", baked->numTreeNodes);
+    fprintf(file, "    .numTreeRoots = %d,\n", baked->numTreeRoots);
+    write_array_field(file, "treeNodes", sym, "tree_nodes", baked->numTreeNodes);
+    write_array_field(file, "treeRoots", sym, "tree_roots", baked->numTreeRoots);
+#endif
+    fprintf(file, "};\n");
+
+    fclose(file);
+    return TRUE;
+}
+
+/**************************************************
+ *                  VERIFICATION                  *
+ **************************************************/
+
+#define SAME_FIELD(a, b, field) (memcmp(&(a)->field, &(b)->field, sizeof((a)->field)) == 0)
+
+/**
+ * Whether two surfaces have exactly the same bits in every field the game uses.
+ */
+static s32 same_surface(struct Surface *a, struct Surface *b) {
+    return SAME_FIELD(a, b, type) && SAME_FIELD(a, b, force) && SAME_FIELD(a, b, flags) && SAME_FIELD(a, b, room)
+        && SAME_FIELD(a, b, lowerY) && SAME_FIELD(a, b, upperY)
+        && SAME_FIELD(a, b, vertex1) && SAME_FIELD(a, b, vertex2) && SAME_FIELD(a, b, vertex3)
+        && SAME_FIELD(a, b, normal) && SAME_FIELD(a, b, originOffset) && SAME_FIELD(a, b, object);
+}
+
+/**
+ * Compares two bakes of the same area. Returns a description of the first difference, or NULL.
+ */
+static const char *compare_baked_areas(struct BakedArea *a, struct BakedArea *b) {
+    s32 i;
+
+    if (a->baked.numSurfaces != b->baked.numSurfaces) return "surface count";
+    if (a->baked.numNodes != b->baked.numNodes) return "node count";
+    if (a->baked.numLists != b->baked.numLists) return "list count";
+
+    for (i = 0; i < a->baked.numSurfaces; i++) {
+        if (!same_surface(&a->surfaces[i], &b->surfaces[i])) return "surface";
+    }
+    if (memcmp(a->nodes, b->nodes, a->baked.numNodes * sizeof(u16)) != 0) return "cell list order";
+    for (i = 0; i < a->baked.numLists; i++) {
+        if (a->lists[i].cell != b->lists[i].cell || a->lists[i].count != b->lists[i].count) return "cell lists";
+    }
+
+#ifdef STATIC_SURFACE_TREE
+    if (a->baked.numTreeNodes != b->baked.numTreeNodes) return "quadtree node count";
+    if (a->baked.numTreeRoots != b->baked.numTreeRoots) return "quadtree root count";
+    for (i = 0; i < a->baked.numTreeNodes; i++) {
+        if (a->treeNodes[i].children != b->treeNodes[i].children
+            || a->treeNodes[i].numSurfaces != b->treeNodes[i].numSurfaces
+            || a->treeNodes[i].list != b->treeNodes[i].list) {
+            return "quadtree nodes";
+        }
+    }
+    for (i = 0; i < a->baked.numTreeRoots; i++) {
+        if (a->treeRoots[i].cell != b->treeRoots[i].cell || a->treeRoots[i].node != b->treeRoots[i].node) return "quadtree roots";
+    }
+#endif
+
+    return NULL;
+}
+
+/**
+ * Whether every static list is stored in consecutive nodes, which is only the case
+ * when the area was loaded from baked collision.
+ */
+static s32 static_lists_are_baked(void) {
+    s32 i;
+
+    for (i = 0; i < gNumStaticSurfaceNodes; i++) {
+        struct SurfaceNode *next = sSurfaceNodePool[i].next;
+
+        if (next != NULL && next != &sSurfaceNodePool[i + 1]) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static f64 time_loads(const struct HostLevel *level, const struct BakedCollision *baked, s32 numLoads) {
+    f64 start = get_time_ns();
+    s32 i;
+
+    for (i = 0; i < numLoads; i++) {
+        host_load_level_baked(level, baked);
+    }
+
+    return (get_time_ns() - start) / numLoads;
+}
+
+/**
+ * Loads an area from its terrain data and from its baked collision, and checks that both
+ * give the same surfaces and partition. Returns FALSE if they differ.
+ */
+static s32 verify_area(const struct HostLevel *level, struct BakedArea *runtime, s32 numLoads) {
+    const struct BakedCollision *baked = (level->baked != NULL) ? level->baked : &runtime->baked;
+    struct BakedArea loaded;
+    TerrainData *environmentRegions;
+    const char *difference;
+    f64 parseNs, bakedNs;
+
+    host_load_level_baked(level, NULL);
+    environmentRegions = gEnvironmentRegions;
+
+    host_load_level_baked(level, baked);
+    if (!static_lists_are_baked()) {
+        printf("%-20s FAILED: the baked collision didn't fit in the surface pools\n", level->name);
+        return FALSE;
+    }
+    if (!bake_current_area(&loaded, level->name)) {
+        return FALSE;
+    }
+
+    difference = compare_baked_areas(runtime, &loaded);
+    if (difference == NULL && gEnvironmentRegions != environmentRegions) {
+        difference = "environment regions";
+    }
+    free_baked_area(&loaded);
+
+    if (difference != NULL) {
+        printf("%-20s FAILED: %s differs\n", level->name, difference);
+        return FALSE;
+    }
+
+    parseNs = time_loads(level, NULL, numLoads);
+    bakedNs = time_loads(level, baked, numLoads);
+
+    printf("%-20s %8d %8d %12.1f %12.1f %7.1fx  same\n", level->name, runtime->baked.numSurfaces, runtime->baked.numNodes,
+           parseNs / 1000.0, bakedNs / 1000.0, parseNs / bakedNs);
+    return TRUE;
+}
+
+/**************************************************
+ *                      MAIN                      *
+ **************************************************/
+
+static void usage(const char *name) {
+    printf("Usage: %s [options]\n"
+           "  -o <dir>      write <dir>/<level>/areas/<area>/collision_baked.inc.c for every area\n"
+           "  -v            load every area from its terrain data and from its baked collision and\n"
+           "                compare the results, exits non-zero if they differ\n"
+           "  -l <name>     only bake areas whose name (\"<level>/<area>\") contains <name>\n"
+           "  -L <count>    with -v, number of timed loads per area (default 20)\n",
+           name);
+}
+
+int main(int argc, char *argv[]) {
+    const char *outDir = NULL;
+    const char *levelFilter = NULL;
+    s32 verify = FALSE;
+    s32 numLoads = 20;
+    s32 numFailed = 0;
+    s32 i;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-v") == 0) {
+            verify = TRUE;
+            continue;
+        }
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return (strcmp(arg, "-h") == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        switch (arg[1]) {
+            case 'o': outDir      = value;               break;
+            case 'l': levelFilter = value;               break;
+            case 'L': numLoads    = MAX(1, atoi(value)); break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    if (outDir == NULL && !verify) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    host_init_surface_pools();
+
+    if (verify) {
+        printf("%-20s %8s %8s %12s %12s %8s\n", "level", "surfaces", "nodes", "parse us", "baked us", "speedup");
+    }
+
+    for (i = 0; i < gNumHostLevels; i++) {
+        const struct HostLevel *level = &gHostLevels[i];
+        struct BakedArea runtime;
+
+        if (levelFilter != NULL && strstr(level->name, levelFilter) == NULL) {
+            continue;
+        }
+
+        host_load_level_baked(level, NULL);
+
+        if (!bake_current_area(&runtime, level->name)) {
+            numFailed++;
+            continue;
+        }
+
+        if (outDir != NULL && !write_baked_area(outDir, level, &runtime)) {
+            numFailed++;
+        }
+
+        if (verify && !verify_area(level, &runtime, numLoads)) {
+            numFailed++;
+        }
+
+        free_baked_area(&runtime);
+    }
+
+    if (numFailed > 0) {
+        printf("\n%d area(s) failed\n", numFailed);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,636 @@
+/**
+ * bake_room_pvs: offline potentially visible set baker for areas with rooms.
+ *
+ * Every area with a room table is loaded through the game's load_area_terrain, and each room
+ * gets a set of sample points: the centers and corners of its floor triangles, raised to
+ * Mario's and the camera's height and kept below the ceiling. Room B is visible from room A if
+ * a line of sight between any sample of A and any sample of B isn't blocked by the area's
+ * collision, or if the rooms share a floor vertex. The game's own raycast is used, and surfaces
+ * that are never drawn (intangible, camera boundaries, warps, death planes) don't block anything.
+ * Doors placed as special objects in the terrain data block the view like closed doors, but the
+ * two rooms a door connects are always visible from each other, so the room behind a door is
+ * already there when it opens. The rooms are found the same way bhv_door_init does.
+ *
+ * The result is written as a RoomVisibility table for GEO_ROOMS. Collision is all the baker
+ * knows about, so windows and see-through walls with solid collision block the view, and
+ * visual-only geometry doesn't. The generated file is meant to be checked in next to
+ * room.inc.c, and can be edited by hand for those cases.
+ *
+ * Build with `make -C tools/collision_bench bake_room_pvs`, then run `./bake_room_pvs -h` for usage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "surface_terrains.h"
+#include "game/object_list_processor.h"
+#include "engine/graph_node.h"
+#include "engine/math_util.h"
+#include "engine/surface_collision.h"
+#include "engine/surface_load.h"
+
+#include "host_collision.h"
+
+// RoomData is an s8, room 0 is no room.
+#define MAX_PVS_ROOMS 127
+
+// Heights above the floor the samples are taken at, roughly Mario's eyes and a raised camera.
+#define SAMPLE_EYE_HEIGHT    120.0f
+#define SAMPLE_CAMERA_HEIGHT 400.0f
+// Distance kept from the ceiling when a sample would be above it.
+#define SAMPLE_CEIL_MARGIN    20.0f
+
+// Steps per cell when walking the cells a line of sight crosses, like RAY_STEPS in math_util.c.
+#define RAY_CELL_STEPS 4
+
+// The box of door_seg3_collision_door, which every door preset uses.
+#define DOOR_HALF_WIDTH      80.0f
+#define DOOR_HEIGHT         240.0f
+#define DOOR_HALF_THICKNESS  30.0f
+
+struct Door {
+    Vec3f pos;
+    f32 cosYaw;
+    f32 sinYaw;
+};
+
+struct RoomSamples {
+    Vec3f *points;
+    s32 numPoints;
+    s32 maxPoints;
+};
+
+struct PvsOptions {
+    s32 samplesPerRoom;
+    s32 verbose;
+};
+
+static struct Door sDoors[MAX_HOST_SPECIAL_OBJECTS];
+static s32 sNumDoors;
+
+static void *pvs_alloc(size_t count, size_t size) {
+    void *buf = calloc(MAX(count, 1), size);
+
+    if (buf == NULL) {
+        fprintf(stderr, "bake_room_pvs: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return buf;
+}
+
+/**************************************************
+ *                    SAMPLING                    *
+ **************************************************/
+
+static s32 is_floor(struct Surface *surf) {
+    return (surf->normal.y > 0.01f);
+}
+
+/**
+ * Whether a surface is drawn, and so blocks the view. Only the types that are never visible
+ * are excluded, anything else with collision is assumed to have geometry.
+ */
+static s32 surface_occludes(struct Surface *surf) {
+    return !(surf->type == SURFACE_INTANGIBLE
+          || surf->type == SURFACE_CAMERA_BOUNDARY
+          || surf->type == SURFACE_DEATH_PLANE
+          || surf->type == SURFACE_VANISH_CAP_WALLS
+          || SURFACE_IS_WARP(surf->type));
+}
+
+/**
+ * Adds a point above the floor at the given height, if it isn't inside something.
+ */
+static void add_sample(struct RoomSamples *samples, Vec3f floorPos, f32 height) {
+    struct Surface *ceil;
+    f32 ceilHeight = find_ceil(floorPos[0], floorPos[1] + 3.0f, floorPos[2], &ceil);
+    f32 y = floorPos[1] + height;
+
+    if (ceil != NULL && y > ceilHeight - SAMPLE_CEIL_MARGIN) {
+        y = (floorPos[1] + ceilHeight) / 2.0f;
+        if (ceilHeight - floorPos[1] < 2.0f * SAMPLE_CEIL_MARGIN) {
+            return;
+        }
+    }
+
+    if (samples->numPoints == samples->maxPoints) {
+        samples->maxPoints = MAX(64, samples->maxPoints * 2);
+        samples->points = realloc(samples->points, samples->maxPoints * sizeof(Vec3f));
+        if (samples->points == NULL) {
+            fprintf(stderr, "bake_room_pvs: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    vec3f_set(samples->points[samples->numPoints++], floorPos[0], y, floorPos[2]);
+}
+
+/**
+ * Adds the center of a floor triangle and its corners, pulled a quarter of the way in.
+ */
+static void add_floor_samples(struct RoomSamples *samples, struct Surface *floor) {
+    Vec3f center, corner;
+    Vec3f vertices[3];
+    s32 i;
+
+    vec3s_to_vec3f(vertices[0], floor->vertex1);
+    vec3s_to_vec3f(vertices[1], floor->vertex2);
+    vec3s_to_vec3f(vertices[2], floor->vertex3);
+    vec3f_set(center, (vertices[0][0] + vertices[1][0] + vertices[2][0]) / 3.0f,
+                      (vertices[0][1] + vertices[1][1] + vertices[2][1]) / 3.0f,
+                      (vertices[0][2] + vertices[1][2] + vertices[2][2]) / 3.0f);
+
+    add_sample(samples, center, SAMPLE_EYE_HEIGHT);
+    add_sample(samples, center, SAMPLE_CAMERA_HEIGHT);
+
+    for (i = 0; i < 3; i++) {
+        vec3f_set(corner, center[0] + (vertices[i][0] - center[0]) * 0.75f,
+                          center[1] + (vertices[i][1] - center[1]) * 0.75f,
+                          center[2] + (vertices[i][2] - center[2]) * 0.75f);
+        add_sample(samples, corner, SAMPLE_EYE_HEIGHT);
+    }
+}
+
+/**
+ * Thins the samples out to at most maxPoints, evenly spread over the room's floors.
+ */
+static void reduce_samples(struct RoomSamples *samples, s32 maxPoints) {
+    s32 i;
+
+    if (samples->numPoints <= maxPoints) {
+        return;
+    }
+
+    for (i = 0; i < maxPoints; i++) {
+        vec3f_copy(samples->points[i], samples->points[(s32) ((s64) i * samples->numPoints / maxPoints)]);
+    }
+    samples->numPoints = maxPoints;
+}
+
+/**************************************************
+ *                   VISIBILITY                   *
+ **************************************************/
+
+static s32 is_door_behavior(const char *behavior) {
+    return (behavior != NULL
+            && (strcmp(behavior, "bhvDoor") == 0 || strcmp(behavior, "bhvDoorWarp") == 0 || strcmp(behavior, "bhvStarDoor") == 0));
+}
+
+/**
+ * Collects the doors among the special objects of the loaded area.
+ */
+static void find_doors(void) {
+    s32 i;
+
+    sNumDoors = 0;
+    for (i = 0; i < gNumHostSpecialObjects; i++) {
+        struct HostSpecialObject *special = &gHostSpecialObjects[i];
+
+        if (is_door_behavior(gSpecialPresetBehaviors[special->presetID])) {
+            struct Door *door = &sDoors[sNumDoors++];
+
+            vec3s_to_vec3f(door->pos, special->pos);
+            door->cosYaw = coss(special->yaw);
+            door->sinYaw = sins(special->yaw);
+        }
+    }
+}
+
+/**
+ * Whether a line segment passes through a door. The door's local +Z is (sin(yaw), 0, cos(yaw)),
+ * its local +X is (cos(yaw), 0, -sin(yaw)).
+ */
+static s32 segment_hits_door(struct Door *door, Vec3f from, Vec3f to) {
+    const f32 lo[3] = { -DOOR_HALF_WIDTH, 0.0f,        -DOOR_HALF_THICKNESS };
+    const f32 hi[3] = {  DOOR_HALF_WIDTH, DOOR_HEIGHT,  DOOR_HALF_THICKNESS };
+    Vec3f a, b, rel;
+    f32 t0 = 0.0f, t1 = 1.0f;
+    s32 axis;
+
+    vec3_diff(rel, from, door->pos);
+    vec3f_set(a, rel[0] * door->cosYaw - rel[2] * door->sinYaw, rel[1], rel[0] * door->sinYaw + rel[2] * door->cosYaw);
+    vec3_diff(rel, to, door->pos);
+    vec3f_set(b, rel[0] * door->cosYaw - rel[2] * door->sinYaw, rel[1], rel[0] * door->sinYaw + rel[2] * door->cosYaw);
+
+    for (axis = 0; axis < 3; axis++) {
+        f32 d = b[axis] - a[axis];
+
+        if (absf(d) < 0.0001f) {
+            if (a[axis] < lo[axis] || a[axis] > hi[axis]) {
+                return FALSE;
+            }
+        } else {
+            f32 tLo = (lo[axis] - a[axis]) / d;
+            f32 tHi = (hi[axis] - a[axis]) / d;
+
+            t0 = MAX(t0, MIN(tLo, tHi));
+            t1 = MIN(t1, MAX(tLo, tHi));
+            if (t0 > t1) {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Whether the segment from + t * dir, 0 < t < 1, passes through the front of a surface.
+ * Unlike the game's raycast, surfaces aren't pushed out along their normal, so samples close
+ * to a wall don't see through it.
+ */
+static s32 segment_hits_surface(struct Surface *surf, Vec3f from, Vec3f dir) {
+    Vec3f v1, e1, e2, h, s, q;
+    f32 det, invDet, u, v, t;
+
+    if (!surface_occludes(surf)) {
+        return FALSE;
+    }
+
+    vec3s_to_vec3f(v1, surf->vertex1);
+    vec3_diff(e1, surf->vertex2, v1);
+    vec3_diff(e2, surf->vertex3, v1);
+    vec3_cross(h, dir, e2);
+    det = vec3_dot(e1, h);
+    // Parallel, or seen from behind where it's backface culled.
+    if (det < 0.0001f) {
+        return FALSE;
+    }
+
+    invDet = 1.0f / det;
+    vec3_diff(s, from, v1);
+    u = vec3_dot(s, h) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return FALSE;
+    }
+
+    vec3_cross(q, s, e1);
+    v = vec3_dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return FALSE;
+    }
+
+    t = vec3_dot(e2, q) * invDet;
+    return (t > 0.0f && t < 1.0f);
+}
+
+static s32 segment_hits_cell(s32 cellX, s32 cellZ, Vec3f from, Vec3f dir) {
+    s32 listIndex;
+
+    if (cellX < 0 || cellX >= NUM_CELLS || cellZ < 0 || cellZ >= NUM_CELLS) {
+        return FALSE;
+    }
+
+    for (listIndex = SPATIAL_PARTITION_FLOORS; listIndex <= SPATIAL_PARTITION_WALLS; listIndex++) {
+        struct SurfaceNode *node;
+
+        for (node = gStaticSurfacePartition[cellZ][cellX][listIndex].next; node != NULL; node = node->next) {
+            if (segment_hits_surface(node->surface, from, dir)) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Whether nothing drawn is between two points. The cells along the way are walked the same
+ * way find_surface_on_ray does.
+ */
+static s32 is_line_of_sight_clear(Vec3f from, Vec3f to) {
+    Vec3f dir;
+    f32 fCellX, fCellZ, dx, dz;
+    s32 cellX, cellZ, prevCellX, prevCellZ;
+    s32 numSteps, i;
+
+    for (i = 0; i < sNumDoors; i++) {
+        if (segment_hits_door(&sDoors[i], from, to)) {
+            return FALSE;
+        }
+    }
+
+    vec3_diff(dir, to, from);
+    numSteps = (s32) (MAX(absf(dir[0]), absf(dir[2])) * RAY_CELL_STEPS / CELL_SIZE) + 1;
+    fCellX = (from[0] + LEVEL_BOUNDARY_MAX) / CELL_SIZE;
+    fCellZ = (from[2] + LEVEL_BOUNDARY_MAX) / CELL_SIZE;
+    dx = dir[0] / CELL_SIZE / numSteps;
+    dz = dir[2] / CELL_SIZE / numSteps;
+    cellX = fCellX;
+    cellZ = fCellZ;
+
+    if (segment_hits_cell(cellX, cellZ, from, dir)) {
+        return FALSE;
+    }
+
+    for (i = 0; i < numSteps; i++) {
+        fCellX += dx;
+        fCellZ += dz;
+        prevCellX = cellX;
+        prevCellZ = cellZ;
+        cellX = fCellX;
+        cellZ = fCellZ;
+
+        if (cellX == prevCellX && cellZ == prevCellZ) {
+            continue;
+        }
+        if (cellX != prevCellX && cellZ != prevCellZ
+            && (segment_hits_cell(cellX, prevCellZ, from, dir) || segment_hits_cell(prevCellX, cellZ, from, dir))) {
+            return FALSE;
+        }
+        if (segment_hits_cell(cellX, cellZ, from, dir)) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static s32 can_see_room(struct RoomSamples *a, struct RoomSamples *b) {
+    s32 i, j;
+
+    for (i = 0; i < a->numPoints; i++) {
+        for (j = 0; j < b->numPoints; j++) {
+            if (is_line_of_sight_clear(a->points[i], b->points[j])) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+static void set_visible(u8 *visible, s32 numRooms, s32 a, s32 b) {
+    visible[(a - 1) * numRooms + (b - 1)] = TRUE;
+    visible[(b - 1) * numRooms + (a - 1)] = TRUE;
+}
+
+/**
+ * Makes the rooms in front of and behind every door visible from each other.
+ */
+static void connect_door_rooms(u8 *visible, s32 numRooms) {
+    struct Surface *floor;
+    s32 rooms[2];
+    s32 i, side;
+
+    for (i = 0; i < sNumDoors; i++) {
+        struct Door *door = &sDoors[i];
+
+        for (side = 0; side < 2; side++) {
+            f32 dist = (side == 0) ? 200.0f : -200.0f;
+
+            find_room_floor(door->pos[0] + door->sinYaw * dist, door->pos[1], door->pos[2] + door->cosYaw * dist, &floor);
+            rooms[side] = (floor != NULL) ? floor->room : 0;
+        }
+
+        if (rooms[0] > 0 && rooms[1] > 0 && rooms[0] <= numRooms && rooms[1] <= numRooms) {
+            set_visible(visible, numRooms, rooms[0], rooms[1]);
+        }
+    }
+}
+
+static s32 same_vertex(Vec3s a, Vec3s b) {
+    return (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]);
+}
+
+static s32 floors_touch(struct Surface *a, struct Surface *b) {
+    Vec3s *va[3] = { &a->vertex1, &a->vertex2, &a->vertex3 };
+    Vec3s *vb[3] = { &b->vertex1, &b->vertex2, &b->vertex3 };
+    s32 i, j;
+
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) {
+            if (same_vertex(*va[i], *vb[j])) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Computes which rooms of the loaded area can see each other. visible is numRooms * numRooms,
+ * row (a - 1) column (b - 1) for rooms a and b. Returns the number of rooms.
+ */
+static s32 bake_current_area(const struct HostLevel *level, struct PvsOptions *opts, u8 **visibleOut) {
+    struct RoomSamples samples[MAX_PVS_ROOMS + 1];
+    struct Surface *surfaces = sSurfacePool;
+    s32 numSurfaces = gNumStaticSurfaces;
+    s32 numRooms = 0;
+    u8 *visible;
+    s32 a, b, i, j;
+
+    memset(samples, 0, sizeof(samples));
+    find_doors();
+
+    for (i = 0; i < numSurfaces; i++) {
+        numRooms = MAX(numRooms, surfaces[i].room);
+    }
+    if (numRooms == 0) {
+        *visibleOut = NULL;
+        return 0;
+    }
+
+    visible = pvs_alloc(numRooms * numRooms, sizeof(u8));
+
+    for (i = 0; i < numSurfaces; i++) {
+        if (surfaces[i].room > 0 && is_floor(&surfaces[i])) {
+            add_floor_samples(&samples[surfaces[i].room], &surfaces[i]);
+        }
+    }
+    for (a = 1; a <= numRooms; a++) {
+        reduce_samples(&samples[a], opts->samplesPerRoom);
+        set_visible(visible, numRooms, a, a);
+    }
+
+    // Rooms that share a floor vertex are joined by a doorway, or at least by a floor.
+    for (i = 0; i < numSurfaces; i++) {
+        if (surfaces[i].room <= 0 || !is_floor(&surfaces[i])) {
+            continue;
+        }
+        for (j = i + 1; j < numSurfaces; j++) {
+            if (surfaces[j].room > 0 && surfaces[j].room != surfaces[i].room && is_floor(&surfaces[j])
+                && floors_touch(&surfaces[i], &surfaces[j])) {
+                set_visible(visible, numRooms, surfaces[i].room, surfaces[j].room);
+            }
+        }
+    }
+
+    connect_door_rooms(visible, numRooms);
+
+    for (a = 1; a <= numRooms; a++) {
+        for (b = a + 1; b <= numRooms; b++) {
+            if (!visible[(a - 1) * numRooms + (b - 1)] && can_see_room(&samples[a], &samples[b])) {
+                set_visible(visible, numRooms, a, b);
+            }
+        }
+    }
+
+    if (opts->verbose) {
+        for (a = 1; a <= numRooms; a++) {
+            s32 numVisible = 0;
+
+            for (b = 1; b <= numRooms; b++) {
+                numVisible += visible[(a - 1) * numRooms + (b - 1)];
+            }
+            printf("%-20s room %3d: %4d samples, %3d/%d rooms visible\n",
+                   level->name, a, samples[a].numPoints, numVisible, numRooms);
+        }
+    }
+
+    for (a = 0; a <= numRooms; a++) {
+        free(samples[a].points);
+    }
+
+    *visibleOut = visible;
+    return numRooms;
+}
+
+/**************************************************
+ *                     OUTPUT                     *
+ **************************************************/
+
+/**
+ * Writes an area's visibility table as the RoomVisibility array <rooms>_pvs.
+ */
+static void write_room_pvs(FILE *file, const struct HostLevel *level, u8 *visible, s32 numRooms) {
+    s32 numWords = ROOM_VISIBILITY_WORDS(numRooms);
+    s32 a, b, word;
+
+    fprintf(file, "// Baked from the collision and rooms of levels/%s by tools/collision_bench/bake_room_pvs.\n", level->name);
+    fprintf(file, "// Use with GEO_ROOMS(%d, %s_pvs).\n\n", numRooms, level->roomsName);
+    fprintf(file, "const RoomVisibility %s_pvs[] = {\n", level->roomsName);
+
+    for (a = 1; a <= numRooms; a++) {
+        fprintf(file, "    /* room %3d */", a);
+        for (word = 0; word < numWords; word++) {
+            u32 bits = 0;
+
+            for (b = word * 32 + 1; b <= MIN(numRooms, word * 32 + 32); b++) {
+                if (visible[(a - 1) * numRooms + (b - 1)]) {
+                    bits |= (1U << ((b - 1) % 32));
+                }
+            }
+            fprintf(file, " 0x%08X,", bits);
+        }
+        fprintf(file, "\n");
+    }
+
+    fprintf(file, "};\n");
+}
+
+static s32 write_area_file(const char *dir, const struct HostLevel *level, u8 *visible, s32 numRooms) {
+    char path[512];
+    char levelName[64];
+    const char *areaName = strchr(level->name, '/');
+    FILE *file;
+
+    if (areaName == NULL) {
+        return FALSE;
+    }
+    snprintf(levelName, sizeof(levelName), "%.*s", (int) (areaName - level->name), level->name);
+    areaName++;
+
+    snprintf(path, sizeof(path), "%s/%s/areas/%s/room_pvs.inc.c", dir, levelName, areaName);
+    file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return FALSE;
+    }
+
+    write_room_pvs(file, level, visible, numRooms);
+    fclose(file);
+    return TRUE;
+}
+
+/**************************************************
+ *                      MAIN                      *
+ **************************************************/
+
+static void usage(const char *name) {
+    printf("Usage: %s [options]\n"
+           "  -o <dir>      write <dir>/<level>/areas/<area>/room_pvs.inc.c for every area with rooms,\n"
+           "                e.g. -o ../../levels, instead of printing the tables\n"
+           "  -l <name>     only bake areas whose name (\"<level>/<area>\") contains <name>\n"
+           "  -s <count>    sample points per room (default 48)\n"
+           "  -v            print how many rooms are visible from every room\n",
+           name);
+}
+
+int main(int argc, char *argv[]) {
+    struct PvsOptions opts = {
+        .samplesPerRoom = 48,
+        .verbose = FALSE,
+    };
+    const char *outDir = NULL;
+    const char *levelFilter = NULL;
+    s32 numFailed = 0;
+    s32 i;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-v") == 0) {
+            opts.verbose = TRUE;
+            continue;
+        }
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return (strcmp(arg, "-h") == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        switch (arg[1]) {
+            case 'o': outDir              = value;               break;
+            case 'l': levelFilter         = value;               break;
+            case 's': opts.samplesPerRoom = MAX(1, atoi(value)); break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    host_init_surface_pools();
+
+    for (i = 0; i < gNumHostLevels; i++) {
+        const struct HostLevel *level = &gHostLevels[i];
+        u8 *visible;
+        s32 numRooms;
+
+        if (level->rooms == NULL || (levelFilter != NULL && strstr(level->name, levelFilter) == NULL)) {
+            continue;
+        }
+
+        host_load_level_baked(level, NULL);
+
+        numRooms = bake_current_area(level, &opts, &visible);
+        if (numRooms == 0) {
+            continue;
+        }
+
+        if (outDir != NULL) {
+            if (!write_area_file(outDir, level, visible, numRooms)) {
+                numFailed++;
+            }
+        } else if (!opts.verbose) {
+            write_room_pvs(stdout, level, visible, numRooms);
+            printf("\n");
+        }
+
+        free(visible);
+    }
+
+    if (numFailed > 0) {
+        printf("\n%d area(s) failed\n", numFailed);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1099 @@
+/**
+ * collision_bench: host-native benchmark for the surface collision engine.
+ *
+ * src/engine/surface_load.c, surface_collision.c and math_util.c are compiled for the host
+ * against a stub ultra64.h. Every area's collision.inc.c is loaded through load_area_terrain,
+ * then randomized (or recorded) probes are replayed through find_floor, find_ceil,
+ * find_wall_collisions, find_water_level_and_floor and find_surface_on_ray.
+ *
+ * For every area and query type this reports the time per query, how long the cell lists
+ * the probes landed in were, and a checksum of every result. The same numbers can be written
+ * to a tab separated baseline and later compared against, so any change to the collision
+ * engine can be checked both for speed and for returning exactly the same surfaces.
+ *
+ * The floor probes are also grouped into clusters of nearby points and run through both
+ * find_floor ("cluster") and find_floors_batch ("batch"), which have to agree.
+ *
+ * With -d, every area also gets a "dynamic" result: surface objects using the game's object
+ * collision models are loaded through load_object_collision_model every frame while some
+ * of them move, go out of range or get replaced. Its checksum covers the contents of every
+ * dynamic cell list on every frame, so INCREMENTAL_DYNAMIC_SURFACES can be compared against
+ * a baseline written without it. A "dynfloor" result covers the floors above the objects
+ * on every frame, found with both find_floor and find_floors_batch.
+ *
+ * Build with `make -C tools/collision_bench`, then run `./collision_bench -h` for usage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "game/object_list_processor.h"
+#include "engine/math_util.h"
+#include "engine/surface_collision.h"
+#include "engine/surface_load.h"
+
+#include "host_collision.h"
+
+enum ProbeTypes {
+    PROBE_LOAD,
+    PROBE_FLOOR,
+    PROBE_CEIL,
+    PROBE_WALL,
+    PROBE_WATER,
+    PROBE_RAY,
+    NUM_PROBE_TYPES
+};
+
+static const char *sProbeNames[NUM_PROBE_TYPES] = {
+    "load", "floor", "ceil", "wall", "water", "ray",
+};
+
+// The cell list each probe type walks, or -1 if it does not walk a single list.
+static const s32 sProbeLists[NUM_PROBE_TYPES] = {
+    -1,
+    SPATIAL_PARTITION_FLOORS,
+    SPATIAL_PARTITION_CEILS,
+    SPATIAL_PARTITION_WALLS,
+    SPATIAL_PARTITION_WATER,
+    -1,
+};
+
+static const char *sListNames[NUM_SPATIAL_PARTITIONS] = {
+    "floors", "ceils", "walls", "water",
+};
+
+struct Probe {
+    Vec3f pos;
+    Vec3f arg; // wall: { radius, offsetY }, ray: direction
+};
+
+struct ProbeSet {
+    struct Probe *probes;
+    s32 count;
+    s32 capacity;
+};
+
+struct BenchResult {
+    char level[64];
+    char query[16];
+    s32 count;
+    f64 nsPerQuery;
+    f64 avgWalk;
+    s32 maxWalk;
+    u32 checksum;
+};
+
+struct BenchOptions {
+    const char *levelFilter;
+    const char *probeFile;
+    const char *recordFile;
+    const char *baselineFile;
+    const char *compareFile;
+    s32 numQueries;
+    s32 numLoads;
+    s32 numWorstCells;
+    s32 numDynamicFrames;
+    u32 seed;
+    f64 failSlowerPct;
+};
+
+static struct BenchResult *sResults = NULL;
+static s32 sNumResults = 0;
+static u32 sRandomState;
+
+/**************************************************
+ *                    HELPERS                     *
+ **************************************************/
+
+static u32 bench_random(void) {
+    // xorshift32
+    sRandomState ^= sRandomState << 13;
+    sRandomState ^= sRandomState >> 17;
+    sRandomState ^= sRandomState << 5;
+    return sRandomState;
+}
+
+static f32 bench_random_range(f32 min, f32 max) {
+    return min + (max - min) * ((bench_random() >> 8) / (f32) (1 << 24));
+}
+
+static f64 get_time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static u32 hash_f32(u32 hash, f32 value) {
+    u32 bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return host_hash_u32(hash, bits);
+}
+
+static u32 hash_surface(u32 hash, struct Surface *surf) {
+    return host_hash_u32(hash, (surf == NULL) ? 0xFFFFFFFF : (u32) (surf - sSurfacePool));
+}
+
+static struct BenchResult *add_result(const char *level, const char *query) {
+    sResults = realloc(sResults, (sNumResults + 1) * sizeof(struct BenchResult));
+    struct BenchResult *result = &sResults[sNumResults++];
+
+    memset(result, 0, sizeof(*result));
+    snprintf(result->level, sizeof(result->level), "%s", level);
+    snprintf(result->query, sizeof(result->query), "%s", query);
+
+    return result;
+}
+
+static void probe_set_add(struct ProbeSet *set, Vec3f pos, Vec3f arg) {
+    if (set->count == set->capacity) {
+        set->capacity = (set->capacity == 0) ? 1024 : (set->capacity * 2);
+        set->probes = realloc(set->probes, set->capacity * sizeof(struct Probe));
+    }
+
+    vec3f_copy(set->probes[set->count].pos, pos);
+    vec3f_copy(set->probes[set->count].arg, arg);
+    set->count++;
+}
+
+static s32 list_length(struct SurfaceNode *node) {
+    s32 length = 0;
+
+    for (; node != NULL; node = node->next) {
+        length++;
+    }
+
+    return length;
+}
+
+static s32 cell_list_length(s32 cellX, s32 cellZ, s32 listIndex) {
+    return list_length(gStaticSurfacePartition[cellZ][cellX][listIndex].next)
+         + list_length(gDynamicSurfacePartition[cellZ][cellX][listIndex].next);
+}
+
+/**
+ * Returns how many surfaces a probe has to look at in the worst case, which is
+ * the length of the static list it lands in plus the dynamic cell list.
+ */
+static s32 probe_walk_length(s32 type, struct Probe *probe) {
+    s32 x = probe->pos[0];
+    s32 z = probe->pos[2];
+    s32 listIndex = sProbeLists[type];
+
+    if (listIndex < 0 || is_outside_level_bounds(x, z)) {
+        return 0;
+    }
+
+    return list_length(get_static_surface_list(x, z, listIndex))
+         + list_length(gDynamicSurfacePartition[GET_CELL_COORD(z)][GET_CELL_COORD(x)][listIndex].next);
+}
+
+/**************************************************
+ *                  PROBE SOURCES                 *
+ **************************************************/
+
+/**
+ * Picks a random point on a random static surface.
+ */
+static void random_point_on_surface(Vec3f dest) {
+    struct Surface *surf = &sSurfacePool[bench_random() % gNumStaticSurfaces];
+    f32 u = bench_random_range(0.0f, 1.0f);
+    f32 v = bench_random_range(0.0f, 1.0f);
+    s32 i;
+
+    if (u + v > 1.0f) {
+        u = 1.0f - u;
+        v = 1.0f - v;
+    }
+
+    for (i = 0; i < 3; i++) {
+        dest[i] = surf->vertex1[i] + u * (surf->vertex2[i] - surf->vertex1[i])
+                                   + v * (surf->vertex3[i] - surf->vertex1[i]);
+    }
+}
+
+/**
+ * Generates probes for every query type. Half of them are spread uniformly over the
+ * bounds of the level's surfaces, the other half are placed near random surfaces so the
+ * dense parts of the level get their share of queries.
+ */
+static void generate_random_probes(struct ProbeSet sets[NUM_PROBE_TYPES], s32 numQueries) {
+    Vec3f min = {  LEVEL_BOUNDARY_MAX,  LEVEL_BOUNDARY_MAX,  LEVEL_BOUNDARY_MAX };
+    Vec3f max = { -LEVEL_BOUNDARY_MAX, -LEVEL_BOUNDARY_MAX, -LEVEL_BOUNDARY_MAX };
+    Vec3f pos, arg;
+    s32 type, i, j;
+
+    for (i = 0; i < gNumStaticSurfaces; i++) {
+        struct Surface *surf = &sSurfacePool[i];
+
+        for (j = 0; j < 3; j++) {
+            min[j] = MIN(min[j], min_3f(surf->vertex1[j], surf->vertex2[j], surf->vertex3[j]));
+            max[j] = MAX(max[j], max_3f(surf->vertex1[j], surf->vertex2[j], surf->vertex3[j]));
+        }
+    }
+
+    for (type = PROBE_FLOOR; type < NUM_PROBE_TYPES; type++) {
+        for (i = 0; i < numQueries; i++) {
+            if (i & 1) {
+                random_point_on_surface(pos);
+                pos[0] += bench_random_range(-100.0f, 100.0f);
+                pos[1] += bench_random_range(-300.0f, 300.0f);
+                pos[2] += bench_random_range(-100.0f, 100.0f);
+            } else {
+                pos[0] = bench_random_range(min[0], max[0]);
+                pos[1] = bench_random_range(min[1] - 500.0f, max[1] + 500.0f);
+                pos[2] = bench_random_range(min[2], max[2]);
+            }
+
+            vec3_zero(arg);
+            if (type == PROBE_WALL) {
+                arg[0] = bench_random_range(25.0f, 150.0f);
+                arg[1] = bench_random_range(0.0f, 150.0f);
+            } else if (type == PROBE_RAY) {
+                arg[0] = bench_random_range(-1.0f, 1.0f);
+                arg[1] = bench_random_range(-1.0f, 1.0f);
+                arg[2] = bench_random_range(-1.0f, 1.0f);
+                vec3f_normalize(arg);
+                vec3_mul_val(arg, bench_random_range(100.0f, 3000.0f));
+            }
+
+            probe_set_add(&sets[type], pos, arg);
+        }
+    }
+}
+
+/**
+ * Reads recorded probes for a level. Each line of the file is
+ *   <level> <query> <x> <y> <z> [<arg0> <arg1> <arg2>]
+ * where the args are { radius, offsetY } for walls and the direction for rays.
+ * Lines starting with '#' are ignored.
+ */
+static s32 read_recorded_probes(const char *path, const char *level, struct ProbeSet sets[NUM_PROBE_TYPES]) {
+    char line[512], name[64], query[16];
+    Vec3f pos, arg;
+    s32 type, numRead = 0;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+
+        vec3_zero(arg);
+        if (sscanf(line, "%63s %15s %f %f %f %f %f %f", name, query,
+                   &pos[0], &pos[1], &pos[2], &arg[0], &arg[1], &arg[2]) < 5) {
+            fprintf(stderr, "%s: malformed probe: %s", path, line);
+            continue;
+        }
+
+        if (strcmp(name, level) != 0) {
+            continue;
+        }
+
+        for (type = PROBE_FLOOR; type < NUM_PROBE_TYPES; type++) {
+            if (strcmp(query, sProbeNames[type]) == 0) {
+                probe_set_add(&sets[type], pos, arg);
+                numRead++;
+                break;
+            }
+        }
+    }
+
+    fclose(file);
+    return numRead;
+}
+
+static void record_probes(FILE *file, const char *level, struct ProbeSet sets[NUM_PROBE_TYPES]) {
+    s32 type, i;
+
+    for (type = PROBE_FLOOR; type < NUM_PROBE_TYPES; type++) {
+        for (i = 0; i < sets[type].count; i++) {
+            struct Probe *probe = &sets[type].probes[i];
+
+            fprintf(file, "%s %s %.9g %.9g %.9g %.9g %.9g %.9g\n", level, sProbeNames[type],
+                    probe->pos[0], probe->pos[1], probe->pos[2],
+                    probe->arg[0], probe->arg[1], probe->arg[2]);
+        }
+    }
+}
+
+/**************************************************
+ *                   BENCHMARKS                   *
+ **************************************************/
+
+/**
+ * Runs every probe of one type through the engine, returning a checksum of all results.
+ */
+static u32 run_probes(s32 type, struct ProbeSet *set) {
+    struct WallCollisionData wallData;
+    struct Surface *surf;
+    Vec3f hitPos;
+    u32 hash = HOST_HASH_INIT;
+    f32 height;
+    s32 i, j;
+
+    for (i = 0; i < set->count; i++) {
+        struct Probe *probe = &set->probes[i];
+
+        switch (type) {
+            case PROBE_FLOOR:
+                height = find_floor(probe->pos[0], probe->pos[1], probe->pos[2], &surf);
+                hash = hash_surface(hash_f32(hash, height), surf);
+                break;
+
+            case PROBE_CEIL:
+                height = find_ceil(probe->pos[0], probe->pos[1], probe->pos[2], &surf);
+                hash = hash_surface(hash_f32(hash, height), surf);
+                break;
+
+            case PROBE_WALL:
+                wallData.x = probe->pos[0];
+                wallData.y = probe->pos[1];
+                wallData.z = probe->pos[2];
+                wallData.radius = probe->arg[0];
+                wallData.offsetY = probe->arg[1];
+                hash = host_hash_u32(hash, find_wall_collisions(&wallData));
+                hash = hash_f32(hash_f32(hash, wallData.x), wallData.z);
+                for (j = 0; j < wallData.numWalls; j++) {
+                    hash = hash_surface(hash, wallData.walls[j]);
+                }
+                break;
+
+            case PROBE_WATER:
+                surf = NULL;
+                hash = host_hash_u32(hash, find_water_level_and_floor(probe->pos[0], probe->pos[1], probe->pos[2], &surf));
+                hash = hash_surface(hash, surf);
+                break;
+
+            case PROBE_RAY:
+                surf = NULL;
+                vec3_zero(hitPos);
+                find_surface_on_ray(probe->pos, probe->arg, &surf, hitPos, RAYCAST_FIND_ALL);
+                hash = hash_surface(hash, surf);
+                if (surf != NULL) {
+                    hash = hash_f32(hash_f32(hash_f32(hash, hitPos[0]), hitPos[1]), hitPos[2]);
+                }
+                break;
+        }
+    }
+
+    return hash;
+}
+
+static void bench_load(const struct HostLevel *level, struct BenchOptions *opts) {
+    struct BenchResult *result = add_result(level->name, sProbeNames[PROBE_LOAD]);
+    f64 start = get_time_ns();
+    s32 i;
+
+    for (i = 0; i < opts->numLoads; i++) {
+        host_load_level(level);
+    }
+
+    result->count = opts->numLoads;
+    result->nsPerQuery = (get_time_ns() - start) / opts->numLoads;
+    // For loads, the walk columns hold the number of surfaces and surface nodes.
+    result->avgWalk = gNumStaticSurfaces;
+    result->maxWalk = gNumStaticSurfaceNodes;
+    result->checksum = host_hash_partition();
+}
+
+static void bench_queries(const struct HostLevel *level, s32 type, struct ProbeSet *set) {
+    struct BenchResult *result = add_result(level->name, sProbeNames[type]);
+    s64 totalWalk = 0;
+    s32 i, walk;
+
+    for (i = 0; i < set->count; i++) {
+        walk = probe_walk_length(type, &set->probes[i]);
+        totalWalk += walk;
+        result->maxWalk = MAX(result->maxWalk, walk);
+    }
+
+    // Warm up once, then time the real run.
+    run_probes(type, set);
+
+    f64 start = get_time_ns();
+    result->checksum = run_probes(type, set);
+    result->nsPerQuery = (set->count > 0) ? ((get_time_ns() - start) / set->count) : 0.0;
+    result->count = set->count;
+    result->avgWalk = (set->count > 0) ? ((f64) totalWalk / set->count) : 0.0;
+}
+
+/**
+ * Prints the distribution of cell list lengths for the static partition, and the longest lists.
+ */
+static void print_cell_stats(const struct HostLevel *level, s32 numWorstCells) {
+    static const s32 buckets[] = { 0, 8, 32, 128, 512 };
+    s32 listIndex, cellX, cellZ, i, k;
+
+    printf("%s: %d surfaces, %d nodes\n", level->name, gNumStaticSurfaces, gNumStaticSurfaceNodes);
+#ifdef STATIC_SURFACE_TREE
+    printf("  %d of %d tree nodes\n", gSurfaceTreeNodesAllocated, STATIC_SURFACE_TREE_NODE_POOL_SIZE);
+#endif
+#ifdef PACKED_STATIC_SURFACES
+    printf("  %s\n", gStaticSurfacesPacked ? "packed" : "not packed, doesn't fit in the packed pools");
+#endif
+
+    for (listIndex = 0; listIndex < NUM_SPATIAL_PARTITIONS; listIndex++) {
+        s32 histogram[ARRAY_COUNT(buckets) + 1] = { 0 };
+        s32 worst[32][3];
+        s32 numWorst = 0;
+        s32 nonEmpty = 0;
+        s64 total = 0;
+
+        for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+            for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+                s32 length = cell_list_length(cellX, cellZ, listIndex);
+
+                for (i = 0; i < ARRAY_COUNT(buckets) && length > buckets[i]; i++);
+                histogram[i]++;
+
+                if (length == 0) {
+                    continue;
+                }
+                nonEmpty++;
+                total += length;
+
+                // Insertion sort into the worst cells.
+                for (i = numWorst; i > 0 && worst[i - 1][0] < length; i--) {
+                    if (i < numWorstCells) {
+                        memcpy(worst[i], worst[i - 1], sizeof(worst[i]));
+                    }
+                }
+                if (i < numWorstCells) {
+                    worst[i][0] = length;
+                    worst[i][1] = cellX;
+                    worst[i][2] = cellZ;
+                    numWorst = MIN(numWorst + 1, numWorstCells);
+                }
+            }
+        }
+
+        printf("  %-6s  cells %4d  avg %7.1f  lengths 0:%d", sListNames[listIndex], nonEmpty,
+               (nonEmpty > 0) ? ((f64) total / nonEmpty) : 0.0, histogram[0]);
+        for (i = 1; i <= ARRAY_COUNT(buckets); i++) {
+            if (i < ARRAY_COUNT(buckets)) {
+                printf(" %d-%d:%d", buckets[i - 1] + 1, buckets[i], histogram[i]);
+            } else {
+                printf(" >%d:%d", buckets[i - 1], histogram[i]);
+            }
+        }
+        printf("\n");
+
+        for (k = 0; k < numWorst; k++) {
+            printf("          cell (%2d, %2d): %d\n", worst[k][1], worst[k][2], worst[k][0]);
+        }
+    }
+}
+
+/**************************************************
+ *                 BATCHED FLOORS                 *
+ **************************************************/
+
+#define FLOOR_CLUSTER_SIZE 6 // Like the camera's floor checks along the line to Mario
+
+/**
+ * Builds clusters of floor probes like the game's multi-point floor checks: each floor probe
+ * followed by points along a short line from it, with every fourth cluster checking its first
+ * point again at the end. Doesn't use bench_random, so the other results keep their probes.
+ */
+static void make_floor_clusters(struct ProbeSet *floors, struct ProbeSet *clusters) {
+    Vec3f pos, delta;
+    Vec3f arg = { 0.0f, 0.0f, 0.0f };
+    s32 i, j;
+
+    for (i = 0; i < floors->count; i++) {
+        u32 hash = host_hash_u32(HOST_HASH_INIT, i);
+
+        delta[0] = (s32) ((hash      ) & 0x3FF) - 0x200;
+        delta[1] = (s32) ((hash >> 10) & 0x0FF) - 0x080;
+        delta[2] = (s32) ((hash >> 18) & 0x3FF) - 0x200;
+
+        for (j = 0; j < FLOOR_CLUSTER_SIZE; j++) {
+            f32 scale = (j == FLOOR_CLUSTER_SIZE - 1 && (i % 4) == 0) ? 0.0f : (j / (f32) FLOOR_CLUSTER_SIZE);
+
+            pos[0] = floors->probes[i].pos[0] + (delta[0] * scale);
+            pos[1] = floors->probes[i].pos[1] + (delta[1] * scale);
+            pos[2] = floors->probes[i].pos[2] + (delta[2] * scale);
+            probe_set_add(clusters, pos, arg);
+        }
+    }
+}
+
+static u32 hash_floor_result(u32 hash, f32 height, struct Surface *floor) {
+    return hash_surface(hash_f32(hash, height), floor);
+}
+
+static u32 run_floor_clusters(struct ProbeSet *clusters, s32 batched) {
+    Vec3f points[FLOOR_CLUSTER_SIZE];
+    struct FloorResult results[FLOOR_CLUSTER_SIZE];
+    struct Surface *floor;
+    u32 hash = HOST_HASH_INIT;
+    f32 height;
+    s32 i, j;
+
+    for (i = 0; i + FLOOR_CLUSTER_SIZE <= clusters->count; i += FLOOR_CLUSTER_SIZE) {
+        struct Probe *probes = &clusters->probes[i];
+
+        if (batched) {
+            for (j = 0; j < FLOOR_CLUSTER_SIZE; j++) {
+                vec3f_copy(points[j], probes[j].pos);
+            }
+            find_floors_batch(points, FLOOR_CLUSTER_SIZE, results);
+            for (j = 0; j < FLOOR_CLUSTER_SIZE; j++) {
+                hash = hash_floor_result(hash, results[j].height, results[j].floor);
+            }
+        } else {
+            for (j = 0; j < FLOOR_CLUSTER_SIZE; j++) {
+                height = find_floor(probes[j].pos[0], probes[j].pos[1], probes[j].pos[2], &floor);
+                hash = hash_floor_result(hash, height, floor);
+            }
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * Returns how many surfaces find_floors_batch has to look at in the worst case for a cluster,
+ * which is the length of every distinct static and dynamic list its probes land in.
+ */
+static s32 cluster_walk_length(struct Probe *probes) {
+    struct SurfaceNode *lists[2 * FLOOR_CLUSTER_SIZE];
+    s32 numLists = 0;
+    s32 walk = 0;
+    s32 i, j, k;
+
+    for (i = 0; i < FLOOR_CLUSTER_SIZE; i++) {
+        s32 x = probes[i].pos[0];
+        s32 z = probes[i].pos[2];
+
+        if (is_outside_level_bounds(x, z)) {
+            continue;
+        }
+
+        struct SurfaceNode *probeLists[2] = {
+            get_static_surface_list(x, z, SPATIAL_PARTITION_FLOORS),
+            gDynamicSurfacePartition[GET_CELL_COORD(z)][GET_CELL_COORD(x)][SPATIAL_PARTITION_FLOORS].next,
+        };
+
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < numLists && lists[k] != probeLists[j]; k++);
+            if (k == numLists) {
+                lists[numLists++] = probeLists[j];
+                walk += list_length(probeLists[j]);
+            }
+        }
+    }
+
+    return walk;
+}
+
+/**
+ * Times clusters of floor probes through find_floor ("cluster") and find_floors_batch ("batch").
+ * Returns 1 if the two disagree on any floor.
+ */
+static s32 bench_floor_batches(const struct HostLevel *level, struct ProbeSet *floors) {
+    struct ProbeSet clusters = { NULL, 0, 0 };
+    struct BenchResult *results[2];
+    s32 batched, i, walk;
+    s64 totalWalk = 0;
+    s32 maxWalk = 0;
+
+    make_floor_clusters(floors, &clusters);
+
+    for (i = 0; i < clusters.count; i++) {
+        walk = probe_walk_length(PROBE_FLOOR, &clusters.probes[i]);
+        totalWalk += walk;
+        maxWalk = MAX(maxWalk, walk);
+    }
+
+    for (batched = 0; batched < 2; batched++) {
+        struct BenchResult *result = add_result(level->name, batched ? "batch" : "cluster");
+
+        // Batches walk each distinct list once.
+        if (batched) {
+            totalWalk = 0;
+            for (i = 0; i + FLOOR_CLUSTER_SIZE <= clusters.count; i += FLOOR_CLUSTER_SIZE) {
+                totalWalk += cluster_walk_length(&clusters.probes[i]);
+            }
+        }
+
+        run_floor_clusters(&clusters, batched);
+
+        f64 start = get_time_ns();
+        result->checksum = run_floor_clusters(&clusters, batched);
+        result->nsPerQuery = (clusters.count > 0) ? ((get_time_ns() - start) / clusters.count) : 0.0;
+        result->count = clusters.count;
+        result->avgWalk = (clusters.count > 0) ? ((f64) totalWalk / clusters.count) : 0.0;
+        result->maxWalk = maxWalk;
+        results[batched] = result;
+    }
+
+    free(clusters.probes);
+
+    if (results[0]->checksum != results[1]->checksum) {
+        fprintf(stderr, "%s: find_floors_batch results differ from find_floor\n", level->name);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**************************************************
+ *                DYNAMIC SURFACES                *
+ **************************************************/
+
+#define NUM_BENCH_OBJECTS   40
+#define MAX_OBJECT_VERTICES 200 // The size of load_object_collision_model's vertex buffer
+#define OBJECT_RESPAWN_RATE 10  // An object is replaced every this many frames
+
+struct BenchObject {
+    Vec3f pos;
+    Vec3s angle;
+};
+
+static struct BenchObject sBenchObjects[NUM_BENCH_OBJECTS];
+
+/**
+ * Returns whether a collision model fits in load_object_collision_model and has any surfaces.
+ */
+static s32 is_loadable_object_collision(const Collision *collision) {
+    s32 numVertices = collision[1];
+
+    return (collision[0] == TERRAIN_LOAD_VERTICES && numVertices > 0 && numVertices <= MAX_OBJECT_VERTICES
+            && collision[2 + (3 * numVertices)] != TERRAIN_LOAD_CONTINUE);
+}
+
+/**
+ * Spawns a surface object with a random collision model at a random point of the area.
+ */
+static void spawn_bench_object(s32 index) {
+    struct Object *obj = &gObjectPool[index];
+    struct BenchObject *benchObj = &sBenchObjects[index];
+    const Collision *collision;
+
+    do {
+        collision = gHostObjectCollisions[bench_random() % gNumHostObjectCollisions].collision;
+    } while (!is_loadable_object_collision(collision));
+
+    random_point_on_surface(benchObj->pos);
+    benchObj->pos[1] += bench_random_range(0.0f, 300.0f);
+    vec3s_set(benchObj->angle, 0, bench_random(), 0);
+
+    memset(obj, 0, sizeof(*obj));
+    obj->activeFlags = ACTIVE_FLAG_ACTIVE;
+    obj->collisionData = (void *) collision;
+    obj->oCollisionDistance = 1000.0f;
+    vec3f_set(obj->header.gfx.scale, 1.0f, 1.0f, 1.0f);
+    obj->header.gfx.throwMatrix = &obj->transform;
+    mtxf_rotate_zxy_and_translate(obj->transform, benchObj->pos, benchObj->angle);
+}
+
+/**
+ * Hashes the contents of every dynamic cell list, independent of the order of surfaces
+ * the lists don't sort. Lists that aren't sorted by upperY are counted in numUnsorted.
+ */
+static u32 hash_dynamic_partition(s32 *numNodes, s32 *numUnsorted) {
+    u32 hash = HOST_HASH_INIT;
+    s32 cellX, cellZ, listIndex;
+
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < NUM_SPATIAL_PARTITIONS; listIndex++) {
+                struct SurfaceNode *node = gDynamicSurfacePartition[cellZ][cellX][listIndex].next;
+                s32 sortDir = (listIndex == SPATIAL_PARTITION_CEILS) ? -1 : (listIndex == SPATIAL_PARTITION_WALLS) ? 0 : 1;
+                u32 sum = 0;
+                s32 count = 0;
+
+                for (; node != NULL; node = node->next) {
+                    struct Surface *surf = node->surface;
+
+                    sum += host_hash_u32(host_hash_surface(HOST_HASH_INIT, surf), surf->object - gObjectPool);
+                    if (node->next != NULL && node->next->surface->upperY * sortDir > surf->upperY * sortDir) {
+                        (*numUnsorted)++;
+                    }
+                    count++;
+                }
+
+                if (count > 0) {
+                    hash = host_hash_u32(host_hash_u32(hash, (cellZ * NUM_CELLS + cellX) * NUM_SPATIAL_PARTITIONS + listIndex), sum);
+                    *numNodes += count;
+                }
+            }
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * Loads NUM_BENCH_OBJECTS surface objects for the given number of frames. A quarter of them move
+ * and turn every frame, an eighth are out of range a quarter of the time, and one is replaced
+ * with a new object every OBJECT_RESPAWN_RATE frames. Only loading the surfaces is timed.
+ */
+/**
+ * Checks the floor above every bench object with find_floor and find_floors_batch, returning
+ * a checksum of the floor heights. Which of several floors at the same height is found depends
+ * on the order they were added to their cell, which INCREMENTAL_DYNAMIC_SURFACES doesn't keep.
+ */
+static u32 check_dynamic_floors(const struct HostLevel *level, u32 hash, s32 *numMismatches) {
+    Vec3f points[NUM_BENCH_OBJECTS];
+    struct FloorResult results[NUM_BENCH_OBJECTS];
+    struct Surface *floor;
+    f32 height;
+    s32 i;
+
+    for (i = 0; i < NUM_BENCH_OBJECTS; i++) {
+        vec3f_copy(points[i], sBenchObjects[i].pos);
+        points[i][1] += 100.0f;
+    }
+
+    find_floors_batch(points, NUM_BENCH_OBJECTS, results);
+
+    for (i = 0; i < NUM_BENCH_OBJECTS; i++) {
+        height = find_floor(points[i][0], points[i][1], points[i][2], &floor);
+
+        if (floor != results[i].floor || height != results[i].height) {
+            if ((*numMismatches)++ == 0) {
+                fprintf(stderr, "%s: find_floors_batch results differ from find_floor\n", level->name);
+            }
+        }
+
+        hash = host_hash_u32(hash_f32(hash, height), (floor != NULL));
+    }
+
+    return hash;
+}
+
+static void bench_dynamic(const struct HostLevel *level, s32 numFrames) {
+    struct BenchResult *result;
+    u32 hash = HOST_HASH_INIT;
+    u32 floorHash = HOST_HASH_INIT;
+    s64 totalNodes = 0;
+    s32 maxNodes = 0;
+    s32 numUnsorted = 0;
+    s32 numMismatches = 0;
+    f64 totalNs = 0.0;
+    f64 floorNs = 0.0;
+    s32 frame, i;
+
+    clear_dynamic_surfaces();
+    for (i = 0; i < NUM_BENCH_OBJECTS; i++) {
+        spawn_bench_object(i);
+    }
+
+    for (frame = 0; frame < numFrames; frame++) {
+        s32 numNodes = 0;
+
+        for (i = 0; i < NUM_BENCH_OBJECTS; i++) {
+            struct BenchObject *benchObj = &sBenchObjects[i];
+
+            if ((i % 4) == 0) {
+                benchObj->pos[0] += bench_random_range(-20.0f, 20.0f);
+                benchObj->pos[1] += bench_random_range(-5.0f, 5.0f);
+                benchObj->pos[2] += bench_random_range(-20.0f, 20.0f);
+                benchObj->angle[1] += 0x200;
+                mtxf_rotate_zxy_and_translate(gObjectPool[i].transform, benchObj->pos, benchObj->angle);
+            }
+        }
+
+        if ((frame % OBJECT_RESPAWN_RATE) == 0) {
+            i = (frame / OBJECT_RESPAWN_RATE) % NUM_BENCH_OBJECTS;
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+            unload_object_surfaces(&gObjectPool[i]);
+#endif
+            spawn_bench_object(i);
+        }
+
+        f64 start = get_time_ns();
+#ifndef INCREMENTAL_DYNAMIC_SURFACES
+        clear_dynamic_surfaces();
+#endif
+        for (i = 0; i < NUM_BENCH_OBJECTS; i++) {
+            if ((i % 8) == 2 && (frame % 64) >= 48) {
+                continue;
+            }
+            gCurrentObject = &gObjectPool[i];
+            load_object_collision_model();
+        }
+#ifdef INCREMENTAL_DYNAMIC_SURFACES
+        unload_stale_dynamic_surfaces();
+#endif
+        totalNs += get_time_ns() - start;
+
+        if (gSurfacePoolError) {
+            fprintf(stderr, "%s: surface pool overflow with dynamic surfaces (flags 0x%X)\n", level->name, gSurfacePoolError);
+            exit(EXIT_FAILURE);
+        }
+
+        hash = host_hash_u32(hash, hash_dynamic_partition(&numNodes, &numUnsorted));
+        totalNodes += numNodes;
+        maxNodes = MAX(maxNodes, numNodes);
+
+        start = get_time_ns();
+        floorHash = check_dynamic_floors(level, floorHash, &numMismatches);
+        floorNs += get_time_ns() - start;
+    }
+
+    if (numUnsorted > 0) {
+        fprintf(stderr, "%s: %d dynamic surfaces out of order\n", level->name, numUnsorted);
+        hash = host_hash_u32(hash, numUnsorted);
+    }
+
+    clear_dynamic_surfaces();
+
+    result = add_result(level->name, "dynamic");
+    result->count = numFrames;
+    result->nsPerQuery = totalNs / numFrames;
+    // For dynamic surfaces, the walk columns hold the average and largest number of surface nodes.
+    result->avgWalk = (f64) totalNodes / numFrames;
+    result->maxWalk = maxNodes;
+    result->checksum = hash;
+
+    // The floors above the objects on every frame. Each point is checked twice, once batched.
+    result = add_result(level->name, "dynfloor");
+    result->count = numFrames * NUM_BENCH_OBJECTS;
+    result->nsPerQuery = floorNs / result->count;
+    result->checksum = host_hash_u32(floorHash, numMismatches);
+}
+
+/**************************************************
+ *                   BASELINES                    *
+ **************************************************/
+
+static void write_baseline(const char *path) {
+    FILE *file = fopen(path, "w");
+    s32 i;
+
+    if (file == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "# level\tquery\tcount\tns_per_query\tavg_walk\tmax_walk\tchecksum\n");
+    for (i = 0; i < sNumResults; i++) {
+        struct BenchResult *result = &sResults[i];
+
+        fprintf(file, "%s\t%s\t%d\t%.2f\t%.2f\t%d\t%08X\n", result->level, result->query, result->count,
+                result->nsPerQuery, result->avgWalk, result->maxWalk, result->checksum);
+    }
+
+    fclose(file);
+}
+
+/**
+ * Compares the results against a baseline. Returns the number of regressions: results that
+ * changed (checksum mismatch on the same probe count), or queries that got slower than allowed.
+ */
+static s32 compare_baseline(const char *path, f64 failSlowerPct) {
+    struct BenchResult base;
+    char line[512];
+    s32 i, numRegressions = 0;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n%-20s %-6s %12s %12s %8s  %s\n", "level", "query", "base ns", "ns", "delta", "result");
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        }
+
+        if (sscanf(line, "%63s %15s %d %lf %lf %d %X", base.level, base.query, &base.count,
+                   &base.nsPerQuery, &base.avgWalk, &base.maxWalk, &base.checksum) != 7) {
+            continue;
+        }
+
+        for (i = 0; i < sNumResults; i++) {
+            struct BenchResult *result = &sResults[i];
+            const char *status = "same";
+
+            if (strcmp(result->level, base.level) != 0 || strcmp(result->query, base.query) != 0) {
+                continue;
+            }
+
+            f64 delta = (base.nsPerQuery > 0.0) ? (100.0 * (result->nsPerQuery - base.nsPerQuery) / base.nsPerQuery) : 0.0;
+
+            if (result->count != base.count) {
+                status = "different probes";
+            } else if (result->checksum != base.checksum) {
+                status = "RESULTS DIFFER";
+                numRegressions++;
+            } else if (failSlowerPct > 0.0 && delta > failSlowerPct) {
+                status = "TOO SLOW";
+                numRegressions++;
+            }
+
+            printf("%-20s %-6s %12.1f %12.1f %+7.1f%%  %s\n", result->level, result->query,
+                   base.nsPerQuery, result->nsPerQuery, delta, status);
+            break;
+        }
+    }
+
+    fclose(file);
+    return numRegressions;
+}
+
+/**************************************************
+ *                      MAIN                      *
+ **************************************************/
+
+static void usage(const char *name) {
+    printf("Usage: %s [options]\n"
+           "  -l <name>     only run areas whose name (\"<level>/<area>\") contains <name>\n"
+           "  -n <count>    random probes per query type and area (default 200000)\n"
+           "  -L <count>    number of timed load_area_terrain calls per area (default 20)\n"
+           "  -s <seed>     random seed (default 1)\n"
+           "  -p <file>     replay recorded probes from <file> instead of random ones\n"
+           "  -r <file>     record the probes that were used to <file>\n"
+           "  -o <file>     write a baseline to <file>\n"
+           "  -c <file>     compare against the baseline in <file>, exits non-zero if results changed\n"
+           "  -f <percent>  with -c, also fail if a query got more than <percent> slower\n"
+           "  -w <count>    print cell list statistics and the <count> longest lists per area\n"
+           "  -d <frames>   also load moving surface objects for <frames> frames per area\n",
+           name);
+}
+
+int main(int argc, char *argv[]) {
+    struct BenchOptions opts = {
+        .numQueries = 200000,
+        .numLoads = 20,
+        .seed = 1,
+    };
+    FILE *recordFile = NULL;
+    s32 i, type, numRegressions = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        switch (arg[1]) {
+            case 'l': opts.levelFilter   = value;               break;
+            case 'n': opts.numQueries    = atoi(value);         break;
+            case 'L': opts.numLoads      = MAX(1, atoi(value)); break;
+            case 's': opts.seed          = strtoul(value, NULL, 0); break;
+            case 'p': opts.probeFile     = value;               break;
+            case 'r': opts.recordFile    = value;               break;
+            case 'o': opts.baselineFile  = value;               break;
+            case 'c': opts.compareFile   = value;               break;
+            case 'f': opts.failSlowerPct = atof(value);         break;
+            case 'w': opts.numWorstCells = MIN(32, atoi(value)); break;
+            case 'd': opts.numDynamicFrames = MAX(0, atoi(value)); break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    if (opts.recordFile != NULL) {
+        recordFile = fopen(opts.recordFile, "w");
+        if (recordFile == NULL) {
+            perror(opts.recordFile);
+            return EXIT_FAILURE;
+        }
+        fprintf(recordFile, "# level query x y z arg0 arg1 arg2\n");
+    }
+
+    host_init_surface_pools();
+
+    printf("%-20s %-6s %9s %10s %9s %9s  %s\n", "level", "query", "count", "ns/query", "avg walk", "max walk", "checksum");
+
+    for (i = 0; i < gNumHostLevels; i++) {
+        const struct HostLevel *level = &gHostLevels[i];
+        struct ProbeSet sets[NUM_PROBE_TYPES];
+        s32 firstResult = sNumResults;
+
+        if (opts.levelFilter != NULL && strstr(level->name, opts.levelFilter) == NULL) {
+            continue;
+        }
+
+        memset(sets, 0, sizeof(sets));
+        // Seed per area, so filtering areas does not change the probes of the others.
+        sRandomState = (opts.seed * 0x9E3779B9) ^ (i + 1) * 0x85EBCA6B;
+        if (sRandomState == 0) {
+            sRandomState = 1;
+        }
+
+        bench_load(level, &opts);
+
+        if (opts.probeFile != NULL) {
+            if (read_recorded_probes(opts.probeFile, level->name, sets) <= 0) {
+                continue;
+            }
+        } else if (gNumStaticSurfaces > 0) {
+            generate_random_probes(sets, opts.numQueries);
+        }
+
+        if (recordFile != NULL) {
+            record_probes(recordFile, level->name, sets);
+        }
+
+        for (type = PROBE_FLOOR; type < NUM_PROBE_TYPES; type++) {
+            bench_queries(level, type, &sets[type]);
+        }
+
+        numRegressions += bench_floor_batches(level, &sets[PROBE_FLOOR]);
+
+        for (type = PROBE_FLOOR; type < NUM_PROBE_TYPES; type++) {
+            free(sets[type].probes);
+        }
+
+        // Surface objects are spawned on the area's static surfaces.
+        if (opts.numDynamicFrames > 0 && gNumStaticSurfaces > 0) {
+            bench_dynamic(level, opts.numDynamicFrames);
+        }
+
+        for (type = firstResult; type < sNumResults; type++) {
+            struct BenchResult *result = &sResults[type];
+
+            printf("%-20s %-6s %9d %10.1f %9.1f %9d  %08X\n", result->level, result->query, result->count,
+                   result->nsPerQuery, result->avgWalk, result->maxWalk, result->checksum);
+        }
+
+        if (opts.numWorstCells > 0) {
+            print_cell_stats(level, opts.numWorstCells);
+        }
+    }
+
+    if (recordFile != NULL) {
+        fclose(recordFile);
+    }
+
+    if (opts.baselineFile != NULL) {
+        write_baseline(opts.baselineFile);
+    }
+
+    if (opts.compareFile != NULL) {
+        numRegressions += compare_baseline(opts.compareFile, opts.failSlowerPct);
+        if (numRegressions > 0) {
+            printf("\n%d regression(s) against %s\n", numRegressions, opts.compareFile);
+        }
+    }
+
+    return (numRegressions > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
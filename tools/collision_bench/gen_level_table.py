@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""
+Generates the level table for the host collision tools.
+
+Every levels/*/areas/*/collision.inc.c (and the matching room.inc.c, if the area
+has one) is included into a single translation unit, and a table of
+{ name, collision, rooms } entries is emitted so the tools can iterate every area.
+With HOST_BAKED_LEVELS, the collision baked by bake_collision is included and linked
+to each entry as well.
+Every object collision model (the other levels/*/*/collision.inc.c and
+actors/*/collision.inc.c) is listed in a second table, for loading as surface objects.
+The special object preset types and behavior names are also extracted from
+include/special_presets.h, so special objects can be skipped or recognized without
+linking any behavior data.
+"""
+
+import glob
+import os
+import re
+import sys
+
+COLLISION_RE = re.compile(r"const\s+Collision\s+(\w+)\s*\[\]")
+OBJECT_COLLISION_GLOBS = ["levels/*/*/collision.inc.c", "actors/*/collision.inc.c"]
+ROOMS_RE     = re.compile(r"const\s+RoomData\s+(\w+)\s*\[\]")
+PRESET_RE    = re.compile(r"\{\s*(0x[0-9A-Fa-f]+|\d+)\s*,\s*(SPTYPE_\w+)\s*,[^,]*,[^,]*,\s*(\w+)")
+SPTYPE_RE    = re.compile(r"#define\s+(SPTYPE_\w+)\s+(\d+)")
+
+
+def first_match(regex, path):
+    with open(path) as f:
+        match = regex.search(f.read())
+    return match.group(1) if match else None
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: %s <repo root> <output file>" % sys.argv[0], file=sys.stderr)
+        return 1
+
+    root, out_path = sys.argv[1], sys.argv[2]
+    includes = []
+    entries  = []
+
+    for path in sorted(glob.glob(os.path.join(root, "levels/*/areas/*/collision.inc.c"))):
+        rel      = os.path.relpath(path, root)
+        parts    = rel.split(os.sep)
+        name     = "%s/%s" % (parts[1], parts[3])
+        collision = first_match(COLLISION_RE, path)
+        if collision is None:
+            continue
+
+        rooms_path = os.path.join(os.path.dirname(path), "room.inc.c")
+        rooms = None
+        includes.append(rel)
+        if os.path.exists(rooms_path):
+            rooms = first_match(ROOMS_RE, rooms_path)
+            if rooms is not None:
+                includes.append(os.path.relpath(rooms_path, root))
+
+        entries.append((name, collision, rooms))
+
+    objects = []
+    for pattern in OBJECT_COLLISION_GLOBS:
+        for path in sorted(glob.glob(os.path.join(root, pattern))):
+            rel = os.path.relpath(path, root)
+            if rel.split(os.sep)[2] == "areas":
+                continue
+            with open(path) as f:
+                collisions = COLLISION_RE.findall(f.read())
+            if collisions:
+                includes.append(rel)
+                objects.extend(collisions)
+
+    with open(os.path.join(root, "include/special_presets.h")) as f:
+        presets_src = f.read()
+    sptypes = dict((m.group(1), int(m.group(2))) for m in SPTYPE_RE.finditer(presets_src))
+    presets = [(int(m.group(1), 0), sptypes[m.group(2)], m.group(3)) for m in PRESET_RE.finditer(presets_src)]
+
+    with open(out_path, "w") as out:
+        out.write("// Generated by gen_level_table.py, do not edit.\n\n")
+        for inc in includes:
+            out.write('#include "%s"\n' % inc)
+
+        out.write("\n#ifdef HOST_BAKED_LEVELS\n")
+        for name, collision, rooms in entries:
+            level, area = name.split("/")
+            out.write('#include "levels/%s/areas/%s/collision_baked.inc.c"\n' % (level, area))
+        out.write("#define BAKED(collision) &collision##_baked\n")
+        out.write("#else\n")
+        out.write("#define BAKED(collision) NULL\n")
+        out.write("#endif\n")
+
+        out.write("\nconst struct HostLevel gHostLevels[] = {\n")
+        for name, collision, rooms in entries:
+            out.write('    { "%s", "%s", %s, %s, %s, BAKED(%s) },\n'
+                      % (name, collision, collision, ('"%s"' % rooms) if rooms else "NULL",
+                         rooms if rooms else "NULL", collision))
+        out.write("};\n\nconst s32 gNumHostLevels = ARRAY_COUNT(gHostLevels);\n\n")
+
+        out.write("const struct HostObjectCollision gHostObjectCollisions[] = {\n")
+        for collision in objects:
+            out.write('    { "%s", %s },\n' % (collision, collision))
+        out.write("};\n\nconst s32 gNumHostObjectCollisions = ARRAY_COUNT(gHostObjectCollisions);\n\n")
+
+        out.write("const s8 gSpecialPresetTypes[256] = {\n")
+        out.write("    [0 ... 255] = -1,\n")
+        for preset_id, preset_type, behavior in presets:
+            out.write("    [0x%02X] = %d,\n" % (preset_id, preset_type))
+        out.write("};\n\n")
+
+        out.write("const char *const gSpecialPresetBehaviors[256] = {\n")
+        for preset_id, preset_type, behavior in presets:
+            if behavior != "NULL":
+                out.write('    [0x%02X] = "%s",\n' % (preset_id, behavior))
+        out.write("};\n")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,62 @@
+#ifndef HOST_COLLISION_H
+#define HOST_COLLISION_H
+
+#include <PR/ultratypes.h>
+
+#include "types.h"
+
+struct BakedCollision;
+
+/**
+ * One area's static collision, as found in levels/<level>/areas/<area>/collision.inc.c.
+ */
+struct HostLevel {
+    const char *name;                   // "<level>/<area>"
+    const char *collisionName;          // The symbol of the area's terrain data
+    const Collision *collision;         // The area's terrain data
+    const char *roomsName;              // The symbol of the area's room table, or NULL
+    const RoomData *rooms;              // The area's room table, or NULL
+    const struct BakedCollision *baked; // The area's baked collision with HOST_BAKED_LEVELS, otherwise NULL
+};
+
+/**
+ * An object collision model, for loading as a surface object.
+ */
+struct HostObjectCollision {
+    const char *name;                   // The symbol of the collision data
+    const Collision *collision;
+};
+
+/**
+ * A special object in the last loaded area's terrain data.
+ */
+struct HostSpecialObject {
+    u8 presetID;
+    Vec3s pos;
+    s16 yaw;                            // Already converted like convert_rotation does, 0 without one
+};
+
+#define MAX_HOST_SPECIAL_OBJECTS 512
+
+// Generated by gen_level_table.py.
+extern const struct HostLevel gHostLevels[];
+extern const s32 gNumHostLevels;
+extern const struct HostObjectCollision gHostObjectCollisions[];
+extern const s32 gNumHostObjectCollisions;
+extern const s8 gSpecialPresetTypes[256];
+extern const char *const gSpecialPresetBehaviors[256]; // NULL for presets without a behavior
+
+// Filled in by host_load_level.
+extern struct HostSpecialObject gHostSpecialObjects[MAX_HOST_SPECIAL_OBJECTS];
+extern s32 gNumHostSpecialObjects;
+
+void host_init_surface_pools(void);
+void host_load_level(const struct HostLevel *level);
+void host_load_level_baked(const struct HostLevel *level, const struct BakedCollision *baked);
+u32 host_hash_partition(void);
+u32 host_hash_surface(u32 hash, struct Surface *surf);
+u32 host_hash_u32(u32 hash, u32 value);
+
+#define HOST_HASH_INIT 0x811C9DC5
+
+#endif // HOST_COLLISION_H
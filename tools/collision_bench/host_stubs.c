@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "game/camera.h"
+#include "game/level_update.h"
+#include "game/memory.h"
+#include "game/object_list_processor.h"
+#include "engine/math_util.h"
+#include "engine/surface_collision.h"
+#include "engine/surface_load.h"
+
+#include "host_collision.h"
+
+/**
+ * Host replacements for the parts of the game the collision engine links against.
+ * Objects, macro objects and special objects are never spawned on the host; terrain
+ * data that would spawn them is only skipped over. Special objects are listed in
+ * gHostSpecialObjects, for tools that need to know where e.g. the doors are.
+ */
+
+s16 gCollisionFlags = COLLISION_FLAGS_NONE;
+struct Object *gCurrentObject = NULL;
+struct Object *gMarioObject = NULL;
+static struct MarioState sHostMarioState;
+struct MarioState *gMarioState = &sHostMarioState;
+struct LakituState gLakituState;
+u32 gTimeStopState = 0;
+s32 gNumFindFloorMisses = 0;
+struct HostSpecialObject gHostSpecialObjects[MAX_HOST_SPECIAL_OBJECTS];
+s32 gNumHostSpecialObjects = 0;
+s32 gSurfaceNodesAllocated = 0;
+s32 gSurfacesAllocated = 0;
+s32 gNumStaticSurfaceNodes = 0;
+s32 gNumStaticSurfaces = 0;
+TerrainData *gEnvironmentRegions = NULL;
+s32 gEnvironmentLevels[20];
+s16 gCCMEnteredSlide = FALSE;
+const BehaviorScript bhvDddWarp[1];
+
+struct Object gObjectPool[OBJECT_POOL_CAPACITY];
+struct ObjectNode *gObjectLists = NULL;
+
+void *main_pool_alloc(u32 size, UNUSED u32 side) {
+    void *buf = calloc(1, size);
+
+    if (buf == NULL) {
+        fprintf(stderr, "main_pool_alloc: out of memory (%u bytes)\n", size);
+        exit(EXIT_FAILURE);
+    }
+
+    return buf;
+}
+
+/**
+ * Memory pools are only used for dynamic surfaces, which can just be malloc'd on the host.
+ */
+struct MemoryPool *mem_pool_init(UNUSED u32 size, UNUSED u32 side) {
+    static u8 sHostMemoryPool;
+
+    return (struct MemoryPool *) &sHostMemoryPool;
+}
+
+void *mem_pool_alloc(UNUSED struct MemoryPool *pool, u32 size) {
+    return malloc(size);
+}
+
+void mem_pool_free(UNUSED struct MemoryPool *pool, void *addr) {
+    free(addr);
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+void reset_red_coins_collected(void) {
+}
+
+f32 dist_between_objects(UNUSED struct Object *obj1, UNUSED struct Object *obj2) {
+    return 0.0f;
+}
+
+void obj_build_transform_from_pos_and_angle(UNUSED struct Object *obj, UNUSED s16 posIndex, UNUSED s16 angleIndex) {
+}
+
+void spawn_macro_objects(UNUSED s32 areaIndex, UNUSED MacroObject *macroObjList) {
+}
+
+void spawn_macro_objects_hardcoded(UNUSED s32 areaIndex, UNUSED MacroObject *macroObjList) {
+}
+
+/**
+ * Same as convert_rotation in macro_special_objects.c.
+ */
+static s16 host_convert_rotation(s16 inRotation) {
+    u16 rotation = ((u16)(inRotation & 0xFF) << 8);
+
+    switch (rotation) {
+        case 0x3F00: rotation = 0x4000; break;
+        case 0x7F00: rotation = 0x8000; break;
+        case 0xBF00: rotation = 0xC000; break;
+        case 0xFF00: rotation = 0x0000; break;
+    }
+
+    return (s16) rotation;
+}
+
+/**
+ * Skips over the special objects in the terrain data, the same way get_special_objects_size does,
+ * and lists them in gHostSpecialObjects.
+ */
+void spawn_special_objects(UNUSED s32 areaIndex, TerrainData **specialObjList) {
+    s32 numOfSpecialObjects = *(*specialObjList)++;
+    s32 i;
+
+    for (i = 0; i < numOfSpecialObjects; i++) {
+        u8 presetID = *(*specialObjList);
+        struct HostSpecialObject *special = NULL;
+
+        if (gNumHostSpecialObjects < MAX_HOST_SPECIAL_OBJECTS) {
+            special = &gHostSpecialObjects[gNumHostSpecialObjects++];
+            special->presetID = presetID;
+            vec3s_set(special->pos, (*specialObjList)[1], (*specialObjList)[2], (*specialObjList)[3]);
+            special->yaw = 0;
+        }
+
+        *specialObjList += 4;
+
+        switch (gSpecialPresetTypes[presetID]) {
+            case 1: // SPTYPE_YROT_NO_PARAMS
+            case 4: // SPTYPE_DEF_PARAM_AND_YROT
+                if (special != NULL) {
+                    special->yaw = host_convert_rotation(**specialObjList);
+                }
+                *specialObjList += 1;
+                break;
+            case 2: // SPTYPE_PARAMS_AND_YROT
+                if (special != NULL) {
+                    special->yaw = host_convert_rotation(**specialObjList);
+                }
+                *specialObjList += 2;
+                break;
+            case 3: // SPTYPE_UNKNOWN
+                *specialObjList += 3;
+                break;
+            case 0: // SPTYPE_NO_YROT_OR_PARAMS
+                break;
+            default:
+                fprintf(stderr, "spawn_special_objects: unknown preset 0x%02X\n", presetID);
+                exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void host_init_surface_pools(void) {
+    alloc_surface_pools();
+    clear_dynamic_surfaces();
+}
+
+void host_load_level(const struct HostLevel *level) {
+    host_load_level_baked(level, level->baked);
+}
+
+/**
+ * Loads an area with the given baked collision, or from its terrain data if baked is NULL.
+ */
+void host_load_level_baked(const struct HostLevel *level, const struct BakedCollision *baked) {
+    gSurfacePoolError = 0;
+    gNumHostSpecialObjects = 0;
+
+    load_area_terrain(0, (TerrainData *) level->collision, (RoomData *) level->rooms, NULL, baked);
+    clear_dynamic_surfaces();
+
+    if (gSurfacePoolError) {
+        fprintf(stderr, "%s: surface pool overflow (flags 0x%X)\n", level->name, gSurfacePoolError);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * FNV-1a over the four bytes of a value.
+ */
+u32 host_hash_u32(u32 hash, u32 value) {
+    s32 i;
+
+    for (i = 0; i < 4; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 0x01000193;
+    }
+
+    return hash;
+}
+
+static u32 hash_f32(u32 hash, f32 value) {
+    u32 bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return host_hash_u32(hash, bits);
+}
+
+/**
+ * Hashes everything about a surface except the object it belongs to.
+ */
+u32 host_hash_surface(u32 hash, struct Surface *surf) {
+    hash = host_hash_u32(hash, ((u16) surf->type << 16) | (u16) surf->force);
+    hash = host_hash_u32(hash, ((u8) surf->flags << 24) | ((u8) surf->room << 16) | (u16) surf->lowerY);
+    hash = host_hash_u32(hash, (u16) surf->upperY);
+    hash = host_hash_u32(hash, ((u16) surf->vertex1[0] << 16) | (u16) surf->vertex1[1]);
+    hash = host_hash_u32(hash, ((u16) surf->vertex1[2] << 16) | (u16) surf->vertex2[0]);
+    hash = host_hash_u32(hash, ((u16) surf->vertex2[1] << 16) | (u16) surf->vertex2[2]);
+    hash = host_hash_u32(hash, ((u16) surf->vertex3[0] << 16) | (u16) surf->vertex3[1]);
+    hash = host_hash_u32(hash, (u16) surf->vertex3[2]);
+    hash = hash_f32(hash, surf->normal.x);
+    hash = hash_f32(hash, surf->normal.y);
+    hash = hash_f32(hash, surf->normal.z);
+    hash = hash_f32(hash, surf->originOffset);
+
+    return hash;
+}
+
+/**
+ * Hashes every static surface and the order of every static cell list, so two ways of building
+ * the static partition can be compared bit for bit.
+ */
+u32 host_hash_partition(void) {
+    u32 hash = HOST_HASH_INIT;
+    s32 i, cellX, cellZ, listIndex;
+
+    for (i = 0; i < gNumStaticSurfaces; i++) {
+        hash = host_hash_surface(hash, &sSurfacePool[i]);
+    }
+
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < NUM_SPATIAL_PARTITIONS; listIndex++) {
+                struct SurfaceNode *node = gStaticSurfacePartition[cellZ][cellX][listIndex].next;
+
+                while (node != NULL) {
+                    hash = host_hash_u32(hash, node->surface - sSurfacePool);
+                    node = node->next;
+                }
+                hash = host_hash_u32(hash, 0xFFFFFFFF);
+            }
+        }
+    }
+
+    return hash;
+}
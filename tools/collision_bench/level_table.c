@@ -0,0 +1,10 @@
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "surface_terrains.h"
+#include "level_misc_macros.h"
+#include "special_preset_names.h"
+
+#include "host_collision.h"
+
+#include "level_table.inc.c"
@@ -0,0 +1,354 @@
+/**
+ * object_bench: host-native check and benchmark for object-object collision detection.
+ *
+ * src/game/object_collision.c is compiled for the host, then random scenes of a few hundred
+ * objects (coin formations, actors, pushables, destructive objects and a few huge hitboxes)
+ * are built in gObjectPool and moved around for a number of frames. Every frame,
+ * detect_object_collisions is run and its results (collided objects in order, interact types,
+ * interaction subtypes and intangibility timers of every object) are compared to checking
+ * every list with check_collision_in_list, which is what the game does without
+ * OBJECT_COLLISION_GRID. Both are also timed.
+ *
+ * Build with `make -C tools/collision_bench object_bench`, then run `./object_bench -h` for usage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "engine/math_util.h"
+#include "game/interaction.h"
+#include "game/object_collision.h"
+#include "game/object_list_processor.h"
+
+#include "host_collision.h"
+
+// The list checks detect_object_collisions uses without OBJECT_COLLISION_GRID.
+void clear_object_collision(struct Object *a);
+void check_player_object_collision(void);
+void check_destructive_object_collision(void);
+void check_pushable_object_collision(void);
+
+#define NUM_COIN_FORMATIONS 15
+#define COINS_PER_FORMATION 8
+
+struct SceneOptions {
+    s32 numScenes;
+    s32 numFrames;
+    s32 numTimedRuns;
+    u32 seed;
+};
+
+static struct ObjectNode sObjectLists[NUM_OBJ_LISTS];
+static u32 sRandomState;
+static s32 sNumObjects;
+
+static u32 bench_random(void) {
+    // xorshift32
+    sRandomState ^= sRandomState << 13;
+    sRandomState ^= sRandomState >> 17;
+    sRandomState ^= sRandomState << 5;
+    return sRandomState;
+}
+
+static f32 bench_random_range(f32 min, f32 max) {
+    return min + (max - min) * ((bench_random() >> 8) / (f32) (1 << 24));
+}
+
+static f64 get_time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**************************************************
+ *                     SCENES                     *
+ **************************************************/
+
+static struct Object *add_object(s32 list, f32 x, f32 y, f32 z, f32 radius, f32 height) {
+    struct Object *obj = &gObjectPool[sNumObjects++];
+    struct ObjectNode *head = &gObjectLists[list];
+
+    memset(obj, 0, sizeof(*obj));
+    obj->activeFlags = ACTIVE_FLAG_ACTIVE;
+    obj->oPosX = x;
+    obj->oPosY = y;
+    obj->oPosZ = z;
+    obj->hitboxRadius = radius;
+    obj->hitboxHeight = height;
+    obj->hitboxDownOffset = (bench_random() % 4 == 0) ? bench_random_range(0.0f, height / 2) : 0.0f;
+    obj->hurtboxRadius = (bench_random() % 3 == 0) ? 0.0f : (radius * bench_random_range(0.5f, 1.2f));
+    obj->hurtboxHeight = height * bench_random_range(0.5f, 1.2f);
+    obj->oInteractType = (1 << (bench_random() % 24));
+    obj->oDistanceToMario = bench_random_range(0.0f, 3000.0f);
+
+    // Some objects are intangible, or only become tangible after a frame or two.
+    switch (bench_random() % 16) {
+        case 0: obj->oIntangibleTimer = -1; break;
+        case 1: obj->oIntangibleTimer =  1; break;
+        case 2: obj->oIntangibleTimer =  2; break;
+    }
+
+    // Append to the list.
+    obj->header.prev = head->prev;
+    obj->header.next = head;
+    head->prev->next = &obj->header;
+    head->prev = &obj->header;
+
+    return obj;
+}
+
+/**
+ * Builds a scene around Mario. Coin formations and actors are spread over a few thousand units,
+ * with some of them on top of Mario so there are more than 4 overlaps to record.
+ */
+static void build_scene(void) {
+    struct Object *mario;
+    f32 x, z;
+    s32 i, j;
+
+    for (i = 0; i < NUM_OBJ_LISTS; i++) {
+        gObjectLists[i].next = &gObjectLists[i];
+        gObjectLists[i].prev = &gObjectLists[i];
+    }
+    sNumObjects = 0;
+
+    mario = add_object(OBJ_LIST_PLAYER, 0.0f, 0.0f, 0.0f, 37.0f, 160.0f);
+    mario->oIntangibleTimer = 0;
+    gMarioObject = mario;
+
+    // Now and then a second player.
+    if (bench_random() % 4 == 0) {
+        add_object(OBJ_LIST_PLAYER, bench_random_range(-200.0f, 200.0f), 0.0f, bench_random_range(-200.0f, 200.0f), 37.0f, 160.0f);
+    }
+
+    for (i = 0; i < NUM_COIN_FORMATIONS; i++) {
+        // The first formations are around Mario.
+        f32 spread = (i < 3) ? 150.0f : 5000.0f;
+        f32 ringRadius = bench_random_range(50.0f, 300.0f);
+
+        x = bench_random_range(-spread, spread);
+        z = bench_random_range(-spread, spread);
+        for (j = 0; j < COINS_PER_FORMATION; j++) {
+            add_object(OBJ_LIST_LEVEL, x + ringRadius * sins(j * 0x2000), bench_random_range(-50.0f, 50.0f),
+                       z + ringRadius * coss(j * 0x2000), 100.0f, 64.0f);
+        }
+    }
+
+    for (i = 0; i < 30; i++) {
+        add_object(OBJ_LIST_GENACTOR, bench_random_range(-3000.0f, 3000.0f), bench_random_range(-100.0f, 100.0f),
+                   bench_random_range(-3000.0f, 3000.0f), bench_random_range(30.0f, 250.0f), bench_random_range(50.0f, 300.0f));
+    }
+
+    // Huge hitboxes, plus a few unusual ones.
+    add_object(OBJ_LIST_GENACTOR, bench_random_range(-1000.0f, 1000.0f), 0.0f, bench_random_range(-1000.0f, 1000.0f), 1200.0f, 500.0f);
+    add_object(OBJ_LIST_SURFACE, bench_random_range(-1000.0f, 1000.0f), 0.0f, bench_random_range(-1000.0f, 1000.0f), 700.0f, 300.0f);
+    add_object(OBJ_LIST_LEVEL, bench_random_range(-500.0f, 500.0f), 0.0f, bench_random_range(-500.0f, 500.0f), -150.0f, 100.0f);
+    add_object(OBJ_LIST_LEVEL, bench_random_range(-500.0f, 500.0f), 0.0f, bench_random_range(-500.0f, 500.0f), 0.0f, 100.0f);
+
+    for (i = 0; i < 12; i++) {
+        add_object(OBJ_LIST_PUSHABLE, bench_random_range(-1500.0f, 1500.0f), 0.0f,
+                   bench_random_range(-1500.0f, 1500.0f), bench_random_range(50.0f, 200.0f), 100.0f);
+        add_object(OBJ_LIST_POLELIKE, bench_random_range(-3000.0f, 3000.0f), 0.0f,
+                   bench_random_range(-3000.0f, 3000.0f), bench_random_range(30.0f, 80.0f), 800.0f);
+        add_object(OBJ_LIST_SURFACE, bench_random_range(-3000.0f, 3000.0f), 0.0f,
+                   bench_random_range(-3000.0f, 3000.0f), bench_random_range(0.0f, 300.0f), 100.0f);
+    }
+
+    for (i = 0; i < 16; i++) {
+        struct Object *obj = add_object(OBJ_LIST_DESTRUCTIVE, bench_random_range(-1500.0f, 1500.0f), 0.0f,
+                                        bench_random_range(-1500.0f, 1500.0f), bench_random_range(20.0f, 150.0f), 80.0f);
+
+        if (bench_random() % 5 == 0) {
+            obj->activeFlags |= ACTIVE_FLAG_DESTRUCTIVE_OBJ_DONT_DESTROY;
+        }
+    }
+
+    // Fill the rest of the pool with particles that nothing checks against.
+    while (sNumObjects < OBJECT_POOL_CAPACITY) {
+        add_object(OBJ_LIST_UNIMPORTANT, bench_random_range(-500.0f, 500.0f), 0.0f, bench_random_range(-500.0f, 500.0f), 50.0f, 50.0f);
+    }
+}
+
+static void move_scene(void) {
+    s32 i;
+
+    for (i = 0; i < sNumObjects; i++) {
+        struct Object *obj = &gObjectPool[i];
+
+        if (i % 3 == 0) {
+            obj->oPosX += bench_random_range(-40.0f, 40.0f);
+            obj->oPosY += bench_random_range(-10.0f, 10.0f);
+            obj->oPosZ += bench_random_range(-40.0f, 40.0f);
+        }
+    }
+}
+
+/**************************************************
+ *                   COLLISIONS                   *
+ **************************************************/
+
+static void detect_object_collisions_in_lists(void) {
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_POLELIKE]);
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PLAYER]);
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PUSHABLE]);
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_GENACTOR]);
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_LEVEL]);
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_SURFACE]);
+    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_DESTRUCTIVE]);
+    check_player_object_collision();
+    check_destructive_object_collision();
+    check_pushable_object_collision();
+}
+
+/**
+ * Hashes everything object collision detection writes, returning the number of collisions.
+ */
+static u32 hash_collisions(s32 *numCollisions) {
+    u32 hash = HOST_HASH_INIT;
+    s32 i, j;
+
+    for (i = 0; i < sNumObjects; i++) {
+        struct Object *obj = &gObjectPool[i];
+
+        hash = host_hash_u32(hash, obj->numCollidedObjs);
+        for (j = 0; j < obj->numCollidedObjs; j++) {
+            hash = host_hash_u32(hash, (u32) (obj->collidedObjs[j] - gObjectPool));
+        }
+        hash = host_hash_u32(hash, obj->collidedObjInteractTypes);
+        hash = host_hash_u32(hash, obj->oInteractionSubtype);
+        hash = host_hash_u32(hash, obj->oIntangibleTimer);
+        *numCollisions += obj->numCollidedObjs;
+    }
+
+    return hash;
+}
+
+/**
+ * Runs one scene. Returns the number of frames where the two results differ.
+ */
+static s32 run_scene(s32 scene, struct SceneOptions *opts, f64 *listNs, f64 *gridNs, s64 *numCollisions) {
+    static struct Object sSavedPool[OBJECT_POOL_CAPACITY];
+    s32 frame, run, numMismatches = 0;
+    s32 listCollisions, gridCollisions;
+    u32 listHash, gridHash;
+    f64 start;
+
+    build_scene();
+
+    for (frame = 0; frame < opts->numFrames; frame++) {
+        move_scene();
+        memcpy(sSavedPool, gObjectPool, sizeof(sSavedPool));
+
+        listCollisions = 0;
+        detect_object_collisions_in_lists();
+        listHash = hash_collisions(&listCollisions);
+
+        memcpy(gObjectPool, sSavedPool, sizeof(sSavedPool));
+        gridCollisions = 0;
+        detect_object_collisions();
+        gridHash = hash_collisions(&gridCollisions);
+
+        if (listHash != gridHash) {
+            if (numMismatches++ == 0) {
+                fprintf(stderr, "scene %d frame %d: %d collisions in the lists, %d in the grid\n",
+                        scene, frame, listCollisions, gridCollisions);
+            }
+        }
+        *numCollisions += gridCollisions;
+
+        // Intangibility timers run out over the timed runs, which both sides see the same way.
+        memcpy(sSavedPool, gObjectPool, sizeof(sSavedPool));
+        start = get_time_ns();
+        for (run = 0; run < opts->numTimedRuns; run++) {
+            detect_object_collisions_in_lists();
+        }
+        *listNs += get_time_ns() - start;
+
+        memcpy(gObjectPool, sSavedPool, sizeof(sSavedPool));
+        start = get_time_ns();
+        for (run = 0; run < opts->numTimedRuns; run++) {
+            detect_object_collisions();
+        }
+        *gridNs += get_time_ns() - start;
+    }
+
+    return numMismatches;
+}
+
+/**************************************************
+ *                      MAIN                      *
+ **************************************************/
+
+static void usage(const char *name) {
+    printf("Usage: %s [options]\n"
+           "  -n <count>    number of random scenes (default 50)\n"
+           "  -f <frames>   frames per scene (default 60)\n"
+           "  -t <count>    timed runs per frame (default 20)\n"
+           "  -s <seed>     random seed (default 1)\n",
+           name);
+}
+
+int main(int argc, char *argv[]) {
+    struct SceneOptions opts = {
+        .numScenes = 50,
+        .numFrames = 60,
+        .numTimedRuns = 20,
+        .seed = 1,
+    };
+    s32 i, numMismatches = 0;
+    s64 numCollisions = 0;
+    f64 listNs = 0.0, gridNs = 0.0;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        switch (arg[1]) {
+            case 'n': opts.numScenes    = MAX(1, atoi(value));     break;
+            case 'f': opts.numFrames    = MAX(1, atoi(value));     break;
+            case 't': opts.numTimedRuns = MAX(1, atoi(value));     break;
+            case 's': opts.seed         = strtoul(value, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    gObjectLists = sObjectLists;
+    sRandomState = (opts.seed * 0x9E3779B9) | 1;
+
+    for (i = 0; i < opts.numScenes; i++) {
+        numMismatches += run_scene(i, &opts, &listNs, &gridNs, &numCollisions);
+    }
+
+    s32 numRuns = opts.numScenes * opts.numFrames * opts.numTimedRuns;
+
+    printf("%d scenes of %d objects, %d frames each, %.1f collisions per frame\n", opts.numScenes, sNumObjects,
+           opts.numFrames, (f64) numCollisions / (opts.numScenes * opts.numFrames));
+    printf("lists: %10.1f ns per frame\n", listNs / numRuns);
+    printf("grid:  %10.1f ns per frame (%.2fx)\n", gridNs / numRuns, (gridNs > 0.0) ? (listNs / gridNs) : 0.0);
+
+    if (numMismatches > 0) {
+        printf("\n%d frame(s) where the grid results differ from the lists\n", numMismatches);
+        return EXIT_FAILURE;
+    }
+
+    printf("grid results match the lists on every frame\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+#ifndef _ULTRA64_H_
+#define _ULTRA64_H_
+
+/**
+ * Minimal stand-in for libultra's ultra64.h, used to compile engine code for the host.
+ * Only the types referenced by the shared headers (types.h, sm64.h) are provided;
+ * nothing in here is meant to be called.
+ */
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#define M_PI 3.14159265358979323846
+
+f32 sqrtf(f32 x);
+#include <strings.h> // bzero
+
+typedef void *OSMesg;
+
+typedef struct {
+    s32 validCount;
+    s32 first;
+    s32 msgCount;
+    OSMesg *msg;
+} OSMesgQueue;
+
+typedef struct {
+    u16 type;
+    u8 status;
+    u8 errno;
+} OSContStatus;
+
+typedef struct {
+    u16 button;
+    s8 stick_x;
+    s8 stick_y;
+    u8 errno;
+} OSContPad;
+
+typedef struct {
+    u32 type;
+    u32 flags;
+} OSTask;
+
+#endif // _ULTRA64_H_
@@ -0,0 +1,402 @@
+#!/usr/bin/env python3
+"""
+Repacks the vertex loads of display lists in model .inc.c files for the vertex cache of the
+microcode, and drops texture loads that load what is already loaded. Prints the RSP commands of every
+file before and after, and rewrites the files with --write.
+
+Most models were exported for the 16 entry cache of Fast3D, so they load a few vertices at a time and
+reload the ones that are shared between loads. Each run of vertex loads and triangles between two
+other commands is redone as loads of up to --cache vertices, identical vertices only loaded once per
+load, with the triangles paired into gsSP2Triangles. The new vertex arrays go right before the display
+list, as <display list>_vertex_<n>, and the old ones are removed once nothing uses them.
+
+Triangles are drawn in the same order unless --reorder is given, which lets triangles sharing
+vertices go into the same load. That's only safe for opaque layers, translucent ones depend on the
+order they are drawn in.
+
+A texture load is dropped when the same commands loaded the same texture earlier in the display list,
+and everything between them leaves the texture memory and tiles alone.
+
+Display lists are left as they are when they don't get smaller, when they have preprocessor lines or
+comments in them, or when a vertex array they load is used anywhere other than in vertex loads, such
+as by code that changes the vertices at runtime. Vertex loads that aren't followed by triangles, which
+are for code or display lists drawing afterwards, are kept too. Files where a display list draws vertices loaded by
+another are skipped completely.
+
+Usage:
+  dl_optimize.py [-c 32] [--reorder] [--write] <model.inc.c or directory>...
+"""
+import argparse
+import collections
+import os
+import re
+import sys
+
+from lod_gen import VERTEX_RE, TRI1_RE, TRI2_RE, parse_int, strip_comments, parse_vertex_arrays, \
+    parse_display_list, batch_triangles, format_vertex
+
+GFX_RE = re.compile(r"Gfx\s+(\w+)\s*\[\s*\w*\s*\]\s*=\s*\{(.*?)\};", re.S)
+VTX_RE = re.compile(r"^(?:static\s+)?const\s+Vtx\s+(\w+)\s*\[\s*\w*\s*\]\s*=\s*\{.*?\};\n", re.S | re.M)
+IDENTIFIER_RE = re.compile(r"[A-Za-z_]\w*")
+
+# Commands that only change what's in texture memory or the tile descriptors.
+TEXTURE_COMMANDS = (
+    "gsDPSetTextureImage", "gsDPLoadBlock", "gsDPLoadTile", "gsDPLoadTLUTCmd", "gsDPSetTile",
+    "gsDPSetTileSize", "gsDPLoadTextureBlock", "gsDPLoadTextureTile", "gsDPLoadMultiBlock",
+    "gsDPLoadMultiTile", "gsDPLoadTLUT",
+)
+SYNC_COMMANDS = ("gsDPLoadSync", "gsDPTileSync", "gsDPPipeSync")
+
+# Commands that can be between two texture loads without changing what the first one loaded.
+KEEPS_TEXTURE_COMMANDS = (
+    "gsSPLight", "gsSPSetLights", "gsSPNumLights", "gsSPLightColor", "gsDPSetCombineMode",
+    "gsDPSetCombineLERP", "gsDPSetPrimColor", "gsDPSetEnvColor", "gsDPSetFogColor", "gsDPSetBlendColor",
+    "gsSPSetGeometryMode", "gsSPClearGeometryMode", "gsSPLoadGeometryMode", "gsSPGeometryMode",
+    "gsDPSetRenderMode", "gsSPTexture", "gsDPSetCycleType", "gsDPSetTextureFilter", "gsDPSetTextureLUT",
+    "gsDPSetTexturePersp", "gsDPSetTextureLOD", "gsDPSetTextureDetail", "gsDPSetTextureConvert",
+    "gsDPSetAlphaCompare", "gsDPSetDepthSource", "gsDPSetPrimDepth", "gsDPSetCombineKey", "gsSPFogPosition",
+    "gsDPSetColorDither", "gsDPSetAlphaDither",
+)
+
+# Gfx words taken by macros that are more than one command, everything else is one.
+MACRO_WORDS = {
+    "gsDPLoadTextureBlock": 7,
+    "gsDPLoadTextureBlock_4b": 7,
+    "gsDPLoadTextureBlockS": 7,
+    "gsDPLoadTextureTile": 7,
+    "gsDPLoadTextureTile_4b": 7,
+    "gsDPLoadMultiBlock": 7,
+    "gsDPLoadMultiBlock_4b": 7,
+    "gsDPLoadMultiTile": 7,
+    "gsDPLoadMultiTile_4b": 7,
+    "gsDPLoadTLUT_pal16": 6,
+    "gsDPLoadTLUT_pal256": 6,
+    "gsSPSetLights0": 3,
+    "gsSPSetLights1": 3,
+    "gsSPSetLights2": 4,
+    "gsSPTextureRectangle": 3,
+}
+
+
+class SharedVerticesError(ValueError):
+    """
+    Raised for triangles drawn with vertices that another display list loaded.
+    """
+
+
+class Stats:
+    def __init__(self):
+        self.words = 0
+        self.vertex_loads = 0
+        self.vertices = 0
+        self.texture_loads = 0
+
+    def add(self, other):
+        self.words += other.words
+        self.vertex_loads += other.vertex_loads
+        self.vertices += other.vertices
+        self.texture_loads += other.texture_loads
+
+
+def command_name(command):
+    return command.split("(", 1)[0].strip()
+
+
+def count_commands(commands):
+    stats = Stats()
+    for command in commands:
+        name = command_name(command)
+        stats.words += MACRO_WORDS.get(name, 1)
+        vertex = VERTEX_RE.fullmatch(command)
+        if vertex is not None:
+            stats.vertex_loads += 1
+            stats.vertices += parse_int(vertex.group(3))
+        elif name in ("gsDPLoadBlock", "gsDPLoadTile") or name.startswith(("gsDPLoadTexture", "gsDPLoadMulti")):
+            stats.texture_loads += 1
+    return stats
+
+
+def split_geometry(commands, arrays, cache_size):
+    """
+    Splits a display list into other commands and runs of geometry. Each run is (triangles, commands),
+    with every triangle a tuple of the three vertices it is drawn with. Vertices of arrays in other
+    files are stood in for by (array, index).
+    """
+    items = []
+    cache = [None] * cache_size
+    run = None
+
+    for command in commands:
+        vertex = VERTEX_RE.fullmatch(command)
+        triangles = TRI1_RE.fullmatch(command) or TRI2_RE.fullmatch(command)
+
+        if vertex is not None:
+            array, offset = vertex.group(1), parse_int(vertex.group(2) or "0")
+            count, dest = parse_int(vertex.group(3)), parse_int(vertex.group(4))
+            if dest + count > cache_size or (array in arrays and offset + count > len(arrays[array])):
+                raise ValueError("can't follow the vertex load {}".format(command))
+            if run is None:
+                run = ([], [])
+                items.append(run)
+            for i in range(count):
+                data = arrays[array][offset + i] if array in arrays else (array, offset + i)
+                cache[dest + i] = (data, id(run))
+            run[1].append(command)
+        elif triangles is not None:
+            indices = [parse_int(token) for token in triangles.groups()]
+            if any(index >= cache_size for index in indices):
+                raise ValueError("can't follow the triangles {}".format(command))
+            if any(cache[index] is None for index in indices):
+                raise SharedVerticesError("triangles with vertices another display list loaded")
+            # Vertices loaded before a light or material change can't be moved along with the run.
+            if run is None or any(cache[index][1] != id(run) for index in indices):
+                raise ValueError("triangles with vertices loaded before {}".format(command))
+            for i in range(0, len(indices), 3):
+                run[0].append(tuple(cache[index][0] for index in indices[i:i + 3]))
+            run[1].append(command)
+        else:
+            # Lights are applied when vertices are loaded, so they end a run as much as a material does.
+            run = None
+            items.append(command)
+
+    return items
+
+
+def reorder_triangles(triangles, cache_size):
+    """
+    Orders triangles so each load of cache_size vertices draws as many of them as it can.
+    """
+    by_vertex = collections.defaultdict(list)
+    for i, triangle in enumerate(triangles):
+        for vertex in set(triangle):
+            by_vertex[vertex].append(i)
+
+    used = [False] * len(triangles)
+    next_unused = 0
+    ordered = []
+    while next_unused < len(triangles):
+        loaded = set()
+        while True:
+            # Triangles sharing a loaded vertex, fewest new vertices first, then in the original order.
+            best, best_new = None, None
+            for vertex in loaded:
+                for i in by_vertex[vertex]:
+                    if not used[i]:
+                        new = len(set(triangles[i]) - loaded)
+                        if len(loaded) + new <= cache_size and (best is None or (new, i) < (best_new, best)):
+                            best, best_new = i, new
+            if best is None:
+                best = next(i for i in range(next_unused, len(triangles)) if not used[i])
+                if len(loaded | set(triangles[best])) > cache_size:
+                    break
+            used[best] = True
+            ordered.append(triangles[best])
+            loaded |= set(triangles[best])
+            while next_unused < len(triangles) and used[next_unused]:
+                next_unused += 1
+            if next_unused == len(triangles):
+                break
+    return ordered
+
+
+def optimize_run(triangles, name, vertex_arrays, cache_size, reorder):
+    if reorder:
+        triangles = reorder_triangles(triangles, cache_size)
+
+    commands = []
+    for vertices, tris in batch_triangles(triangles, cache_size):
+        array_name = "{}_vertex_{}".format(name, len(vertex_arrays))
+        vertex_arrays.append((array_name, vertices))
+        commands.append("gsSPVertex({}, {}, 0)".format(array_name, len(vertices)))
+        for i in range(0, len(tris) - 1, 2):
+            commands.append("gsSP2Triangles({:2d}, {:2d}, {:2d}, 0x0, {:2d}, {:2d}, {:2d}, 0x0)".format(
+                *tris[i], *tris[i + 1]))
+        if len(tris) % 2 != 0:
+            commands.append("gsSP1Triangle({:2d}, {:2d}, {:2d}, 0x0)".format(*tris[-1]))
+    return commands
+
+
+def drop_texture_reloads(commands):
+    """
+    Returns the commands without texture loads that load what the last one loaded.
+    """
+    result = []
+    loaded = None
+    i = 0
+    while i < len(commands):
+        name = command_name(commands[i])
+        if name.startswith(TEXTURE_COMMANDS) or name in SYNC_COMMANDS:
+            end = i
+            while end < len(commands) and (command_name(commands[end]).startswith(TEXTURE_COMMANDS)
+                                           or command_name(commands[end]) in SYNC_COMMANDS):
+                end += 1
+            block = commands[i:end]
+            if any(command_name(command) not in SYNC_COMMANDS for command in block):
+                if block == loaded:
+                    i = end
+                    continue
+                loaded = block
+            result.extend(block)
+            i = end
+            continue
+
+        if not (name.startswith(KEEPS_TEXTURE_COMMANDS) or VERTEX_RE.fullmatch(commands[i])
+                or TRI1_RE.fullmatch(commands[i]) or TRI2_RE.fullmatch(commands[i])):
+            loaded = None
+        result.append(commands[i])
+        i += 1
+    return result
+
+
+def optimize_display_list(commands, name, arrays, movable, cache_size, reorder):
+    """
+    Returns the new commands of a display list and its new vertex arrays as (name, vertices).
+    """
+    items = split_geometry(commands, arrays, cache_size)
+    vertex_arrays = []
+    new_commands = []
+    for item in items:
+        if isinstance(item, tuple):
+            triangles, run_commands = item
+            loads = [VERTEX_RE.fullmatch(command).group(1) for command in run_commands
+                     if VERTEX_RE.fullmatch(command)]
+            # Vertices loaded at the end of a run are for whoever draws after the display list.
+            if all(array in movable for array in loads) and not VERTEX_RE.fullmatch(run_commands[-1]):
+                new_commands += optimize_run(triangles, name, vertex_arrays, cache_size, reorder)
+            else:
+                new_commands += run_commands
+        else:
+            new_commands.append(item)
+    return drop_texture_reloads(new_commands), vertex_arrays
+
+
+def count_identifiers(paths):
+    counts = collections.Counter()
+    for path in paths:
+        with open(path, errors="replace") as f:
+            counts.update(IDENTIFIER_RE.findall(f.read()))
+    return counts
+
+
+def source_files(roots):
+    for root in roots:
+        if os.path.isfile(root):
+            yield root
+            continue
+        for directory, _, files in os.walk(root):
+            for file in sorted(files):
+                if file.endswith((".c", ".h", ".s")):
+                    yield os.path.join(directory, file)
+
+
+def definition_start(text, position):
+    """
+    Moves back from the start of a definition over the comment lines right before it.
+    """
+    while True:
+        line_start = text.rfind("\n", 0, max(position - 1, 0)) + 1
+        if position == 0 or not text[line_start:position].lstrip().startswith("//"):
+            return position
+        position = line_start
+
+
+def optimize_file(path, repo_counts, cache_size, reorder, write):
+    with open(path) as f:
+        source = f.read()
+    text = strip_comments(source)
+    arrays = parse_vertex_arrays(text)
+    file_counts = collections.Counter(IDENTIFIER_RE.findall(text))
+
+    # Arrays that are only ever loaded with gsSPVertex in this file can be replaced.
+    loads = collections.Counter(match.group(1) for match in VERTEX_RE.finditer(text))
+    movable = {name for name in arrays
+               if re.search(r"static\s+const\s+Vtx\s+" + name + r"\b", text)
+               and file_counts[name] == loads[name] + 1 and repo_counts[name] == file_counts[name]}
+
+    before, after = Stats(), Stats()
+    changes = []
+    for match in GFX_RE.finditer(source):
+        name, body = match.group(1), match.group(2)
+        commands = parse_display_list(text, name)
+        stats = count_commands(commands)
+        before.add(stats)
+        if "#" in body or "//" in body or "/*" in body:
+            after.add(stats)
+            continue
+        try:
+            new_commands, vertex_arrays = optimize_display_list(commands, name, arrays, movable,
+                                                                cache_size, reorder)
+        except SharedVerticesError:
+            # Moving the vertices of one display list would break the other, leave the whole file alone.
+            unchanged = Stats()
+            for other in GFX_RE.finditer(text):
+                unchanged.add(count_commands(parse_display_list(text, other.group(1))))
+            return unchanged, unchanged
+        except ValueError:
+            after.add(stats)
+            continue
+        new_stats = count_commands(new_commands)
+        if new_stats.words >= stats.words:
+            after.add(stats)
+            continue
+        after.add(new_stats)
+        changes.append((match, new_commands, vertex_arrays))
+
+    if write and changes:
+        for match, new_commands, vertex_arrays in reversed(changes):
+            body = "\n" + "".join("    {},\n".format(command) for command in new_commands)
+            source = source[:match.start(2)] + body + source[match.end(2):]
+            start = definition_start(source, source.rfind("\n", 0, match.start()) + 1)
+            definitions = "".join("static const Vtx {}[] = {{\n{}\n}};\n\n".format(
+                array_name, "\n".join(format_vertex(vertex) for vertex in vertices))
+                for array_name, vertices in vertex_arrays)
+            source = source[:start] + definitions + source[start:]
+
+        # Old vertex arrays that nothing loads anymore.
+        used = collections.Counter(IDENTIFIER_RE.findall(strip_comments(source)))
+        for match in reversed(list(VTX_RE.finditer(source))):
+            if match.group(1) in movable and used[match.group(1)] == 1:
+                start = definition_start(source, match.start())
+                end = match.end() + (source[match.end():match.end() + 1] == "\n")
+                source = source[:start] + source[end:]
+
+        with open(path, "w") as f:
+            f.write(source)
+
+    return before, after
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Repacks the vertex loads of model display lists.")
+    parser.add_argument("-c", "--cache", type=int, default=32, help="vertex cache size of the microcode")
+    parser.add_argument("--reorder", action="store_true", help="reorder triangles, only for opaque layers")
+    parser.add_argument("-w", "--write", action="store_true", help="rewrite the files")
+    parser.add_argument("paths", nargs="+", help="model .inc.c files or directories of them")
+    args = parser.parse_args()
+
+    tools_dir = os.path.dirname(os.path.abspath(__file__))
+    repo_dir = os.path.dirname(tools_dir)
+    roots = [os.path.join(repo_dir, directory) for directory in ("actors", "levels", "src", "bin", "include")]
+    repo_counts = count_identifiers(source_files(roots))
+
+    paths = [path for path in source_files(args.paths) if path.endswith(".inc.c")]
+    total_before, total_after = Stats(), Stats()
+    print("{:<56} {:>15} {:>13} {:>17} {:>11}".format("", "commands", "vtx loads", "vertices", "tex loads"))
+    for path in paths:
+        with open(path, errors="replace") as f:
+            if "gsSPVertex" not in f.read():
+                continue
+        before, after = optimize_file(path, repo_counts, args.cache, args.reorder, args.write)
+        total_before.add(before)
+        total_after.add(after)
+        print("{:<56} {:>7} {:>7} {:>6} {:>6} {:>8} {:>8} {:>5} {:>5}".format(
+            os.path.relpath(path), before.words, after.words, before.vertex_loads, after.vertex_loads,
+            before.vertices, after.vertices, before.texture_loads, after.texture_loads))
+
+    print("{:<56} {:>7} {:>7} {:>6} {:>6} {:>8} {:>8} {:>5} {:>5}".format(
+        "total", total_before.words, total_after.words, total_before.vertex_loads, total_after.vertex_loads,
+        total_before.vertices, total_after.vertices, total_before.texture_loads, total_after.texture_loads))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,6 @@
+// Forced in ahead of every file flat_geo_check is built from.
+#include "config.h"
+
+#ifndef FLAT_GEO_LAYOUTS
+#define FLAT_GEO_LAYOUTS
+#endif
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#include "sm64.h"
+#include "types.h"
+#include "engine/graph_node.h"
+#include "engine/math_util.h"
+#include "game/game_init.h"
+#include "game/memory.h"
+#include "game/rendering_graph_node.h"
+
+#include "host_graph.h"
+
+/**
+ * Checks FLAT_GEO_LAYOUTS against processing the scene graph recursively.
+ *
+ * Random trees of transform, display list, generated list, switch, render range and other nodes
+ * are flattened the way level scripts flatten geo layouts, then drawn through geo_process_root for
+ * a few frames. Between frames, nodes are switched on and off, switch cases change and nodes are
+ * set to process their children first, the way geo functions change them after the layout was
+ * flattened. Each frame is drawn again with the flat lists cleared, and both have to append the
+ * same display lists with the same matrices to the master list, in the same order.
+ */
+
+#define NUM_TREES         3000
+#define FRAMES_PER_TREE   4
+#define MAX_TREE_NODES    8192
+#define MAX_TREE_DEPTH    9
+#define MAX_LIST_ENTRIES  0x4000
+#define TREE_POOL_SIZE    0x200000
+
+struct ListEntry {
+    void *displayList;
+    s32 layer; // ucode * LAYER_COUNT + layer
+    u32 transform[sizeof(Mtx) / sizeof(u32)];
+};
+
+extern s16 gMatStackIndex;
+
+static u8 sTreePool[TREE_POOL_SIZE] ALIGNED16;
+static Gfx sDisplayLists[4096];
+static s32 sNumDisplayLists;
+static struct GraphNode *sTreeNodes[MAX_TREE_NODES];
+static s32 sNumTreeNodes;
+static struct ListEntry sEntriesA[MAX_LIST_ENTRIES];
+static struct ListEntry sEntriesB[MAX_LIST_ENTRIES];
+
+// Returns a list of its own for each node, only its address is compared.
+static Gfx *generate_list(s32 callContext, struct GraphNode *node, UNUSED void *context) {
+    return (callContext == GEO_CONTEXT_RENDER ? (Gfx *) node : NULL);
+}
+
+static void *random_display_list(void) {
+    return ((host_random() % 3) != 0 ? &sDisplayLists[sNumDisplayLists++ % ARRAY_COUNT(sDisplayLists)] : NULL);
+}
+
+static void random_vec(Vec3s vec) {
+    vec[0] = (s16) (host_random() % 2000) - 1000;
+    vec[1] = (s16) host_random();
+    vec[2] = (s16) (host_random() % 2000) - 1000;
+}
+
+static struct GraphNode *make_node(struct AllocOnlyPool *pool, s32 depth) {
+    struct GraphNode *node;
+    Vec3s translation, rotation;
+    s32 layer = host_random() % LAYER_COUNT;
+    s32 type = host_random() % (depth > 6 ? 8 : 14);
+    s32 numChildren, i;
+
+    random_vec(translation);
+    random_vec(rotation);
+
+    switch (type) {
+        case 0:
+            node = &init_graph_node_translation(pool, NULL, layer, random_display_list(), translation)->node;
+            break;
+        case 1:
+            node = &init_graph_node_rotation(pool, NULL, layer, random_display_list(), rotation)->node;
+            break;
+        case 2:
+            node = &init_graph_node_scale(pool, NULL, layer, random_display_list(), 0.5f + (host_random() % 100) / 50.0f)->node;
+            break;
+        case 3:
+            node = &init_graph_node_translation_rotation(pool, NULL, layer, random_display_list(), translation, rotation)->node;
+            break;
+        case 4:
+            node = &init_graph_node_animated_part(pool, NULL, layer, random_display_list(), translation)->node;
+            break;
+        case 5:
+            node = &init_graph_node_bone(pool, NULL, layer, random_display_list(), translation, rotation)->node;
+            break;
+        case 6:
+            node = &init_graph_node_display_list(pool, NULL, layer, &sDisplayLists[sNumDisplayLists++ % ARRAY_COUNT(sDisplayLists)])->node;
+            break;
+        case 7:
+            node = &init_graph_node_generated(pool, NULL, generate_list, 0)->fnNode.node;
+            SET_GRAPH_NODE_LAYER(node->flags, layer);
+            break;
+        case 8:
+            node = &init_graph_node_shadow(pool, NULL, 100, 0xFF, 0)->node;
+            break;
+        case 9:
+            node = &init_graph_node_start(pool, NULL)->node;
+            break;
+        case 10:
+            node = &init_graph_node_culling_radius(pool, NULL, 300)->node;
+            break;
+        case 11:
+            node = &init_graph_node_render_range(pool, NULL, -2000 + (host_random() % 2000), host_random() % 3000)->node;
+            break;
+        case 12:
+            node = &init_graph_node_switch_case(pool, NULL, 3, 0, NULL, 0)->fnNode.node;
+            break;
+        default:
+            node = &init_graph_node_translation(pool, NULL, layer, NULL, translation)->node;
+            break;
+    }
+
+    if (sNumTreeNodes < MAX_TREE_NODES) {
+        sTreeNodes[sNumTreeNodes++] = node;
+    }
+
+    if (depth < MAX_TREE_DEPTH) {
+        numChildren = (type == 12 ? 1 + host_random() % 3 : host_random() % (depth < 3 ? 4 : 3));
+        for (i = 0; i < numChildren; i++) {
+            geo_add_child(node, make_node(pool, depth + 1));
+        }
+    }
+
+    return node;
+}
+
+/**
+ * Changes the tree the way geo functions and objects do between frames.
+ */
+static void change_tree(void) {
+    s32 i;
+
+    for (i = 0; i < sNumTreeNodes; i++) {
+        struct GraphNode *node = sTreeNodes[i];
+
+        node->flags |= GRAPH_RENDER_ACTIVE;
+        node->flags &= ~GRAPH_RENDER_CHILDREN_FIRST;
+        if ((host_random() % 12) == 0) {
+            node->flags &= ~GRAPH_RENDER_ACTIVE;
+        }
+        if ((host_random() % 20) == 0) {
+            node->flags |= GRAPH_RENDER_CHILDREN_FIRST;
+        }
+        if (node->type == GRAPH_NODE_TYPE_SWITCH_CASE) {
+            ((struct GraphNodeSwitchCase *) node)->selectedCase = host_random() % 3;
+        }
+    }
+}
+
+/**
+ * Draws the tree and copies what the master list ended up with into entries. Returns the number
+ * of entries, or -1 if the matrix stack wasn't left where it started.
+ */
+static s32 draw_tree(struct GraphNodeRoot *root, struct GraphNodeMasterList *masterList, struct ListEntry *entries) {
+    struct DisplayListNode *list;
+    s32 numEntries = 0;
+    s32 ucode, layer;
+
+    host_reset_gfx_pool();
+    geo_process_root(root, NULL, NULL, 0);
+    if (gMatStackIndex != 0) {
+        return -1;
+    }
+
+    for (ucode = 0; ucode < GRAPH_NODE_NUM_UCODES; ucode++) {
+        for (layer = LAYER_FIRST; layer < LAYER_COUNT; layer++) {
+            for (list = masterList->listHeads[ucode][layer]; list != NULL; list = list->next) {
+                struct ListEntry *entry = &entries[numEntries++];
+
+                if (numEntries > MAX_LIST_ENTRIES) {
+                    fprintf(stderr, "too many display lists\n");
+                    exit(EXIT_FAILURE);
+                }
+                memset(entry, 0, sizeof(*entry));
+                entry->displayList = list->displayList;
+                entry->layer = ucode * LAYER_COUNT + layer;
+                memcpy(entry->transform, list->transform, sizeof(entry->transform));
+            }
+        }
+    }
+
+    return numEntries;
+}
+
+int main(void) {
+    struct AllocOnlyPool pool;
+    s32 numFailed = 0;
+    s32 numFrames = 0;
+    s32 numEntries = 0;
+    s32 i, frame;
+
+    for (i = 0; i < NUM_TREES; i++) {
+        struct GraphNodeRoot *root;
+        struct GraphNodeMasterList *masterList;
+        struct GraphNodeTranslation *camera;
+        Vec3s cameraPos = { 0, 0, 0 };
+
+        host_pool_init(&pool, sTreePool, sizeof(sTreePool));
+        sNumTreeNodes = 0;
+
+        root = init_graph_node_root(&pool, NULL, 0, 160, 120, 160, 120);
+        masterList = init_graph_node_master_list(&pool, NULL, TRUE);
+        camera = init_graph_node_translation(&pool, NULL, LAYER_OPAQUE, NULL, cameraPos);
+        geo_add_child(&root->node, &masterList->node);
+        geo_add_child(&masterList->node, &camera->node);
+        geo_add_child(&camera->node, make_node(&pool, 0));
+
+        geo_clear_flat_layouts();
+        geo_flatten_layout(&pool, &root->node);
+
+        for (frame = 0; frame < FRAMES_PER_TREE; frame++) {
+            s32 numEntriesA, numEntriesB;
+
+            change_tree();
+            // How far away the tree is, for render range nodes.
+            camera->translation[2] = -(s16) (host_random() % 3000);
+
+            numEntriesA = draw_tree(root, masterList, sEntriesA);
+            geo_clear_flat_layouts();
+            numEntriesB = draw_tree(root, masterList, sEntriesB);
+            geo_flatten_layout(&pool, &root->node);
+
+            if (numEntriesA < 0) {
+                printf("tree %d, frame %d: the matrix stack wasn't restored\n", i, frame);
+                numFailed++;
+            } else if (numEntriesA != numEntriesB
+                       || memcmp(sEntriesA, sEntriesB, numEntriesA * sizeof(struct ListEntry)) != 0) {
+                printf("tree %d, frame %d: %d display lists flat, %d recursively\n", i, frame, numEntriesA, numEntriesB);
+                numFailed++;
+            }
+            numEntries += numEntriesB;
+            numFrames++;
+        }
+    }
+
+    printf("%d frames, %d display lists: %d failed\n", numFrames, numEntries, numFailed);
+    return (numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
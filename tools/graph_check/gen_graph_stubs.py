@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""
+Writes graph_stubs.c for the graph_check programs.
+
+Every symbol the engine objects use that no object defines gets an empty function. These are the
+parts of the game the renderer calls that the checks never reach, like shadows, the camera and the
+debug displays. Anything a check does reach has a real host version in host_stubs.c instead, and
+anything the C library has, like sqrtf, is left to it.
+
+Usage: gen_graph_stubs.py <output> <engine objects...> -- <host objects...>
+"""
+
+import subprocess
+import sys
+
+
+def read_symbols(path):
+    defined = set()
+    undefined = set()
+    out = subprocess.run(["nm", path], check=True, capture_output=True, text=True).stdout
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 2 and parts[0] == "U":
+            undefined.add(parts[1])
+        elif len(parts) == 3:
+            defined.add(parts[2])
+    return defined, undefined
+
+
+def read_libc_symbols():
+    symbols = set()
+    for lib in ["libc.so.6", "libm.so.6"]:
+        path = subprocess.run(["gcc", "-print-file-name=" + lib], check=True, capture_output=True, text=True).stdout.strip()
+        out = subprocess.run(["nm", "-D", "--defined-only", path], check=True, capture_output=True, text=True).stdout
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) == 3:
+                symbols.add(parts[2].split("@")[0])
+    return symbols
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__.strip())
+
+    output = sys.argv[1]
+    engine_objects = sys.argv[2:]
+    host_objects = []
+    if "--" in engine_objects:
+        split = engine_objects.index("--")
+        engine_objects, host_objects = engine_objects[:split], engine_objects[split + 1:]
+
+    defined = set()
+    undefined = set()
+    for path in engine_objects + host_objects:
+        d, u = read_symbols(path)
+        defined |= d
+        if path in engine_objects:
+            undefined |= u
+
+    stubs = sorted(name for name in undefined - defined - read_libc_symbols() if not name.startswith("_"))
+
+    with open(output, "w") as f:
+        f.write("// Generated by gen_graph_stubs.py, do not edit.\n\n")
+        for name in stubs:
+            f.write(f"void {name}(void) {{}}\n")
+
+
+if __name__ == "__main__":
+    main()
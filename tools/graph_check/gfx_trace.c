@@ -0,0 +1,308 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#include "sm64.h"
+
+#include "host_graph.h"
+
+/**
+ * Follows an F3DEX2 display list the way the RSP would, without drawing anything. Every triangle
+ * is reduced to a hash of what would end up on screen: the vertices as they were loaded, the
+ * modelview matrix at the time they were loaded and all the state set so far. State commands are
+ * keyed by what they set (the opcode, and the tile, word or memory index where there is one), so
+ * setting the same thing twice, or in a different order, gives the same hash.
+ */
+
+#define GFX_TRACE_MAX_DEPTH    18
+#define GFX_TRACE_MAX_COMMANDS 0x100000
+#define GFX_TRACE_MAX_MATRICES 10
+#define GFX_TRACE_NUM_VERTICES 32
+
+struct GfxVertex {
+    Vtx vtx;
+    u32 matrixHash; // Hash of the modelview matrix the vertex was loaded with
+};
+
+struct GfxTraceState {
+    u32 stateValues[0x10000]; // Hash of the last command of each key, 0 if never set
+    u32 stateHash;            // The above, all xor'd together
+    u32 geometryMode;
+    u32 otherModeH;
+    u32 otherModeL;
+    f32 modelview[GFX_TRACE_MAX_MATRICES][4][4];
+    s32 modelviewIndex;
+    u32 modelviewHash;
+    struct GfxVertex vertices[GFX_TRACE_NUM_VERTICES];
+    u32 pass;
+    u32 order;
+};
+
+static struct GfxTraceState sTraceState;
+
+static u32 hash_word(u32 hash, u32 word) {
+    hash = (hash ^ word) * 0x9E3779B1;
+    return hash ^ (hash >> 15);
+}
+
+static u32 hash_words(u32 hash, const void *data, s32 size) {
+    const u32 *words = data;
+    s32 i;
+
+    for (i = 0; i < size / 4; i++) {
+        hash = hash_word(hash, words[i]);
+    }
+    return hash;
+}
+
+static void set_state(struct GfxTraceState *state, u32 key, u32 w0, uintptr_t w1) {
+    u32 value = hash_word(hash_word(hash_word(0x811C9DC5, key), w0), (u32) w1);
+
+    state->stateHash ^= state->stateValues[key & 0xFFFF] ^ value;
+    state->stateValues[key & 0xFFFF] = value;
+}
+
+static void fixed_to_float_matrix(f32 dest[4][4], const Mtx *mtx) {
+    const s32 *words = (const s32 *) mtx->m;
+    s32 i;
+
+    for (i = 0; i < 16; i++) {
+        u32 intPart = words[i / 2];
+        u32 fracPart = words[8 + i / 2];
+
+        if ((i & 1) == 0) {
+            intPart >>= 16;
+            fracPart >>= 16;
+        }
+        dest[i / 4][i % 4] = (s32) (((intPart & 0xFFFF) << 16) | (fracPart & 0xFFFF)) / 65536.0f;
+    }
+}
+
+static void load_matrix(struct GfxTraceState *state, const Mtx *mtx, u32 params) {
+    f32 matrix[4][4];
+    f32 (*top)[4];
+    s32 i, j, k;
+
+    fixed_to_float_matrix(matrix, mtx);
+
+    if (params & G_MTX_PROJECTION) {
+        set_state(state, G_MTX << 8, 0, hash_words(0, matrix, sizeof(matrix)));
+        return;
+    }
+
+    // gSPMatrix xors G_MTX_PUSH, so the bit is set for matrices that don't push.
+    if (!(params & G_MTX_PUSH) && state->modelviewIndex < GFX_TRACE_MAX_MATRICES - 1) {
+        memcpy(state->modelview[state->modelviewIndex + 1], state->modelview[state->modelviewIndex], sizeof(matrix));
+        state->modelviewIndex++;
+    }
+
+    top = state->modelview[state->modelviewIndex];
+    if (params & G_MTX_LOAD) {
+        memcpy(top, matrix, sizeof(matrix));
+    } else {
+        f32 product[4][4];
+
+        for (i = 0; i < 4; i++) {
+            for (j = 0; j < 4; j++) {
+                product[i][j] = 0.0f;
+                for (k = 0; k < 4; k++) {
+                    product[i][j] += matrix[i][k] * top[k][j];
+                }
+            }
+        }
+        memcpy(top, product, sizeof(product));
+    }
+    state->modelviewHash = hash_words(0, top, sizeof(matrix));
+}
+
+static void add_triangle(struct GfxTraceState *state, struct GfxTrace *trace, s32 v0, s32 v1, s32 v2) {
+    struct GfxTriangle *triangle;
+    s32 vertices[3] = { v0, v1, v2 };
+    u32 renderMode = (state->otherModeL >> G_MDSFT_RENDERMODE) << G_MDSFT_RENDERMODE;
+    u32 zMode = (renderMode & ZMODE_DEC);
+    u32 hash = hash_word(state->stateHash, state->geometryMode);
+    s32 i;
+
+    if (trace->numTriangles >= trace->maxTriangles) {
+        trace->error = "too many triangles";
+        return;
+    }
+
+    hash = hash_word(hash_word(hash, state->otherModeH), state->otherModeL);
+    for (i = 0; i < 3; i++) {
+        struct GfxVertex *vertex = &state->vertices[vertices[i] % GFX_TRACE_NUM_VERTICES];
+
+        hash = hash_word(hash_words(hash, &vertex->vtx, sizeof(Vtx)), vertex->matrixHash);
+    }
+
+    triangle = &trace->triangles[trace->numTriangles++];
+    triangle->pass = state->pass;
+    triangle->hash = hash;
+    if ((state->geometryMode & G_ZBUFFER) && (renderMode & (Z_CMP | Z_UPD)) == (Z_CMP | Z_UPD)
+        && (zMode == ZMODE_OPA || zMode == ZMODE_INTER)) {
+        triangle->order = 0;
+    } else {
+        triangle->order = ++state->order;
+    }
+}
+
+static void set_other_mode(u32 *mode, u32 w0, u32 w1) {
+    u32 len = (w0 & 0xFF) + 1;
+    u32 shift = 32 - len - ((w0 >> 8) & 0xFF);
+    u32 mask = (len == 32 ? 0xFFFFFFFF : (((1U << len) - 1) << shift));
+
+    *mode = (*mode & ~mask) | (w1 & mask);
+}
+
+void gfx_trace(const Gfx *dl, struct GfxTrace *trace) {
+    struct GfxTraceState *state = &sTraceState;
+    const Gfx *stack[GFX_TRACE_MAX_DEPTH];
+    s32 depth = 0;
+
+    memset(state, 0, sizeof(*state));
+    trace->numTriangles = 0;
+    trace->numCommands = 0;
+    trace->numMatrices = 0;
+    trace->error = NULL;
+
+    while (trace->error == NULL) {
+        u32 w0 = dl->words.w0;
+        uintptr_t w1 = dl->words.w1;
+        u8 cmd = (w0 >> 24);
+
+        if (trace->numCommands++ >= GFX_TRACE_MAX_COMMANDS) {
+            trace->error = "too many commands";
+            break;
+        }
+        dl++;
+
+        switch (cmd) {
+            case (u8) G_VTX: {
+                s32 numVertices = ((w0 >> 12) & 0xFF);
+                s32 first = (((w0 >> 1) & 0x7F) - numVertices);
+                const Vtx *vtx = (const Vtx *) w1;
+                s32 i;
+
+                if (first < 0 || first + numVertices > GFX_TRACE_NUM_VERTICES) {
+                    trace->error = "vertex index out of range";
+                    break;
+                }
+                for (i = 0; i < numVertices; i++) {
+                    state->vertices[first + i].vtx = vtx[i];
+                    state->vertices[first + i].matrixHash = state->modelviewHash;
+                }
+                break;
+            }
+            case (u8) G_TRI1:
+                add_triangle(state, trace, ((w0 >> 16) & 0xFF) / 2, ((w0 >> 8) & 0xFF) / 2, (w0 & 0xFF) / 2);
+                break;
+            case (u8) G_TRI2:
+            case (u8) G_QUAD:
+                add_triangle(state, trace, ((w0 >> 16) & 0xFF) / 2, ((w0 >> 8) & 0xFF) / 2, (w0 & 0xFF) / 2);
+                add_triangle(state, trace, ((w1 >> 16) & 0xFF) / 2, ((w1 >> 8) & 0xFF) / 2, (w1 & 0xFF) / 2);
+                break;
+            case (u8) G_MTX:
+                trace->numMatrices++;
+                load_matrix(state, (const Mtx *) w1, (w0 & 0xFF));
+                break;
+            case (u8) G_POPMTX:
+                state->modelviewIndex = MAX(state->modelviewIndex - (s32) (w1 / sizeof(Mtx)), 0);
+                state->modelviewHash = hash_words(0, state->modelview[state->modelviewIndex], sizeof(state->modelview[0]));
+                break;
+            case (u8) G_GEOMETRYMODE:
+                state->geometryMode = ((state->geometryMode & (0xFF000000 | (w0 & 0xFFFFFF))) | w1);
+                break;
+            case (u8) G_SETOTHERMODE_H:
+                set_other_mode(&state->otherModeH, w0, w1);
+                break;
+            case (u8) G_SETOTHERMODE_L:
+                set_other_mode(&state->otherModeL, w0, w1);
+                // The master list sets the render mode of each layer it draws.
+                if (depth == 0 && ((32 - ((w0 & 0xFF) + 1) - ((w0 >> 8) & 0xFF)) == G_MDSFT_RENDERMODE)) {
+                    state->pass++;
+                    state->order = 0;
+                }
+                break;
+            case (u8) G_DL:
+                if (((w0 >> 16) & 0xFF) != G_DL_NOPUSH) {
+                    if (depth >= GFX_TRACE_MAX_DEPTH) {
+                        trace->error = "display list stack overflow";
+                        break;
+                    }
+                    stack[depth++] = dl;
+                }
+                dl = (const Gfx *) w1;
+                break;
+            case (u8) G_ENDDL:
+                if (depth == 0) {
+                    return;
+                }
+                dl = stack[--depth];
+                break;
+            case (u8) G_BRANCH_Z:
+                // Which branch is taken depends on where the vertex is on screen.
+                trace->error = "G_BRANCH_Z isn't supported";
+                break;
+            case (u8) G_CULLDL:
+            case (u8) G_NOOP:
+            case (u8) G_SPNOOP:
+            case (u8) G_RDPPIPESYNC:
+            case (u8) G_RDPTILESYNC:
+            case (u8) G_RDPLOADSYNC:
+            case (u8) G_RDPFULLSYNC:
+                break;
+            case (u8) G_SETTILE:
+            case (u8) G_SETTILESIZE:
+            case (u8) G_LOADBLOCK:
+            case (u8) G_LOADTILE:
+            case (u8) G_LOADTLUT:
+                set_state(state, (cmd << 8) | ((w1 >> 24) & 0x7), w0, w1);
+                break;
+            case (u8) G_MOVEWORD:
+                set_state(state, (cmd << 8) | ((w0 >> 16) & 0xFF), w0, w1 + ((w0 & 0xFFFF) << 16));
+                break;
+            case (u8) G_MOVEMEM:
+                set_state(state, (cmd << 8) | (w0 & 0xFF), w0, w1);
+                break;
+            default:
+                set_state(state, (cmd << 8), w0, w1);
+                break;
+        }
+    }
+}
+
+static int compare_triangles(const void *a, const void *b) {
+    const struct GfxTriangle *triangleA = a;
+    const struct GfxTriangle *triangleB = b;
+
+    if (triangleA->pass != triangleB->pass) {
+        return (triangleA->pass < triangleB->pass ? -1 : 1);
+    }
+    if (triangleA->order != triangleB->order) {
+        return (triangleA->order < triangleB->order ? -1 : 1);
+    }
+    if (triangleA->hash != triangleB->hash) {
+        return (triangleA->hash < triangleB->hash ? -1 : 1);
+    }
+    return 0;
+}
+
+void gfx_trace_sort(struct GfxTrace *trace) {
+    qsort(trace->triangles, trace->numTriangles, sizeof(struct GfxTriangle), compare_triangles);
+}
+
+s32 gfx_trace_compare(const struct GfxTrace *a, const struct GfxTrace *b) {
+    s32 i;
+
+    for (i = 0; i < MIN(a->numTriangles, b->numTriangles); i++) {
+        if (compare_triangles(&a->triangles[i], &b->triangles[i]) != 0) {
+            return i;
+        }
+    }
+    if (a->numTriangles != b->numTriangles) {
+        return i;
+    }
+    return -1;
+}
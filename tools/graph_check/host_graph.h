@@ -0,0 +1,49 @@
+#ifndef HOST_GRAPH_H
+#define HOST_GRAPH_H
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#include "types.h"
+
+struct AllocOnlyPool;
+
+/**
+ * A triangle the RSP would draw, reduced to what it looks like: its vertices, the matrix they are
+ * transformed by and all the state it is drawn with. Triangles that end up the same on screen
+ * have the same hash, no matter the display lists that drew them.
+ */
+struct GfxTriangle {
+    u32 pass;  // How many times the master list had set a render mode before this triangle
+    u32 order; // 0 for opaque triangles drawn with the z-buffer, otherwise how many others came before it in the pass
+    u32 hash;
+};
+
+struct GfxTrace {
+    struct GfxTriangle *triangles;
+    s32 numTriangles;
+    s32 maxTriangles;
+    s32 numCommands;
+    s32 numMatrices; // G_MTX commands run, at any depth
+    const char *error; // Set if the display list couldn't be followed
+};
+
+// host_stubs.c
+
+// Makes pool allocate from buf, the same way the game's alloc-only pools do.
+void host_pool_init(struct AllocOnlyPool *pool, void *buf, s32 size);
+// Resets gDisplayListHead and the display list pool alloc_display_list takes from.
+void host_reset_gfx_pool(void);
+u32 host_random(void);
+
+// gfx_trace.c
+
+// Runs a display list the way the RSP would and records every triangle it draws into trace.
+void gfx_trace(const Gfx *dl, struct GfxTrace *trace);
+// Sorts the triangles of a trace so that two traces can be compared with gfx_trace_compare. Only
+// the order of opaque triangles drawn with the z-buffer doesn't matter, the rest keep theirs.
+void gfx_trace_sort(struct GfxTrace *trace);
+// Returns the index of the first triangle that differs between two sorted traces, -1 if they match.
+s32 gfx_trace_compare(const struct GfxTrace *a, const struct GfxTrace *b);
+
+#endif // HOST_GRAPH_H
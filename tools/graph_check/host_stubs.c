@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "engine/geo_layout.h"
+#include "engine/graph_node.h"
+#include "engine/surface_load.h"
+#include "game/area.h"
+#include "game/game_init.h"
+#include "game/main.h"
+#include "game/memory.h"
+#include "game/object_list_processor.h"
+#include "game/shadow.h"
+
+#include "host_graph.h"
+
+/**
+ * Host replacements for the parts of the game the renderer links against. Everything the
+ * renderer allocates comes from static arenas: VIRTUAL_TO_PHYSICAL only keeps the low 29 bits of
+ * an address, so pointers the display lists hold have to be in the low part of the address space,
+ * which is where a -no-pie executable has its data. Segments are never set, so segmented
+ * addresses are already host addresses.
+ */
+
+#define HOST_GFX_POOL_SIZE  0x80000 // Gfx commands
+#define HOST_MAIN_POOL_SIZE 0x100000
+
+#define ALIGN4(val) (((val) + 0x3) & ~0x3)
+#define ALIGN8(val) (((val) + 0x7) & ~0x7)
+
+u8 gBorderHeight = 0;
+struct Config gConfig;
+s16 gCurrLevelNum = 0;
+struct Shadow gCurrShadow;
+Gfx *gDisplayListHead;
+u8 *gGfxPoolEnd;
+u8 gIsConsole = TRUE;
+s16 gMarioCurrentRoom = 0;
+struct GraphNode gObjParentGraphNode;
+SpatialPartitionCell gStaticSurfacePartition[NUM_CELLS][NUM_CELLS];
+SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
+
+static Gfx sHostGfxPool[HOST_GFX_POOL_SIZE];
+static u8 sHostMainPool[HOST_MAIN_POOL_SIZE] ALIGNED16;
+static struct AllocOnlyPool sHostMainAllocOnlyPool;
+static u32 sHostRandomState = 0x12345678;
+
+void host_pool_init(struct AllocOnlyPool *pool, void *buf, s32 size) {
+    pool->totalSpace = size;
+    pool->usedSpace = 0;
+    pool->startPtr = buf;
+    pool->freePtr = buf;
+}
+
+void host_reset_gfx_pool(void) {
+    gDisplayListHead = sHostGfxPool;
+    gGfxPoolEnd = (u8 *) &sHostGfxPool[HOST_GFX_POOL_SIZE];
+}
+
+/**
+ * xorshift32, so the checks build the same scenes on every host.
+ */
+u32 host_random(void) {
+    sHostRandomState ^= sHostRandomState << 13;
+    sHostRandomState ^= sHostRandomState >> 17;
+    sHostRandomState ^= sHostRandomState << 5;
+    return sHostRandomState;
+}
+
+void *get_segment_base_addr(UNUSED s32 segment) {
+    return (void *) 0x80000000;
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+/**
+ * The main pool only holds the display list heap of the frame being drawn, which is freed again
+ * at the end of geo_process_root.
+ */
+u32 main_pool_available(void) {
+    return sizeof(sHostMainPool);
+}
+
+u32 main_pool_free(UNUSED void *addr) {
+    return sizeof(sHostMainPool);
+}
+
+struct AllocOnlyPool *alloc_only_pool_init(u32 size, UNUSED u32 side) {
+    host_pool_init(&sHostMainAllocOnlyPool, sHostMainPool, MIN(size, sizeof(sHostMainPool)));
+    return &sHostMainAllocOnlyPool;
+}
+
+void *alloc_only_pool_alloc(struct AllocOnlyPool *pool, s32 size) {
+    void *addr = NULL;
+
+    size = ALIGN4(size);
+    if (size > 0 && pool->usedSpace + size <= pool->totalSpace) {
+        addr = pool->freePtr;
+        pool->freePtr += size;
+        pool->usedSpace += size;
+    }
+
+    return addr;
+}
+
+void *alloc_display_list(u32 size) {
+    void *ptr = NULL;
+
+    size = ALIGN8(size);
+    if (gGfxPoolEnd - size >= (u8 *) gDisplayListHead) {
+        gGfxPoolEnd -= size;
+        ptr = gGfxPoolEnd;
+    } else {
+        fprintf(stderr, "alloc_display_list: out of memory (%u bytes)\n", size);
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,7 @@
+// Forced in ahead of every file instancing_check is built from, so it checks instancing whether
+// or not the ROM has it enabled.
+#include "config.h"
+
+#ifndef DISPLAY_LIST_INSTANCING
+#define DISPLAY_LIST_INSTANCING
+#endif
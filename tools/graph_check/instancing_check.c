@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#include "sm64.h"
+#include "types.h"
+#include "engine/graph_node.h"
+#include "engine/math_util.h"
+#include "game/game_init.h"
+#include "game/memory.h"
+#include "game/rendering_graph_node.h"
+
+#include "host_graph.h"
+
+/**
+ * Checks DISPLAY_LIST_INSTANCING against drawing every display list on its own.
+ *
+ * First, every test model is split the way init_graph_node_display_list does it, and running the
+ * setup, geometry and reset parts one after another has to draw the same as the model itself.
+ *
+ * Then random scenes are drawn through geo_process_root, once as they are and once with every
+ * node's instanceLists cleared, which is the path the game takes without instancing. Models are
+ * shared between several translation nodes the way objects share them, on random layers, in
+ * master lists with and without the z-buffer. The two master lists have to draw the same
+ * triangles, in the same order except within z-buffered opaque layers.
+ *
+ * Like the game's models, every test model sets all the state it draws with, and resets what
+ * other models don't set themselves. The exception is drawn after a generated list that sets its
+ * environment color, which is different for every instance, like the boo's alpha.
+ */
+
+#define NUM_SCENES        3000
+#define MAX_SCENE_NODES   512
+#define MAX_TRIANGLES     0x4000
+#define NODE_POOL_SIZE    0x40000
+
+struct TestModel {
+    const char *name;
+    Gfx *displayList;
+    s32 canBeInstanced;
+    s32 inScenes; // Models that don't set their own state would draw differently when moved.
+};
+
+static Vtx sQuadVertices[] = {
+    { { { -50, 0, -50 }, 0, {    0,    0 }, { 0xFF, 0x00, 0x00, 0xFF } } },
+    { { {  50, 0, -50 }, 0, { 1024,    0 }, { 0x00, 0xFF, 0x00, 0xFF } } },
+    { { {  50, 0,  50 }, 0, { 1024, 1024 }, { 0x00, 0x00, 0xFF, 0xFF } } },
+    { { { -50, 0,  50 }, 0, {    0, 1024 }, { 0xFF, 0xFF, 0xFF, 0xFF } } },
+};
+
+static Vtx sBoxVertices[] = {
+    { { { -20, -20, -20 }, 0, { 0, 0 }, { 0x00, 0x7F, 0x00, 0xFF } } },
+    { { {  20, -20, -20 }, 0, { 0, 0 }, { 0x00, 0x7F, 0x00, 0xFF } } },
+    { { {  20,  20, -20 }, 0, { 0, 0 }, { 0x00, 0x7F, 0x00, 0xFF } } },
+    { { { -20,  20, -20 }, 0, { 0, 0 }, { 0x00, 0x7F, 0x00, 0xFF } } },
+    { { { -20, -20,  20 }, 0, { 0, 0 }, { 0x7F, 0x00, 0x00, 0xFF } } },
+    { { {  20, -20,  20 }, 0, { 0, 0 }, { 0x7F, 0x00, 0x00, 0xFF } } },
+    { { {  20,  20,  20 }, 0, { 0, 0 }, { 0x7F, 0x00, 0x00, 0xFF } } },
+    { { { -20,  20,  20 }, 0, { 0, 0 }, { 0x7F, 0x00, 0x00, 0xFF } } },
+};
+
+static Texture sTextureA[64 * 32];
+static Texture sTextureB[64 * 32];
+
+// Scales by 2 on top of the node's matrix, set in main.
+static Mtx sScaleMatrix;
+
+static Gfx sCoinSetup[] = {
+    gsSPClearGeometryMode(G_LIGHTING),
+    gsDPSetCombineMode(G_CC_MODULATEIA, G_CC_MODULATEIA),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_ON),
+    gsSPEndDisplayList(),
+};
+
+static Gfx sCoinEnd[] = {
+    gsSP2Triangles(0, 1, 2, 0x0, 0, 2, 3, 0x0),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_OFF),
+    gsSPSetGeometryMode(G_LIGHTING),
+    gsSPEndDisplayList(),
+};
+
+// Like the coin models: the material is in a display list of its own and the triangles are
+// drawn by the one it branches to, which also resets the state.
+static Gfx sCoinModel[] = {
+    gsDPPipeSync(),
+    gsDPSetTextureImage(G_IM_FMT_IA, G_IM_SIZ_8b, 64, sTextureA),
+    gsSPDisplayList(sCoinSetup),
+    gsSPVertex(sQuadVertices, 4, 0),
+    gsSPBranchList(sCoinEnd),
+};
+
+static Gfx sBoxModel[] = {
+    gsDPPipeSync(),
+    gsDPSetTextureImage(G_IM_FMT_IA, G_IM_SIZ_8b, 64, sTextureB),
+    gsDPSetCombineMode(G_CC_SHADE, G_CC_SHADE),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_OFF),
+    gsSPVertex(sBoxVertices, 8, 0),
+    gsSP2Triangles(0, 1, 2, 0x0, 0, 2, 3, 0x0),
+    gsSP2Triangles(4, 5, 6, 0x0, 4, 6, 7, 0x0),
+    gsSP2Triangles(0, 1, 5, 0x0, 0, 5, 4, 0x0),
+    gsSPEndDisplayList(),
+};
+
+static Gfx sTwoMaterialModel[] = {
+    gsDPPipeSync(),
+    gsDPSetTextureImage(G_IM_FMT_IA, G_IM_SIZ_8b, 64, sTextureA),
+    gsDPSetCombineMode(G_CC_SHADE, G_CC_SHADE),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_OFF),
+    gsSPVertex(sQuadVertices, 4, 0),
+    gsSP1Triangle(0, 1, 2, 0x0),
+    gsDPPipeSync(),
+    gsDPSetCombineMode(G_CC_MODULATEIA, G_CC_MODULATEIA),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_ON),
+    gsSPVertex(sBoxVertices, 4, 0),
+    gsSP1Triangle(0, 1, 2, 0x0),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_OFF),
+    gsSPEndDisplayList(),
+};
+
+static Gfx sMatrixModel[] = {
+    gsDPPipeSync(),
+    gsDPSetTextureImage(G_IM_FMT_IA, G_IM_SIZ_8b, 64, sTextureB),
+    gsDPSetCombineMode(G_CC_SHADE, G_CC_SHADE),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_OFF),
+    gsSPMatrix(&sScaleMatrix, G_MTX_MODELVIEW | G_MTX_MUL | G_MTX_PUSH),
+    gsSPVertex(sQuadVertices, 4, 0),
+    gsSP2Triangles(0, 1, 2, 0x0, 0, 2, 3, 0x0),
+    gsSPPopMatrix(G_MTX_MODELVIEW),
+    gsSPEndDisplayList(),
+};
+
+static Gfx sNoSetupModel[] = {
+    gsSPVertex(sQuadVertices, 4, 0),
+    gsSP2Triangles(0, 1, 2, 0x0, 0, 2, 3, 0x0),
+    gsSPEndDisplayList(),
+};
+
+// Drawn with the environment color geo_set_env_color sets, which it resets after.
+static Gfx sEnvColorModel[] = {
+    gsDPPipeSync(),
+    gsDPSetTextureImage(G_IM_FMT_IA, G_IM_SIZ_8b, 64, sTextureB),
+    gsDPSetCombineMode(G_CC_FADE, G_CC_FADE),
+    gsSPTexture(0xFFFF, 0xFFFF, 0, G_TX_RENDERTILE, G_OFF),
+    gsSPVertex(sQuadVertices, 4, 0),
+    gsSP2Triangles(0, 1, 2, 0x0, 0, 2, 3, 0x0),
+    gsDPSetEnvColor(255, 255, 255, 255),
+    gsSPEndDisplayList(),
+};
+
+static Gfx sUnloadedSegmentModel[] = {
+    gsDPPipeSync(),
+    gsSPDisplayList(0x09000000),
+    gsSPEndDisplayList(),
+};
+
+static struct TestModel sTestModels[] = {
+    { "coin",           sCoinModel,            TRUE,  TRUE  },
+    { "box",            sBoxModel,             TRUE,  TRUE  },
+    { "two materials",  sTwoMaterialModel,     FALSE, TRUE  },
+    { "matrix",         sMatrixModel,          FALSE, TRUE  },
+    { "no setup",       sNoSetupModel,         FALSE, FALSE },
+    { "env color",      sEnvColorModel,        TRUE,  FALSE },
+    { "unloaded",       sUnloadedSegmentModel, FALSE, FALSE },
+};
+
+static u8 sNodePool[NODE_POOL_SIZE] ALIGNED16;
+static struct GraphNodeDisplayList *sSceneDisplayLists[MAX_SCENE_NODES];
+static Gfx *sSceneInstanceLists[MAX_SCENE_NODES];
+static s32 sNumSceneDisplayLists;
+static struct GfxTriangle sTrianglesA[MAX_TRIANGLES];
+static struct GfxTriangle sTrianglesB[MAX_TRIANGLES];
+static Gfx sPartsDisplayList[4];
+static u32 sNumEnvColors;
+
+static s32 check_split(struct AllocOnlyPool *pool, struct TestModel *model) {
+    struct GraphNodeDisplayList *node = init_graph_node_display_list(pool, NULL, LAYER_OPAQUE, model->displayList);
+    struct GfxTrace traceA = { sTrianglesA, 0, MAX_TRIANGLES, 0, 0, NULL };
+    struct GfxTrace traceB = { sTrianglesB, 0, MAX_TRIANGLES, 0, 0, NULL };
+    Gfx *lists = node->instanceLists;
+
+    if ((lists != NULL) != model->canBeInstanced) {
+        printf("%s: %s\n", model->name, (lists != NULL ? "split, but shouldn't be" : "not split"));
+        return FALSE;
+    }
+    if (lists == NULL) {
+        return TRUE;
+    }
+    if ((uintptr_t) lists & 7) {
+        printf("%s: parts aren't 8 byte aligned\n", model->name);
+        return FALSE;
+    }
+
+    gSPDisplayList(&sPartsDisplayList[0], lists);
+    gSPDisplayList(&sPartsDisplayList[1], &lists[node->instanceBodyOffset]);
+    gSPDisplayList(&sPartsDisplayList[2], &lists[node->instanceTailOffset]);
+    gSPEndDisplayList(&sPartsDisplayList[3]);
+
+    gfx_trace(model->displayList, &traceA);
+    gfx_trace(sPartsDisplayList, &traceB);
+    if (traceA.error != NULL || traceB.error != NULL || traceA.numTriangles == 0 || gfx_trace_compare(&traceA, &traceB) >= 0) {
+        printf("%s: parts don't draw the same as the model\n", model->name);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static s16 random_angle(void) {
+    return ((host_random() & 3) == 0 ? 0 : (s16) host_random());
+}
+
+static struct GraphNode *add_transform_node(struct AllocOnlyPool *pool, struct GraphNode *parent) {
+    Vec3s translation = { 0, 0, 0 };
+    Vec3s rotation = { 0, 0, 0 };
+    struct GraphNodeTranslationRotation *node;
+
+    // Some instances are drawn with the same matrix as their parent.
+    if ((host_random() % 4) != 0) {
+        translation[0] = (s16) (host_random() % 4000) - 2000;
+        translation[1] = (s16) (host_random() % 4000) - 2000;
+        translation[2] = (s16) (host_random() % 4000) - 2000;
+        rotation[0] = random_angle();
+        rotation[1] = random_angle();
+        rotation[2] = random_angle();
+    }
+
+    node = init_graph_node_translation_rotation(pool, NULL, LAYER_OPAQUE, NULL, translation, rotation);
+    return geo_add_child(parent, &node->node);
+}
+
+static struct GraphNodeDisplayList *add_display_list_node(struct AllocOnlyPool *pool, struct GraphNode *parent,
+                                                          s32 layer, Gfx *displayList) {
+    struct GraphNodeDisplayList *node = init_graph_node_display_list(pool, NULL, layer, displayList);
+
+    geo_add_child(parent, &node->node);
+    sSceneInstanceLists[sNumSceneDisplayLists] = node->instanceLists;
+    sSceneDisplayLists[sNumSceneDisplayLists++] = node;
+    return node;
+}
+
+static struct GraphNodeDisplayList *add_test_model_node(struct AllocOnlyPool *pool, struct GraphNode *parent) {
+    struct TestModel *model;
+
+    do {
+        model = &sTestModels[host_random() % ARRAY_COUNT(sTestModels)];
+    } while (!model->inScenes);
+
+    return add_display_list_node(pool, parent, host_random() % LAYER_COUNT, model->displayList);
+}
+
+/**
+ * Sets a different environment color every time it's drawn, the way geo_update_layer_transparency
+ * sets the alpha of each boo.
+ */
+static Gfx *geo_set_env_color(s32 callContext, UNUSED struct GraphNode *node, UNUSED void *context) {
+    Gfx *dl;
+
+    if (callContext != GEO_CONTEXT_RENDER) {
+        return NULL;
+    }
+
+    dl = alloc_display_list(2 * sizeof(Gfx));
+    gDPSetEnvColor(&dl[0], 255, 255, 255, sNumEnvColors++ & 0xFF);
+    gSPEndDisplayList(&dl[1]);
+    return dl;
+}
+
+/**
+ * Adds a generated list that sets the environment color, then a display list node on the same layer
+ * that draws with it.
+ */
+static void add_env_color_nodes(struct AllocOnlyPool *pool, struct GraphNode *parent) {
+    struct GraphNodeGenerated *generated = init_graph_node_generated(pool, NULL, geo_set_env_color, 0);
+    s32 layer = host_random() % LAYER_COUNT;
+
+    SET_GRAPH_NODE_LAYER(generated->fnNode.node.flags, layer);
+    geo_add_child(parent, &generated->fnNode.node);
+    add_display_list_node(pool, parent, layer, sEnvColorModel);
+}
+
+/**
+ * Builds a random scene: a few models made of one to three display list nodes, some of them after
+ * a generated list, drawn by up to 60 transform nodes each. Transform nodes sometimes have another
+ * one above them, and some display list nodes are only drawn once, between the shared ones.
+ */
+static struct GraphNodeRoot *build_scene(struct AllocOnlyPool *pool) {
+    struct GraphNodeRoot *root = init_graph_node_root(pool, NULL, 0, 160, 120, 160, 120);
+    struct GraphNodeMasterList *masterList = init_graph_node_master_list(pool, NULL, (host_random() % 4) != 0);
+    struct GraphNode *models[4];
+    s32 numModels = 1 + host_random() % ARRAY_COUNT(models);
+    s32 numInstances = 1 + host_random() % 60;
+    s32 i, j;
+
+    sNumSceneDisplayLists = 0;
+    geo_add_child(&root->node, &masterList->node);
+
+    for (i = 0; i < numModels; i++) {
+        s32 numParts = 1 + host_random() % 3;
+
+        models[i] = &init_graph_node_start(pool, NULL)->node;
+        for (j = 0; j < numParts; j++) {
+            if ((host_random() % 4) == 0) {
+                add_env_color_nodes(pool, models[i]);
+            } else {
+                add_test_model_node(pool, models[i]);
+            }
+        }
+    }
+
+    for (i = 0; i < numInstances; i++) {
+        struct GraphNode *parent = &masterList->node;
+        struct GraphNode *instance;
+
+        if ((host_random() % 4) == 0) {
+            parent = add_transform_node(pool, parent);
+        }
+        instance = add_transform_node(pool, parent);
+        if ((host_random() % 8) == 0) {
+            add_test_model_node(pool, instance);
+        } else {
+            // Shared the way object nodes share their model, without making it their child.
+            instance->children = models[host_random() % numModels];
+        }
+    }
+
+    return root;
+}
+
+static void draw_scene(struct GraphNodeRoot *root, struct GfxTrace *trace) {
+    Gfx *start;
+
+    host_reset_gfx_pool();
+    sNumEnvColors = 0;
+    start = gDisplayListHead;
+    // The geometry mode init_rsp starts every frame with, which the models reset to, and the
+    // environment color sEnvColorModel resets to.
+    gSPSetGeometryMode(gDisplayListHead++, G_SHADE | G_SHADING_SMOOTH | G_CULL_BACK | G_LIGHTING);
+    gDPSetEnvColor(gDisplayListHead++, 255, 255, 255, 255);
+    geo_process_root(root, NULL, NULL, 0);
+    gSPEndDisplayList(gDisplayListHead++);
+
+    gfx_trace(start, trace);
+    gfx_trace_sort(trace);
+}
+
+int main(void) {
+    struct AllocOnlyPool pool;
+    struct GfxTrace traceA = { sTrianglesA, 0, MAX_TRIANGLES, 0, 0, NULL };
+    struct GfxTrace traceB = { sTrianglesB, 0, MAX_TRIANGLES, 0, 0, NULL };
+    s32 numFailed = 0;
+    s32 numInstanced = 0;
+    s32 numTriangles = 0;
+    u32 i;
+    s32 j;
+    Mat4 scale;
+
+    mtxf_identity(scale);
+    scale[0][0] = scale[1][1] = scale[2][2] = 2.0f;
+    mtxf_to_mtx(&sScaleMatrix, scale);
+
+    for (i = 0; i < ARRAY_COUNT(sTestModels); i++) {
+        host_pool_init(&pool, sNodePool, sizeof(sNodePool));
+        // Pool allocations are only 4 byte aligned, make sure the parts still get aligned.
+        alloc_only_pool_alloc(&pool, 4);
+        if (!check_split(&pool, &sTestModels[i])) {
+            numFailed++;
+        }
+    }
+
+    for (i = 0; i < NUM_SCENES; i++) {
+        struct GraphNodeRoot *root;
+        s32 mismatch;
+
+        host_pool_init(&pool, sNodePool, sizeof(sNodePool));
+        root = build_scene(&pool);
+
+        draw_scene(root, &traceA);
+        for (j = 0; j < sNumSceneDisplayLists; j++) {
+            sSceneDisplayLists[j]->instanceLists = NULL;
+        }
+        draw_scene(root, &traceB);
+        for (j = 0; j < sNumSceneDisplayLists; j++) {
+            sSceneDisplayLists[j]->instanceLists = sSceneInstanceLists[j];
+        }
+
+        if (traceA.error != NULL || traceB.error != NULL) {
+            printf("scene %u: %s\n", i, (traceA.error != NULL ? traceA.error : traceB.error));
+            numFailed++;
+            continue;
+        }
+
+        mismatch = gfx_trace_compare(&traceA, &traceB);
+        if (mismatch >= 0) {
+            printf("scene %u: triangle %d differs (%d triangles instanced, %d without)\n",
+                   i, mismatch, traceA.numTriangles, traceB.numTriangles);
+            numFailed++;
+        }
+        if (traceA.numCommands != traceB.numCommands) {
+            numInstanced++;
+        }
+        numTriangles += traceB.numTriangles;
+    }
+
+    printf("%u scenes, %d triangles, %d with instances drawn together: %d failed\n",
+           NUM_SCENES, numTriangles, numInstanced, numFailed);
+    return (numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,6 @@
+// Forced in ahead of every file mtx_check is built from.
+#include "config.h"
+
+#ifndef BATCHED_MATRIX_CONVERSION
+#define BATCHED_MATRIX_CONVERSION
+#endif
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <PR/ultratypes.h>
+#include <PR/gbi.h>
+
+#include "sm64.h"
+#include "types.h"
+#include "engine/math_util.h"
+
+#include "host_graph.h"
+
+/**
+ * Checks that mtxf_to_mtx_batch, which BATCHED_MATRIX_CONVERSION converts every matrix of a frame
+ * with, writes the same Mtx as mtxf_to_mtx does for each matrix on its own. The matrices are
+ * random transforms like the scene graph makes: a rotation and scale part between tiny and large
+ * values, and translations from a few units up to the edge of what fits in s15.16.
+ */
+
+#define NUM_MATRICES 4096
+
+static Mat4 sMatrices[NUM_MATRICES];
+static Mtx sExpected[NUM_MATRICES];
+static Mtx sBatch[NUM_MATRICES];
+static Mtx *sBatchPtrs[NUM_MATRICES];
+
+// A random float in [-range, range), with some exact multiples of 1/65536 and integers mixed in.
+static f32 random_value(f32 range) {
+    s32 value = (s32) (host_random() & 0xFFFFFF) - 0x800000;
+
+    switch (host_random() % 8) {
+        case 0:
+            return (s32) (value / (f32) 0x800000 * range);
+        case 1:
+            return (s32) (value / (f32) 0x800000 * range * 65536.0f) / 65536.0f;
+        default:
+            return value / (f32) 0x800000 * range;
+    }
+}
+
+static void random_matrix(Mat4 mtx, s32 index) {
+    static const f32 sScaleRanges[] = { 0.001f, 1.0f, 4.0f, 64.0f };
+    static const f32 sTranslationRanges[] = { 2.0f, 100.0f, 8000.0f, 32000.0f };
+    f32 scaleRange = sScaleRanges[index % ARRAY_COUNT(sScaleRanges)];
+    f32 translationRange = sTranslationRanges[(index / ARRAY_COUNT(sScaleRanges)) % ARRAY_COUNT(sTranslationRanges)];
+    s32 i, j;
+
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) {
+            mtx[i][j] = random_value(scaleRange);
+        }
+        mtx[i][3] = 0.0f;
+        mtx[3][i] = random_value(translationRange);
+    }
+    mtx[3][3] = 1.0f;
+}
+
+int main(void) {
+    s32 numMismatches = 0;
+    s32 i, j;
+
+    for (i = 0; i < NUM_MATRICES; i++) {
+        if (i == 0) {
+            mtxf_identity(sMatrices[i]);
+        } else {
+            random_matrix(sMatrices[i], i);
+        }
+        mtxf_to_mtx(&sExpected[i], sMatrices[i]);
+
+        // The batch converts in place, from the float matrix geo_get_fixed_matrix leaves in the Mtx.
+        mtxf_copy((void *) &sBatch[i], sMatrices[i]);
+        sBatchPtrs[i] = &sBatch[i];
+    }
+
+    mtxf_to_mtx_batch(sBatchPtrs, NUM_MATRICES);
+
+    for (i = 0; i < NUM_MATRICES; i++) {
+        const u32 *expected = (const u32 *) &sExpected[i];
+        const u32 *batch = (const u32 *) &sBatch[i];
+
+        for (j = 0; j < (s32) (sizeof(Mtx) / sizeof(u32)); j++) {
+            if (expected[j] != batch[j]) {
+                if (numMismatches < 10) {
+                    printf("matrix %d, word %d: mtxf_to_mtx wrote %08X, mtxf_to_mtx_batch %08X\n",
+                           i, j, expected[j], batch[j]);
+                }
+                numMismatches++;
+            }
+        }
+    }
+
+    printf("%d matrices: %d words differ\n", NUM_MATRICES, numMismatches);
+    return (numMismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mips_cpu.h"
+
+/**
+ * Checks inflate_segment (src/boot/inflate.s, FAST_INFLATE) by running the assembled code on
+ * mips_cpu.c: every segment given is decoded the way load_segment_decompress decodes it, and has
+ * to come out the same as the data it was compressed from.
+ *
+ * Usage: inflate_check <compressed> <uncompressed> [<compressed> <uncompressed>...]
+ *
+ * The compressed files are what the ROM holds for gzip: deflate data followed by the size, as
+ * filesizer writes it (see gziprules.mk). The decoder is only loaded once, like on console, so
+ * anything it leaves behind in its tables is there for the next segment too.
+ *
+ * Besides the output, it has to return the size, leave $sp and the registers it has to save
+ * as they were, and only store to the output, its own data and its stack frame.
+ */
+
+#define STACK_TOP     0x80200000
+#define STACK_SIZE    0x1000
+#define SRC_ADDR      0x80200000
+#define SRC_SIZE      0x400000
+#define DEST_ADDR     0x80600000
+#define DEST_SIZE     0x800000
+// Where inflate_segment is called from, nothing is there.
+#define RETURN_ADDR   0x80000100
+
+#define MAX_INSTRUCTIONS_PER_BYTE 1000
+
+static u8 sCompressed[SRC_SIZE];
+static u8 sExpected[DEST_SIZE];
+static u8 sOutput[DEST_SIZE];
+static u32 sRandomState = 1;
+
+static u32 read_file(const char *path, u8 *dest, u32 maxSize) {
+    FILE *file = fopen(path, "rb");
+    size_t size;
+
+    if (file == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    size = fread(dest, 1, maxSize, file);
+    if (!feof(file) && fgetc(file) != EOF) {
+        fprintf(stderr, "%s: larger than 0x%X bytes\n", path, maxSize);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return size;
+}
+
+// A sign-extended 32-bit value, for the registers inflate_segment gets.
+static u64 random_register(void) {
+    sRandomState = sRandomState * 1103515245 + 12345;
+    return (u64) (s64) (s32) (sRandomState ^ (sRandomState >> 15));
+}
+
+/**
+ * Decodes the segment already in RAM at SRC_ADDR. Returns FALSE and says why if it doesn't match
+ * sExpected.
+ */
+static s32 check_segment(const char *path, u32 expectedSize, u64 *numInstructions) {
+    struct MipsCpu cpu;
+    u64 saved[32];
+    s32 i;
+
+    memset(&cpu, 0, sizeof(cpu));
+    for (i = 1; i < 32; i++) {
+        cpu.regs[i] = random_register();
+    }
+    cpu.regs[MIPS_A0] = (u64) (s64) (s32) SRC_ADDR;
+    cpu.regs[MIPS_A1] = (u64) (s64) (s32) DEST_ADDR;
+    cpu.regs[MIPS_A2] = expectedSize;
+    cpu.regs[MIPS_SP] = (u64) (s64) (s32) STACK_TOP;
+    cpu.regs[MIPS_RA] = (u64) (s64) (s32) RETURN_ADDR;
+    memcpy(saved, cpu.regs, sizeof(saved));
+
+    cpu.pc = gMipsImage.entry;
+    cpu.code.start = gMipsImage.addr;
+    cpu.code.end = gMipsImage.codeEnd;
+    cpu.writable[0].start = gMipsImage.writableStart;
+    cpu.writable[0].end = gMipsImage.addr + gMipsImage.size;
+    cpu.writable[1].start = STACK_TOP - STACK_SIZE;
+    cpu.writable[1].end = STACK_TOP;
+    cpu.writable[2].start = DEST_ADDR;
+    cpu.writable[2].end = DEST_ADDR + expectedSize;
+    cpu.numWritable = 3;
+
+    // Whatever the pool had in it before.
+    memset(sOutput, 0xAA, expectedSize);
+    mips_write(DEST_ADDR, sOutput, expectedSize);
+
+    if (!mips_run(&cpu, RETURN_ADDR, (u64) MAX_INSTRUCTIONS_PER_BYTE * (expectedSize + 0x100))) {
+        printf("%s: %s\n", path, cpu.error);
+        return FALSE;
+    }
+    *numInstructions += cpu.numInstructions;
+
+    if (cpu.regs[MIPS_V0] != expectedSize) {
+        printf("%s: returned %llX instead of %X\n", path, (unsigned long long) cpu.regs[MIPS_V0], expectedSize);
+        return FALSE;
+    }
+    for (i = MIPS_S0; i <= MIPS_S7; i++) {
+        if (cpu.regs[i] != saved[i]) {
+            printf("%s: $s%d wasn't saved\n", path, i - MIPS_S0);
+            return FALSE;
+        }
+    }
+    if (cpu.regs[MIPS_GP] != saved[MIPS_GP] || cpu.regs[MIPS_SP] != saved[MIPS_SP]
+        || cpu.regs[MIPS_FP] != saved[MIPS_FP]) {
+        printf("%s: $gp, $sp or $fp wasn't saved\n", path);
+        return FALSE;
+    }
+
+    mips_read(sOutput, DEST_ADDR, expectedSize);
+    for (i = 0; i < (s32) expectedSize; i++) {
+        if (sOutput[i] != sExpected[i]) {
+            printf("%s: byte 0x%X is %02X instead of %02X\n", path, i, sOutput[i], sExpected[i]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+int main(int argc, char *argv[]) {
+    s32 numSegments = 0;
+    s32 numFailed = 0;
+    u64 numBytes = 0;
+    u64 numInstructions = 0;
+    s32 i;
+
+    if (argc < 3 || (argc % 2) != 1) {
+        fprintf(stderr, "Usage: %s <compressed> <uncompressed> [<compressed> <uncompressed>...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    mips_write(gMipsImage.addr, gMipsImage.data, gMipsImage.size);
+
+    for (i = 1; i < argc; i += 2) {
+        u32 compressedSize = read_file(argv[i], sCompressed, SRC_SIZE);
+        u32 expectedSize = read_file(argv[i + 1], sExpected, DEST_SIZE);
+        u32 size = 0;
+
+        // load_segment_decompress takes the size from the end of the segment.
+        if (compressedSize >= 4) {
+            u8 *trailer = &sCompressed[compressedSize - 4];
+            size = (u32) trailer[0] << 24 | trailer[1] << 16 | trailer[2] << 8 | trailer[3];
+        }
+        if (compressedSize < 4 || size != expectedSize) {
+            printf("%s: doesn't end with the size of %s\n", argv[i], argv[i + 1]);
+            numFailed++;
+        } else {
+            // What follows the segment in RAM is left from before.
+            memset(sCompressed + compressedSize, 0xAA, SRC_SIZE - compressedSize);
+            mips_write(SRC_ADDR, sCompressed, SRC_SIZE);
+            if (!check_segment(argv[i], expectedSize, &numInstructions)) {
+                numFailed++;
+            }
+        }
+        numSegments++;
+        numBytes += expectedSize;
+    }
+
+    printf("%d segments, 0x%llX bytes, %.2f instructions a byte: %d failed\n", numSegments,
+           (unsigned long long) numBytes, (double) numInstructions / (numBytes ? numBytes : 1), numFailed);
+    return (numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
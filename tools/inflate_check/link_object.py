@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+Lays out the sections of a MIPS object (32-bit, big-endian) in KSEG0, applies its relocations and
+writes the result as a struct MipsImage in C, for mips_cpu.c to run.
+
+Only what hand-written code in src/boot needs is supported: .text, .data, .rodata and .bss, and the
+R_MIPS_32, R_MIPS_26 and R_MIPS_HI16/R_MIPS_LO16 relocations between them. The object can't use any
+symbol it doesn't define.
+
+Usage: link_object.py <object> <entry symbol> <output>
+"""
+
+import struct
+import sys
+
+BASE_ADDR = 0x80100000
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHT_REL = 9
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+R_MIPS_32 = 2
+R_MIPS_26 = 4
+R_MIPS_HI16 = 5
+R_MIPS_LO16 = 6
+
+
+class Section:
+    def __init__(self, index, name, type, flags, offset, size, link, info, align):
+        self.index = index
+        self.name = name
+        self.type = type
+        self.flags = flags
+        self.offset = offset
+        self.size = size
+        self.link = link
+        self.info = info
+        self.align = max(align, 1)
+        self.addr = None
+
+
+def read_sections(elf):
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 2:
+        sys.exit("not a 32-bit big-endian ELF object")
+    shoff, = struct.unpack_from(">I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from(">HHH", elf, 0x2E)
+
+    sections = []
+    for i in range(shnum):
+        fields = struct.unpack_from(">IIIIIIIIII", elf, shoff + i * shentsize)
+        name, type, flags, _, offset, size, link, info, align, _ = fields
+        sections.append(Section(i, name, type, flags, offset, size, link, info, align))
+    names = sections[shstrndx]
+    for section in sections:
+        end = elf.index(b"\0", names.offset + section.name)
+        section.name = elf[names.offset + section.name:end].decode()
+    return sections
+
+
+def read_symbols(elf, sections):
+    symtab = next(s for s in sections if s.type == SHT_SYMTAB)
+    strtab = sections[symtab.link]
+    symbols = []
+    for offset in range(symtab.offset, symtab.offset + symtab.size, 16):
+        name, value, _, _, _, shndx = struct.unpack_from(">IIIBBH", elf, offset)
+        end = elf.index(b"\0", strtab.offset + name)
+        symbols.append((elf[strtab.offset + name:end].decode(), value, shndx))
+    return symbols
+
+
+def align(addr, alignment):
+    return (addr + alignment - 1) & ~(alignment - 1)
+
+
+def layout(sections):
+    """
+    Code first, then read-only data, then writable data and bss, so what may be written is in one
+    range at the end. Returns the sections laid out and the start of the writable range.
+    """
+    loaded = [s for s in sections if s.flags & SHF_ALLOC and s.type in (SHT_PROGBITS, SHT_NOBITS)]
+    order = lambda s: (s.type == SHT_NOBITS, not (s.flags & SHF_EXECINSTR), bool(s.flags & SHF_WRITE))
+    loaded.sort(key=order)
+
+    addr = BASE_ADDR
+    writable = None
+    for section in loaded:
+        addr = align(addr, max(section.align, 16))
+        if writable is None and (section.flags & SHF_WRITE):
+            writable = addr
+        section.addr = addr
+        addr += section.size
+    return loaded, (writable if writable is not None else addr), addr
+
+
+def relocate(elf, sections, symbols, image):
+    by_index = {s.index: s for s in sections}
+
+    def symbol_addr(index):
+        name, value, shndx = symbols[index]
+        if shndx not in by_index or by_index[shndx].addr is None:
+            sys.exit("{} isn't defined in a section that is loaded".format(name or "symbol %d" % index))
+        return by_index[shndx].addr + value
+
+    for rel in sections:
+        if rel.type != SHT_REL or rel.info not in by_index or by_index[rel.info].addr is None:
+            continue
+        target = by_index[rel.info]
+        pending_hi = []
+        for offset in range(rel.offset, rel.offset + rel.size, 8):
+            r_offset, r_info = struct.unpack_from(">II", elf, offset)
+            sym, type = r_info >> 8, r_info & 0xFF
+            place = target.addr + r_offset
+            word, = struct.unpack_from(">I", image, place - BASE_ADDR)
+            s = symbol_addr(sym)
+
+            if type == R_MIPS_32:
+                word = (word + s) & 0xFFFFFFFF
+            elif type == R_MIPS_26:
+                dest = s + ((word & 0x3FFFFFF) << 2)
+                if (dest >> 28) != ((place + 4) >> 28):
+                    sys.exit("jump at {:08X} can't reach {:08X}".format(place, dest))
+                word = (word & 0xFC000000) | ((dest >> 2) & 0x3FFFFFF)
+            elif type == R_MIPS_HI16:
+                pending_hi.append((place, word, sym))
+                continue
+            elif type == R_MIPS_LO16:
+                lo = word & 0xFFFF
+                lo = lo - 0x10000 if lo & 0x8000 else lo
+                for hi_place, hi_word, hi_sym in pending_hi:
+                    if hi_sym != sym:
+                        sys.exit("R_MIPS_HI16 at {:08X} has no R_MIPS_LO16".format(hi_place))
+                    value = s + ((hi_word & 0xFFFF) << 16) + lo
+                    hi_word = (hi_word & 0xFFFF0000) | (((value + 0x8000) >> 16) & 0xFFFF)
+                    struct.pack_into(">I", image, hi_place - BASE_ADDR, hi_word)
+                pending_hi = []
+                word = (word & 0xFFFF0000) | ((s + lo) & 0xFFFF)
+            else:
+                sys.exit("relocation type {} at {:08X} isn't supported".format(type, place))
+            struct.pack_into(">I", image, place - BASE_ADDR, word)
+        if pending_hi:
+            sys.exit("R_MIPS_HI16 at {:08X} has no R_MIPS_LO16".format(pending_hi[0][0]))
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__.strip().splitlines()[-1])
+    obj_path, entry_name, out_path = sys.argv[1:]
+    with open(obj_path, "rb") as f:
+        elf = f.read()
+
+    sections = read_sections(elf)
+    symbols = read_symbols(elf, sections)
+    loaded, writable, end = layout(sections)
+
+    # bss is part of the image too, as zeros, so it is cleared whenever the image is loaded.
+    image = bytearray(end - BASE_ADDR)
+    for section in loaded:
+        if section.type == SHT_PROGBITS:
+            start = section.addr - BASE_ADDR
+            image[start:start + section.size] = elf[section.offset:section.offset + section.size]
+    relocate(elf, sections, symbols, image)
+
+    entry = [(value, shndx) for name, value, shndx in symbols if name == entry_name]
+    if not entry:
+        sys.exit("{} isn't in {}".format(entry_name, obj_path))
+    entry_addr = next(s.addr for s in loaded if s.index == entry[0][1]) + entry[0][0]
+    code_end = max(s.addr + s.size for s in loaded if s.flags & SHF_EXECINSTR)
+
+    with open(out_path, "w") as f:
+        f.write("// Made from {} by link_object.py.\n\n".format(obj_path))
+        f.write('#include "mips_cpu.h"\n\n')
+        f.write("static const u8 sImageData[] = {\n")
+        for i in range(0, len(image), 16):
+            f.write("    " + " ".join("0x{:02X},".format(b) for b in image[i:i + 16]) + "\n")
+        f.write("};\n\n")
+        f.write("const struct MipsImage gMipsImage = {\n")
+        f.write("    0x{:08X}, sImageData, sizeof(sImageData),\n".format(BASE_ADDR))
+        f.write("    0x{:08X}, 0x{:08X}, 0x{:08X},\n".format(code_end, writable, entry_addr))
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,401 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mips_cpu.h"
+
+/**
+ * Enough of the VR4300 to run hand-written code that only uses the integer unit: MIPS III with
+ * 64-bit registers, big-endian memory and branch delay slots. Anything else (coprocessors,
+ * exceptions, traps, lwl/lwr/swl/swr) stops it as unknown.
+ *
+ * It also stops where the VR4300 would do something the code can't have meant:
+ *   - a 32-bit operation on a register that doesn't hold a sign-extended 32-bit value, which
+ *     the architecture leaves unpredictable
+ *   - a branch or jump in a delay slot
+ *   - add, addi or sub overflowing and unaligned loads and stores, which would raise exceptions
+ *   - division by zero, which gives nothing useful
+ *   - stores outside cpu->writable, and running anything outside cpu->code
+ */
+
+u8 gMipsRam[MIPS_RAM_SIZE];
+
+static jmp_buf sStop;
+static struct MipsCpu *sCpu;
+
+static void stop(const char *format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(sCpu->error, sizeof(sCpu->error), format, args);
+    va_end(args);
+    longjmp(sStop, 1);
+}
+
+static u32 physical(u64 addr, u32 size, s32 isStore) {
+    u32 phys;
+    s32 i;
+
+    if ((u64) (s64) (s32) addr != addr) {
+        stop("address %016llX at %08X isn't sign-extended", (unsigned long long) addr, sCpu->pc);
+    }
+    if ((addr & (size - 1)) != 0) {
+        stop("unaligned %u byte access to %08X at %08X", size, (u32) addr, sCpu->pc);
+    }
+    if ((u32) addr < 0x80000000 || (u32) addr >= 0xC0000000) {
+        stop("access to %08X at %08X, outside KSEG0 and KSEG1", (u32) addr, sCpu->pc);
+    }
+    phys = (u32) addr & 0x1FFFFFFF;
+    if (phys + size > MIPS_RAM_SIZE) {
+        stop("access to %08X at %08X, past the end of RAM", (u32) addr, sCpu->pc);
+    }
+    if (isStore) {
+        for (i = 0; i < sCpu->numWritable; i++) {
+            if (phys + 0x80000000 >= sCpu->writable[i].start && phys + 0x80000000 + size <= sCpu->writable[i].end) {
+                break;
+            }
+        }
+        if (i == sCpu->numWritable) {
+            stop("store to %08X at %08X", (u32) addr, sCpu->pc);
+        }
+    }
+    return phys;
+}
+
+static u64 load(u64 addr, u32 size) {
+    u32 phys = physical(addr, size, FALSE);
+    u64 value = 0;
+    u32 i;
+
+    for (i = 0; i < size; i++) {
+        value = (value << 8) | gMipsRam[phys + i];
+    }
+    return value;
+}
+
+static void store(u64 addr, u32 size, u64 value) {
+    u32 phys = physical(addr, size, TRUE);
+    s32 i;
+
+    for (i = size - 1; i >= 0; i--) {
+        gMipsRam[phys + i] = (u8) value;
+        value >>= 8;
+    }
+}
+
+void mips_write(u32 addr, const void *src, u32 size) {
+    memcpy(&gMipsRam[addr & 0x1FFFFFFF], src, size);
+}
+
+void mips_read(void *dest, u32 addr, u32 size) {
+    memcpy(dest, &gMipsRam[addr & 0x1FFFFFFF], size);
+}
+
+static u64 sext32(u32 value) {
+    return (u64) (s64) (s32) value;
+}
+
+// Value of a register a 32-bit operation reads.
+static u32 reg32(u32 reg) {
+    u64 value = sCpu->regs[reg];
+
+    if (sext32((u32) value) != value) {
+        stop("32-bit operation at %08X on $%u = %016llX", sCpu->pc, reg, (unsigned long long) value);
+    }
+    return (u32) value;
+}
+
+// Bits above the low count of value, which may be 64.
+static u64 high_mask(u32 count) {
+    return (count >= 64 ? 0 : ~0ULL << count);
+}
+
+s32 mips_run(struct MipsCpu *cpu, u32 returnAddr, u64 maxInstructions) {
+    u64 *regs = cpu->regs;
+    u32 nextPc = cpu->pc + 4;
+    s32 inDelaySlot = FALSE;
+
+    sCpu = cpu;
+    cpu->error[0] = '\0';
+    if (setjmp(sStop) != 0) {
+        return FALSE;
+    }
+
+    while (cpu->pc != returnAddr) {
+        u32 insn, op, rs, rt, rd, sa, funct;
+        u64 imm, uimm;
+        s32 isBranch = FALSE;
+        s32 taken = FALSE;
+        s32 likely = FALSE;
+        u32 target = 0;
+        u32 newNextPc = nextPc + 4;
+
+        if (cpu->pc < cpu->code.start || cpu->pc >= cpu->code.end) {
+            stop("jumped to %08X", cpu->pc);
+        }
+        if (cpu->numInstructions++ >= maxInstructions) {
+            stop("still going after %llu instructions", (unsigned long long) maxInstructions);
+        }
+
+        insn = (u32) load(sext32(cpu->pc), 4);
+        op = insn >> 26;
+        rs = (insn >> 21) & 0x1F;
+        rt = (insn >> 16) & 0x1F;
+        rd = (insn >> 11) & 0x1F;
+        sa = (insn >> 6) & 0x1F;
+        funct = insn & 0x3F;
+        imm = (u64) (s64) (s16) insn;
+        uimm = insn & 0xFFFF;
+
+        switch (op) {
+            case 0x00:
+                switch (funct) {
+                    case 0x00: regs[rd] = sext32((u32) regs[rt] << sa); break;
+                    case 0x02: regs[rd] = sext32(reg32(rt) >> sa); break;
+                    case 0x03: regs[rd] = sext32((s32) reg32(rt) >> sa); break;
+                    case 0x04: regs[rd] = sext32((u32) regs[rt] << (regs[rs] & 0x1F)); break;
+                    case 0x06: regs[rd] = sext32(reg32(rt) >> (regs[rs] & 0x1F)); break;
+                    case 0x07: regs[rd] = sext32((s32) reg32(rt) >> (regs[rs] & 0x1F)); break;
+                    case 0x08: // jr
+                        isBranch = taken = TRUE;
+                        target = (u32) regs[rs];
+                        if (sext32(target) != regs[rs]) {
+                            stop("jr to %016llX at %08X", (unsigned long long) regs[rs], cpu->pc);
+                        }
+                        break;
+                    case 0x09: // jalr
+                        isBranch = taken = TRUE;
+                        target = (u32) regs[rs];
+                        regs[rd] = sext32(cpu->pc + 8);
+                        break;
+                    case 0x0F: break; // sync
+                    case 0x10: regs[rd] = cpu->hi; break;
+                    case 0x11: cpu->hi = regs[rs]; break;
+                    case 0x12: regs[rd] = cpu->lo; break;
+                    case 0x13: cpu->lo = regs[rs]; break;
+                    case 0x14: regs[rd] = regs[rt] << (regs[rs] & 0x3F); break;
+                    case 0x16: regs[rd] = regs[rt] >> (regs[rs] & 0x3F); break;
+                    case 0x17: regs[rd] = (u64) ((s64) regs[rt] >> (regs[rs] & 0x3F)); break;
+                    case 0x18: { // mult
+                        s64 product = (s64) (s32) reg32(rs) * (s32) reg32(rt);
+                        cpu->lo = sext32((u32) product);
+                        cpu->hi = sext32((u32) ((u64) product >> 32));
+                        break;
+                    }
+                    case 0x19: { // multu
+                        u64 product = (u64) reg32(rs) * reg32(rt);
+                        cpu->lo = sext32((u32) product);
+                        cpu->hi = sext32((u32) (product >> 32));
+                        break;
+                    }
+                    case 0x1A: // div
+                    case 0x1B: // divu
+                        if (reg32(rt) == 0) {
+                            stop("division by zero at %08X", cpu->pc);
+                        }
+                        if (funct == 0x1B) {
+                            cpu->lo = sext32(reg32(rs) / reg32(rt));
+                            cpu->hi = sext32(reg32(rs) % reg32(rt));
+                        } else if ((s32) reg32(rt) == -1) {
+                            cpu->lo = sext32(-reg32(rs));
+                            cpu->hi = 0;
+                        } else {
+                            cpu->lo = sext32((s32) reg32(rs) / (s32) reg32(rt));
+                            cpu->hi = sext32((s32) reg32(rs) % (s32) reg32(rt));
+                        }
+                        break;
+                    case 0x1C: { // dmult
+                        __int128 product = (__int128) (s64) regs[rs] * (s64) regs[rt];
+                        cpu->lo = (u64) product;
+                        cpu->hi = (u64) (product >> 64);
+                        break;
+                    }
+                    case 0x1D: { // dmultu
+                        unsigned __int128 product = (unsigned __int128) regs[rs] * regs[rt];
+                        cpu->lo = (u64) product;
+                        cpu->hi = (u64) (product >> 64);
+                        break;
+                    }
+                    case 0x1E: // ddiv
+                    case 0x1F: // ddivu
+                        if (regs[rt] == 0) {
+                            stop("division by zero at %08X", cpu->pc);
+                        }
+                        if (funct == 0x1F) {
+                            cpu->lo = regs[rs] / regs[rt];
+                            cpu->hi = regs[rs] % regs[rt];
+                        } else if ((s64) regs[rt] == -1) {
+                            cpu->lo = -regs[rs];
+                            cpu->hi = 0;
+                        } else {
+                            cpu->lo = (u64) ((s64) regs[rs] / (s64) regs[rt]);
+                            cpu->hi = (u64) ((s64) regs[rs] % (s64) regs[rt]);
+                        }
+                        break;
+                    case 0x20: // add
+                    case 0x22: { // sub
+                        s64 result = (funct == 0x20 ? (s64) (s32) reg32(rs) + (s32) reg32(rt)
+                                                    : (s64) (s32) reg32(rs) - (s32) reg32(rt));
+                        if (result != (s32) result) {
+                            stop("overflow at %08X", cpu->pc);
+                        }
+                        regs[rd] = (u64) result;
+                        break;
+                    }
+                    case 0x21: regs[rd] = sext32(reg32(rs) + reg32(rt)); break;
+                    case 0x23: regs[rd] = sext32(reg32(rs) - reg32(rt)); break;
+                    case 0x24: regs[rd] = regs[rs] & regs[rt]; break;
+                    case 0x25: regs[rd] = regs[rs] | regs[rt]; break;
+                    case 0x26: regs[rd] = regs[rs] ^ regs[rt]; break;
+                    case 0x27: regs[rd] = ~(regs[rs] | regs[rt]); break;
+                    case 0x2A: regs[rd] = ((s64) regs[rs] < (s64) regs[rt]); break;
+                    case 0x2B: regs[rd] = (regs[rs] < regs[rt]); break;
+                    case 0x2C: // dadd
+                    case 0x2E: { // dsub
+                        s64 result;
+                        if (funct == 0x2C ? __builtin_add_overflow((s64) regs[rs], (s64) regs[rt], &result)
+                                          : __builtin_sub_overflow((s64) regs[rs], (s64) regs[rt], &result)) {
+                            stop("overflow at %08X", cpu->pc);
+                        }
+                        regs[rd] = (u64) result;
+                        break;
+                    }
+                    case 0x2D: regs[rd] = regs[rs] + regs[rt]; break;
+                    case 0x2F: regs[rd] = regs[rs] - regs[rt]; break;
+                    case 0x38: regs[rd] = regs[rt] << sa; break;
+                    case 0x3A: regs[rd] = regs[rt] >> sa; break;
+                    case 0x3B: regs[rd] = (u64) ((s64) regs[rt] >> sa); break;
+                    case 0x3C: regs[rd] = regs[rt] << (sa + 32); break;
+                    case 0x3E: regs[rd] = regs[rt] >> (sa + 32); break;
+                    case 0x3F: regs[rd] = (u64) ((s64) regs[rt] >> (sa + 32)); break;
+                    default:
+                        stop("unknown instruction %08X at %08X", insn, cpu->pc);
+                }
+                break;
+            case 0x01: // bltz, bgez, bltzl, bgezl, bltzal, bgezal
+                if ((rt & 0xC) != 0 || ((rt & 0x10) && (rt & 0x2))) {
+                    stop("unknown instruction %08X at %08X", insn, cpu->pc);
+                }
+                isBranch = TRUE;
+                taken = ((rt & 1) ? (s64) regs[rs] >= 0 : (s64) regs[rs] < 0);
+                likely = ((rt & 2) != 0);
+                target = nextPc + ((u32) imm << 2);
+                if (rt & 0x10) {
+                    regs[MIPS_RA] = sext32(cpu->pc + 8);
+                }
+                break;
+            case 0x02: // j
+            case 0x03: // jal
+                isBranch = taken = TRUE;
+                target = (nextPc & 0xF0000000) | ((insn & 0x3FFFFFF) << 2);
+                if (op == 0x03) {
+                    regs[MIPS_RA] = sext32(cpu->pc + 8);
+                }
+                break;
+            case 0x04: case 0x14: // beq, beql
+            case 0x05: case 0x15: // bne, bnel
+            case 0x06: case 0x16: // blez, blezl
+            case 0x07: case 0x17: // bgtz, bgtzl
+                isBranch = TRUE;
+                likely = (op >= 0x14);
+                switch (op & 3) {
+                    case 0: taken = (regs[rs] == regs[rt]); break;
+                    case 1: taken = (regs[rs] != regs[rt]); break;
+                    case 2: taken = ((s64) regs[rs] <= 0); break;
+                    case 3: taken = ((s64) regs[rs] > 0); break;
+                }
+                target = nextPc + ((u32) imm << 2);
+                break;
+            case 0x08: { // addi
+                s64 result = (s64) (s32) reg32(rs) + (s64) imm;
+                if (result != (s32) result) {
+                    stop("overflow at %08X", cpu->pc);
+                }
+                regs[rt] = (u64) result;
+                break;
+            }
+            case 0x09: regs[rt] = sext32(reg32(rs) + (u32) imm); break;
+            case 0x0A: regs[rt] = ((s64) regs[rs] < (s64) imm); break;
+            case 0x0B: regs[rt] = (regs[rs] < imm); break;
+            case 0x0C: regs[rt] = regs[rs] & uimm; break;
+            case 0x0D: regs[rt] = regs[rs] | uimm; break;
+            case 0x0E: regs[rt] = regs[rs] ^ uimm; break;
+            case 0x0F: regs[rt] = sext32((u32) uimm << 16); break;
+            case 0x18: { // daddi
+                s64 result;
+                if (__builtin_add_overflow((s64) regs[rs], (s64) imm, &result)) {
+                    stop("overflow at %08X", cpu->pc);
+                }
+                regs[rt] = (u64) result;
+                break;
+            }
+            case 0x19: regs[rt] = regs[rs] + imm; break;
+            case 0x1A: { // ldl
+                u64 addr = regs[rs] + imm;
+                u32 shift = (addr & 7) * 8;
+                regs[rt] = (load(addr & ~7ULL, 8) << shift) | (regs[rt] & ~high_mask(shift));
+                break;
+            }
+            case 0x1B: { // ldr
+                u64 addr = regs[rs] + imm;
+                u32 shift = (7 - (addr & 7)) * 8;
+                regs[rt] = (load(addr & ~7ULL, 8) >> shift) | (regs[rt] & high_mask(64 - shift));
+                break;
+            }
+            case 0x20: regs[rt] = (u64) (s64) (s8) load(regs[rs] + imm, 1); break;
+            case 0x21: regs[rt] = (u64) (s64) (s16) load(regs[rs] + imm, 2); break;
+            case 0x23: regs[rt] = sext32((u32) load(regs[rs] + imm, 4)); break;
+            case 0x24: regs[rt] = load(regs[rs] + imm, 1); break;
+            case 0x25: regs[rt] = load(regs[rs] + imm, 2); break;
+            case 0x27: regs[rt] = load(regs[rs] + imm, 4); break;
+            case 0x28: store(regs[rs] + imm, 1, regs[rt]); break;
+            case 0x29: store(regs[rs] + imm, 2, regs[rt]); break;
+            case 0x2B: store(regs[rs] + imm, 4, regs[rt]); break;
+            case 0x2C: { // sdl, from addr to the end of its doubleword
+                u64 addr = regs[rs] + imm;
+                u32 i;
+                for (i = 0; i < 8 - (addr & 7); i++) {
+                    store(addr + i, 1, regs[rt] >> (56 - i * 8));
+                }
+                break;
+            }
+            case 0x2D: { // sdr, from the start of its doubleword to addr
+                u64 addr = regs[rs] + imm;
+                u32 i;
+                for (i = 0; i <= (addr & 7); i++) {
+                    store(addr - i, 1, regs[rt] >> (i * 8));
+                }
+                break;
+            }
+            case 0x2F: break; // cache
+            case 0x37: regs[rt] = load(regs[rs] + imm, 8); break;
+            case 0x3F: store(regs[rs] + imm, 8, regs[rt]); break;
+            default:
+                stop("unknown instruction %08X at %08X", insn, cpu->pc);
+        }
+        regs[MIPS_ZERO] = 0;
+
+        if (isBranch) {
+            if (inDelaySlot) {
+                stop("branch in the delay slot at %08X", cpu->pc);
+            }
+            if (taken) {
+                newNextPc = target;
+            } else if (likely) {
+                // The delay slot is skipped.
+                nextPc += 4;
+                newNextPc = nextPc + 4;
+                isBranch = FALSE;
+            }
+        }
+        inDelaySlot = isBranch;
+        cpu->pc = nextPc;
+        nextPc = newNextPc;
+    }
+
+    if (inDelaySlot) {
+        stop("returned without running the delay slot");
+    }
+    return TRUE;
+}
@@ -0,0 +1,60 @@
+#ifndef MIPS_CPU_H
+#define MIPS_CPU_H
+
+#include <PR/ultratypes.h>
+
+// RAM, seen through KSEG0 (0x80000000) and KSEG1 (0xA0000000) like on console.
+#define MIPS_RAM_SIZE 0x1000000
+#define MIPS_MAX_WRITABLE 4
+
+enum MipsRegister {
+    MIPS_ZERO, MIPS_AT, MIPS_V0, MIPS_V1, MIPS_A0, MIPS_A1, MIPS_A2, MIPS_A3,
+    MIPS_T0, MIPS_T1, MIPS_T2, MIPS_T3, MIPS_T4, MIPS_T5, MIPS_T6, MIPS_T7,
+    MIPS_S0, MIPS_S1, MIPS_S2, MIPS_S3, MIPS_S4, MIPS_S5, MIPS_S6, MIPS_S7,
+    MIPS_T8, MIPS_T9, MIPS_K0, MIPS_K1, MIPS_GP, MIPS_SP, MIPS_FP, MIPS_RA,
+};
+
+struct MipsRange {
+    u32 start;
+    u32 end;
+};
+
+struct MipsCpu {
+    u64 regs[32];
+    u64 hi;
+    u64 lo;
+    u32 pc;
+    // Instructions are only fetched from here.
+    struct MipsRange code;
+    // Stores anywhere else stop the CPU.
+    struct MipsRange writable[MIPS_MAX_WRITABLE];
+    s32 numWritable;
+    u64 numInstructions;
+    // Why mips_run stopped, if it didn't return.
+    char error[128];
+};
+
+// Code and data laid out in RAM by link_object.py, from addr to addr + size.
+struct MipsImage {
+    u32 addr;
+    const u8 *data;
+    u32 size;
+    u32 codeEnd;       // code is from addr to here
+    u32 writableStart; // data and bss are from here to addr + size
+    u32 entry;
+};
+
+extern u8 gMipsRam[MIPS_RAM_SIZE];
+extern const struct MipsImage gMipsImage;
+
+/**
+ * Runs from cpu->pc until it jumps to returnAddr, which it returns TRUE for. Returns FALSE and
+ * says why in cpu->error if it gets to anything the VR4300 would do something else for, or
+ * something this doesn't know.
+ */
+s32 mips_run(struct MipsCpu *cpu, u32 returnAddr, u64 maxInstructions);
+
+void mips_write(u32 addr, const void *src, u32 size);
+void mips_read(void *dest, u32 addr, u32 size);
+
+#endif // MIPS_CPU_H
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Runs inflate_check over segments compressed the way gziprules.mk compresses them, and over the
+same segments compressed by zlib in ways gzip -9 never does, so every kind of block and code
+inflate_segment has to handle is seen: stored blocks, fixed codes, Huffman-only and run-length
+streams, and streams flushed in random places, which gives empty and tiny blocks.
+
+Besides the segments given, a few are made up here: parts of the repo's own sources from a few
+bytes long up, runs of the same byte and of short patterns, which make matches that overlap
+themselves, a block of the few bytes whose code lengths are sent last followed by one without
+them, random bytes, which don't compress at all, and a mix of them.
+
+Usage: run_inflate_check.py --filesizer <filesizer> [segments...]
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import zlib
+
+BUILD_DIR = "build/segments"
+REPO_ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def write_file(path, data):
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def make_segments():
+    sources = b""
+    for name in sorted(os.listdir(os.path.join(REPO_ROOT, "src", "game"))):
+        if name.endswith(".c"):
+            sources += read_file(os.path.join(REPO_ROOT, "src", "game", name))
+
+    rng = random.Random(64)
+    segments = {}
+    for size in (0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 0x100, 0x1001, 0x8000, 0x10003, 0x40000):
+        segments["sources_%X" % size] = sources[:size]
+    for distance in range(1, 12):
+        pattern = bytes(rng.getrandbits(8) for _ in range(distance))
+        segments["pattern_%d" % distance] = (pattern * (0x2345 // distance + 1))[:0x2345]
+    segments["zeros"] = bytes(0x24000)
+    # Short codes for the literals whose code lengths are sent last, if at all, in the next block.
+    segments["control_bytes"] = bytes(rng.choice(b"\x01\x02\x0E\x0F") for _ in range(0x9000)) + sources[:0x9000]
+    segments["random"] = bytes(rng.getrandbits(8) for _ in range(0x5044))
+    segments["mixed"] = b"".join(
+        bytes(rng.getrandbits(8) for _ in range(rng.randrange(0x800))) + bytes([rng.getrandbits(8)]) * rng.randrange(0x2000)
+        + sources[rng.randrange(len(sources) - 0x1000):][:rng.randrange(0x1000)]
+        for _ in range(24))
+
+    paths = []
+    for name, data in segments.items():
+        path = os.path.join(BUILD_DIR, name + ".bin")
+        write_file(path, data)
+        paths.append(path)
+    return paths
+
+
+def deflate(data, level=9, strategy=zlib.Z_DEFAULT_STRATEGY, flushes=None):
+    """
+    Raw deflate data, without the zlib header and trailer. With flushes, the data is fed in random
+    pieces, each one flushed with one of them.
+    """
+    compressor = zlib.compressobj(level, zlib.DEFLATED, -15, 9, strategy)
+    if flushes is None:
+        return compressor.compress(data) + compressor.flush()
+
+    rng = random.Random(len(data))
+    out = b""
+    pos = 0
+    while pos < len(data):
+        size = rng.choice((0, 1, 5, 100, 3000, 20000))
+        out += compressor.compress(data[pos:pos + size]) + compressor.flush(rng.choice(flushes))
+        pos += size
+    return out + compressor.flush()
+
+
+def gzip(path):
+    # gzip's own header is stripped, as in gziprules.mk.
+    return subprocess.run(["gzip", "-c", "-9", "-n", path], check=True, capture_output=True).stdout[10:]
+
+
+VARIANTS = {
+    "gzip": lambda path, data: gzip(path),
+    "z9": lambda path, data: deflate(data),
+    "z1": lambda path, data: deflate(data, level=1),
+    "stored": lambda path, data: deflate(data, level=0),
+    "fixed": lambda path, data: deflate(data, strategy=zlib.Z_FIXED),
+    "huffman": lambda path, data: deflate(data, strategy=zlib.Z_HUFFMAN_ONLY),
+    "rle": lambda path, data: deflate(data, strategy=zlib.Z_RLE),
+    "flushed": lambda path, data: deflate(data, flushes=(zlib.Z_NO_FLUSH, zlib.Z_SYNC_FLUSH, zlib.Z_FULL_FLUSH)),
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(usage=__doc__.strip().splitlines()[-1])
+    parser.add_argument("--filesizer", required=True)
+    parser.add_argument("segments", nargs="*")
+    args = parser.parse_args()
+
+    os.makedirs(BUILD_DIR, exist_ok=True)
+    segments = make_segments() + args.segments
+
+    failed = False
+    for variant, compress in VARIANTS.items():
+        check_args = []
+        for i, path in enumerate(segments):
+            out = os.path.join(BUILD_DIR, "%d_%s.%s" % (i, os.path.basename(path), variant))
+            data = read_file(path)
+            compressed = compress(path, data)
+            if zlib.decompress(compressed, -15) != data:
+                sys.exit("%s: zlib doesn't decompress the %s data to it" % (path, variant))
+            write_file(out + ".strip", compressed)
+            # The size goes at the end, as in gziprules.mk.
+            subprocess.run([args.filesizer, out + ".strip", out, str(len(data))], check=True)
+            check_args += [out, path]
+
+        print("./inflate_check (%s)" % variant)
+        sys.stdout.flush()
+        if subprocess.run(["./inflate_check"] + check_args).returncode != 0:
+            failed = True
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
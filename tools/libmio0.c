@@ -7,6 +7,7 @@
 #endif
 
 #include "libmio0.h"
+#include "lzparse.h"
 #include "utils.h"
 
 // defines
@@ -193,14 +194,76 @@ int mio0_decode(const unsigned char *in, unsigned char *out, unsigned int *end)
    return bytes_written;
 }
 
+unsigned int mio0_in_place_margin(const unsigned char *in, unsigned int file_size)
+{
+   mio0_header_t head;
+   int bytes_written = 0;
+   int bit_idx = 0;
+   int comp_idx = 0;
+   int uncomp_idx = 0;
+   int lead = 0;
+   int start;
+
+   mio0_decode_header(in, &head);
+
+   // data the decoder has read can be written over, anything it reads later has to stay
+   // ahead of the output. lead is how far ahead of the data the output gets at most.
+   while (bytes_written < (int)head.dest_size) {
+      if (bit_idx % 32 == 0) {
+         // control bits are loaded a word at a time
+         lead = MAX(lead, bytes_written - (MIO0_HEADER_LENGTH + bit_idx / 8));
+      }
+      if (GET_BIT(&in[MIO0_HEADER_LENGTH], bit_idx)) {
+         lead = MAX(lead, bytes_written - (int)(head.uncomp_offset + uncomp_idx));
+         bytes_written++;
+         uncomp_idx++;
+      } else {
+         const unsigned char *vals = &in[head.comp_offset + comp_idx];
+         lead = MAX(lead, bytes_written - (int)(head.comp_offset + comp_idx));
+         comp_idx += 2;
+         bytes_written += ((vals[0] & 0xF0) >> 4) + 3;
+      }
+      bit_idx++;
+   }
+
+   // the data goes at the end of the buffer, which has to leave lead bytes in front of it
+   start = ALIGN(lead, 16);
+   return ALIGN(MAX(head.dest_size, start + file_size), 16) - head.dest_size;
+}
+
+// put together the header and the three parts of the data
+static int write_mio0(unsigned char *out, unsigned int length, const unsigned char *bit_buf, int bit_idx,
+                      const unsigned char *comp_buf, int comp_idx, const unsigned char *uncomp_buf, int uncomp_idx)
+{
+   unsigned int bit_length;
+   unsigned int comp_offset;
+   unsigned int uncomp_offset;
+
+   // compute final sizes and offsets
+   // +7 so int division accounts for all bits
+   bit_length = ((bit_idx + 7) / 8);
+   // compressed data after control bits and aligned to 4-byte boundary
+   comp_offset = ALIGN(MIO0_HEADER_LENGTH + bit_length, 4);
+   uncomp_offset = comp_offset + comp_idx;
+
+   // output header
+   memcpy(out, "MIO0", 4);
+   write_u32_be(&out[4], length);
+   write_u32_be(&out[8], comp_offset);
+   write_u32_be(&out[12], uncomp_offset);
+   // output data
+   memcpy(&out[MIO0_HEADER_LENGTH], bit_buf, bit_length);
+   memcpy(&out[comp_offset], comp_buf, comp_idx);
+   memcpy(&out[uncomp_offset], uncomp_buf, uncomp_idx);
+
+   return uncomp_offset + uncomp_idx;
+}
+
 int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out)
 {
    unsigned char *bit_buf;
    unsigned char *comp_buf;
    unsigned char *uncomp_buf;
-   unsigned int bit_length;
-   unsigned int comp_offset;
-   unsigned int uncomp_offset;
    unsigned int bytes_proc = 0;
    int bytes_written;
    int bit_idx = 0;
@@ -268,23 +331,7 @@ int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out
       bit_idx++;
    }
 
-   // compute final sizes and offsets
-   // +7 so int division accounts for all bits
-   bit_length = ((bit_idx + 7) / 8);
-   // compressed data after control bits and aligned to 4-byte boundary
-   comp_offset = ALIGN(MIO0_HEADER_LENGTH + bit_length, 4);
-   uncomp_offset = comp_offset + comp_idx;
-   bytes_written = uncomp_offset + uncomp_idx;
-
-   // output header
-   memcpy(out, "MIO0", 4);
-   write_u32_be(&out[4], length);
-   write_u32_be(&out[8], comp_offset);
-   write_u32_be(&out[12], uncomp_offset);
-   // output data
-   memcpy(&out[MIO0_HEADER_LENGTH], bit_buf, bit_length);
-   memcpy(&out[comp_offset], comp_buf, comp_idx);
-   memcpy(&out[uncomp_offset], uncomp_buf, uncomp_idx);
+   bytes_written = write_mio0(out, length, bit_buf, bit_idx, comp_buf, comp_idx, uncomp_buf, uncomp_idx);
 
    // free allocated buffers
    free(bit_buf);
@@ -295,6 +342,70 @@ int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out
    return bytes_written;
 }
 
+// bits taken up by a match: the flag and two bytes of length and offset
+static unsigned int match_price(void *arg, int length, int offset)
+{
+   return 17;
+}
+
+int mio0_encode_optimal(const unsigned char *in, unsigned int length, unsigned char *out)
+{
+   lz_config config = { 3, 18, 4096, 4096, 0 };
+   lz_match_table table;
+   lz_match *parse;
+   unsigned char *bit_buf;
+   unsigned char *comp_buf;
+   unsigned char *uncomp_buf;
+   unsigned int bytes_proc = 0;
+   int bytes_written;
+   int bit_idx = 0;
+   int comp_idx = 0;
+   int uncomp_idx = 0;
+
+   if (lz_find_matches(in, length, &config, &table)) {
+      return -1;
+   }
+   parse = malloc(length * sizeof(*parse));
+   lz_optimal_parse(&table, 0, length, 9, match_price, NULL, parse);
+
+   // allocate some temporary buffers worst case size
+   bit_buf = calloc((length + 7) / 8, 1); // 1-bit/byte
+   comp_buf = malloc(length); // 16-bits/2bytes
+   uncomp_buf = malloc(length); // all uncompressed
+
+   while (bytes_proc < length) {
+      int match_length = parse[bytes_proc].length;
+      int offset = parse[bytes_proc].offset;
+      if (match_length > 0) {
+         // compressed block
+         comp_buf[comp_idx] = (((match_length - 3) & 0x0F) << 4) |
+                              (((offset - 1) >> 8) & 0x0F);
+         comp_buf[comp_idx + 1] = (offset - 1) & 0xFF;
+         comp_idx += 2;
+         PUT_BIT(bit_buf, bit_idx, 0);
+         bytes_proc += match_length;
+      } else {
+         // uncompressed byte
+         uncomp_buf[uncomp_idx] = in[bytes_proc];
+         uncomp_idx++;
+         PUT_BIT(bit_buf, bit_idx, 1);
+         bytes_proc++;
+      }
+      bit_idx++;
+   }
+
+   bytes_written = write_mio0(out, length, bit_buf, bit_idx, comp_buf, comp_idx, uncomp_buf, uncomp_idx);
+
+   // free allocated buffers
+   free(bit_buf);
+   free(comp_buf);
+   free(uncomp_buf);
+   free(parse);
+   lz_free_matches(&table);
+
+   return bytes_written;
+}
+
 static FILE *mio0_open_out_file(const char *out_file) {
    if (strcmp(out_file, "-") == 0) {
 #if defined(_WIN32) || defined(_WIN64)
@@ -382,7 +493,7 @@ free_all:
    return ret_val;
 }
 
-int mio0_encode_file(const char *in_file, const char *out_file)
+int mio0_encode_file(const char *in_file, const char *out_file, int in_place, int optimal)
 {
    FILE *in;
    FILE *out;
@@ -412,11 +523,28 @@ int mio0_encode_file(const char *in_file, const char *out_file)
       goto free_all;
    }
 
-   // allocate worst case length
-   out_buf = malloc(MIO0_HEADER_LENGTH + ((file_size+7)/8) + file_size);
+   // allocate worst case length, with room for alignment and the in-place trailer
+   out_buf = malloc(MIO0_HEADER_LENGTH + ((file_size+7)/8) + file_size + 0x20);
 
    // compress data in MIO0 format
-   bytes_encoded = mio0_encode(in_buf, file_size, out_buf);
+   if (optimal) {
+      bytes_encoded = mio0_encode_optimal(in_buf, file_size, out_buf);
+   } else {
+      bytes_encoded = mio0_encode(in_buf, file_size, out_buf);
+   }
+   if (bytes_encoded < 0) {
+      ret_val = 6;
+      goto free_all;
+   }
+
+   if (in_place) {
+      unsigned int padded_size = ALIGN(bytes_encoded + MIO0_TRAILER_LENGTH, 16);
+      unsigned int margin = mio0_in_place_margin(out_buf, padded_size);
+      memset(&out_buf[bytes_encoded], 0, padded_size - bytes_encoded);
+      write_u32_be(&out_buf[padded_size - 8], margin);
+      write_u32_be(&out_buf[padded_size - 4], file_size);
+      bytes_encoded = padded_size;
+   }
 
    // open output file
    out = mio0_open_out_file(out_file);
@@ -455,6 +583,8 @@ typedef struct
    char *out_filename;
    unsigned int offset;
    int compress;
+   int in_place;
+   int optimal;
 } arg_config;
 
 static arg_config default_config =
@@ -462,12 +592,14 @@ static arg_config default_config =
    NULL,
    NULL,
    0,
-   1
+   1,
+   0,
+   0
 };
 
 static void print_usage(void)
 {
-   ERROR("Usage: mio0 [-c / -d] [-o OFFSET] FILE [OUTPUT]\n"
+   ERROR("Usage: mio0 [-c / -d] [-o OFFSET] [-t] [-p] FILE [OUTPUT]\n"
          "\n"
          "mio0 v" MIO0_VERSION ": MIO0 compression and decompression tool\n"
          "\n"
@@ -475,6 +607,11 @@ static void print_usage(void)
          " -c           compress raw data into MIO0 (default: compress)\n"
          " -d           decompress MIO0 into raw data\n"
          " -o OFFSET    starting offset in FILE (default: 0)\n"
+         " -t           when compressing, pad to 16 bytes and end with how much larger than the\n"
+         "              raw data a buffer needs to be to decompress the data at its end into it,\n"
+         "              followed by the raw size (both 32-bit big endian)\n"
+         " -p           when compressing, pick the matches that make the output the smallest,\n"
+         "              searching on every core\n"
          "\n"
          "File arguments:\n"
          " FILE        input file\n"
@@ -500,6 +637,12 @@ static void parse_arguments(int argc, char *argv[], arg_config *config)
             case 'd':
                config->compress = 0;
                break;
+            case 't':
+               config->in_place = 1;
+               break;
+            case 'p':
+               config->optimal = 1;
+               break;
             case 'o':
                if (++i >= argc) {
                   print_usage();
@@ -546,7 +689,7 @@ int main(int argc, char *argv[])
 
    // operation
    if (config.compress) {
-      ret_val = mio0_encode_file(config.in_filename, config.out_filename);
+      ret_val = mio0_encode_file(config.in_filename, config.out_filename, config.in_place, config.optimal);
    } else {
       ret_val = mio0_decode_file(config.in_filename, config.offset, config.out_filename);
    }
@@ -567,6 +710,9 @@ int main(int argc, char *argv[])
       case 5:
          ERROR("Error writing bytes to output file \"%s\"\n", config.out_filename);
          break;
+      case 6:
+         ERROR("Out of memory compressing \"%s\"\n", config.in_filename);
+         break;
    }
 
    return ret_val;
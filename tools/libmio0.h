@@ -4,6 +4,8 @@
 // defines
 
 #define MIO0_HEADER_LENGTH 16
+// in-place trailer: margin and decompressed size at the end of a file padded to 16 bytes
+#define MIO0_TRAILER_LENGTH 8
 
 // typedefs
 
@@ -36,6 +38,18 @@ int mio0_decode(const unsigned char *in, unsigned char *out, unsigned int *end);
 // returns size of compressed data in 'out' including MIO0 header
 int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out);
 
+// encode MIO0 data in memory, choosing the matches that make it the smallest
+// in: buffer containing raw data
+// out: buffer for MIO0 data
+// returns size of compressed data in 'out' including MIO0 header, negative value on failure
+int mio0_encode_optimal(const unsigned char *in, unsigned int length, unsigned char *out);
+
+// find how much larger than the decompressed data a buffer has to be for MIO0 data at its end to decode into it
+// in: buffer containing MIO0 data
+// file_size: size of the file the data ends up in, padding and trailer included
+// returns the margin, which keeps the end of the buffer 16 byte aligned
+unsigned int mio0_in_place_margin(const unsigned char *in, unsigned int file_size);
+
 // decode an entire MIO0 block at an offset from file to output file
 // in_file: input filename
 // offset: offset to start decoding from in_file
@@ -45,6 +59,8 @@ int mio0_decode_file(const char *in_file, unsigned long offset, const char *out_
 // encode an entire file
 // in_file: input filename containing raw data to be encoded
 // out_file: output filename to write MIO0 compressed data to
-int mio0_encode_file(const char *in_file, const char *out_file);
+// in_place: append the trailer for decompressing in place
+// optimal: encode with mio0_encode_optimal
+int mio0_encode_file(const char *in_file, const char *out_file, int in_place, int optimal);
 
 #endif // LIBMIO0_H_
@@ -0,0 +1,546 @@
+#!/usr/bin/env python3
+"""
+Generates lower detail versions of display lists in a model.inc.c and wraps them in GEO_RENDER_RANGE
+nodes in the model's geo.inc.c, so distant objects draw fewer triangles.
+
+Each display list is simplified on its own. Commands other than vertex loads and triangles are kept
+as they are, the geometry between them is simplified by collapsing edges into one of their vertices,
+cheapest first by quadric error. Since vertices only move onto other existing vertices, their UVs,
+colors and normals are kept, a corner that moves takes those of the closest matching vertex. Vertices
+that are also used by geometry with a different material are never moved, so materials don't crack
+apart, and open edges are weighted so the outline of a part keeps its shape.
+
+For each display list <name>, <name>_lod1, <name>_lod2, ... are appended to model.inc.c with their
+own vertex arrays and declared next to <name> in the header that declares it, which is looked for in
+the directories above model.inc.c. Every geo command drawing <name> in geo.inc.c is rewritten to
+choose one by distance. The command keeps its transform, so animated parts still take their animation values:
+
+  GEO_ANIMATED_PART(LAYER_OPAQUE, 0, 0, 0, NULL),
+  GEO_OPEN_NODE(),
+     GEO_RENDER_RANGE(-32768, 1500),
+     GEO_OPEN_NODE(),
+        GEO_DISPLAY_LIST(LAYER_OPAQUE, <name>),
+     GEO_CLOSE_NODE(),
+     GEO_RENDER_RANGE(1500, 3000),
+     ...
+
+Distances are in world units from the camera. With AUTO_LOD, emulators always draw the first level.
+
+Usage:
+  lod_gen.py [options] <model.inc.c> <geo.inc.c> <display list>...
+"""
+import argparse
+import glob
+import heapq
+import os
+import re
+import sys
+
+GEO_LOD_MIN = -0x8000
+GEO_LOD_MAX = 0x7FFF
+
+# Cost added per unit of squared distance from the line of an open edge, relative to surface error.
+BOUNDARY_WEIGHT = 10.0
+
+# Collapses that turn a triangle's normal further than this (cosine) are rejected.
+MIN_NORMAL_DOT = 0.2
+
+# Smallest geometry run that is simplified, anything smaller is kept as it is.
+MIN_RUN_TRIANGLES = 4
+
+VERTEX_RE = re.compile(r"gsSPVertex\(\s*(\w+)\s*(?:\+\s*(\w+)\s*)?,\s*(\w+)\s*,\s*(\w+)\s*\)")
+TRI1_RE = re.compile(r"gsSP1Triangle\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*\w+\s*\)")
+TRI2_RE = re.compile(r"gsSP2Triangles\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*\w+\s*,"
+                     r"\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*\w+\s*\)")
+
+
+def parse_int(token):
+    return int(token, 0)
+
+
+def strip_comments(text):
+    return re.sub(r"//[^\n]*|/\*.*?\*/", "", text, flags=re.S)
+
+
+def parse_vertex_arrays(text):
+    """
+    Returns {name: [(x, y, z, flag, s, t, r, g, b, a), ...]} for every Vtx array in the file.
+    """
+    arrays = {}
+    for match in re.finditer(r"Vtx\s+(\w+)\s*\[\s*\w*\s*\]\s*=\s*\{(.*?)\};", text, re.S):
+        vertices = []
+        for entry in re.finditer(r"\{\{\s*\{(.*?)\}\s*\}\s*\}", match.group(2), re.S):
+            values = [parse_int(token) for token in re.findall(r"-?(?:0x[0-9A-Fa-f]+|\d+)", entry.group(1))]
+            if len(values) == 10:
+                vertices.append(tuple(values))
+        arrays[match.group(1)] = vertices
+    return arrays
+
+
+def parse_display_list(text, name):
+    """
+    Returns the commands of a Gfx array as a list of strings, without the trailing commas.
+    """
+    match = re.search(r"Gfx\s+" + re.escape(name) + r"\s*\[\s*\w*\s*\]\s*=\s*\{(.*?)\};", text, re.S)
+    if match is None:
+        raise ValueError("display list {} not found".format(name))
+
+    commands = []
+    depth = 0
+    current = ""
+    for char in match.group(1):
+        if char == "," and depth == 0:
+            if current.strip():
+                commands.append(current.strip())
+            current = ""
+            continue
+        depth += (char == "(") - (char == ")")
+        current += char
+    if current.strip():
+        commands.append(current.strip())
+    return commands
+
+
+def split_runs(commands, arrays, cache_size):
+    """
+    Splits a display list into kept commands and runs of geometry. Returns a list of items that are
+    either a command string or a list of triangles, each a tuple of three (array, index) references.
+    """
+    items = []
+    cache = [None] * cache_size
+    run = None
+
+    for command in commands:
+        vertex = VERTEX_RE.fullmatch(command)
+        tri1 = TRI1_RE.fullmatch(command)
+        tri2 = TRI2_RE.fullmatch(command)
+
+        if vertex is not None:
+            array, offset = vertex.group(1), parse_int(vertex.group(2) or "0")
+            count, dest = parse_int(vertex.group(3)), parse_int(vertex.group(4))
+            if array not in arrays:
+                raise ValueError("vertex array {} not found".format(array))
+            for i in range(count):
+                cache[dest + i] = (array, offset + i)
+            if run is None:
+                run = []
+                items.append(run)
+        elif tri1 is not None or tri2 is not None:
+            indices = [parse_int(token) for token in (tri1 or tri2).groups()]
+            if run is None:
+                raise ValueError("triangles before the first vertex load")
+            for i in range(0, len(indices), 3):
+                run.append(tuple(cache[index] for index in indices[i:i + 3]))
+        else:
+            # Other commands can change the material, the cache doesn't survive them in the output.
+            run = None
+            items.append(command)
+
+    return items
+
+
+def sub(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+
+def cross(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+
+def dot(a, b):
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+
+def plane_quadric(normal, point, weight):
+    """
+    Returns the quadric of the squared distance to a plane as 10 coefficients.
+    """
+    a, b, c = normal
+    d = -dot(normal, point)
+    return [weight * value for value in (a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d)]
+
+
+def quadric_error(q, p):
+    x, y, z = p
+    return (q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+            + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+            + q[7] * z * z + 2 * q[8] * z + q[9])
+
+
+class Mesh:
+    """
+    Triangles of one geometry run, welded by position.
+    """
+
+    def __init__(self, triangles, arrays, locked_positions):
+        self.positions = []
+        self.position_ids = {}
+        self.triangles = []  # [position ids, corner vertex refs], None once removed
+        self.corners = {}    # position id -> vertex refs seen there
+
+        for triangle in triangles:
+            ids = []
+            for ref in triangle:
+                vertex = arrays[ref[0]][ref[1]]
+                pos = vertex[0:3]
+                if pos not in self.position_ids:
+                    self.position_ids[pos] = len(self.positions)
+                    self.positions.append(pos)
+                ids.append(self.position_ids[pos])
+                self.corners.setdefault(ids[-1], set()).add(ref)
+            if len(set(ids)) == 3:
+                self.triangles.append([ids, list(triangle)])
+
+        self.locked = {self.position_ids[pos] for pos in locked_positions if pos in self.position_ids}
+        self.vertex_triangles = {i: set() for i in range(len(self.positions))}
+        for t, (ids, _) in enumerate(self.triangles):
+            for i in ids:
+                self.vertex_triangles[i].add(t)
+
+        self.quadrics = [[0.0] * 10 for _ in self.positions]
+        edge_count = {}
+        for ids, _ in self.triangles:
+            normal = self.normal(ids)
+            length = dot(normal, normal) ** 0.5
+            if length == 0:
+                continue
+            unit = tuple(n / length for n in normal)
+            q = plane_quadric(unit, self.positions[ids[0]], length / 2)
+            for i in ids:
+                self.add_quadric(i, q)
+            for k in range(3):
+                edge = (ids[k], ids[(k + 1) % 3])
+                edge_count[edge] = edge_count.get(edge, 0) + 1
+                edge_count.setdefault(edge[::-1], 0)
+
+        # Open edges get a plane through them perpendicular to the surface.
+        for ids, _ in self.triangles:
+            normal = self.normal(ids)
+            for k in range(3):
+                a, b = ids[k], ids[(k + 1) % 3]
+                if edge_count[(b, a)] == 0:
+                    along = sub(self.positions[b], self.positions[a])
+                    side = cross(along, normal)
+                    length = dot(side, side) ** 0.5
+                    if length == 0:
+                        continue
+                    unit = tuple(n / length for n in side)
+                    q = plane_quadric(unit, self.positions[a], BOUNDARY_WEIGHT * dot(along, along) ** 0.5)
+                    self.add_quadric(a, q)
+                    self.add_quadric(b, q)
+
+    def add_quadric(self, i, q):
+        self.quadrics[i] = [a + b for a, b in zip(self.quadrics[i], q)]
+
+    def normal(self, ids):
+        p0, p1, p2 = (self.positions[i] for i in ids)
+        return cross(sub(p1, p0), sub(p2, p0))
+
+    def num_triangles(self):
+        return sum(1 for triangle in self.triangles if triangle is not None)
+
+    def neighbors(self, i):
+        result = set()
+        for t in self.vertex_triangles[i]:
+            result.update(self.triangles[t][0])
+        result.discard(i)
+        return result
+
+    def collapse_cost(self, u, v):
+        """
+        Returns the cost of moving u onto v, or None if that would break the mesh.
+        """
+        if u in self.locked:
+            return None
+
+        shared = self.neighbors(u) & self.neighbors(v)
+        edge_triangles = [t for t in self.vertex_triangles[u] if v in self.triangles[t][0]]
+        if not edge_triangles or len(shared) > len(edge_triangles):
+            # Not an edge, or collapsing it would pinch the surface.
+            return None
+
+        for t in self.vertex_triangles[u]:
+            ids = self.triangles[t][0]
+            if v in ids:
+                continue
+            moved = [v if i == u else i for i in ids]
+            old, new = self.normal(ids), self.normal(moved)
+            old_length, new_length = dot(old, old) ** 0.5, dot(new, new) ** 0.5
+            if new_length == 0 or (old_length > 0 and dot(old, new) < MIN_NORMAL_DOT * old_length * new_length):
+                return None
+
+        q = [a + b for a, b in zip(self.quadrics[u], self.quadrics[v])]
+        return quadric_error(q, self.positions[v])
+
+    def closest_corner(self, ref, v, arrays):
+        """
+        Returns the vertex at position v whose UV and color or normal are closest to those of ref.
+        """
+        vertex = arrays[ref[0]][ref[1]]
+
+        def distance(other_ref):
+            other = arrays[other_ref[0]][other_ref[1]]
+            return sum((a - b) ** 2 for a, b in zip(vertex[4:10], other[4:10]))
+
+        return min(sorted(self.corners[v]), key=distance)
+
+    def collapse(self, u, v, arrays):
+        for t in list(self.vertex_triangles[u]):
+            ids, refs = self.triangles[t]
+            if v in ids:
+                self.triangles[t] = None
+                for i in ids:
+                    self.vertex_triangles[i].discard(t)
+                continue
+            k = ids.index(u)
+            ids[k] = v
+            refs[k] = self.closest_corner(refs[k], v, arrays)
+            self.vertex_triangles[v].add(t)
+        self.vertex_triangles[u] = set()
+        self.add_quadric(v, self.quadrics[u])
+
+    def simplify(self, target, arrays):
+        heap = []
+        version = [0] * len(self.positions)
+
+        def push(u):
+            for v in self.neighbors(u):
+                cost = self.collapse_cost(u, v)
+                if cost is not None:
+                    heapq.heappush(heap, (cost, u, v, version[u], version[v]))
+
+        for u in range(len(self.positions)):
+            push(u)
+
+        count = self.num_triangles()
+        while count > target and heap:
+            cost, u, v, version_u, version_v = heapq.heappop(heap)
+            if version_u != version[u] or version_v != version[v]:
+                continue
+            if self.collapse_cost(u, v) is None:
+                continue
+            self.collapse(u, v, arrays)
+            count = self.num_triangles()
+            for i in [v] + list(self.neighbors(v)):
+                version[i] += 1
+            for i in [v] + list(self.neighbors(v)):
+                push(i)
+
+        return [refs for triangle in self.triangles if triangle is not None for refs in [triangle[1]]]
+
+
+def batch_triangles(triangles, cache_size):
+    """
+    Splits triangles into batches that each fit in the vertex cache. Returns (vertex refs, triangles as
+    cache indices) for every batch.
+    """
+    batches = []
+    refs, indices, tris = [], {}, []
+    for triangle in triangles:
+        new = [ref for ref in dict.fromkeys(triangle) if ref not in indices]
+        if len(refs) + len(new) > cache_size:
+            batches.append((refs, tris))
+            refs, indices, tris = [], {}, []
+            new = list(dict.fromkeys(triangle))
+        for ref in new:
+            indices[ref] = len(refs)
+            refs.append(ref)
+        tris.append(tuple(indices[ref] for ref in triangle))
+    if tris:
+        batches.append((refs, tris))
+    return batches
+
+
+def format_vertex(vertex):
+    x, y, z, flag, s, t, r, g, b, a = vertex
+    return "    {{{{{{{:6d}, {:6d}, {:6d}}}, {}, {{{:6d}, {:6d}}}, {{0x{:02x}, 0x{:02x}, 0x{:02x}, 0x{:02x}}}}}}},".format(
+        x, y, z, flag, s, t, r & 0xFF, g & 0xFF, b & 0xFF, a & 0xFF)
+
+
+def make_lod(name, lod_name, items, arrays, ratio, cache_size):
+    """
+    Returns the C source of one level of detail and its triangle counts before and after.
+    """
+    # Positions used by more than one run are where materials meet.
+    runs = [item for item in items if isinstance(item, list)]
+    run_positions = [{arrays[ref[0]][ref[1]][0:3] for tri in run for ref in tri} for run in runs]
+    seen, locked = set(), set()
+    for positions in run_positions:
+        locked |= positions & seen
+        seen |= positions
+
+    vertex_arrays = []
+    commands = []
+    before = after = 0
+    for item in items:
+        if not isinstance(item, list):
+            commands.append(item)
+            continue
+
+        before += len(item)
+        triangles = item
+        if len(item) >= MIN_RUN_TRIANGLES:
+            mesh = Mesh(item, arrays, locked)
+            triangles = mesh.simplify(max(1, int(round(len(item) * ratio))), arrays)
+        after += len(triangles)
+
+        for refs, tris in batch_triangles(triangles, cache_size):
+            array_name = "{}_vertex_{}".format(lod_name, len(vertex_arrays))
+            vertex_arrays.append("static const Vtx {}[] = {{\n{}\n}};\n".format(
+                array_name, "\n".join(format_vertex(arrays[ref[0]][ref[1]]) for ref in refs)))
+            commands.append("gsSPVertex({}, {}, 0)".format(array_name, len(refs)))
+            for i in range(0, len(tris) - 1, 2):
+                commands.append("gsSP2Triangles({:2d}, {:2d}, {:2d}, 0x0, {:2d}, {:2d}, {:2d}, 0x0)".format(
+                    *tris[i], *tris[i + 1]))
+            if len(tris) % 2 != 0:
+                commands.append("gsSP1Triangle({:2d}, {:2d}, {:2d}, 0x0)".format(*tris[-1]))
+
+    source = "\n// {} at {:.0f}% of the triangles of {}, made by tools/lod_gen.py\n".format(lod_name, ratio * 100, name)
+    source += "\n".join(vertex_arrays)
+    source += "\nconst Gfx {}[] = {{\n{}\n}};\n".format(lod_name, "\n".join("    {},".format(c) for c in commands))
+    return source, before, after
+
+
+def rewrite_geo(lines, name, lod_names, distances):
+    """
+    Wraps every geo command drawing the display list in render ranges. Returns the new lines and how
+    many commands were rewritten.
+    """
+    command_re = re.compile(r"^(\s*)(GEO_\w+)\((\s*[^,()]+)((?:,[^,()]*)*),\s*" + re.escape(name) + r"\s*\)(,?.*)$")
+    ranges = list(zip([GEO_LOD_MIN] + distances, distances + [GEO_LOD_MAX]))
+    result = []
+    count = 0
+    i = 0
+
+    while i < len(lines):
+        line = lines[i]
+        i += 1
+        match = command_re.match(line)
+        if match is None:
+            result.append(line)
+            continue
+
+        indent, command, layer = match.group(1), match.group(2), match.group(3).strip()
+        count += 1
+
+        lod_lines = []
+        for (lo, hi), lod_name in zip(ranges, [name] + lod_names):
+            lod_lines += [
+                "GEO_RENDER_RANGE({}, {}),".format(lo, hi),
+                "GEO_OPEN_NODE(),",
+                "   GEO_DISPLAY_LIST({}, {}),".format(layer, lod_name),
+                "GEO_CLOSE_NODE(),",
+            ]
+
+        has_children = i < len(lines) and lines[i].strip().startswith("GEO_OPEN_NODE")
+        if command == "GEO_DISPLAY_LIST" and not has_children:
+            result += [indent + lod_line for lod_line in lod_lines]
+            continue
+
+        # Keep the command for its transform and children, the render ranges become its first children.
+        result.append("{}{}({}{}, NULL){}".format(indent, command, match.group(3), match.group(4), match.group(5)))
+        if has_children:
+            result.append(lines[i])
+            i += 1
+            result += [indent + "   " + lod_line for lod_line in lod_lines]
+        else:
+            result.append(indent + "GEO_OPEN_NODE(),")
+            result += [indent + "   " + lod_line for lod_line in lod_lines]
+            result.append(indent + "GEO_CLOSE_NODE(),")
+
+    return result, count
+
+
+def find_header(model_path, name):
+    """
+    Returns the path of the header declaring the display list, such as actors/common0.h for the goomba.
+    """
+    declaration = re.compile(r"extern\s+const\s+Gfx\s+" + re.escape(name) + r"\s*\[\s*\]\s*;")
+    directory = os.path.dirname(os.path.abspath(model_path))
+    for _ in range(4):
+        for path in sorted(glob.glob(os.path.join(directory, "*.h"))):
+            with open(path) as f:
+                if declaration.search(f.read()):
+                    return path
+        directory = os.path.dirname(directory)
+    return None
+
+
+def declare_lods(header, name, lod_names):
+    declaration = re.compile(r"^(\s*extern\s+const\s+Gfx\s+)" + re.escape(name) + r"(\s*\[\s*\]\s*;.*)$", re.M)
+    match = declaration.search(header)
+    lines = "".join("\n{}{}{}".format(match.group(1), lod_name, match.group(2)) for lod_name in lod_names)
+    return header[:match.end()] + lines + header[match.end():]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates levels of detail for display lists of a model.")
+    parser.add_argument("model", help="model.inc.c with the display lists, the LODs are appended to it")
+    parser.add_argument("geo", help="geo.inc.c drawing them, rewritten to choose a LOD by distance")
+    parser.add_argument("display_lists", nargs="+", help="names of the display lists")
+    parser.add_argument("-r", "--ratios", default="0.5,0.25",
+                        help="fraction of the triangles each LOD keeps (default 0.5,0.25)")
+    parser.add_argument("-d", "--distances", default="1500,3000",
+                        help="distance from the camera each LOD starts at (default 1500,3000)")
+    parser.add_argument("-c", "--vertex-cache", type=int, default=32,
+                        help="vertices loaded at once in the LODs (default 32)")
+    parser.add_argument("-n", "--dry-run", action="store_true", help="only print how many triangles are kept")
+    args = parser.parse_args()
+
+    ratios = [float(r) for r in args.ratios.split(",")]
+    distances = [int(d) for d in args.distances.split(",")]
+    if len(ratios) != len(distances):
+        sys.exit("there must be as many distances as ratios")
+    if distances != sorted(distances) or distances[0] <= GEO_LOD_MIN or distances[-1] >= GEO_LOD_MAX:
+        sys.exit("distances must be increasing and fit in an s16")
+
+    with open(args.model) as f:
+        model = f.read()
+    with open(args.geo) as f:
+        geo_lines = f.read().split("\n")
+
+    text = strip_comments(model)
+    arrays = parse_vertex_arrays(text)
+    appended = ""
+    headers = {}
+
+    for name in args.display_lists:
+        lod_names = ["{}_lod{}".format(name, i + 1) for i in range(len(ratios))]
+        if re.search(r"\b" + re.escape(lod_names[0]) + r"\b", text):
+            sys.exit("{} already has LODs".format(name))
+
+        header_path = find_header(args.model, name)
+        if header_path is None:
+            sys.exit("no header above {} declares {}".format(args.model, name))
+        if header_path not in headers:
+            with open(header_path) as f:
+                headers[header_path] = f.read()
+        headers[header_path] = declare_lods(headers[header_path], name, lod_names)
+
+        items = split_runs(parse_display_list(text, name), arrays, max(64, args.vertex_cache))
+        if not any(isinstance(item, list) for item in items):
+            sys.exit("{} has no triangles".format(name))
+
+        for ratio, lod_name in zip(ratios, lod_names):
+            source, before, after = make_lod(name, lod_name, items, arrays, ratio, args.vertex_cache)
+            print("{}: {} -> {} triangles".format(lod_name, before, after))
+            appended += source
+
+        geo_lines, count = rewrite_geo(geo_lines, name, lod_names, distances)
+        if count == 0:
+            print("warning: {} isn't drawn by any geo command in {}".format(name, args.geo), file=sys.stderr)
+
+    if args.dry_run:
+        return
+
+    with open(args.model, "a") as f:
+        f.write(appended)
+    with open(args.geo, "w") as f:
+        f.write("\n".join(geo_lines))
+    for path, header in headers.items():
+        with open(path, "w") as f:
+            f.write(header)
+
+
+if __name__ == "__main__":
+    main()
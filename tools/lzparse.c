@@ -0,0 +1,252 @@
+#include <stdlib.h>
+#include <pthread.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "lzparse.h"
+#include "utils.h"
+
+// defines
+
+#define HASH_BITS 16
+#define NO_POSITION (-1)
+#define NICE_LENGTH 128
+
+// types
+typedef struct
+{
+   const unsigned char *in;
+   int length;
+   const lz_config *config;
+   const int *prev;  // previous position with the same hash of 3 bytes
+   const int *prev2; // previous position starting with the same 2 bytes
+   lz_match_table *table;
+   int start;
+   int end;
+} search_job;
+
+// functions
+static int default_thread_count(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwNumberOfProcessors;
+#else
+   long count = sysconf(_SC_NPROCESSORS_ONLN);
+   return count > 0 ? count : 1;
+#endif
+}
+
+static inline unsigned int hash3(const unsigned char *buf)
+{
+   unsigned int key = (buf[0] << 16) | (buf[1] << 8) | buf[2];
+   return (key * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static inline int match_length(const unsigned char *in, int pos, int from, int max_length)
+{
+   int i = 0;
+   while (i < max_length && in[from + i] == in[pos + i]) {
+      i++;
+   }
+   return i;
+}
+
+// record a match that's longer than the ones found closer to pos
+static inline void add_candidate(lz_match_table *table, int pos, int length, int offset)
+{
+   lz_match *matches = &table->matches[pos * LZ_MAX_CANDIDATES];
+   int count = table->counts[pos];
+
+   // when full, the longest match replaces the last one instead
+   if (count == LZ_MAX_CANDIDATES) {
+      count--;
+   }
+   matches[count].length = length;
+   matches[count].offset = offset;
+   table->counts[pos] = count + 1;
+}
+
+static void *search_range(void *arg)
+{
+   search_job *job = arg;
+   const unsigned char *in = job->in;
+   const lz_config *config = job->config;
+
+   for (int pos = job->start; pos < job->end; pos++) {
+      int max_length = MIN(config->max_length, job->length - pos);
+      int best = config->min_length - 1;
+      int steps = 0;
+      int from;
+
+      if (max_length < config->min_length) {
+         continue;
+      }
+
+      // the closest pair of bytes is the best match of 2 there is
+      if (config->min_length == 2) {
+         from = job->prev2[pos];
+         if (from != NO_POSITION && pos - from <= config->max_offset) {
+            int length = match_length(in, pos, from, max_length);
+            add_candidate(job->table, pos, length, pos - from);
+            best = length;
+         }
+      }
+
+      for (from = job->prev[pos]; from != NO_POSITION && best < max_length; from = job->prev[from]) {
+         if (pos - from > config->max_offset || steps++ >= config->max_chain) {
+            break;
+         }
+         // only a match longer than the best one so far is worth comparing
+         if (in[from + best] == in[pos + best]) {
+            int length = match_length(in, pos, from, max_length);
+            if (length > best) {
+               add_candidate(job->table, pos, length, pos - from);
+               best = length;
+            }
+         }
+      }
+   }
+   return NULL;
+}
+
+int lz_find_matches(const unsigned char *in, int length, const lz_config *config, lz_match_table *table)
+{
+   int thread_count = config->threads ? config->threads : default_thread_count();
+   int *head = malloc((1 << HASH_BITS) * sizeof(*head));
+   int *prev = malloc(length * sizeof(*prev));
+   int *prev2 = NULL;
+   pthread_t *threads = malloc(thread_count * sizeof(*threads));
+   search_job *jobs = malloc(thread_count * sizeof(*jobs));
+   int started;
+
+   table->length = length;
+   table->min_length = config->min_length;
+   table->matches = malloc((size_t)length * LZ_MAX_CANDIDATES * sizeof(*table->matches));
+   table->counts = calloc(length, 1);
+   if (config->min_length == 2) {
+      prev2 = malloc(length * sizeof(*prev2));
+   }
+   if (!head || !prev || !threads || !jobs || !table->matches || !table->counts || (config->min_length == 2 && !prev2)) {
+      free(head);
+      free(prev);
+      free(prev2);
+      free(threads);
+      free(jobs);
+      lz_free_matches(table);
+      return 1;
+   }
+
+   // chain together the positions with the same first 3 bytes, the searches only read these
+   for (int i = 0; i < (1 << HASH_BITS); i++) {
+      head[i] = NO_POSITION;
+   }
+   for (int pos = 0; pos < length; pos++) {
+      if (pos + 3 <= length) {
+         unsigned int hash = hash3(&in[pos]);
+         prev[pos] = head[hash];
+         head[hash] = pos;
+      } else {
+         prev[pos] = NO_POSITION;
+      }
+   }
+   if (config->min_length == 2) {
+      for (int i = 0; i < (1 << HASH_BITS); i++) {
+         head[i] = NO_POSITION;
+      }
+      for (int pos = 0; pos + 2 <= length; pos++) {
+         unsigned int key = (in[pos] << 8) | in[pos + 1];
+         prev2[pos] = head[key];
+         head[key] = pos;
+      }
+      if (length > 0) {
+         prev2[length - 1] = NO_POSITION;
+      }
+   }
+
+   // every position is searched on its own, so the buffer is split evenly between the threads
+   for (int i = 0; i < thread_count; i++) {
+      jobs[i].in = in;
+      jobs[i].length = length;
+      jobs[i].config = config;
+      jobs[i].prev = prev;
+      jobs[i].prev2 = prev2;
+      jobs[i].table = table;
+      jobs[i].start = (int)((long long)length * i / thread_count);
+      jobs[i].end = (int)((long long)length * (i + 1) / thread_count);
+   }
+   for (started = 1; started < thread_count; started++) {
+      if (pthread_create(&threads[started], NULL, search_range, &jobs[started])) {
+         break;
+      }
+   }
+   search_range(&jobs[0]);
+   // the ranges of threads that couldn't be started are searched here too
+   for (int i = started; i < thread_count; i++) {
+      search_range(&jobs[i]);
+   }
+   for (int i = 1; i < started; i++) {
+      pthread_join(threads[i], NULL);
+   }
+
+   free(head);
+   free(prev);
+   free(prev2);
+   free(threads);
+   free(jobs);
+
+   return 0;
+}
+
+void lz_free_matches(lz_match_table *table)
+{
+   free(table->matches);
+   free(table->counts);
+   table->matches = NULL;
+   table->counts = NULL;
+}
+
+unsigned int lz_optimal_parse(const lz_match_table *table, int start, int end, unsigned int literal_price,
+                              lz_match_price match_price, void *arg, lz_match *parse)
+{
+   unsigned int *cost = malloc((end - start + 1) * sizeof(*cost));
+   unsigned int total;
+
+   // the cheapest price from each position to the end, working back from the end
+   cost[end - start] = 0;
+   for (int pos = end - 1; pos >= start; pos--) {
+      const lz_match *matches = &table->matches[pos * LZ_MAX_CANDIDATES];
+      unsigned int best = literal_price + cost[pos + 1 - start];
+      lz_match choice = { 0, 0 };
+      int length = table->min_length;
+
+      // each candidate is the closest match for the lengths up to its own
+      for (int i = 0; i < table->counts[pos]; i++) {
+         int max_length = MIN(matches[i].length, end - pos);
+         for (; length <= max_length; length++) {
+            unsigned int price;
+            // past NICE_LENGTH only the whole match is tried, runs of the same bytes would take forever otherwise
+            if (length > NICE_LENGTH && length < max_length) {
+               length = max_length;
+            }
+            price = match_price(arg, length, matches[i].offset);
+            // on a tie, the longer match leaves the decoder less to do
+            if (price != LZ_PRICE_INVALID && price + cost[pos + length - start] <= best) {
+               best = price + cost[pos + length - start];
+               choice.length = length;
+               choice.offset = matches[i].offset;
+            }
+         }
+      }
+      cost[pos - start] = best;
+      parse[pos] = choice;
+   }
+
+   total = cost[0];
+   free(cost);
+   return total;
+}
@@ -0,0 +1,63 @@
+#ifndef LZPARSE_H_
+#define LZPARSE_H_
+
+// defines
+
+// most matches kept per position, each one longer and farther back than the one before
+#define LZ_MAX_CANDIDATES 8
+
+// price of something the format can't store
+#define LZ_PRICE_INVALID 0xFFFFFFFFu
+
+// typedefs
+
+typedef struct
+{
+   unsigned short length;
+   unsigned short offset; // how far back the match starts, 1 for the byte just before
+} lz_match;
+
+typedef struct
+{
+   int min_length; // shortest match the format can store, 2 or 3
+   int max_length; // longest match the format can store
+   int max_offset; // farthest back a match can start
+   int max_chain;  // most earlier positions looked at per position
+   int threads;    // threads to search with, 0 for one per core
+} lz_config;
+
+typedef struct
+{
+   lz_match *matches;     // LZ_MAX_CANDIDATES entries per position
+   unsigned char *counts; // how many of the entries of each position are used
+   int length;
+   int min_length;
+} lz_match_table;
+
+// price in bits of a match of length bytes from offset bytes back
+typedef unsigned int (*lz_match_price)(void *arg, int length, int offset);
+
+// function prototypes
+
+// find the matches at every position of a buffer, splitting the buffer between threads
+// in: buffer containing raw data
+// length: size of in
+// config: what the format can store and how hard to search
+// table: filled with the matches, free with lz_free_matches
+// returns 0 on success
+int lz_find_matches(const unsigned char *in, int length, const lz_config *config, lz_match_table *table);
+
+// free the matches found by lz_find_matches
+void lz_free_matches(lz_match_table *table);
+
+// choose the cheapest way to store the bytes from start to end as literals and matches
+// table: matches found in the whole buffer, matches that go past end aren't used
+// literal_price: price in bits of a literal byte
+// match_price: price of a match, LZ_PRICE_INVALID for ones that can't be stored
+// parse: for each position, the match to use there or a length of 0 for a literal.
+//        Only the positions reached going forward from start are set
+// returns the price of the whole range in bits
+unsigned int lz_optimal_parse(const lz_match_table *table, int start, int end, unsigned int literal_price,
+                              lz_match_price match_price, void *arg, lz_match *parse);
+
+#endif // LZPARSE_H_
@@ -4,6 +4,8 @@ import os
 import traceback
 import sys
 
+import anim_compress
+
 num_headers = 0
 items = []
 len_mapping = {}
@@ -73,7 +75,35 @@ def parse_file(filename, lines):
             name = lines[lineindex][len("s16 "):-6]
             lineindex = parse_array(filename, lines, lineindex, name, is_indices)
 
+def compress_items(max_error):
+    """
+    Replaces the index and value arrays with the compact format from anim_compress.py.
+    """
+    arrays = {name: obj for type, name, obj in items if type == "array"}
+    compressed = {}
+    partners = {}
+    for type, name, obj in items:
+        if type == "header":
+            values, indices = obj[5], obj[6]
+            if partners.setdefault(indices, values) != values:
+                raise SyntaxError("Error: " + indices + " is used with more than one values array, which can't be compressed")
+            if indices not in compressed:
+                new_indices, new_values = anim_compress.compress_animation(
+                    [int(v, 0) for v in arrays[indices][1]], [int(v, 0) for v in arrays[values][1]], max_error)
+                compressed[indices] = ["0x{:04X}".format(v & 0xFFFF) for v in new_indices]
+                compressed[values] = ["0x{:04X}".format(v & 0xFFFF) for v in new_values]
+
+    for i, (type, name, obj) in enumerate(items):
+        if type == "header":
+            v1, v2, v3, v4, v5, values, indices = obj
+            items[i] = (type, name, (v1 | anim_compress.ANIM_FLAG_COMPRESSED, v2, v3, v4, v5, values, indices))
+        elif name in compressed:
+            items[i] = (type, name, (obj[0], compressed[name]))
+
 try:
+    compress = "--compress" in sys.argv[1:]
+    max_error = int(sys.argv[sys.argv.index("--max-error") + 1]) if "--max-error" in sys.argv[1:] else 0
+
     files = os.listdir("assets/anims")
     files.sort()
 
@@ -93,6 +123,9 @@ try:
             if lines:
                 parse_file(filename, lines)
 
+    if compress:
+        compress_items(max_error)
+
     structdef = ["u32 numEntries;", "const struct Animation *addrPlaceholder;", "struct OffsetSizePair entries[" + str(num_headers) + "];"]
     structobj = [str(num_headers) + ",", "NULL,","{"]
 
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Converts a frame trace recorded with PROFILER_TRACE into Chrome trace-event JSON, which can be opened
+in chrome://tracing or https://ui.perfetto.dev.
+
+The input is either a file UNFLoader saved from USB, or gProfilerTraceSlowFrame dumped from an emulator
+(struct ProfilerTrace in src/game/profiling.h, big-endian). Anything past numEvents is ignored.
+
+If the map file of the build is given, behavior addresses are shown as behavior names.
+"""
+import sys
+import json
+import struct
+
+PROFILER_TRACE_MAGIC = 0x50545243
+PROFILER_TRACE_VERSION = 1
+
+HEADER_FORMAT = ">IHHIII"
+EVENT_FORMAT = ">IBBHI"
+
+# osGetCount() runs at half the CPU clock.
+COUNTS_PER_USEC = 46.875
+
+# Must match enum ProfilerTraceZone in src/game/profiling.h.
+sZoneNames = [
+    "Frame",
+    "Objects",
+    "Behavior",
+    "Collision",
+    "Graph",
+    "Audio",
+    "RSP gfx",
+    "RSP audio",
+]
+
+THREAD_GAME = 1
+THREAD_AUDIO = 2
+THREAD_RSP = 3
+
+sThreadNames = {
+    THREAD_GAME: "Game",
+    THREAD_AUDIO: "Audio",
+    THREAD_RSP: "RSP",
+}
+
+sZoneThreads = {
+    "Audio": THREAD_AUDIO,
+    "RSP gfx": THREAD_RSP,
+    "RSP audio": THREAD_RSP,
+}
+
+
+def read_map_symbols(path):
+    symbols = {}
+    with open(path) as f:
+        for line in f:
+            tokens = line.split()
+            # Symbol lines look like "0x0000000080123456                bhvGoomba"
+            if len(tokens) == 2 and tokens[0].startswith("0x00000000") and tokens[1].isidentifier():
+                symbols[int(tokens[0], 16)] = tokens[1]
+    return symbols
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    if len(data) < header_size:
+        sys.exit("{}: too short for a trace".format(path))
+
+    magic, version, event_size, frame, num_events, num_dropped = struct.unpack_from(HEADER_FORMAT, data)
+    if magic != PROFILER_TRACE_MAGIC:
+        sys.exit("{}: not a profiler trace".format(path))
+    if version != PROFILER_TRACE_VERSION or event_size != struct.calcsize(EVENT_FORMAT):
+        sys.exit("{}: trace version {} isn't supported".format(path, version))
+
+    num_events = min(num_events, (len(data) - header_size) // event_size)
+    events = [struct.unpack_from(EVENT_FORMAT, data, header_size + i * event_size) for i in range(num_events)]
+    return frame, num_dropped, events
+
+
+def convert(frame, events, symbols):
+    trace_events = []
+    stacks = {tid: [] for tid in sThreadNames}
+    last_count = None
+    time = 0
+
+    for tid, name in sThreadNames.items():
+        trace_events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}})
+
+    for count, zone, is_end, _, arg in events:
+        # The count register wraps every ~90 seconds, events are in order so just track the deltas.
+        if last_count is not None:
+            time += (count - last_count) & 0xFFFFFFFF
+        last_count = count
+
+        name = sZoneNames[zone] if zone < len(sZoneNames) else "Zone {}".format(zone)
+        tid = sZoneThreads.get(name, THREAD_GAME)
+        stack = stacks[tid]
+        ts = time / COUNTS_PER_USEC
+
+        if not is_end:
+            event = {"name": name, "ph": "B", "pid": 1, "tid": tid, "ts": ts}
+            if name == "Behavior":
+                event["name"] = symbols.get(arg, "0x{:08X}".format(arg))
+            elif name == "Frame":
+                event["args"] = {"frame": arg}
+            stack.append(zone)
+            trace_events.append(event)
+        elif zone in stack:
+            # Close anything left open inside it, such as an object that spawned and deleted in one update.
+            while stack:
+                open_zone = stack.pop()
+                trace_events.append({"ph": "E", "pid": 1, "tid": tid, "ts": ts})
+                if open_zone == zone:
+                    break
+        # Otherwise it began before the trace did, e.g. an RSP task started last frame.
+
+    # And things that end after it, such as the gfx task of this frame.
+    end_ts = time / COUNTS_PER_USEC
+    for tid, stack in stacks.items():
+        for _ in stack:
+            trace_events.append({"ph": "E", "pid": 1, "tid": tid, "ts": end_ts})
+
+    return {"traceEvents": trace_events, "otherData": {"frame": frame}}
+
+
+def main():
+    if len(sys.argv) < 2 or len(sys.argv) > 3 or sys.argv[1] in ("-h", "--help"):
+        print("Usage: {} <trace.bin> [sm64.map] > <trace.json>".format(sys.argv[0]))
+        sys.exit(0 if len(sys.argv) == 2 else 1)
+
+    symbols = read_map_symbols(sys.argv[2]) if len(sys.argv) == 3 else {}
+    frame, num_dropped, events = read_trace(sys.argv[1])
+    if num_dropped > 0:
+        print("warning: {} events didn't fit in the trace buffer".format(num_dropped), file=sys.stderr)
+
+    json.dump(convert(frame, events, symbols), sys.stdout)
+    print()
+
+
+if __name__ == "__main__":
+    main()
@@ -6,6 +6,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "lzparse.h"
+
 #ifndef _WIN32
 #include <sys/stat.h>
 #else
@@ -70,6 +72,14 @@ typedef struct vars_s {
     uint32 leeway;
     uint32 chunks_count;
 
+    uint32 in_place;
+    int in_place_read, in_place_written, in_place_lead;
+
+    uint32 optimal;
+    lz_match_table matches;
+    lz_match *parse;
+    lz_match *best_parse;
+
     uint8 *mem1;
     uint8 *pack_block_start;
     uint8 *pack_block_max;
@@ -238,6 +248,8 @@ vars_t *init_vars()
     v->dict_size = 0xFFFF;
     v->method = 1;
     v->puse_mode = 'p';
+    v->in_place = 0;
+    v->optimal = 0;
 
     v->read_start_offset = 0;
     v->write_start_offset = 0;
@@ -882,13 +894,223 @@ void proc_19(vars_t *v, huftable_t *data, int count)
         write_bits_m1(v, count - (1 << (bits - 1)), bits - 1);
 }
 
+// Prices for the optimal parse are in 1/16 bits, so literals can carry a share of the literal run lengths
+#define PRICE_SCALE 16
+#define OPTIMAL_PASSES 4
+#define OPTIMAL_MAX_LITERALS 0x200
+
+typedef struct price_tables_s {
+    uint16 raw[16];
+    uint16 len[16];
+    uint16 pos[16];
+    uint32 literal;
+} price_tables_t;
+
+uint32 symbol_price(const uint16 *depths, uint16 value)
+{
+    int bits = (value <= 1) ? value : bits_count(value);
+
+    // symbols the last pass didn't use get a long code
+    return (depths[bits] ? depths[bits] : 12) + ((bits > 1) ? bits - 1 : 0);
+}
+
+unsigned int match_price_m1(void *arg, int length, int offset)
+{
+    price_tables_t *prices = (price_tables_t *)arg;
+
+    return (symbol_price(prices->raw, 0) + symbol_price(prices->pos, length - 2) + symbol_price(prices->len, offset - 1)) * PRICE_SCALE;
+}
+
+unsigned int match_price_m2(void *arg, int length, int offset)
+{
+    int offset_bits = 8 + match_offset_bits_count_table[(offset - 1) >> 8];
+
+    if (length == 2)
+        return (offset <= 0x100) ? 11 : LZ_PRICE_INVALID;
+
+    if (length >= 9)
+        return 4 + 8 + offset_bits;
+
+    return match_count_bits_count_table[length - 2] + offset_bits;
+}
+
+// Builds the code lengths the tables of a block get from how often each symbol is used
+void count_symbols(vars_t *v, uint32 start, uint32 end, const lz_match *parse, uint16 *raw, uint16 *len, uint16 *pos, uint32 *literals)
+{
+    huftable_t tables[3][16];
+    uint32 data_length = 0;
+
+    clear_table(tables[0], 16);
+    clear_table(tables[1], 16);
+    clear_table(tables[2], 16);
+    *literals = 0;
+
+    for (uint32 i = start; i < end; )
+    {
+        if (parse[i].length)
+        {
+            tables[0][(data_length <= 1) ? data_length : bits_count(data_length)].l1++;
+            tables[1][(parse[i].offset - 1 <= 1) ? parse[i].offset - 1 : bits_count(parse[i].offset - 1)].l1++;
+            tables[2][(parse[i].length - 2 <= 1) ? parse[i].length - 2 : bits_count(parse[i].length - 2)].l1++;
+            data_length = 0;
+            i += parse[i].length;
+        }
+        else
+        {
+            data_length++;
+            (*literals)++;
+            i++;
+        }
+    }
+    tables[0][(data_length <= 1) ? data_length : bits_count(data_length)].l1++;
+
+    for (int t = 0; t < 3; ++t)
+    {
+        uint16 *depths = (t == 0) ? raw : (t == 1) ? len : pos;
+
+        proc_16(v, tables[t], 16);
+        for (int i = 0; i < 16; ++i)
+            depths[i] = tables[t][i].bit_depth;
+    }
+}
+
+// Exact size in bits of a method 1 block, tables included
+uint32 block_bits_m1(uint32 start, uint32 end, const lz_match *parse, const price_tables_t *prices)
+{
+    uint32 bits = 16 + 3 * 5;
+    uint32 data_length = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (prices->raw[i]) bits += 4;
+        if (prices->len[i]) bits += 4;
+        if (prices->pos[i]) bits += 4;
+    }
+
+    for (uint32 i = start; i < end; )
+    {
+        if (parse[i].length)
+        {
+            bits += symbol_price(prices->raw, data_length) + symbol_price(prices->len, parse[i].offset - 1) + symbol_price(prices->pos, parse[i].length - 2);
+            data_length = 0;
+            i += parse[i].length;
+        }
+        else
+        {
+            bits += 8;
+            data_length++;
+            i++;
+        }
+    }
+
+    return bits + symbol_price(prices->raw, data_length);
+}
+
+// Method 1 prices depend on the tables, which depend on the parse. Each pass parses with the
+// tables of the pass before, the smallest result is kept.
+void parse_block_m1(vars_t *v, uint32 start, uint32 end)
+{
+    price_tables_t prices;
+    uint32 best_bits = 0xFFFFFFFF;
+
+    for (int i = 0; i < 16; ++i)
+        prices.raw[i] = prices.len[i] = prices.pos[i] = 4;
+    prices.literal = 8 * PRICE_SCALE;
+
+    for (int pass = 0; pass < OPTIMAL_PASSES; ++pass)
+    {
+        uint32 literals, bits;
+        int run_bits;
+
+        lz_optimal_parse(&v->matches, start, end, prices.literal, match_price_m1, &prices, v->parse);
+        count_symbols(v, start, end, v->parse, prices.raw, prices.len, prices.pos, &literals);
+
+        bits = block_bits_m1(start, end, v->parse, &prices);
+        if (bits < best_bits)
+        {
+            best_bits = bits;
+            memcpy(&v->best_parse[start], &v->parse[start], (end - start) * sizeof(*v->parse));
+        }
+
+        // what the literal runs cost beyond a run of 0 in front of every match, spread over the literals
+        run_bits = bits - 8 * literals;
+        for (uint32 i = start; i < end; )
+        {
+            if (v->parse[i].length)
+            {
+                run_bits -= symbol_price(prices.raw, 0) + symbol_price(prices.len, v->parse[i].offset - 1) + symbol_price(prices.pos, v->parse[i].length - 2);
+                i += v->parse[i].length;
+            }
+            else
+                i++;
+        }
+        if (run_bits < 0)
+            run_bits = 0;
+        prices.literal = 8 * PRICE_SCALE + (literals ? ((uint32)run_bits * PRICE_SCALE) / literals / 2 : 0);
+    }
+
+    memcpy(&v->parse[start], &v->best_parse[start], (end - start) * sizeof(*v->parse));
+}
+
+// Fills in the tables and the list of literal runs and matches of a block like proc_6 does,
+// with the matches from the optimal parse
+void parse_block(vars_t *v)
+{
+    uint32 start = v->v7;
+    uint32 end = v->v7 + v->pack_block_size;
+    uint32 data_length = 0;
+
+    if (end > v->unpacked_size)
+        end = v->unpacked_size;
+
+    if (v->method == 1)
+        parse_block_m1(v, start, end);
+    else
+        lz_optimal_parse(&v->matches, start, end, 9, match_price_m2, NULL, v->parse);
+
+    v->v17 = 0;
+    v->temp_offset = 0;
+
+    for (uint32 i = start; i < end; )
+    {
+        // method 1 keeps literals in tmp_crc_data until a word of bits is done, so a long
+        // run of them ends the block early
+        if (v->method == 1 && data_length == OPTIMAL_MAX_LITERALS)
+            break;
+
+        if (v->parse[i].length)
+        {
+            update_bits_table(v, v->raw_table, data_length);
+            update_bits_table(v, v->pos_table, v->parse[i].length - 2);
+            update_bits_table(v, v->len_table, v->parse[i].offset - 1);
+
+            v->v17++;
+            data_length = 0;
+            i += v->parse[i].length;
+        }
+        else
+        {
+            data_length++;
+            i++;
+        }
+    }
+
+    update_bits_table(v, v->raw_table, data_length);
+    v->v17++;
+
+    v->temp_offset = 0;
+}
+
 void compress_data_2(vars_t *v)
 {
     int src_offset = v->read_start_offset;
 
     while (v->v7 < v->unpacked_size)
     {
-        proc_6(v);
+        if (v->optimal)
+            parse_block(v);
+        else
+            proc_6(v);
         v->input_offset = src_offset;
 
         while (v->v17--)
@@ -964,7 +1186,10 @@ void compress_data_1(vars_t *v)
         clear_table(v->pos_table, _countof(v->pos_table));
         clear_table(v->raw_table, _countof(v->raw_table));
 
-        proc_6(v);
+        if (v->optimal)
+            parse_block(v);
+        else
+            proc_6(v);
         v->input_offset = src_offset;
 
         proc_16(v, v->raw_table, _countof(v->raw_table));
@@ -1069,6 +1294,20 @@ void do_pack_data(vars_t *v)
 
     init_dicts(v);
 
+    if (v->optimal)
+    {
+        // matches of every position of the whole file, found on all cores at once
+        lz_config config = { 2, v->max_matches, v->dict_size, 4096, 0 };
+
+        if (lz_find_matches(&v->input[v->read_start_offset], v->unpacked_size, &config, &v->matches))
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        v->parse = (lz_match *)malloc(v->unpacked_size * sizeof(*v->parse));
+        v->best_parse = (lz_match *)malloc(v->unpacked_size * sizeof(*v->best_parse));
+    }
+
     write_dword_be(v->output, &v->output_offset, (RNC_SIGN << 8) | (v->method & 0xFF));
     write_dword_be(v->output, &v->output_offset, v->unpacked_size);
     write_dword_be(v->output, &v->output_offset, 0);
@@ -1120,6 +1359,13 @@ void do_pack_data(vars_t *v)
     free(v->mem3);
     free(v->mem4);
     free(v->mem5);
+
+    if (v->optimal)
+    {
+        lz_free_matches(&v->matches);
+        free(v->parse);
+        free(v->best_parse);
+    }
 }
 
 int do_pack(vars_t *v)
@@ -1140,6 +1386,11 @@ int do_pack(vars_t *v)
 
 uint8 read_source_byte(vars_t *v)
 {
+    // how far the output gets past packed data that hasn't been read yet, for the in-place margin
+    if (v->in_place_written - (RNC_HEADER_SIZE + v->in_place_read) > v->in_place_lead)
+        v->in_place_lead = v->in_place_written - (RNC_HEADER_SIZE + v->in_place_read);
+    v->in_place_read++;
+
     if (v->pack_block_start == &v->mem1[0xFFFD])
     {
         int left_size = v->file_size - v->input_offset;
@@ -1264,6 +1515,7 @@ void write_decoded_byte(vars_t *v, uint8 b)
     }
 
     *v->window++ = b;
+    v->in_place_written++;
     v->unpacked_crc_real = crc_table[(v->unpacked_crc_real ^ b) & 0xFF] ^ (v->unpacked_crc_real >> 8);
 }
 
@@ -1454,6 +1706,9 @@ int do_unpack_data(vars_t *v)
     v->bit_count = 0;
     v->bit_buffer = 0;
     v->processed_size = 0;
+    v->in_place_read = 0;
+    v->in_place_written = 0;
+    v->in_place_lead = 0;
 
     uint16 specified_key = v->enc_key;
 
@@ -1502,6 +1757,39 @@ int do_unpack(vars_t *v)
     return do_unpack_data(v); // data
 }
 
+// Pads the packed file to 16 bytes and ends it with the in-place margin and the unpacked size.
+// With the file DMAed to the end of a buffer that much larger than the unpacked data, it can be
+// unpacked into the start of the same buffer without writing over data that is still to be read.
+int append_in_place_trailer(vars_t *v)
+{
+    vars_t *u = init_vars();
+    u->puse_mode = 'u';
+    u->dict_size = v->dict_size;
+    u->input = &v->output[v->write_start_offset];
+    u->file_size = v->output_offset - v->write_start_offset;
+    u->output = (uint8*)malloc(MAX_BUF_SIZE);
+
+    // unpack it again to see how close the output comes to the packed data
+    int error_code = do_unpack(u);
+    if (!error_code)
+    {
+        uint32 padded_size = (u->file_size + 8 + 15) & ~15;
+        uint32 start = (u->in_place_lead + 15) & ~15;
+        uint32 buffer_size = (start + padded_size > v->file_size) ? (start + padded_size) : v->file_size;
+
+        while (v->output_offset < v->write_start_offset + padded_size - 8)
+            write_byte(v->output, &v->output_offset, 0);
+
+        write_dword_be(v->output, &v->output_offset, ((buffer_size + 15) & ~15) - v->file_size);
+        write_dword_be(v->output, &v->output_offset, v->file_size);
+    }
+
+    free(u->output);
+    free(u);
+
+    return error_code;
+}
+
 int do_search(vars_t *v, size_t input_size, int save)
 {
     int error_code = 11;
@@ -1572,7 +1860,9 @@ void print_usage()
     printf("Unpack        : <u> <infile.bin> [outfile.bin] [-i=hex_offset_to_read_from] [-k=hex_key_if_protected]\n");
     printf("Search        : <s> <infile.bin>\n");
     printf("Seach&Extract : <e> <infile.bin>\n");
-    printf("Pack          : <p> <infile.bin> [outfile.bin] <-m=1|2> [-k=hex_key_to_protect]\n");
+    printf("Pack          : <p> <infile.bin> [outfile.bin] <-m=1|2> [-k=hex_key_to_protect] [-t] [-p]\n");
+    printf("                -t pads the output to 16 bytes and ends it with the in-place margin and unpacked size\n");
+    printf("                -p picks the matches that make the output the smallest, searching on every core\n");
 }
 
 int parse_args(int argc, char **argv, vars_t *vars)
@@ -1599,6 +1889,21 @@ int parse_args(int argc, char **argv, vars_t *vars)
     {
         if (((argv[i][0] == '-') || (argv[i][0] == '/'))) {
             char which = argv[i][1];
+
+            // -t and -p take no value
+            if (which == 't')
+            {
+                vars->in_place = 1;
+                i++;
+                continue;
+            }
+            if (which == 'p')
+            {
+                vars->optimal = 1;
+                i++;
+                continue;
+            }
+
             // If argument is just the letter, use next arg; otherwise, use what's after it
             char const *arg_ptr = argv[i][2] ? &argv[i][2] : argv[++i];
 
@@ -1693,7 +1998,11 @@ int main(int argc, char *argv[])
     int error_code = 0;
     switch (v->puse_mode)
     {
-    case 'p': error_code = do_pack(v); break;
+    case 'p':
+        error_code = do_pack(v);
+        if (!error_code && v->in_place)
+            error_code = append_in_place_trailer(v);
+        break;
     case 'u': error_code = do_unpack(v); break;
     case 's':
     case 'e': error_code = do_search(v, v->file_size, v->puse_mode == 'e'); break;
@@ -0,0 +1,628 @@
+#!/usr/bin/env python3
+"""
+Chooses the codec of every compressed segment for COMPRESS=mixed.
+
+  segment_codec.py plan [--budget <bytes>] [--tools <dir>] [-v] -o <plan.txt> <segment.bin>...
+  segment_codec.py pack [--tools <dir>] --plan <plan.txt> <segment.bin> <segment.szp>
+
+plan compresses each segment with every codec, then decodes the result again with a model of the
+decoder that src/boot uses for it, which counts the operations the decoder goes through. Together
+with the time the PI takes to DMA the compressed data, that gives an estimate of how long the
+segment takes to load on the console. Every segment gets its fastest codec. With a budget, every
+segment starts out with its smallest codec instead, and the ones that save the most time per byte
+of ROM move to faster codecs for as long as the total size of the segments stays within the
+budget.
+
+pack writes the segment with the codec from the plan. The .szp files start with a 16 byte header,
+the codec in the first byte (SEGMENT_CODEC_* in src/boot/memory.c) and the decompressed size in
+the word at 4. The codec's own data follows, padded to 16 bytes.
+"""
+import argparse
+import multiprocessing
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+CODECS = ["none", "rnc1", "rnc2", "yay0", "mio0", "gzip"]
+HEADER_SIZE = 0x10
+
+CPU_HZ = 93750000
+# What PI DMAs get from the cartridge with the usual ROM timings.
+PI_BYTES_PER_SECOND = 5000000
+
+# Estimated CPU cycles per operation of each decoder, counted from the loops in src/boot/*.s and,
+# for gzip, from what inflate_fast compiles to. Cache misses on the data are folded in.
+CYCLES = {
+    "none": {},
+    "rnc1": {
+        "table": 120, "table_entry": 90,    # make_huftable, per table and per code in it
+        "symbol": 22, "symbol_scan": 6,     # input_value, per symbol and per table entry looked at
+        "extra_bit": 3,
+        "literal_run": 20, "literal": 8,
+        "match": 10, "match_byte": 7,
+    },
+    "rnc2": {
+        "bit": 5,
+        "literal": 10,
+        "match": 14, "match_byte": 7,
+    },
+    "yay0": {
+        "flags": 5,
+        "literal": 11,
+        "match": 12, "long_match": 4, "match_byte": 7,
+    },
+    "mio0": {
+        "flags": 5,
+        "literal": 11,
+        "match": 11, "match_byte": 7,
+    },
+    "gzip": {
+        "block": 300, "dynamic_table": 3000, "code_length": 25,
+        "stored_byte": 2,
+        "literal": 18,
+        "match": 32, "match_byte": 3,
+    },
+}
+# gzip with FAST_INFLATE, where inflate_segment in src/boot/inflate.s decodes it instead of zlib.
+FAST_INFLATE_CYCLES = {
+    "block": 30, "dynamic_table": 20000, "code_length": 15,  # clearing and filling the tables
+    "stored_byte": 6,
+    "literal": 17,
+    "match": 64, "match_byte": 2,
+}
+
+
+class DecodeError(Exception):
+    pass
+
+
+def be32(data, offset):
+    return struct.unpack_from(">I", data, offset)[0]
+
+
+def copy_match(out, offset, count):
+    if offset > len(out) or offset <= 0:
+        raise DecodeError("match reaches before the start of the data")
+    start = len(out) - offset
+    for i in range(count):
+        out.append(out[start + i])
+
+
+def decode_yay0(data, mio0=False):
+    """
+    Same as slidstart (yay0) and decompress (mio0).
+    """
+    size = be32(data, 4)
+    link = be32(data, 8)
+    chunk = be32(data, 12)
+    flags = HEADER_SIZE
+    out = bytearray()
+    ops = dict.fromkeys(["flags", "literal", "match", "long_match", "match_byte"], 0)
+    bits = 0
+    word = 0
+
+    while len(out) < size:
+        if bits == 0:
+            word = be32(data, flags)
+            flags += 4
+            bits = 32
+            ops["flags"] += 1
+        if word & 0x80000000:
+            out.append(data[chunk])
+            chunk += 1
+            ops["literal"] += 1
+        else:
+            pair = (data[link] << 8) | data[link + 1]
+            link += 2
+            count = pair >> 12
+            if mio0:
+                count += 3
+            elif count == 0:
+                count = data[chunk] + 18
+                chunk += 1
+                ops["long_match"] += 1
+            else:
+                count += 2
+            copy_match(out, (pair & 0xFFF) + 1, count)
+            ops["match"] += 1
+            ops["match_byte"] += count
+        word = (word << 1) & 0xFFFFFFFF
+        bits -= 1
+    return bytes(out[:size]), ops
+
+
+RNC_HEADER_SIZE = 18
+
+
+class RncBits:
+    def __init__(self, data):
+        self.data = data + bytes(4)
+        self.pos = RNC_HEADER_SIZE
+        self.buffer = 0
+        self.count = 0
+
+    def read_byte(self):
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+
+class Rnc1Bits(RncBits):
+    """
+    16-bit little endian words read from the low bit up. Literal bytes come from after the word
+    being read.
+    """
+    def bits(self, count):
+        if count <= self.count:
+            value = self.buffer & ((1 << count) - 1)
+            self.buffer >>= count
+            self.count -= count
+            return value
+        word = self.data[self.pos] | (self.data[self.pos + 1] << 8)
+        self.pos += 2
+        used = count - self.count
+        value = self.buffer | ((word & ((1 << used) - 1)) << self.count)
+        self.buffer = word >> used
+        self.count = 16 - used
+        return value
+
+    def peek(self, count):
+        word = self.data[self.pos] | (self.data[self.pos + 1] << 8)
+        return (self.buffer | (word << self.count)) & ((1 << count) - 1)
+
+
+class Rnc2Bits(RncBits):
+    """
+    Bytes read from the high bit down, in between the literal bytes.
+    """
+    def bit(self):
+        if self.count == 0:
+            self.buffer = self.read_byte()
+            self.count = 8
+        self.count -= 1
+        return (self.buffer >> self.count) & 1
+
+    def bits(self, count):
+        value = 0
+        for _ in range(count):
+            value = (value << 1) | self.bit()
+        return value
+
+
+def reverse_bits(value, count):
+    result = 0
+    for _ in range(count):
+        result = (result << 1) | (value & 1)
+        value >>= 1
+    return result
+
+
+def rnc1_read_table(stream, ops):
+    depths = []
+    codes = []
+    num_codes = min(stream.bits(5), 16)
+    for _ in range(num_codes):
+        depths.append(stream.bits(4))
+    # Canonical codes, shortest first, stored bit reversed as they are read from the low bit up.
+    value = 0
+    for depth in range(1, 17):
+        for i in range(num_codes):
+            if depths[i] == depth:
+                codes.append((i, depth, reverse_bits(value >> (32 - depth), depth)))
+                value += 1 << (32 - depth)
+    ops["table"] += 1
+    ops["table_entry"] += num_codes
+    return sorted(codes)
+
+
+def rnc1_decode(stream, table, ops):
+    ops["symbol"] += 1
+    for scanned, (i, depth, code) in enumerate(table, 1):
+        if stream.peek(depth) == code:
+            stream.bits(depth)
+            ops["symbol_scan"] += scanned
+            if i < 2:
+                return i
+            ops["extra_bit"] += i - 1
+            return stream.bits(i - 1) | (1 << (i - 1))
+    raise DecodeError("no code matches")
+
+
+def decode_rnc1(data):
+    size = be32(data, 4)
+    stream = Rnc1Bits(data)
+    out = bytearray()
+    ops = dict.fromkeys(CYCLES["rnc1"], 0)
+
+    stream.bits(2)
+    while len(out) < size:
+        literals = rnc1_read_table(stream, ops)
+        offsets = rnc1_read_table(stream, ops)
+        counts = rnc1_read_table(stream, ops)
+        subchunks = stream.bits(16)
+        for i in range(subchunks):
+            length = rnc1_decode(stream, literals, ops)
+            if length:
+                out += stream.data[stream.pos:stream.pos + length]
+                stream.pos += length
+                ops["literal_run"] += 1
+                ops["literal"] += length
+            if i < subchunks - 1:
+                offset = rnc1_decode(stream, offsets, ops) + 1
+                count = rnc1_decode(stream, counts, ops) + 2
+                copy_match(out, offset, count)
+                ops["match"] += 1
+                ops["match_byte"] += count
+        if subchunks == 0 and not literals:
+            raise DecodeError("empty block")
+    return bytes(out[:size]), ops
+
+
+def rnc2_read_offset(stream):
+    offset = 0
+    if stream.bit():
+        offset = stream.bit()
+        if stream.bit():
+            offset = ((offset << 1) | stream.bit()) | 4
+            if not stream.bit():
+                offset = (offset << 1) | stream.bit()
+        elif not offset:
+            offset = stream.bit() + 2
+    return ((offset << 8) | stream.read_byte()) + 1
+
+
+def decode_rnc2(data):
+    size = be32(data, 4)
+    stream = Rnc2Bits(data)
+    out = bytearray()
+    ops = dict.fromkeys(CYCLES["rnc2"], 0)
+    bits_before = 0
+
+    stream.bits(2)
+    while len(out) < size:
+        before = len(out)
+        while True:
+            if not stream.bit():
+                out.append(stream.read_byte())
+                ops["literal"] += 1
+                continue
+            if stream.bit():
+                if stream.bit():
+                    if stream.bit():
+                        count = stream.read_byte() + 8
+                        if count == 8:
+                            stream.bit()
+                            break
+                    else:
+                        count = 3
+                    offset = rnc2_read_offset(stream)
+                else:
+                    count = 2
+                    offset = stream.read_byte() + 1
+            else:
+                count = stream.bit() + 4
+                if stream.bit():
+                    count = ((count - 1) << 1) + stream.bit()
+                if count == 9:
+                    length = (stream.bits(4) << 2) + 12
+                    out += stream.data[stream.pos:stream.pos + length]
+                    stream.pos += length
+                    ops["literal"] += length
+                    continue
+                offset = rnc2_read_offset(stream)
+            copy_match(out, offset, count)
+            ops["match"] += 1
+            ops["match_byte"] += count
+        if len(out) == before and stream.pos >= len(data):
+            raise DecodeError("data ends early")
+    return bytes(out[:size]), ops
+
+
+DEFLATE_LENGTH_BASE = [3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                       35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258]
+DEFLATE_LENGTH_EXTRA = [0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0]
+DEFLATE_DIST_BASE = [1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577]
+DEFLATE_DIST_EXTRA = [0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                      7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13]
+DEFLATE_CODE_LENGTH_ORDER = [16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15]
+
+
+class DeflateBits:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+        self.buffer = 0
+        self.count = 0
+
+    def bits(self, count):
+        while self.count < count:
+            if self.pos >= len(self.data):
+                raise DecodeError("data ends early")
+            self.buffer |= self.data[self.pos] << self.count
+            self.pos += 1
+            self.count += 8
+        value = self.buffer & ((1 << count) - 1)
+        self.buffer >>= count
+        self.count -= count
+        return value
+
+
+def deflate_table(lengths):
+    """
+    Returns {(length, code): symbol} for the canonical code with the given lengths.
+    """
+    table = {}
+    code = 0
+    for length in range(1, 16):
+        for symbol, symbol_length in enumerate(lengths):
+            if symbol_length == length:
+                table[(length, code)] = symbol
+                code += 1
+        code <<= 1
+    return table
+
+
+def deflate_decode(stream, table):
+    code = 0
+    for length in range(1, 16):
+        code = (code << 1) | stream.bits(1)
+        symbol = table.get((length, code))
+        if symbol is not None:
+            return symbol
+    raise DecodeError("no code matches")
+
+
+def inflate(data):
+    stream = DeflateBits(data)
+    out = bytearray()
+    ops = dict.fromkeys(CYCLES["gzip"], 0)
+    fixed = None
+
+    final = 0
+    while not final:
+        final = stream.bits(1)
+        kind = stream.bits(2)
+        ops["block"] += 1
+        if kind == 0:
+            stream.buffer = stream.count = 0
+            length = data[stream.pos] | (data[stream.pos + 1] << 8)
+            stream.pos += 4
+            out += data[stream.pos:stream.pos + length]
+            stream.pos += length
+            ops["stored_byte"] += length
+            continue
+        if kind == 1:
+            if fixed is None:
+                fixed = (deflate_table([8] * 144 + [9] * 112 + [7] * 24 + [8] * 8), deflate_table([5] * 30))
+            literals, distances = fixed
+        elif kind == 2:
+            num_literals = stream.bits(5) + 257
+            num_distances = stream.bits(5) + 1
+            num_lengths = stream.bits(4) + 4
+            code_lengths = [0] * 19
+            for i in range(num_lengths):
+                code_lengths[DEFLATE_CODE_LENGTH_ORDER[i]] = stream.bits(3)
+            lengths_table = deflate_table(code_lengths)
+            lengths = []
+            while len(lengths) < num_literals + num_distances:
+                symbol = deflate_decode(stream, lengths_table)
+                if symbol < 16:
+                    lengths.append(symbol)
+                elif symbol == 16:
+                    lengths += [lengths[-1]] * (stream.bits(2) + 3)
+                elif symbol == 17:
+                    lengths += [0] * (stream.bits(3) + 3)
+                else:
+                    lengths += [0] * (stream.bits(7) + 11)
+            ops["dynamic_table"] += 1
+            ops["code_length"] += len(lengths)
+            literals = deflate_table(lengths[:num_literals])
+            distances = deflate_table(lengths[num_literals:])
+        else:
+            raise DecodeError("bad block type")
+
+        while True:
+            symbol = deflate_decode(stream, literals)
+            if symbol < 256:
+                out.append(symbol)
+                ops["literal"] += 1
+            elif symbol == 256:
+                break
+            else:
+                symbol -= 257
+                count = DEFLATE_LENGTH_BASE[symbol] + stream.bits(DEFLATE_LENGTH_EXTRA[symbol])
+                symbol = deflate_decode(stream, distances)
+                offset = DEFLATE_DIST_BASE[symbol] + stream.bits(DEFLATE_DIST_EXTRA[symbol])
+                copy_match(out, offset, count)
+                ops["match"] += 1
+                ops["match_byte"] += count
+    return bytes(out), ops
+
+
+def compress(codec, raw, tools, optimal=False):
+    """
+    Returns the codec's data for raw, without the segment header. With optimal, the LZ codecs
+    pick their matches with the optimal parse.
+    """
+    if codec == "none":
+        return raw
+    if codec == "gzip":
+        # Same as gzip -9 without the gzip header and trailer, inflate is told there are none.
+        deflate = zlib.compressobj(9, zlib.DEFLATED, -zlib.MAX_WBITS)
+        return deflate.compress(raw) + deflate.flush()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        with open(os.path.join(tmp, "in.bin"), "wb") as f:
+            f.write(raw)
+        # Relative paths, rncpack takes arguments starting with a slash for options.
+        tools = os.path.abspath(tools)
+        if codec in ("rnc1", "rnc2"):
+            command = [os.path.join(tools, "rncpack"), "p", "in.bin", "out.bin", "-m" + codec[3]]
+        elif codec == "yay0":
+            command = [os.path.join(tools, "slienc"), "in.bin", "out.bin"]
+        else:
+            command = [os.path.join(tools, "mio0"), "in.bin", "out.bin"]
+        if optimal:
+            command.append("-p")
+        subprocess.run(command, check=True, cwd=tmp, stdout=subprocess.DEVNULL)
+        with open(os.path.join(tmp, "out.bin"), "rb") as f:
+            return f.read()
+
+
+def decode(codec, data):
+    if codec == "none":
+        return data, {}
+    if codec == "rnc1":
+        return decode_rnc1(data)
+    if codec == "rnc2":
+        return decode_rnc2(data)
+    if codec in ("yay0", "mio0"):
+        return decode_yay0(data, codec == "mio0")
+    return inflate(data)
+
+
+def segment_size(data):
+    return HEADER_SIZE + ((len(data) + 0xF) & ~0xF)
+
+
+def load_cycles(codec, size, ops, fast_inflate=False):
+    dma = size * CPU_HZ // PI_BYTES_PER_SECOND
+    cycles = FAST_INFLATE_CYCLES if codec == "gzip" and fast_inflate else CYCLES[codec]
+    return dma + sum(cycles.get(op, 0) * count for op, count in ops.items())
+
+
+def measure(args):
+    """
+    Returns [(size, cycles, codec)] for every codec that gets the segment back unchanged.
+    """
+    path, tools, optimal, fast_inflate = args
+    with open(path, "rb") as f:
+        raw = f.read()
+
+    results = []
+    for codec in CODECS:
+        data = compress(codec, raw, tools, optimal)
+        try:
+            decoded, ops = decode(codec, data)
+        except (DecodeError, IndexError) as e:
+            decoded, ops = None, str(e)
+        if decoded != raw:
+            print("warning: {} doesn't decode back with {}, not using it".format(path, codec), file=sys.stderr)
+            continue
+        size = segment_size(data)
+        results.append((size, load_cycles(codec, size, ops, fast_inflate), codec))
+    return results
+
+
+def choose(candidates, budget):
+    """
+    Takes [(size, cycles, codec)] per segment and returns the index of the chosen one for each.
+    """
+    if not budget:
+        return [min(range(len(c)), key=lambda i: (c[i][1], c[i][0])) for c in candidates]
+
+    chosen = [min(range(len(c)), key=lambda i: (c[i][0], c[i][1])) for c in candidates]
+    total = sum(c[i][0] for c, i in zip(candidates, chosen))
+    if total > budget:
+        print("warning: the segments take {} bytes at their smallest, over the budget of {}".format(total, budget),
+              file=sys.stderr)
+        return chosen
+
+    while True:
+        best = None
+        for segment, c in enumerate(candidates):
+            size, cycles, _ = c[chosen[segment]]
+            for i, (new_size, new_cycles, _) in enumerate(c):
+                if new_cycles >= cycles or total - size + new_size > budget:
+                    continue
+                gain = (cycles - new_cycles) / max(new_size - size, 1)
+                if best is None or gain > best[0]:
+                    best = (gain, segment, i)
+        if best is None:
+            return chosen
+        _, segment, i = best
+        total += candidates[segment][i][0] - candidates[segment][chosen[segment]][0]
+        chosen[segment] = i
+
+
+def plan(args):
+    with multiprocessing.Pool() as pool:
+        candidates = pool.map(measure, [(path, args.tools, args.optimal, args.fast_inflate)
+                                        for path in args.segments])
+
+    chosen = choose(candidates, args.budget)
+    lines = ["{} {}\n".format(c[i][2], path) for path, c, i in zip(args.segments, candidates, chosen)]
+
+    if args.verbose:
+        for path, c, i in zip(args.segments, candidates, chosen):
+            options = "  ".join("{}:{}/{:.2f}ms".format(codec, size, cycles * 1000.0 / CPU_HZ)
+                                for size, cycles, codec in c)
+            print("{:<48} {:<5} {}".format(path, c[i][2], options))
+        size = sum(c[i][0] for c, i in zip(candidates, chosen))
+        cycles = sum(c[i][1] for c, i in zip(candidates, chosen))
+        print("{} bytes, {:.1f}ms to load every segment once".format(size, cycles * 1000.0 / CPU_HZ))
+
+    # Leave the plan alone if nothing changed, so the segments aren't packed again.
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            if f.readlines() == lines:
+                return
+    with open(args.output, "w") as f:
+        f.writelines(lines)
+
+
+def pack(args):
+    codec = None
+    with open(args.plan) as f:
+        for line in f:
+            line_codec, path = line.split(None, 1)
+            if os.path.normpath(path.strip()) == os.path.normpath(args.segment):
+                codec = line_codec
+    if codec is None:
+        sys.exit("{} isn't in {}".format(args.segment, args.plan))
+
+    with open(args.segment, "rb") as f:
+        raw = f.read()
+    data = compress(codec, raw, args.tools, args.optimal)
+    header = struct.pack(">B3xI8x", CODECS.index(codec), len(raw))
+    with open(args.output, "wb") as f:
+        f.write(header + data + bytes(segment_size(data) - HEADER_SIZE - len(data)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Chooses the codec of every compressed segment.")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    plan_parser = commands.add_parser("plan", help="pick a codec for every segment")
+    plan_parser.add_argument("--budget", type=int, default=0,
+                             help="most bytes the segments may take together, 0 for no limit")
+    plan_parser.add_argument("--tools", default=os.path.dirname(os.path.abspath(__file__)))
+    plan_parser.add_argument("--optimal", action="store_true", help="compress with the optimal parse")
+    plan_parser.add_argument("--fast-inflate", action="store_true",
+                             help="gzip segments are decoded by inflate_segment instead of zlib")
+    plan_parser.add_argument("-v", "--verbose", action="store_true", help="print the estimates for every codec")
+    plan_parser.add_argument("-o", "--output", required=True)
+    plan_parser.add_argument("segments", nargs="+")
+
+    pack_parser = commands.add_parser("pack", help="compress a segment with the codec from the plan")
+    pack_parser.add_argument("--tools", default=os.path.dirname(os.path.abspath(__file__)))
+    pack_parser.add_argument("--plan", required=True)
+    pack_parser.add_argument("--optimal", action="store_true", help="compress with the optimal parse")
+    # Only changes the costs the plan is made with, the segments are packed the same either way.
+    pack_parser.add_argument("--fast-inflate", action="store_true", help=argparse.SUPPRESS)
+    pack_parser.add_argument("segment")
+    pack_parser.add_argument("output")
+
+    args = parser.parse_args()
+    if args.command == "plan":
+        plan(args)
+    else:
+        pack(args)
+
+
+if __name__ == "__main__":
+    main()
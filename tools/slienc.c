@@ -2,16 +2,21 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "lzparse.h"
+
 // Yay0 "slienc" compression tool
 // originally decompiled by SimonTime
 
 int main(int argc, const char **argv, const char **envp);
 void encode();
+void encodeoptimal();
+unsigned int matchprice(void *arg, int length, int offset);
 void search(unsigned int a1, int a2, int *a3, unsigned int *a4);
 int mischarsearch(unsigned char *a1, int a2, unsigned char *a3, int a4);
 void initskip(unsigned char *a1, int a2);
 void writeshort(short a1);
 void writeint4(int a1);
+int inplacemargin(int filesize);
 
 unsigned short skip[256]; // idb
 int cp; // weak
@@ -31,11 +36,24 @@ int main(int argc, const char **argv, const char **envp)
 {
     char src[999];
 	char dest[999];
+	int inplace = 0;
+	int optimal = 0;
 
+	// -t pads the output to 16 bytes and ends it with the in-place margin and the raw size
+	// -p picks the matches that make the output the smallest instead of the longest ones
+	while (argc > 1 && (!strcmp(argv[1], "-t") || !strcmp(argv[1], "-p")))
+	{
+		if (argv[1][1] == 't')
+			inplace = 1;
+		else
+			optimal = 1;
+		argc--;
+		argv++;
+	}
 
 	if (argc < 3)
 	{
-		fprintf(stderr, "slienc [infile] [outfile]\n");
+		fprintf(stderr, "slienc [-t] [-p] [infile] [outfile]\n");
 		return 1;
 	}
 	
@@ -71,7 +89,10 @@ int main(int argc, const char **argv, const char **envp)
 		exit(1);
 	}
 	
-	encode();
+	if (optimal)
+		encodeoptimal();
+	else
+		encode();
 	
 	fprintf(fp, "Yay0");
 	
@@ -87,6 +108,18 @@ int main(int argc, const char **argv, const char **envp)
 		writeshort(pol[i]);
 	
 	fwrite(def, 1u, dp, fp);
+
+	if (inplace)
+	{
+		int size = 16 + 4 * cp + 2 * pp + dp;
+		int padded = (size + 8 + 15) & ~15;
+
+		for (int i = size; i < padded - 8; i++)
+			fputc(0, fp);
+
+		writeint4(inplacemargin(padded));
+		writeint4(insize);
+	}
 	fclose(fp);
 	
 	return 0;
@@ -202,6 +235,121 @@ void encode()
 	//fprintf(stderr, "IN=%d OUT=%d\n", insize, dp + 2 * pp + 4 * cp + 16);
 }
 
+// Bits a match takes up: the flag, the link and the extra length byte of long matches
+unsigned int matchprice(void *arg, int length, int offset)
+{
+	return (length > 0x11) ? 25 : 17;
+}
+
+// Same output as encode, with the matches chosen by lzparse to make it as small as possible
+void encodeoptimal()
+{
+	lz_config config = { 3, 273, 4096, 4096, 0 };
+	lz_match_table table;
+	lz_match *parse = malloc(insize * sizeof(*parse));
+	unsigned int v1 = 2147483648;
+
+	dp = 0;
+	pp = 0;
+	cp = 0;
+	cmd = calloc(insize / 32 + 2, 4u);
+	pol = malloc(2 * (insize / 3 + 1));
+	def = malloc(insize + 1);
+
+	if (lz_find_matches(bz, insize, &config, &table))
+	{
+		fprintf(stderr, "OUT OF MEMORY!\n");
+		exit(1);
+	}
+	lz_optimal_parse(&table, 0, insize, 9, matchprice, NULL, parse);
+
+	for (int v0 = 0; v0 < insize; )
+	{
+		int length = parse[v0].length;
+		int v3 = parse[v0].offset - 1;
+
+		if (length == 0)
+		{
+			cmd[cp] |= v1;
+			def[dp++] = bz[v0++];
+		}
+		else
+		{
+			if (length > 0x11)
+			{
+				pol[pp++] = v3;
+				def[dp++] = length - 18;
+			}
+			else
+			{
+				pol[pp++] = v3 | ((length - 2) << 12);
+			}
+			v0 += length;
+		}
+		v1 >>= 1;
+		if (!v1)
+		{
+			v1 = 2147483648;
+			cmd[++cp] = 0;
+		}
+	}
+	if ( v1 != 0x80000000 )
+		++cp;
+
+	lz_free_matches(&table);
+	free(parse);
+}
+
+// How much larger than the raw data a buffer has to be to decompress the data into it, with
+// the file (filesize bytes) DMAed to its end. Data the decoder has read can be written over,
+// so the output may catch up with the data but not overtake what is still to be read.
+int inplacemargin(int filesize)
+{
+	int linkoffset = 4 * cp + 16;
+	int chunkoffset = 2 * pp + 4 * cp + 16;
+	int out = 0;
+	int lead = 0;
+	int link = 0;
+	int chunk = 0;
+	int start;
+	int bufsize;
+
+	for (int bit = 0; out < insize; bit++)
+	{
+		// The decoder loads a word of flags every 32 bits
+		if (bit % 32 == 0 && out - (16 + 4 * (bit / 32)) > lead)
+			lead = out - (16 + 4 * (bit / 32));
+
+		if (cmd[bit / 32] & (0x80000000u >> (bit % 32)))
+		{
+			if (out - (chunkoffset + chunk) > lead)
+				lead = out - (chunkoffset + chunk);
+			chunk++;
+			out++;
+		}
+		else
+		{
+			if (out - (linkoffset + 2 * link) > lead)
+				lead = out - (linkoffset + 2 * link);
+			if (pol[link] >> 12)
+			{
+				out += (pol[link] >> 12) + 2;
+			}
+			else
+			{
+				if (out - (chunkoffset + chunk) > lead)
+					lead = out - (chunkoffset + chunk);
+				out += def[chunk++] + 18;
+			}
+			link++;
+		}
+	}
+
+	start = (lead + 15) & ~15;
+	bufsize = (start + filesize > insize) ? start + filesize : insize;
+	return ((bufsize + 15) & ~15) - insize;
+}
+
 void search(unsigned int a1, int a2, int *a3, unsigned int *a4)
 {
 	unsigned int v4; // ebx
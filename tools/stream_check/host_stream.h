@@ -0,0 +1,19 @@
+#ifndef HOST_STREAM_H
+#define HOST_STREAM_H
+
+#include <PR/ultratypes.h>
+
+// What the RAM a DMA goes to holds until its message has been received.
+#define HOST_DMA_PENDING_BYTE 0xAA
+
+struct HostDmaStats {
+    u32 numDmas;
+    u32 numBytes;
+    u32 maxInFlight;
+};
+
+extern struct HostDmaStats gHostDmaStats;
+
+u32 host_dma_pending(void);
+
+#endif // HOST_STREAM_H
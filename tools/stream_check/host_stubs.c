@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ultra64.h>
+
+#include "game/memory.h"
+
+#include "host_stream.h"
+
+/**
+ * Host replacements for the libultra functions streamed decompression calls (bcopy and bzero
+ * come from libc). PI DMAs are kept in a queue and only copied when osRecvMesg takes their
+ * message, the way they finish one after the other on console. Until then the RAM they go to
+ * holds HOST_DMA_PENDING_BYTE, so reading a chunk before it has arrived, or after a later DMA was
+ * started into it, shows up as wrong output.
+ *
+ * Device addresses are u32, like on console, so the ROM image has to be in the low part of the
+ * address space, which is where a -no-pie executable has its data.
+ */
+
+#define HOST_DMA_QUEUE_SIZE 64
+
+#define ALIGN16(val) (((val) + 0xF) & ~0xF)
+
+struct HostDma {
+    u8 *dest;
+    const u8 *src;
+    u32 size;
+};
+
+static struct HostDma sDmaQueue[HOST_DMA_QUEUE_SIZE];
+static u32 sDmaHead;
+static u32 sDmaTail;
+
+struct HostDmaStats gHostDmaStats;
+
+static void host_dma_fail(const char *message) {
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+void osInvalDCache(UNUSED void *vaddr, UNUSED s32 nbytes) {
+}
+
+void osCreateMesgQueue(UNUSED OSMesgQueue *mq, UNUSED OSMesg *msg, UNUSED s32 count) {
+    if (sDmaHead != sDmaTail) {
+        host_dma_fail("a message queue was created while DMAs were still going");
+    }
+}
+
+s32 osPiStartDma(UNUSED OSIoMesg *mb, UNUSED s32 priority, UNUSED s32 direction, u32 devAddr, void *vAddr,
+                 u32 nbytes, UNUSED OSMesgQueue *mq) {
+    struct HostDma *dma = &sDmaQueue[sDmaTail % HOST_DMA_QUEUE_SIZE];
+
+    if (sDmaTail - sDmaHead >= HOST_DMA_QUEUE_SIZE) {
+        host_dma_fail("too many DMAs at once");
+    }
+    if ((devAddr & 0x1) || ((uintptr_t) vAddr & 0x7) || (nbytes & 0x1)) {
+        host_dma_fail("DMA that isn't aligned");
+    }
+
+    __builtin_memset(vAddr, HOST_DMA_PENDING_BYTE, nbytes);
+    dma->dest = vAddr;
+    dma->src = (const u8 *) (uintptr_t) devAddr;
+    dma->size = nbytes;
+    sDmaTail++;
+
+    gHostDmaStats.numDmas++;
+    gHostDmaStats.numBytes += nbytes;
+    if (sDmaTail - sDmaHead > gHostDmaStats.maxInFlight) {
+        gHostDmaStats.maxInFlight = (sDmaTail - sDmaHead);
+    }
+    return 0;
+}
+
+s32 osRecvMesg(UNUSED OSMesgQueue *mq, UNUSED OSMesg *msg, UNUSED s32 flag) {
+    struct HostDma *dma = &sDmaQueue[sDmaHead % HOST_DMA_QUEUE_SIZE];
+
+    if (sDmaHead == sDmaTail) {
+        // On console this waits forever.
+        host_dma_fail("waited for a DMA that was never started");
+    }
+
+    __builtin_memcpy(dma->dest, dma->src, dma->size);
+    sDmaHead++;
+    return 0;
+}
+
+void dma_read(u8 *dest, u8 *srcStart, u8 *srcEnd) {
+    __builtin_memcpy(dest, srcStart, ALIGN16(srcEnd - srcStart));
+}
+
+u32 host_dma_pending(void) {
+    return (sDmaTail - sDmaHead);
+}
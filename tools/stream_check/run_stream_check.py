@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Runs stream_check_rnc1, stream_check_rnc2 and stream_check_gzip over segments compressed the way
+the ROM build compresses them (rnc1rules.mk, rnc2rules.mk and gziprules.mk).
+
+Besides the segments given, a few are made up here: parts of the repo's own sources cut to end
+just before, on and after chunk boundaries, long runs of the same byte, and random bytes, which
+don't compress at all.
+
+Usage: run_stream_check.py --rncpack <rncpack> --filesizer <filesizer> [segments...]
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+
+BUILD_DIR = "build/segments"
+CHUNK_SIZE = 0x1000
+REPO_ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def write_file(path, data):
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def make_segments():
+    sources = b""
+    for name in sorted(os.listdir(os.path.join(REPO_ROOT, "src", "game"))):
+        if name.endswith(".c"):
+            sources += read_file(os.path.join(REPO_ROOT, "src", "game", name))
+
+    rng = random.Random(64)
+    segments = {}
+    for size in (0x100, CHUNK_SIZE - 1, CHUNK_SIZE, CHUNK_SIZE + 1, 3 * CHUNK_SIZE - 0x10,
+                 4 * CHUNK_SIZE, 4 * CHUNK_SIZE + 2, 9 * CHUNK_SIZE + 0x123, 0x40000):
+        segments["sources_%X" % size] = sources[:size]
+    segments["zeros"] = bytes(0x24000)
+    segments["random"] = bytes(rng.getrandbits(8) for _ in range(5 * CHUNK_SIZE + 0x44))
+    segments["mixed"] = b"".join(
+        bytes(rng.getrandbits(8) for _ in range(rng.randrange(0x800))) + bytes([rng.getrandbits(8)]) * rng.randrange(0x2000)
+        for _ in range(24))
+
+    paths = []
+    for name, data in segments.items():
+        path = os.path.join(BUILD_DIR, name + ".bin")
+        write_file(path, data)
+        paths.append(path)
+    return paths
+
+
+def compress(codec, path, out, args):
+    """
+    Returns False if the segment can't be checked with the codec.
+    """
+    if codec in ("rnc1", "rnc2"):
+        subprocess.run([args.rncpack, "p", path, out, "-m" + codec[-1]], check=True, stdout=subprocess.DEVNULL)
+        # rncpack cuts what it packs off at the size of the segment, so segments that don't get any
+        # smaller can't be unpacked again, not even by rncpack itself.
+        unpacked = subprocess.run([args.rncpack, "u", out, out + ".unpacked"], stdout=subprocess.DEVNULL)
+        if unpacked.returncode != 0 or read_file(out + ".unpacked") != read_file(path):
+            print("%s: rncpack can't unpack it again, skipped" % path)
+            return False
+    else:
+        # gzip's own header is stripped, and the size is added to the end by filesizer.
+        gz = subprocess.run(["gzip", "-c", "-9", "-n", path], check=True, capture_output=True).stdout
+        write_file(out + ".strip", gz[10:])
+        subprocess.run([args.filesizer, out + ".strip", out, str(os.path.getsize(path))], check=True)
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(usage=__doc__.strip().splitlines()[-1])
+    parser.add_argument("--rncpack", required=True)
+    parser.add_argument("--filesizer", required=True)
+    parser.add_argument("segments", nargs="*")
+    args = parser.parse_args()
+
+    os.makedirs(BUILD_DIR, exist_ok=True)
+    segments = make_segments() + args.segments
+
+    failed = False
+    for codec in ("rnc1", "rnc2", "gzip"):
+        check_args = []
+        for i, path in enumerate(segments):
+            out = os.path.join(BUILD_DIR, "%d_%s.%s" % (i, os.path.basename(path), codec))
+            if compress(codec, path, out, args):
+                check_args += [out, path]
+
+        print("./stream_check_" + codec)
+        sys.stdout.flush()
+        if subprocess.run(["./stream_check_" + codec] + check_args).returncode != 0:
+            failed = True
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
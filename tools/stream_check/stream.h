@@ -0,0 +1,10 @@
+// Forced in ahead of every file stream_check is built from, so it checks streamed decompression
+// whether or not the ROM has it enabled. bcopy and bzero come from the host's libc, libultra only
+// declares them for TARGET_N64.
+#include <strings.h>
+
+#include "config.h"
+
+#ifndef STREAMED_DECOMPRESSION
+#define STREAMED_DECOMPRESSION
+#endif
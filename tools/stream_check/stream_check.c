@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+
+#include "sm64.h"
+#include "boot/stream_decompress.h"
+
+#include "host_stream.h"
+
+/**
+ * Checks STREAMED_DECOMPRESSION: every segment given is streamed through stream_decompress from a
+ * ROM image, the way load_segment_decompress does, and has to come out the same as the data it
+ * was compressed from, which is what decompress() gives for it. Built once per codec.
+ *
+ * Usage: stream_check_<codec> <compressed> <uncompressed> [<compressed> <uncompressed>...]
+ *
+ * The compressed files are what the ROM holds: the output of rncpack for RNC, and gzip output
+ * without its header and with the filesizer trailer for gzip (see rnc1rules.mk and gziprules.mk).
+ */
+
+#define ROM_SIZE  0x800000
+#define DEST_SIZE 0x800000
+// Written after the end of the decompressed data, which has to be left alone.
+#define CANARY_SIZE 0x100
+#define CANARY_BYTE 0x77
+
+#define ALIGN16(val) (((val) + 0xF) & ~0xF)
+
+static u8 sRom[ROM_SIZE] ALIGNED16;
+static u8 sDest[DEST_SIZE + CANARY_SIZE] ALIGNED16;
+static u8 sExpected[DEST_SIZE];
+static u8 sBuffer[STREAM_DECOMPRESS_BUFFER_SIZE] ALIGNED16;
+
+static u32 read_file(const char *path, u8 *dest, u32 maxSize) {
+    FILE *file = fopen(path, "rb");
+    size_t size;
+
+    if (file == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    size = fread(dest, 1, maxSize, file);
+    if (!feof(file) && fgetc(file) != EOF) {
+        fprintf(stderr, "%s: larger than 0x%X bytes\n", path, maxSize);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return size;
+}
+
+/**
+ * Streams the segment at the start of the ROM image into sDest. Returns FALSE and says why if it
+ * doesn't match sExpected.
+ */
+static s32 check_segment(const char *path, u32 compressedSize, u32 expectedSize) {
+    struct DmaStream stream;
+    u32 size, i;
+
+    // Segments start at a 16 byte boundary in ROM, and DMAs of the last chunk go up to the next one.
+    memset(sRom + compressedSize, 0, ALIGN16(compressedSize) - compressedSize);
+    memset(sDest, CANARY_BYTE, sizeof(sDest));
+
+    size = stream_decompress_open(&stream, sBuffer, sRom, (sRom + compressedSize));
+    if (size != expectedSize) {
+        printf("%s: decompresses to 0x%X bytes instead of 0x%X\n", path, size, expectedSize);
+        stream_decompress_close(&stream);
+        return FALSE;
+    }
+
+    stream_decompress(&stream, sBuffer, sDest);
+    stream_decompress_close(&stream);
+
+    if (host_dma_pending() != 0) {
+        printf("%s: %u DMAs still going after stream_decompress_close\n", path, host_dma_pending());
+        return FALSE;
+    }
+    for (i = 0; i < expectedSize; i++) {
+        if (sDest[i] != sExpected[i]) {
+            printf("%s: byte 0x%X is %02X instead of %02X\n", path, i, sDest[i], sExpected[i]);
+            return FALSE;
+        }
+    }
+    for (i = expectedSize; i < expectedSize + CANARY_SIZE; i++) {
+        if (sDest[i] != CANARY_BYTE) {
+            printf("%s: byte 0x%X after the end was written to\n", path, (i - expectedSize));
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+int main(int argc, char *argv[]) {
+    s32 numSegments = 0;
+    s32 numFailed = 0;
+    u32 numBytes = 0;
+    s32 i;
+
+    if (argc < 3 || (argc % 2) != 1) {
+        fprintf(stderr, "Usage: %s <compressed> <uncompressed> [<compressed> <uncompressed>...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 1; i < argc; i += 2) {
+        u32 compressedSize = read_file(argv[i], sRom, ROM_SIZE - 0x10);
+        u32 expectedSize = read_file(argv[i + 1], sExpected, DEST_SIZE);
+
+        if (!check_segment(argv[i], compressedSize, expectedSize)) {
+            numFailed++;
+        }
+        numSegments++;
+        numBytes += expectedSize;
+    }
+
+    printf("%d segments, 0x%X bytes, %u DMAs, at most %u at once: %d failed\n",
+           numSegments, numBytes, gHostDmaStats.numDmas, gHostDmaStats.maxInFlight, numFailed);
+    return (numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}